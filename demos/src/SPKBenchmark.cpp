@@ -0,0 +1,1017 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2011 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+// Headless benchmarks of the SPARK core (no rendering is involved)
+// Usage : SPKBenchmark [-quick] [benchmark name]...
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include <SPARK.h>
+
+const float DELTA_TIME = 0.016f;
+
+bool quick = false; // reduces the size of the benchmarks
+
+// Returns the time in ms elapsed since the given time point
+double getElapsedTime(const std::chrono::steady_clock::time_point& startTime)
+{
+	return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Updates a system a given number of times and returns the mean time of an update in ms
+// The system is first updated for the given warm up time to reach a steady state
+double updateSystem(const SPK::Ref<SPK::System>& system,float warmUpTime,size_t nbFrames)
+{
+	for (float time = 0.0f; time < warmUpTime; time += DELTA_TIME)
+		system->updateParticles(DELTA_TIME);
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < nbFrames; ++i)
+		system->updateParticles(DELTA_TIME);
+	return getElapsedTime(startTime) / nbFrames;
+}
+
+// Gets the numbers of threads to bench (1 means no thread pool)
+std::vector<size_t> getNbThreadsList()
+{
+	std::vector<size_t> nbThreadsList;
+	const size_t maxNbThreads = SPK::ThreadPool::getHardwareConcurrency();
+	for (size_t nbThreads = 1; nbThreads < maxNbThreads; nbThreads <<= 1)
+		nbThreadsList.push_back(nbThreads);
+	nbThreadsList.push_back(maxNbThreads);
+	if (maxNbThreads == 1)
+		nbThreadsList.push_back(2); // to check the overhead of the pool
+	return nbThreadsList;
+}
+
+//////////////////////
+// Groups benchmark //
+//////////////////////
+
+// Creates a group with a continuous flow of particles
+const float FLOW_LIFE_TIME = 2.0f;
+
+SPK::Ref<SPK::Group> createFlowGroup(const SPK::Ref<SPK::System>& system,size_t capacity,float offset)
+{
+	const float lifeTime = FLOW_LIFE_TIME;
+
+	SPK::Ref<SPK::Group> group = system->createGroup(capacity);
+	group->setLifeTime(lifeTime,lifeTime);
+	group->addEmitter(SPK::RandomEmitter::create(SPK::Sphere::create(SPK::Vector3D(offset,0.0f,0.0f),1.0f),true,-1,capacity / lifeTime,0.5f,1.0f));
+	group->setColorInterpolator(SPK::ColorSimpleInterpolator::create(0xFFFFFFFF,0xFF000000));
+	group->setParamInterpolator(SPK::PARAM_SCALE,SPK::FloatSimpleInterpolator::create(1.0f,2.0f));
+	group->addModifier(SPK::Gravity::create(SPK::Vector3D(0.0f,-1.0f,0.0f)));
+	group->addModifier(SPK::Friction::create(0.2f));
+	group->addModifier(SPK::PointMass::create(SPK::Vector3D(offset,1.0f,0.0f),0.5f));
+	return group;
+}
+
+void benchGroups()
+{
+	const size_t nbGroups = 16;
+	const size_t nbParticlesPerGroup = quick ? 1000 : 10000;
+	const size_t nbFrames = quick ? 20 : 200;
+
+	std::cout << "GROUPS BENCH : " << nbGroups << " groups of " << nbParticlesPerGroup << " particles" << std::endl;
+
+	std::vector<size_t> nbThreadsList = getNbThreadsList();
+	double referenceTime = 0.0;
+	for (size_t i = 0; i < nbThreadsList.size(); ++i)
+	{
+		SPK::ThreadPool* threadPool = nbThreadsList[i] > 1 ? new SPK::ThreadPool(nbThreadsList[i] - 1) : NULL;
+
+		SPK::Ref<SPK::System> system = SPK::System::create(true);
+		system->setThreadPool(threadPool);
+		for (size_t j = 0; j < nbGroups; ++j)
+			createFlowGroup(system,nbParticlesPerGroup,static_cast<float>(j));
+
+		// A chain of dependent groups that must be updated serially
+		SPK::Ref<SPK::Group> trailGroup = system->createGroup(nbParticlesPerGroup);
+		trailGroup->setLifeTime(0.5f,0.5f);
+		system->getGroup(0)->addModifier(SPK::EmitterAttacher::create(trailGroup,SPK::RandomEmitter::create(SPK::Point::create(),true,-1,2.0f)));
+
+		const double time = updateSystem(system,FLOW_LIFE_TIME,nbFrames);
+		if (i == 0)
+			referenceTime = time;
+
+		std::cout << "  " << std::setw(2) << nbThreadsList[i] << " thread(s) : "
+			<< std::fixed << std::setprecision(3) << time << "ms per update, "
+			<< std::setprecision(2) << referenceTime / time << "x, "
+			<< system->getNbParticles() << " particles" << std::endl;
+
+		system.reset();
+		delete threadPool;
+	}
+}
+
+//////////////////////
+// Chunks benchmark //
+//////////////////////
+
+void benchChunks()
+{
+	const size_t nbParticles = quick ? 50000 : 500000;
+	const size_t nbFrames = quick ? 20 : 100;
+
+	std::cout << "CHUNKS BENCH : 1 group of " << nbParticles << " particles" << std::endl;
+
+	std::vector<size_t> nbThreadsList = getNbThreadsList();
+	double referenceTime = 0.0;
+	for (size_t i = 0; i < nbThreadsList.size(); ++i)
+	{
+		SPK::ThreadPool* threadPool = nbThreadsList[i] > 1 ? new SPK::ThreadPool(nbThreadsList[i] - 1) : NULL;
+
+		SPK::Ref<SPK::System> system = SPK::System::create(true);
+		system->setThreadPool(threadPool);
+		SPK::Ref<SPK::Group> group = createFlowGroup(system,nbParticles,0.0f);
+		group->addModifier(SPK::LinearForce::createAsSimpleForce(SPK::Vector3D(1.0f,0.0f,0.0f),SPK::Sphere::create(SPK::Vector3D(),2.0f),SPK::ZONE_TEST_INSIDE));
+
+		const double time = updateSystem(system,FLOW_LIFE_TIME,nbFrames);
+		if (i == 0)
+			referenceTime = time;
+
+		std::cout << "  " << std::setw(2) << nbThreadsList[i] << " thread(s) : "
+			<< std::fixed << std::setprecision(3) << time << "ms per update, "
+			<< std::setprecision(2) << referenceTime / time << "x, "
+			<< system->getNbParticles() << " particles" << std::endl;
+
+		system.reset();
+		delete threadPool;
+	}
+}
+
+///////////////////////
+// Kernels benchmark //
+///////////////////////
+
+void benchKernels()
+{
+	const size_t nbParticles = quick ? 100000 : 1000000;
+	const size_t nbLoops = quick ? 20 : 200;
+
+	std::cout << "KERNELS BENCH : " << nbParticles << " particles" << std::endl;
+
+	std::vector<float> ages(nbParticles,0.0f);
+	std::vector<float> lifeTimes(nbParticles,1000.0f);
+	std::vector<float> energies(nbParticles,1.0f);
+	std::vector<SPK::Vector3D> positions(nbParticles);
+	std::vector<SPK::Vector3D> oldPositions(nbParticles);
+	std::vector<SPK::Vector3D> velocities(nbParticles,SPK::Vector3D(1.0f,2.0f,3.0f));
+
+	const char* const NAMES[] = { "scalar","sse2","avx2" };
+	const SPK::InstructionSet bestInstructionSet = SPK::Kernels::getBestInstructionSet();
+	for (int i = SPK::INSTRUCTION_SET_SCALAR; i <= SPK::INSTRUCTION_SET_AVX2; ++i)
+	{
+		SPK::InstructionSet instructionSet = static_cast<SPK::InstructionSet>(i);
+		std::cout << "  " << std::setw(6) << NAMES[i] << " : ";
+		if (!SPK::Kernels::setInstructionSet(instructionSet))
+		{
+			std::cout << "not compiled" << std::endl;
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for (size_t j = 0; j < nbLoops; ++j)
+		{
+			SPK::Kernels::add(&ages[0],DELTA_TIME,nbParticles);
+			SPK::Kernels::computeEnergies(&energies[0],&ages[0],&lifeTimes[0],nbParticles);
+			SPK::Kernels::integrate(&positions[0],&oldPositions[0],&velocities[0],DELTA_TIME,nbParticles);
+		}
+		const double time = getElapsedTime(startTime);
+
+		std::cout << std::fixed << std::setprecision(1)
+			<< nbParticles * nbLoops / (time * 1000.0) << "M particles per second" << std::endl;
+	}
+	SPK::Kernels::setInstructionSet(bestInstructionSet);
+}
+
+///////////////////////////////
+// Streamed update benchmark //
+///////////////////////////////
+
+void benchStreamedUpdate()
+{
+	const size_t nbParticles = quick ? 50000 : 500000;
+	const size_t nbFrames = quick ? 20 : 100;
+
+	std::cout << "STREAMED UPDATE BENCH : 1 group of " << nbParticles << " particles" << std::endl;
+
+	double referenceTime = 0.0;
+	for (size_t i = 0; i < 2; ++i)
+	{
+		SPK::Ref<SPK::System> system = SPK::System::create(true);
+		SPK::Ref<SPK::Group> group = createFlowGroup(system,nbParticles,0.0f);
+		group->enableStreamedUpdate(i == 1);
+
+		const double time = updateSystem(system,FLOW_LIFE_TIME,nbFrames);
+		if (i == 0)
+			referenceTime = time;
+
+		std::cout << "  " << (i == 0 ? "  direct" : "streamed") << " update : "
+			<< std::fixed << std::setprecision(3) << time << "ms per update, "
+			<< std::setprecision(2) << referenceTime / time << "x, "
+			<< system->getNbParticles() << " particles" << std::endl;
+	}
+}
+
+//////////////////////
+// Fusion benchmark //
+//////////////////////
+
+void benchFusion()
+{
+	const size_t nbParticles = quick ? 100000 : 1000000;
+	const size_t nbFrames = quick ? 10 : 50;
+
+	std::cout << "FUSION BENCH : 1 group of " << nbParticles << " immortal particles and 5 chunk safe modifiers" << std::endl;
+
+	// Serial update and update with all the hardware threads
+	std::vector<size_t> nbThreadsList(1,1);
+	if (SPK::ThreadPool::getHardwareConcurrency() > 1)
+		nbThreadsList.push_back(SPK::ThreadPool::getHardwareConcurrency());
+
+	for (size_t t = 0; t < nbThreadsList.size(); ++t)
+	{
+		const size_t nbThreads = nbThreadsList[t];
+		SPK::ThreadPool* threadPool = nbThreads > 1 ? new SPK::ThreadPool(nbThreads - 1) : NULL;
+
+		double referenceTime = 0.0;
+		for (size_t i = 0; i < 4; ++i)
+		{
+			const bool streamed = i >= 2;
+			const bool fusion = (i & 1) != 0;
+
+			SPK::Ref<SPK::System> system = SPK::System::create(true);
+			system->setThreadPool(threadPool);
+
+			// The particles are all born at once so that the updates only measure the modifiers
+			SPK::Ref<SPK::Group> group = system->createGroup(nbParticles);
+			group->setImmortal(true);
+			group->enableStreamedUpdate(streamed);
+			group->enableModifierFusion(fusion);
+			group->setParamInterpolator(SPK::PARAM_ANGLE,SPK::FloatRandomInitializer::create(0.0f,6.28f));
+			group->setParamInterpolator(SPK::PARAM_ROTATION_SPEED,SPK::FloatRandomInitializer::create(-1.0f,1.0f));
+			group->addModifier(SPK::Rotator::create());
+			group->addModifier(SPK::Gravity::create(SPK::Vector3D(0.0f,-1.0f,0.0f)));
+			group->addModifier(SPK::PointMass::create(SPK::Vector3D(0.0f,1.0f,0.0f),0.5f));
+			group->addModifier(SPK::LinearForce::create(SPK::Vector3D(1.0f,0.0f,0.0f)));
+			group->addModifier(SPK::Friction::create(0.2f));
+			group->addParticles(static_cast<unsigned int>(nbParticles),SPK::Sphere::create(SPK::Vector3D(),1.0f),SPK::RandomEmitter::create());
+
+			const double time = updateSystem(system,DELTA_TIME,nbFrames);
+			if (i == 0)
+				referenceTime = time;
+
+			std::cout << "  " << std::setw(2) << nbThreads << " thread(s), "
+				<< (streamed ? "streamed" : "  direct") << " update, " << (fusion ? "   fused" : "separate") << " passes : "
+				<< std::fixed << std::setprecision(3) << time << "ms per update, "
+				<< std::setprecision(2) << referenceTime / time << "x" << std::endl;
+		}
+
+		delete threadPool;
+	}
+}
+
+////////////////////////////
+// Vector field benchmark //
+////////////////////////////
+
+void benchVectorField()
+{
+	const size_t nbParticles = quick ? 100000 : 1000000;
+	const size_t nbFrames = quick ? 10 : 50;
+	const size_t nbPointMasses = 16;
+	const unsigned int resolution = 32;
+
+	std::cout << "VECTOR FIELD BENCH : 1 group of " << nbParticles << " immortal particles, "
+		<< nbPointMasses << " point masses against a " << resolution << "x" << resolution << "x" << resolution << " baked field" << std::endl;
+
+	// The point masses are spread on a circle
+	std::vector<SPK::Ref<SPK::Modifier> > pointMasses;
+	for (size_t i = 0; i < nbPointMasses; ++i)
+	{
+		const float angle = 6.28f * i / nbPointMasses;
+		pointMasses.push_back(SPK::PointMass::create(SPK::Vector3D(std::cos(angle),0.0f,std::sin(angle)),i % 2 == 0 ? 0.5f : -0.25f,0.1f));
+	}
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	SPK::Ref<SPK::VectorFieldForce> vectorField = SPK::VectorFieldForce::create(resolution,resolution,resolution,SPK::Vector3D(-2.0f,-2.0f,-2.0f),SPK::Vector3D(4.0f,4.0f,4.0f));
+	vectorField->bake(pointMasses);
+	std::cout << "  Baked in " << std::fixed << std::setprecision(3) << getElapsedTime(startTime) << "ms" << std::endl;
+
+	double referenceTime = 0.0;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		const bool streamed = i >= 2;
+		const bool baked = (i & 1) != 0;
+
+		SPK::Ref<SPK::System> system = SPK::System::create(true);
+		SPK::Ref<SPK::Group> group = system->createGroup(nbParticles);
+		group->setImmortal(true);
+		group->enableStreamedUpdate(streamed);
+		if (baked)
+			group->addModifier(vectorField);
+		else
+			for (size_t j = 0; j < nbPointMasses; ++j)
+				group->addModifier(pointMasses[j]);
+		group->addParticles(static_cast<unsigned int>(nbParticles),SPK::Sphere::create(SPK::Vector3D(),1.5f),SPK::Vector3D());
+
+		const double time = updateSystem(system,DELTA_TIME,nbFrames);
+		if (i == 0)
+			referenceTime = time;
+
+		std::cout << "  " << (streamed ? "streamed" : "  direct") << " update, " << (baked ? "vector field" : "point masses") << " : "
+			<< std::fixed << std::setprecision(3) << time << "ms per update, "
+			<< std::setprecision(2) << referenceTime / time << "x" << std::endl;
+	}
+}
+
+//////////////////////////
+// Turbulence benchmark //
+//////////////////////////
+
+void benchTurbulence()
+{
+	const size_t nbParticles = quick ? 100000 : 1000000;
+	const size_t nbFrames = quick ? 10 : 50;
+
+	const float minLifeTime = 0.5f;
+	const float maxLifeTime = 1.5f;
+
+	std::cout << "TURBULENCE BENCH : 1 group of " << nbParticles << " particles in a continuous flow, random force against curl noise turbulence" << std::endl;
+
+	double referenceTime = 0.0;
+	for (size_t i = 0; i < 6; ++i)
+	{
+		const bool streamed = i >= 3;
+		const unsigned int nbOctaves = i % 3 == 2 ? 3 : 1;
+		const bool turbulence = i % 3 != 0;
+
+		SPK::Ref<SPK::System> system = SPK::System::create(true);
+		SPK::Ref<SPK::Group> group = system->createGroup(nbParticles);
+		group->setLifeTime(minLifeTime,maxLifeTime);
+		group->addEmitter(SPK::RandomEmitter::create(SPK::Sphere::create(SPK::Vector3D(),10.0f),true,-1,2.0f * nbParticles / (minLifeTime + maxLifeTime),0.0f,0.1f));
+		group->enableStreamedUpdate(streamed);
+		if (turbulence)
+			group->addModifier(SPK::Turbulence::create(1.0f,0.5f,nbOctaves));
+		else
+			group->addModifier(SPK::RandomForce::create(SPK::Vector3D(-1.0f,-1.0f,-1.0f),SPK::Vector3D(1.0f,1.0f,1.0f),0.1f,0.5f));
+
+		const double time = updateSystem(system,maxLifeTime,nbFrames);
+		if (i == 0)
+			referenceTime = time;
+
+		std::cout << "  " << (streamed ? "streamed" : "  direct") << " update, ";
+		if (turbulence)
+			std::cout << "turbulence (" << nbOctaves << " octave" << (nbOctaves > 1 ? "s" : "") << ")";
+		else
+			std::cout << "random force";
+		std::cout << " : " << std::fixed << std::setprecision(3) << time << "ms per update, "
+			<< std::setprecision(2) << referenceTime / time << "x" << std::endl;
+	}
+}
+
+//////////////////////
+// Deaths benchmark //
+//////////////////////
+
+void benchDeaths()
+{
+	const size_t nbParticles = quick ? 10000 : 100000;
+	const float lifeTime = 0.5f;
+
+	std::cout << "DEATHS BENCH : burst of " << nbParticles << " particles dying in the same frame" << std::endl;
+
+	SPK::Ref<SPK::System> system = SPK::System::create(true);
+	SPK::Ref<SPK::Group> group = system->createGroup(nbParticles);
+	group->setLifeTime(lifeTime,lifeTime);
+	group->setColorInterpolator(SPK::ColorSimpleInterpolator::create(0xFFFFFFFF,0xFF000000));
+	group->setParamInterpolator(SPK::PARAM_SCALE,SPK::FloatSimpleInterpolator::create(1.0f,2.0f));
+	group->addModifier(SPK::Gravity::create(SPK::Vector3D(0.0f,-1.0f,0.0f)));
+	group->addParticles(nbParticles,SPK::Sphere::create(SPK::Vector3D(),1.0f),SPK::Vector3D());
+
+	// Updates the system until the burst is dead and keeps track of the frame where it dies
+	double aliveTime = 0.0;
+	size_t nbAliveFrames = 0;
+	double deathTime = 0.0;
+	while (true)
+	{
+		const size_t nbParticlesBefore = system->getNbParticles();
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		system->updateParticles(DELTA_TIME);
+		const double time = getElapsedTime(startTime);
+
+		if (system->getNbParticles() == 0 && nbParticlesBefore > 0)
+		{
+			deathTime = time;
+			break;
+		}
+		else if (nbParticlesBefore > 0)
+		{
+			aliveTime += time;
+			++nbAliveFrames;
+		}
+	}
+
+	if (nbAliveFrames > 0)
+		aliveTime /= nbAliveFrames;
+
+	std::cout << "  alive frame : " << std::fixed << std::setprecision(3) << aliveTime << "ms per update" << std::endl;
+	std::cout << "  death frame : " << std::fixed << std::setprecision(3) << deathTime << "ms per update, "
+		<< std::setprecision(2) << deathTime / aliveTime << "x" << std::endl;
+}
+
+//////////////////////
+// Births benchmark //
+//////////////////////
+
+void benchBirths()
+{
+	const size_t nbParticles = quick ? 10000 : 100000;
+	const size_t nbBursts = quick ? 5 : 20;
+
+	std::cout << "BIRTHS BENCH : bursts of " << nbParticles << " particles born in the same frame" << std::endl;
+
+	// Each burst is emitted in a new system so that the frame only measures the births
+	double time = 0.0;
+	for (size_t i = 0; i < nbBursts; ++i)
+	{
+		SPK::Ref<SPK::System> system = SPK::System::create(true);
+		SPK::Ref<SPK::Group> group = system->createGroup(nbParticles);
+		group->setLifeTime(1.0f,2.0f);
+		group->addEmitter(SPK::SphericEmitter::create(SPK::Vector3D(0.0f,1.0f,0.0f),0.0f,3.14159f,SPK::Point::create(),true,nbParticles / 2,-1,1.0f,2.0f));
+		group->addEmitter(SPK::RandomEmitter::create(SPK::Sphere::create(SPK::Vector3D(),1.0f),true,nbParticles / 2,-1,0.5f,1.0f));
+		group->setColorInterpolator(SPK::ColorSimpleInterpolator::create(0xFFFFFFFF,0xFF000000));
+		group->setParamInterpolator(SPK::PARAM_SCALE,SPK::FloatRandomInitializer::create(0.5f,1.0f));
+		group->setParamInterpolator(SPK::PARAM_ANGLE,SPK::FloatRandomInitializer::create(0.0f,6.28f));
+		group->addModifier(SPK::Gravity::create(SPK::Vector3D(0.0f,-1.0f,0.0f)));
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		system->updateParticles(DELTA_TIME);
+		time += getElapsedTime(startTime);
+	}
+
+	std::cout << "  birth frame : " << std::fixed << std::setprecision(3) << time / nbBursts << "ms per update" << std::endl;
+}
+
+///////////////////////
+// Sorting benchmark //
+///////////////////////
+
+void benchSorting()
+{
+	const size_t nbParticles = quick ? 10000 : 200000;
+	const size_t nbFrames = quick ? 20 : 100;
+	const float cameraSpeeds[] = { 0.1f, 0.002f }; // radians per update
+
+	std::cout << "SORTING BENCH : flow of " << nbParticles << " particles sorted from a camera turning around them" << std::endl;
+
+	// The last modes only sort indices for rendering
+	const char* const NAMES[] = { "quick", "radix", "incremental", "radix indices", "incremental indices" };
+	const int nbModes = sizeof(NAMES) / sizeof(const char*);
+	for (size_t i = 0; i < sizeof(cameraSpeeds) / sizeof(float); ++i)
+	{
+		std::cout << "  camera turning by " << std::setprecision(3) << cameraSpeeds[i] << " radians per update" << std::endl;
+
+		double referenceTime = 0.0;
+		for (int j = -1; j < nbModes; ++j)
+		{
+			SPK::Ref<SPK::System> system = SPK::System::create(true);
+			SPK::Ref<SPK::Group> group = createFlowGroup(system,nbParticles,0.0f);
+			group->enableDistanceComputation(true); // for the reference time without sorting
+			if (j >= 0)
+			{
+				group->enableSorting(true);
+				group->enableIndexSorting(j > SPK::SORTING_INCREMENTAL);
+				group->setSortingMode(j > SPK::SORTING_INCREMENTAL ? static_cast<SPK::SortingMode>(j - 2) : static_cast<SPK::SortingMode>(j));
+			}
+
+			for (float time = 0.0f; time < FLOW_LIFE_TIME; time += DELTA_TIME)
+				system->updateParticles(DELTA_TIME);
+
+			double time = 0.0;
+			size_t nbUnsorted = 0;
+			for (size_t k = 0; k < nbFrames; ++k)
+			{
+				const float angle = k * cameraSpeeds[i];
+				system->setCameraPosition(SPK::Vector3D(std::cos(angle) * 10.0f,0.0f,std::sin(angle) * 10.0f));
+
+				std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+				system->updateParticles(DELTA_TIME);
+				time += getElapsedTime(startTime);
+
+				const unsigned int* sortedIndices = group->getSortedIndices();
+				if (j >= 0)
+					for (size_t l = 1; l < group->getNbParticles(); ++l)
+						if (sortedIndices != NULL ?
+							group->getParticle(sortedIndices[l - 1]).getSqrDistanceFromCamera() < group->getParticle(sortedIndices[l]).getSqrDistanceFromCamera() :
+							group->getParticle(l - 1).getSqrDistanceFromCamera() < group->getParticle(l).getSqrDistanceFromCamera())
+							++nbUnsorted;
+			}
+			time /= nbFrames;
+
+			if (j < 0)
+			{
+				referenceTime = time;
+				std::cout << "             no sorting : " << std::fixed << std::setprecision(3) << time << "ms per update" << std::endl;
+			}
+			else
+				std::cout << "    " << std::setw(19) << NAMES[j] << " : " << std::fixed << std::setprecision(3) << time << "ms per update, "
+					<< time - referenceTime << "ms to sort, " << nbUnsorted << " unsorted particles" << std::endl;
+		}
+	}
+}
+
+/////////////////////////////
+// Spatial indices benchmark //
+/////////////////////////////
+
+void benchSpatialIndices()
+{
+	const size_t nbSizes = 3;
+	const size_t SIZES[nbSizes] = { 10000,100000,1000000 };
+	const char* const NAMES[] = { "octree","grid","morton" };
+
+	std::cout << "SPATIAL INDICES BENCH : build and collision queries" << std::endl;
+
+	for (size_t i = 0; i < nbSizes; ++i)
+	{
+		const size_t nbParticles = quick ? SIZES[i] / 10 : SIZES[i];
+		const size_t nbFrames = std::max<size_t>(1,200000 / nbParticles);
+		const float radius = 0.05f;
+
+		double referenceTime = 0.0;
+		for (int j = SPK::SPATIAL_INDEX_OCTREE; j <= SPK::SPATIAL_INDEX_MORTON; ++j)
+		{
+			// Particles are kept still at a constant density whatever their number so that all indices are compared on the same positions
+			SPK::Ref<SPK::System> system = SPK::System::create(true);
+			SPK::Ref<SPK::Group> group = system->createGroup(nbParticles);
+			group->setImmortal(true);
+			group->setStill(true);
+			group->setPhysicalRadius(radius);
+			group->setSpatialIndexType(static_cast<SPK::SpatialIndexType>(j));
+			group->addModifier(SPK::Collider::create());
+			group->addParticles(nbParticles,SPK::Sphere::create(SPK::Vector3D(),radius * 3.0f * std::pow(static_cast<float>(nbParticles),1.0f / 3.0f)),SPK::Vector3D());
+
+			const double time = updateSystem(system,2.0f * DELTA_TIME,nbFrames); // the second update allocates the cells
+			if (j == SPK::SPATIAL_INDEX_OCTREE)
+				referenceTime = time;
+
+			std::cout << "  " << std::setw(7) << nbParticles << " particles, " << std::setw(6) << NAMES[j] << " : "
+				<< std::fixed << std::setprecision(3) << time << "ms per update, "
+				<< std::setprecision(2) << referenceTime / time << "x" << std::endl;
+		}
+	}
+}
+
+//////////////////////////
+// Collisions benchmark //
+//////////////////////////
+
+// Creates a group of particles on a lattice with velocities that do not depend on any random state
+SPK::Ref<SPK::Group> createCollisionGroup(const SPK::Ref<SPK::System>& system,size_t nbParticles,bool parallelSolving)
+{
+	const float radius = 0.05f;
+	const float spacing = radius * 2.4f;
+	const size_t side = static_cast<size_t>(std::ceil(std::pow(static_cast<float>(nbParticles),1.0f / 3.0f)));
+
+	SPK::Ref<SPK::Collider> collider = SPK::Collider::create(0.8f);
+	collider->enableParallelSolving(parallelSolving);
+
+	SPK::Ref<SPK::Group> group = system->createGroup(nbParticles);
+	group->setImmortal(true);
+	group->setPhysicalRadius(radius);
+	group->setSpatialIndexType(SPK::SPATIAL_INDEX_GRID);
+	group->addModifier(collider);
+
+	for (size_t i = 0; i < nbParticles; ++i)
+	{
+		const SPK::Vector3D position((i % side) * spacing,(i / side % side) * spacing,(i / side / side) * spacing);
+		const SPK::Vector3D velocity(std::sin(i * 0.7f),std::sin(i * 1.3f),std::sin(i * 2.9f));
+		group->addParticles(1,position,velocity);
+	}
+
+	return group;
+}
+
+void benchCollisions()
+{
+	const size_t nbParticles = quick ? 20000 : 200000;
+	const size_t nbFrames = quick ? 10 : 50;
+
+	std::cout << "COLLISIONS BENCH : 1 group of " << nbParticles << " colliding particles" << std::endl;
+
+	std::vector<size_t> nbThreadsList = getNbThreadsList();
+	nbThreadsList.insert(nbThreadsList.begin(),0); // 0 stands for the serial solver
+
+	double referenceTime = 0.0;
+	for (size_t i = 0; i < nbThreadsList.size(); ++i)
+	{
+		SPK::ThreadPool* threadPool = nbThreadsList[i] > 1 ? new SPK::ThreadPool(nbThreadsList[i] - 1) : NULL;
+
+		SPK::Ref<SPK::System> system = SPK::System::create(true);
+		system->setThreadPool(threadPool);
+		SPK::Ref<SPK::Group> group = createCollisionGroup(system,nbParticles,nbThreadsList[i] > 0);
+
+		const double time = updateSystem(system,2.0f * DELTA_TIME,nbFrames);
+		if (i == 0)
+			referenceTime = time;
+
+		// The checksum of the velocities must be the same for any number of threads
+		double checksum = 0.0;
+		for (SPK::ConstGroupIterator particleIt(*group); !particleIt.end(); ++particleIt)
+			checksum += particleIt->velocity().x + particleIt->velocity().y * 2.0f + particleIt->velocity().z * 3.0f;
+
+		if (nbThreadsList[i] == 0)
+			std::cout << "      serial : ";
+		else
+			std::cout << "  " << std::setw(2) << nbThreadsList[i] << " thread(s) : ";
+		std::cout << std::fixed << std::setprecision(3) << time << "ms per update, "
+			<< std::setprecision(2) << referenceTime / time << "x, checksum "
+			<< std::setprecision(6) << checksum << std::endl;
+
+		system.reset();
+		delete threadPool;
+	}
+}
+
+//////////////////////////
+// Billboards benchmark //
+//////////////////////////
+
+// Expands the quads particle by particle as renderers used to do
+void expandPerParticle(const SPK::Group& group,const SPK::Vector3D& side,const SPK::Vector3D& up,size_t atlasNbX,size_t atlasNbY,SPK::Vector3D* vertices,SPK::Color* colors,float* texCoords)
+{
+	for (SPK::ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+	{
+		float size = particleIt->getParam(SPK::PARAM_SCALE);
+		float angle = particleIt->getParam(SPK::PARAM_ANGLE);
+		SPK::Vector3D sideQuad = (side * std::cos(angle) + up * std::sin(angle)) * size;
+		SPK::Vector3D upQuad = (up * std::cos(angle) - side * std::sin(angle)) * size;
+
+		*(vertices++) = particleIt->position() + sideQuad + upQuad;
+		*(vertices++) = particleIt->position() - sideQuad + upQuad;
+		*(vertices++) = particleIt->position() - sideQuad - upQuad;
+		*(vertices++) = particleIt->position() + sideQuad - upQuad;
+		for (size_t i = 0; i < 4; ++i)
+			*(colors++) = particleIt->getColor();
+
+		int textureIndex = static_cast<int>(particleIt->getParam(SPK::PARAM_TEXTURE_INDEX));
+		float u0 = static_cast<float>(textureIndex % atlasNbX) / atlasNbX;
+		float v0 = static_cast<float>(textureIndex / atlasNbX) / atlasNbY;
+		float u1 = u0 + 1.0f / atlasNbX;
+		float v1 = v0 + 1.0f / atlasNbY;
+		*(texCoords++) = u1; *(texCoords++) = v0;
+		*(texCoords++) = u0; *(texCoords++) = v0;
+		*(texCoords++) = u0; *(texCoords++) = v1;
+		*(texCoords++) = u1; *(texCoords++) = v1;
+	}
+}
+
+void benchBillboards()
+{
+	const size_t nbParticles = quick ? 100000 : 1000000;
+	const size_t nbLoops = quick ? 20 : 100;
+
+	std::cout << "BILLBOARDS BENCH : " << nbParticles << " rotated and atlas textured quads" << std::endl;
+
+	const SPK::Vector3D side(0.6f,0.0f,-0.8f);
+	const SPK::Vector3D up(0.0f,1.0f,0.0f);
+
+	std::vector<SPK::Vector3D> vertices(nbParticles << 2);
+	std::vector<SPK::Color> colors(nbParticles << 2);
+	std::vector<float> texCoords(nbParticles << 3);
+
+	SPK::QuadVertexArrays arrays;
+	arrays.positions = &vertices[0];
+	arrays.positionStride = sizeof(SPK::Vector3D);
+	arrays.colors = &colors[0];
+	arrays.colorStride = sizeof(SPK::Color);
+	arrays.texCoords = &texCoords[0];
+	arrays.texCoordStride = 2 * sizeof(float);
+
+	SPK::QuadExpander expander;
+	expander.setOrientation(side,up);
+	expander.setTexturing(SPK::TEXTURE_MODE_2D,4,4);
+
+	// Each run is described by a number of threads (0 stands for the per particle expansion) and an instruction set
+	struct Run
+	{
+		size_t nbThreads;
+		SPK::InstructionSet instructionSet;
+	};
+
+	std::vector<Run> runs;
+	Run perParticleRun = { 0,SPK::INSTRUCTION_SET_SCALAR };
+	runs.push_back(perParticleRun);
+	Run scalarRun = { 1,SPK::INSTRUCTION_SET_SCALAR };
+	runs.push_back(scalarRun);
+	std::vector<size_t> nbThreadsList = getNbThreadsList();
+	for (size_t i = 0; i < nbThreadsList.size(); ++i)
+	{
+		Run run = { nbThreadsList[i],SPK::Kernels::getBestInstructionSet() };
+		runs.push_back(run);
+	}
+
+	// The same particles are expanded by all the runs
+	SPK::Ref<SPK::System> system = SPK::System::create(true);
+	SPK::Ref<SPK::Group> group = createFlowGroup(system,nbParticles,0.0f);
+	group->setParamInterpolator(SPK::PARAM_ANGLE,SPK::FloatRandomInitializer::create(0.0f,6.28f));
+	group->setParamInterpolator(SPK::PARAM_TEXTURE_INDEX,SPK::FloatRandomInitializer::create(0.0f,15.9f));
+	for (float time = 0.0f; time < FLOW_LIFE_TIME; time += DELTA_TIME)
+		system->updateParticles(DELTA_TIME);
+
+	const char* const NAMES[] = { "scalar","sse2","avx2" };
+	const SPK::InstructionSet bestInstructionSet = SPK::Kernels::getBestInstructionSet();
+	double referenceTime = 0.0;
+	for (size_t i = 0; i < runs.size(); ++i)
+	{
+		SPK::ThreadPool* threadPool = runs[i].nbThreads > 1 ? new SPK::ThreadPool(runs[i].nbThreads - 1) : NULL;
+		system->setThreadPool(threadPool);
+		SPK::Kernels::setInstructionSet(runs[i].instructionSet);
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for (size_t j = 0; j < nbLoops; ++j)
+			if (runs[i].nbThreads == 0)
+				expandPerParticle(*group,side,up,4,4,&vertices[0],&colors[0],&texCoords[0]);
+			else
+				expander.expand(*group,arrays);
+		const double time = getElapsedTime(startTime) / nbLoops;
+		if (i == 0)
+			referenceTime = time;
+
+		// The vertices must be the same whatever the number of threads and the instruction set
+		double checksum = 0.0;
+		for (size_t j = 0; j < group->getNbParticles() << 2; ++j)
+			checksum += vertices[j].x + vertices[j].y * 2.0f + vertices[j].z * 3.0f;
+
+		if (runs[i].nbThreads == 0)
+			std::cout << "      per particle : ";
+		else
+			std::cout << "  " << std::setw(6) << NAMES[runs[i].instructionSet] << " " << std::setw(2) << runs[i].nbThreads << " thread(s) : ";
+		std::cout << std::fixed << std::setprecision(3) << time << "ms per expansion, "
+			<< std::setprecision(2) << referenceTime / time << "x, checksum "
+			<< std::setprecision(3) << checksum << std::endl;
+
+		system->setThreadPool(NULL);
+		delete threadPool;
+	}
+	SPK::Kernels::setInstructionSet(bestInstructionSet);
+}
+
+///////////////////////
+// Effects benchmark //
+///////////////////////
+
+// Creates a short lived hit effect made of sparks and smoke
+SPK::Ref<SPK::System> createHitEffect(SPK::BlockAllocator* allocator)
+{
+	SPK::Ref<SPK::System> system = SPK::System::create(true);
+	system->setAllocator(allocator);
+
+	SPK::Ref<SPK::Group> sparks = system->createGroup(256);
+	sparks->setLifeTime(0.2f,0.5f);
+	sparks->addEmitter(SPK::SphericEmitter::create(SPK::Vector3D(0.0f,1.0f,0.0f),0.0f,1.5f,SPK::Point::create(),true,256,-1,2.0f,4.0f));
+	sparks->setColorInterpolator(SPK::ColorRandomInterpolator::create(0xFFFFFFFF,0xFFFF00FF,0xFF000000,0xFF800000));
+	sparks->setParamInterpolator(SPK::PARAM_SCALE,SPK::FloatRandomInterpolator::create(0.1f,0.2f,0.0f,0.05f));
+	sparks->addModifier(SPK::Gravity::create(SPK::Vector3D(0.0f,-9.8f,0.0f)));
+	sparks->addModifier(SPK::RandomForce::create(SPK::Vector3D(-1.0f,-1.0f,-1.0f),SPK::Vector3D(1.0f,1.0f,1.0f),0.05f,0.1f));
+
+	SPK::Ref<SPK::Group> smoke = system->createGroup(64);
+	smoke->setLifeTime(0.5f,1.0f);
+	smoke->addEmitter(SPK::RandomEmitter::create(SPK::Sphere::create(SPK::Vector3D(),0.2f),true,64,-1,0.1f,0.5f));
+	smoke->setColorInterpolator(SPK::ColorSimpleInterpolator::create(0x80808080,0x80808000));
+	smoke->setParamInterpolator(SPK::PARAM_SCALE,SPK::FloatSimpleInterpolator::create(0.5f,2.0f));
+	smoke->setParamInterpolator(SPK::PARAM_ANGLE,SPK::FloatRandomInterpolator::create(0.0f,3.14f,3.14f,6.28f));
+
+	return system;
+}
+
+void benchEffects()
+{
+	const size_t nbEffects = quick ? 2000 : 20000;
+	const size_t nbFrames = 4; // frames an effect lives before being destroyed
+
+	std::cout << "EFFECTS BENCH : " << nbEffects << " hit effects created, updated " << nbFrames << " times and destroyed" << std::endl;
+
+	const char* const NAMES[] = { "heap","block allocator","system pool" };
+
+	double referenceTime = 0.0;
+	for (size_t i = 0; i < 3; ++i)
+	{
+		SPK::BlockAllocator* allocator = i == 1 ? new SPK::BlockAllocator() : NULL;
+		SPK::SystemPool* pool = i == 2 ? new SPK::SystemPool(createHitEffect(NULL),1) : NULL;
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for (size_t j = 0; j < nbEffects; ++j)
+		{
+			SPK::Ref<SPK::System> system = pool != NULL ? pool->acquire() : createHitEffect(allocator);
+			for (size_t k = 0; k < nbFrames; ++k)
+				system->updateParticles(DELTA_TIME);
+			if (pool != NULL)
+				pool->release(system);
+		}
+		const double time = getElapsedTime(startTime) / nbEffects;
+		if (i == 0)
+			referenceTime = time;
+
+		std::cout << "  " << std::setw(15) << NAMES[i] << " : "
+			<< std::fixed << std::setprecision(4) << time << "ms per effect, "
+			<< std::setprecision(2) << referenceTime / time << "x";
+		if (allocator != NULL)
+			std::cout << ", " << allocator->getNbHeapAllocations() << " heap allocations for "
+				<< allocator->getNbHeapAllocations() + allocator->getNbRecycledAllocations() << " blocks";
+		if (pool != NULL)
+			std::cout << ", " << pool->getNbInstances() << " instance(s)";
+		std::cout << std::endl;
+
+		delete pool;
+		delete allocator;
+	}
+}
+
+////////////////////////
+// Samplers benchmark //
+////////////////////////
+
+// Calls a sampler a given number of times and returns the number of samples per second in millions
+template<typename Sampler>
+double measureSamples(Sampler sampler,size_t nbSamples,size_t nbLoops)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < nbLoops; ++i)
+		sampler();
+	return nbSamples * nbLoops / (getElapsedTime(startTime) * 1000.0);
+}
+
+void printSamples(const char* name,double single,double bulk)
+{
+	std::cout << "  " << std::setw(16) << name << " : "
+		<< std::fixed << std::setprecision(1) << single << "M / " << bulk << "M samples per second, "
+		<< std::setprecision(2) << bulk / single << "x" << std::endl;
+}
+
+void benchSamplers()
+{
+	const size_t nbSamples = quick ? 10000 : 100000;
+	const size_t nbLoops = quick ? 10 : 100;
+
+	std::cout << "SAMPLERS BENCH : " << nbSamples << " samples generated " << nbLoops << " times one by one / in bulk" << std::endl;
+
+	std::vector<SPK::Vector3D> positions(nbSamples);
+
+	struct ZoneDef
+	{
+		const char* name;
+		SPK::Ref<SPK::Zone> zone;
+		bool full;
+	};
+
+	const ZoneDef ZONES[] =
+	{
+		{ "sphere",SPK::Sphere::create(SPK::Vector3D(),1.0f),true },
+		{ "sphere border",SPK::Sphere::create(SPK::Vector3D(),1.0f),false },
+		{ "box",SPK::Box::create(SPK::Vector3D(),SPK::Vector3D(1.0f,2.0f,3.0f)),true },
+		{ "box border",SPK::Box::create(SPK::Vector3D(),SPK::Vector3D(1.0f,2.0f,3.0f)),false },
+		{ "cylinder",SPK::Cylinder::create(SPK::Vector3D(),2.0f,1.0f),true },
+		{ "cylinder border",SPK::Cylinder::create(SPK::Vector3D(),2.0f,1.0f),false },
+		{ "ring",SPK::Ring::create(SPK::Vector3D(),SPK::Vector3D(0.0f,1.0f,0.0f),0.5f,1.0f),true },
+	};
+
+	for (size_t i = 0; i < sizeof(ZONES) / sizeof(ZoneDef); ++i)
+	{
+		const ZoneDef& def = ZONES[i];
+		def.zone->updateTransform();
+
+		const double single = measureSamples([&]()
+		{
+			for (size_t j = 0; j < nbSamples; ++j)
+				def.zone->generatePosition(positions[j],def.full);
+		},nbSamples,nbLoops);
+
+		const double bulk = measureSamples([&]()
+		{
+			def.zone->generatePositions(&positions[0],nbSamples,def.full);
+		},nbSamples,nbLoops);
+
+		printSamples(def.name,single,bulk);
+	}
+
+	// The velocities are generated for the particles of a group
+	SPK::Ref<SPK::System> system = SPK::System::create(true);
+	SPK::Ref<SPK::Group> group = system->createGroup(nbSamples);
+	group->setLifeTime(1000.0f,1000.0f);
+	group->addParticles(static_cast<unsigned int>(nbSamples),SPK::Vector3D(),SPK::Vector3D());
+	system->updateParticles(DELTA_TIME);
+
+	std::vector<float> speeds(nbSamples,1.0f);
+
+	struct EmitterDef
+	{
+		const char* name;
+		SPK::Ref<SPK::Emitter> emitter;
+	};
+
+	const EmitterDef EMITTERS[] =
+	{
+		{ "spheric emitter",SPK::SphericEmitter::create(SPK::Vector3D(0.0f,1.0f,0.0f),0.0f,1.5f) },
+		{ "random emitter",SPK::RandomEmitter::create() },
+		{ "straight emitter",SPK::StraightEmitter::create(SPK::Vector3D(0.0f,1.0f,0.0f)) },
+	};
+
+	for (size_t i = 0; i < sizeof(EMITTERS) / sizeof(EmitterDef); ++i)
+	{
+		const EmitterDef& def = EMITTERS[i];
+		def.emitter->updateTransform();
+
+		// The implementation of the base class generates the velocities one by one
+		const double single = measureSamples([&]()
+		{
+			def.emitter->SPK::Emitter::generateVelocities(*group,0,nbSamples,&speeds[0]);
+		},nbSamples,nbLoops);
+
+		const double bulk = measureSamples([&]()
+		{
+			def.emitter->generateVelocities(*group,0,nbSamples,&speeds[0]);
+		},nbSamples,nbLoops);
+
+		printSamples(def.name,single,bulk);
+	}
+}
+
+//////////
+// Main //
+//////////
+
+struct Benchmark
+{
+	const char* name;
+	void (*run)();
+};
+
+const Benchmark BENCHMARKS[] =
+{
+	{ "groups", &benchGroups },
+	{ "chunks", &benchChunks },
+	{ "kernels", &benchKernels },
+	{ "streamed", &benchStreamedUpdate },
+	{ "fusion", &benchFusion },
+	{ "field", &benchVectorField },
+	{ "turbulence", &benchTurbulence },
+	{ "deaths", &benchDeaths },
+	{ "births", &benchBirths },
+	{ "sorting", &benchSorting },
+	{ "spatial", &benchSpatialIndices },
+	{ "collisions", &benchCollisions },
+	{ "billboards", &benchBillboards },
+	{ "effects", &benchEffects },
+	{ "samplers", &benchSamplers },
+};
+
+const size_t NB_BENCHMARKS = sizeof(BENCHMARKS) / sizeof(Benchmark);
+
+int main(int argc, char *argv[])
+{
+	SPK::Logger::get().setEnabled(false);
+
+	std::vector<std::string> names;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg(argv[i]);
+		if (arg == "-quick")
+			quick = true;
+		else
+			names.push_back(arg);
+	}
+
+	for (size_t i = 0; i < NB_BENCHMARKS; ++i)
+		if (names.empty() || std::find(names.begin(),names.end(),BENCHMARKS[i].name) != names.end())
+			BENCHMARKS[i].run();
+
+	SPK_DUMP_MEMORY
+
+	return 0;
+}
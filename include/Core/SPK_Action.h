@@ -25,6 +25,7 @@
 namespace SPK
 {
 	class Particle;
+	class Group;
 
 	/**
 	* @brief An abstract class that allows to perform an action on a single particle
@@ -59,6 +60,14 @@ namespace SPK
 		*/
 		virtual void apply(Particle& particle) const = 0;
 
+		/**
+		* @brief Gets the groups, other than the one triggering this action, that this action writes to
+		* A system uses this information to know which groups can be updated concurrently (see System::setThreadPool(ThreadPool*)).<br>
+		* An action that adds particles to or modifies another group must override this method.
+		* @param targets : the vector in which to add the target groups
+		*/
+		virtual void getTargetGroups(std::vector<const Group*>& targets) const {}
+
 	public :
 		spark_description(Action, SPKObject)
 		(
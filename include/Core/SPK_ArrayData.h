@@ -23,6 +23,7 @@
 #define H_SPK_ARRAYDATA
 
 #include <algorithm> // for std:swap
+#include <new> // for placement new
 
 namespace SPK
 {
@@ -30,7 +31,13 @@ namespace SPK
 	* @brief A class that holds an array of generic type per particle.
 	*
 	* Each particle can hold n variable of the given type. the whole data is stored in a unique array of size : <br>
-	* <i>max number of particles * number of variables per particles</i>
+	* <i>max number of particles * number of variables per particles</i><br>
+	* <br>
+	* The array is allocated by the current allocator of the calling thread at construction if any (see BlockAllocator::getCurrent()).
+	* This is the allocator of the system while a group prepares its data sets.<br>
+	* <br>
+	* The first time the particles are reordered, a second array of the same size is allocated.
+	* The data are gathered in it and the two arrays are then swapped, so that the following reorders do not allocate.
 	*/
 	template<typename T>
 	class ArrayData : public Data
@@ -101,12 +108,19 @@ namespace SPK
 	private :
 
 		T* data;
+		T* reorderBuffer; // the array in which the data are gathered when reordered, NULL until the first reorder
 		size_t totalSize;
 		size_t sizePerParticle;
+		BlockAllocator* allocator;
 
 		~ArrayData<T>();
 
+		T* allocateArray() const;
+		void deallocateArray(T* t) const;
+
 		virtual void swap(size_t index0,size_t index1);
+		virtual void compact(const size_t* moves,size_t nbMoves);
+		virtual void reorder(const size_t* order,size_t nb);
 	};
 
 	typedef ArrayData<float>	FloatArrayData;		/**< @brief ArrayData holding floats */
@@ -116,16 +130,46 @@ namespace SPK
 	template<typename T>
 	inline ArrayData<T>::ArrayData(size_t nbParticles,size_t sizePerParticle) :
 		Data(),
+		reorderBuffer(NULL),
 		totalSize(nbParticles * sizePerParticle),
-		sizePerParticle(sizePerParticle)
+		sizePerParticle(sizePerParticle),
+		allocator(BlockAllocator::getCurrent())
 	{
-		data = SPK_NEW_ARRAY(T,totalSize);
+		data = allocateArray();
 	}
 
 	template<typename T>
 	inline ArrayData<T>::~ArrayData()
 	{
-		SPK_DELETE_ARRAY(data);
+		deallocateArray(data);
+		if (reorderBuffer != NULL)
+			deallocateArray(reorderBuffer);
+	}
+
+	template<typename T>
+	inline T* ArrayData<T>::allocateArray() const
+	{
+		if (allocator == NULL)
+			return SPK_NEW_ARRAY(T,totalSize);
+
+		T* t = static_cast<T*>(allocator->allocate(totalSize * sizeof(T)));
+		for (size_t i = 0; i < totalSize; ++i)
+			new (t + i) T();
+		return t;
+	}
+
+	template<typename T>
+	inline void ArrayData<T>::deallocateArray(T* t) const
+	{
+		if (allocator == NULL)
+		{
+			SPK_DELETE_ARRAY(t);
+			return;
+		}
+
+		for (size_t i = 0; i < totalSize; ++i)
+			t[i].~T();
+		allocator->deallocate(t,totalSize * sizeof(T));
 	}
 
 	template<typename T>
@@ -184,6 +228,36 @@ namespace SPK
 		for (size_t i = 0; i < sizePerParticle; ++i)
 			std::swap(data[index0 + i],data[index1 + i]);
 	}
+
+	template<typename T>
+	inline void ArrayData<T>::compact(const size_t* moves,size_t nbMoves)
+	{
+		for (size_t i = 0; i < nbMoves; ++i)
+		{
+			const T* src = data + moves[i << 1] * sizePerParticle;
+			T* dst = data + moves[(i << 1) + 1] * sizePerParticle;
+			for (size_t j = 0; j < sizePerParticle; ++j)
+				dst[j] = src[j];
+		}
+	}
+
+	template<typename T>
+	inline void ArrayData<T>::reorder(const size_t* order,size_t nb)
+	{
+		// Gathers the data in the other array (the data after the nb first particles belongs to dead particles)
+		if (reorderBuffer == NULL)
+			reorderBuffer = allocateArray();
+
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const T* src = data + order[i] * sizePerParticle;
+			T* dst = reorderBuffer + i * sizePerParticle;
+			for (size_t j = 0; j < sizePerParticle; ++j)
+				dst[j] = src[j];
+		}
+
+		std::swap(data,reorderBuffer);
+	}
 }
 
 #endif
@@ -0,0 +1,176 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_BLOCKALLOCATOR
+#define H_SPK_BLOCKALLOCATOR
+
+namespace SPK
+{
+	/**
+	* @brief An allocator recycling the memory blocks of particle data
+	*
+	* The allocator returns aligned blocks of memory and keeps the freed blocks in a cache sorted by size classes.
+	* A block of a given size class is reused by the next allocation of the same class instead of being requested to the heap.<br>
+	* Creating and destroying short lived systems (impacts, muzzle flashes...) is therefore done without touching the heap
+	* once the cache holds the blocks of a few instances.<br>
+	* <br>
+	* Each group places all its particle arrays (positions, velocities, ages, colors, parameters...) within a single block.
+	* The arrays of the data sets created for the group by its renderer, modifiers and interpolators (see ArrayData) are allocated
+	* by the allocator as well.<br>
+	* <br>
+	* An allocator is not used by default by SPARK. It must be set explicitly either to a given system
+	* (see System::setAllocator(BlockAllocator*)) or to every systems at once (see SPKContext::setAllocator(BlockAllocator*)).<br>
+	* The allocator is not owned by SPARK : the user is responsible for its destruction once no system refers to it anymore.
+	* An allocator can be shared by systems updated concurrently.
+	*/
+	class SPK_PREFIX BlockAllocator
+	{
+	public :
+
+		/** @brief The alignment in bytes of the blocks */
+		static const size_t ALIGNMENT = 64;
+
+		/**
+		* @brief Sets an allocator as the current one of the calling thread for the lifetime of the scope
+		* The current allocator is used by the data created meanwhile (see ArrayData). The previous one is restored at destruction.
+		*/
+		class SPK_PREFIX Scope
+		{
+		public :
+
+			explicit Scope(BlockAllocator* allocator);
+			~Scope();
+
+		private :
+
+			BlockAllocator* previous;
+
+			Scope(const Scope&); // Not used
+			Scope& operator=(const Scope&); // Not used
+		};
+
+		/**
+		* @brief Constructor of block allocator
+		* @param maxCachedSize : the maximum size in bytes of the freed blocks kept in the cache (0 for no limit)
+		*/
+		explicit BlockAllocator(size_t maxCachedSize = 0);
+
+		/** @brief Destructor of block allocator (releases the cached blocks) */
+		~BlockAllocator();
+
+		/**
+		* @brief Allocates a block
+		* The block is aligned on ALIGNMENT bytes.
+		* @param size : the size of the block in bytes
+		* @return the allocated block
+		*/
+		void* allocate(size_t size);
+
+		/**
+		* @brief Frees a block
+		* The block is kept in the cache unless the cache is full.
+		* @param block : the block to free (must have been allocated by this allocator)
+		* @param size : the size of the block in bytes as passed at allocation
+		*/
+		void deallocate(void* block,size_t size);
+
+		/** @brief Returns all the cached blocks to the heap */
+		void releaseCache();
+
+		/**
+		* @brief Sets the maximum size of the cache
+		* Blocks are returned to the heap if needed.
+		* @param maxCachedSize : the maximum size in bytes of the freed blocks kept in the cache (0 for no limit)
+		*/
+		void setMaxCachedSize(size_t maxCachedSize);
+
+		/**
+		* @brief Gets the maximum size of the cache
+		* @return the maximum size in bytes of the freed blocks kept in the cache (0 for no limit)
+		*/
+		size_t getMaxCachedSize() const;
+
+		/**
+		* @brief Gets the size of the blocks currently kept in the cache
+		* @return the size of the cache in bytes
+		*/
+		size_t getCachedSize() const;
+
+		/**
+		* @brief Gets the number of blocks currently allocated by this allocator and not freed yet
+		* @return the number of blocks in use
+		*/
+		size_t getNbUsedBlocks() const;
+
+		/**
+		* @brief Gets the number of allocations requested to the heap so far
+		* @return the number of heap allocations
+		*/
+		size_t getNbHeapAllocations() const;
+
+		/**
+		* @brief Gets the number of allocations served from the cache so far
+		* @return the number of recycled allocations
+		*/
+		size_t getNbRecycledAllocations() const;
+
+		/**
+		* @brief Gets the size actually reserved for a block
+		* Sizes are rounded up to size classes so that blocks of close sizes can be recycled for each other.
+		* There are 4 size classes per power of two, so that at most 25% of a block is wasted.
+		* @param size : the size requested in bytes
+		* @return the size of the size class in bytes
+		*/
+		static size_t getBlockSize(size_t size);
+
+		/**
+		* @brief Gets the current allocator of the calling thread
+		* @return the current allocator or NULL if none
+		*/
+		static BlockAllocator* getCurrent();
+
+		/**
+		* @brief Allocates an aligned block from the heap
+		* This is used when no allocator is set.
+		* @param size : the size of the block in bytes
+		* @return the allocated block aligned on ALIGNMENT bytes
+		*/
+		static void* allocateAligned(size_t size);
+
+		/**
+		* @brief Frees a block allocated by allocateAligned(size_t)
+		* @param block : the block to free
+		*/
+		static void deallocateAligned(void* block);
+
+	private :
+
+		struct Cache;
+		Cache* cache;
+
+		void trimCache();
+
+		BlockAllocator(const BlockAllocator&); // Not used
+		BlockAllocator& operator=(const BlockAllocator&); // Not used
+	};
+}
+
+#endif
@@ -418,13 +418,13 @@ namespace SPK
 
 	// Specialization of the random generation of colors
 	template<>
-	inline Color SPKContext::generateRandom(const Color& c0,const Color& c1)
+	inline Color RandomGenerator::generate(const Color& c0,const Color& c1)
 	{
 		return Color(
-			generateRandom(c0.getR(),c1.getR()),
-			generateRandom(c0.getG(),c1.getG()),
-			generateRandom(c0.getB(),c1.getB()),
-			generateRandom(c0.getA(),c1.getA()));
+			generate(c0.getR(),c1.getR()),
+			generate(c0.getG(),c1.getG()),
+			generate(c0.getB(),c1.getB()),
+			generate(c0.getA(),c1.getA()));
 	}
 }
 
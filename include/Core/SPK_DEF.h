@@ -53,12 +53,13 @@
 
 /**
 * @brief A macro returning a random value within [min,max[
-* This is a shortcut syntax to <i>SPK::SPKContext::get().generateRandom(min,max)</i>
+* This is a shortcut syntax to <i>SPK::RandomGenerator::getCurrent().generate(min,max)</i>.<br>
+* The value is generated by the current random generator of the calling thread (see RandomGenerator).
 * @param min : the minimum bound of the interval (inclusive)
 * @param max : the maximum bound of the interval (exclusive)
 * @return a random number within [min,max[
 */
-#define SPK_RANDOM(min,max) SPK::SPKContext::get().generateRandom(min,max)
+#define SPK_RANDOM(min,max) SPK::RandomGenerator::getCurrent().generate(min,max)
 
 /**
 * @brief A macro returning the zone by default of SPARK
@@ -82,6 +83,10 @@
 namespace SPK
 {
 // The code below regarding fixed size integer is an adaptation from SFML code
+// 8 bits integer types
+	typedef signed   char int8;
+	typedef unsigned char uint8;
+
 // 32 bits integer types
 #if USHRT_MAX == 0xFFFFFFFF
 	typedef signed   short int32;
@@ -97,6 +102,8 @@ namespace SPK
 #endif
 
 	class Zone;
+	class ThreadPool;
+	class BlockAllocator;
 
 #ifdef SPK_DOXYGEN_ONLY // for documentation purpose only
 
@@ -218,6 +225,7 @@ namespace SPK
 
 		/**
 		* @brief Gets a random value within the interval [min,max[
+		* The value is generated by the current random generator of the calling thread (see RandomGenerator::getCurrent()).
 		* @param min : the minimum bound of the interval (inclusive)
 		* @param max : the maximum bound of the interval (exclusive)
 		* @return a random number within [min,max[
@@ -225,10 +233,39 @@ namespace SPK
 		template<typename T>
 		T generateRandom(const T& min,const T& max);
 
+		/**
+		* @brief Sets the thread pool used by default by the systems
+		* The thread pool is used by every system that has no thread pool set explicitly (see System::setThreadPool(ThreadPool*)).<br>
+		* The thread pool is not owned by the context. Set it to NULL to update systems in the calling thread only.
+		* @param threadPool : the thread pool to use by default or NULL
+		*/
+		void setThreadPool(ThreadPool* threadPool);
+
+		/**
+		* @brief Gets the thread pool used by default by the systems
+		* @return the thread pool used by default or NULL if none
+		*/
+		ThreadPool* getThreadPool() const;
+
+		/**
+		* @brief Sets the allocator used by default by the systems
+		* The allocator is used by every system that has no allocator set explicitly (see System::setAllocator(BlockAllocator*)).<br>
+		* The allocator is not owned by the context. Set it to NULL to allocate particle data from the heap.
+		* @param allocator : the allocator to use by default or NULL
+		*/
+		void setAllocator(BlockAllocator* allocator);
+
+		/**
+		* @brief Gets the allocator used by default by the systems
+		* @return the allocator used by default or NULL if none
+		*/
+		BlockAllocator* getAllocator() const;
+
 	private :
 
 		Ref<Zone> defaultZone;
-		unsigned int randomSeed;
+		ThreadPool* threadPool;
+		BlockAllocator* allocator;
 
 		SPKContext();
 		~SPKContext();
@@ -237,23 +274,24 @@ namespace SPK
 		SPKContext& operator=(const SPKContext&); // Not used
 	};
 
-	template<typename T>
-	inline T SPKContext::generateRandom(const T& min,const T& max)
+	inline void SPKContext::setThreadPool(ThreadPool* threadPool)
 	{
-		// optimized standard minimal
-		long tmp0 = 16807L * (randomSeed & 0xFFFFL);
-		long tmp1 = 16807L * (randomSeed >> 16);
-		long tmp2 = (tmp0 >> 16) + tmp1;
-		tmp0 = ((tmp0 & 0xFFFF)|((tmp2 & 0x7FFF) << 16)) + (tmp2 >> 15);
+		this->threadPool = threadPool;
+	}
 
-		// correction of the error
-		if ((tmp0 & 0x80000000L) != 0)
-			tmp0 = (tmp0 + 1) & 0x7FFFFFFFL;
+	inline ThreadPool* SPKContext::getThreadPool() const
+	{
+		return threadPool;
+	}
 
-		randomSeed = tmp0;
+	inline void SPKContext::setAllocator(BlockAllocator* allocator)
+	{
+		this->allocator = allocator;
+	}
 
-		// find a random number in the interval
-		return static_cast<T>(min + ((randomSeed - 1) / 2147483646.0) * (max - min));
+	inline BlockAllocator* SPKContext::getAllocator() const
+	{
+		return allocator;
 	}
 }
 
@@ -76,6 +76,31 @@ namespace SPK
 		* @param index1 : index of the second particle
 		*/
 		virtual void swap(size_t index0,size_t index1) = 0;
+
+		/**
+		* @brief Moves the additional data of several particles at once
+		* This is used by the group to remove all the particles dead during an update in a single pass.<br>
+		* moves holds nbMoves pairs of indices : the data of the particle at moves[2 * i] must be moved to moves[2 * i + 1].<br>
+		* The data previously at the destination belongs to a dead particle and can be discarded, the data left at the source is not used anymore.<br>
+		* <br>
+		* The default implementation swaps the data of each pair which is always safe.
+		* Children can override it with a faster implementation.
+		* @param moves : the pairs of source and destination indices
+		* @param nbMoves : the number of pairs
+		*/
+		virtual void compact(const size_t* moves,size_t nbMoves);
+
+		/**
+		* @brief Reorders the additional data of the particles
+		* This is used by the group to sort its particles in a single pass.<br>
+		* The data of the particle at order[i] must be moved to i for i in [0,nb[. order is a permutation of [0,nb[.<br>
+		* <br>
+		* The default implementation follows the cycles of the permutation with swaps which is always safe.
+		* Children can override it with a faster implementation.
+		* @param order : the index of the particle whose data must be moved at each index
+		* @param nb : the number of particles
+		*/
+		virtual void reorder(const size_t* order,size_t nb);
 	};
 
 	/**
@@ -98,6 +123,7 @@ namespace SPK
 		* @brief Inializes the data with the given number of slots of Data
 		* Any previously held data is destroyed.<br>
 		* This reserves the slots of data but does not fill them with any data.
+		* The slots left empty are ignored when the particles are moved.
 		* @param nbData : the number of data this dataset can hold
 		*/
 		void init(size_t nbData);
@@ -148,6 +174,8 @@ namespace SPK
 
 		void setInitialized();
 		void swap(size_t index0,size_t index1);
+		void compact(const size_t* moves,size_t nbMoves);
+		void reorder(const size_t* order,size_t nb);
 	};
 
 	inline Data::Data() :
@@ -164,6 +192,25 @@ namespace SPK
 		return flag;
 	}
 
+	inline void Data::compact(const size_t* moves,size_t nbMoves)
+	{
+		for (size_t i = 0; i < nbMoves; ++i)
+			swap(moves[i << 1],moves[(i << 1) + 1]);
+	}
+
+	inline void Data::reorder(const size_t* order,size_t nb)
+	{
+		for (size_t i = 0; i < nb; ++i)
+		{
+			// The data initially at order[i] was moved further by the previous swaps if order[i] < i
+			size_t index = order[i];
+			while (index < i)
+				index = order[index];
+			if (index != i)
+				swap(i,index);
+		}
+	}
+
 	inline DataSet::DataSet() :
 		nbData(0),
 		initialized(false),
@@ -204,7 +251,22 @@ namespace SPK
 	inline void DataSet::swap(size_t index0,size_t index1)
 	{
 		for (size_t i = 0; i < nbData; ++i)
-			dataArray[i]->swap(index0,index1);
+			if (dataArray[i] != NULL)
+				dataArray[i]->swap(index0,index1);
+	}
+
+	inline void DataSet::compact(const size_t* moves,size_t nbMoves)
+	{
+		for (size_t i = 0; i < nbData; ++i)
+			if (dataArray[i] != NULL)
+				dataArray[i]->compact(moves,nbMoves);
+	}
+
+	inline void DataSet::reorder(const size_t* order,size_t nb)
+	{
+		for (size_t i = 0; i < nbData; ++i)
+			if (dataArray[i] != NULL)
+				dataArray[i]->reorder(order,nb);
 	}
 };
 
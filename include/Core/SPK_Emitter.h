@@ -41,6 +41,7 @@ namespace SPK
 	class SPK_PREFIX Emitter :	public Transformable
 	{
 	friend class Group;
+	friend class SystemRecorder;
 
 	public :
 
@@ -202,6 +203,20 @@ namespace SPK
 
 		virtual Ref<SPKObject> findByName(const std::string& name);
 
+		/**
+		* @brief Generates the initial velocities of several particles at once
+		*
+		* This is used to emit a batch of particles.
+		* The default implementation calls generateVelocity(Particle&,float) for each particle.
+		* Inherited emitters can override it to generate the velocities in bulk.
+		*
+		* @param group : the group of the particles
+		* @param start : the index of the first particle
+		* @param nb : the number of particles
+		* @param speeds : the desired speed of each particle
+		*/
+		virtual void generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const;
+
 	public :
 		spark_description(Emitter, Transformable)
 		(
@@ -243,7 +258,8 @@ namespace SPK
 
 		mutable float fraction;
 		
-		void emitIt(Particle& particle) const;
+		void emitBatch(Group& group,size_t start,size_t end,const float* radii) const;
+		void initVelocities(Group& group,size_t start,size_t end) const;
 
 		size_t updateTankFromTime(float deltaTime);
 		size_t updateTankFromNb(size_t nb);
@@ -33,6 +33,28 @@ namespace SPK
 	class System;
 	class Octree;
 
+	/**
+	* @enum SpatialIndexType
+	* @brief Constants defining the structure of the spatial index of a group
+	*/
+	enum SpatialIndexType
+	{
+		SPATIAL_INDEX_OCTREE,	/**< An adaptive octree, the default */
+		SPATIAL_INDEX_GRID,		/**< A dense uniform grid filled by a counting sort in linear time */
+		SPATIAL_INDEX_MORTON,	/**< A sparse uniform grid whose cells are sorted by morton code with a radix sort in linear time */
+	};
+
+	/**
+	* @enum SortingMode
+	* @brief Constants defining the algorithm used to sort the particles of a group from back to front
+	*/
+	enum SortingMode
+	{
+		SORTING_QUICK,			/**< A quick sort swapping all the attributes of the particles at each step */
+		SORTING_RADIX,			/**< A stable radix sort of the distances in linear time whose permutation is applied once per attribute, the default */
+		SORTING_INCREMENTAL,	/**< An insertion sort starting from the order of the previous frame, the particles far from their place being radix sorted apart and merged */
+	};
+
 	/**
 	* @brief Group of particles
 	*
@@ -54,7 +76,9 @@ namespace SPK
 	{
 	friend class Particle;
 	friend class System;
+	friend class Emitter;
 	friend class DataSet;
+	friend class SystemRecorder;
 
 	public :
 
@@ -100,6 +124,13 @@ namespace SPK
 		void reallocate(unsigned int capacity);
 		void empty();
 
+		/**
+		* @brief Resets the group to its starting state
+		* The particles are removed, including the ones added but not born yet, and the tanks of the emitters are refilled.
+		* Shared emitters are left untouched as they may be used by other groups.
+		*/
+		void reset();
+
 		void addEmitter(const Ref<Emitter>& emitter);
 		void removeEmitter(const Ref<Emitter>& emitter);
 		void removeAllEmitters();
@@ -121,8 +152,105 @@ namespace SPK
 		void enableSorting(bool sorting);
 		bool isSortingEnabled() const;
 
+		/**
+		* @brief Enables or disables the streamed update of this group
+		*
+		* The storage of the particles is not changed : positions, velocities and old positions remain arrays of vectors.
+		* In a streamed update, each block of particles is transposed into temporary aligned streams of coordinates (x[],y[],z[]),
+		* integrated and modified there by the modifiers compatible with SOA (see Modifier::isSoACompatible()),
+		* then transposed back into the arrays of vectors while still in cache.
+		* Consecutive compatible modifiers share a single transposition.<br>
+		* <br>
+		* The transpositions have a cost that the modifiers must amortize : with the light modifiers of the engine,
+		* the streamed update is slower than the direct update. It is meant for modifiers that vectorize well on streams.
+		* Note that in a streamed update, the chunk safe interpolators are computed before the integration of the positions.
+		*
+		* @param streamedUpdate : true to enable the streamed update, false to disable it
+		*/
+		void enableStreamedUpdate(bool streamedUpdate);
+		bool isStreamedUpdateEnabled() const;
+
+		/**
+		* @brief Enables or disables the fusion of the modifiers of this group
+		*
+		* When the fusion is enabled, the active modifiers are compiled in a pipeline of passes each time they change.
+		* The consecutive chunk safe modifiers are fused in a single pass that applies them in turn on small blocks of particles remaining in cache,
+		* instead of going over all the particles once per modifier.
+		* The first pass is also fused with the update of the particles when nothing has to be done between them.<br>
+		* The other modifiers are processed in their own pass.<br>
+		* <br>
+		* When the fusion is disabled, each modifier is processed in its own pass over the particles.
+		* This is mainly useful for debugging and benchmarking purpose.<br>
+		* The fusion is enabled by default.
+		*
+		* @param fusion : true to enable the fusion of the modifiers, false to disable it
+		*/
+		void enableModifierFusion(bool fusion);
+		bool isModifierFusionEnabled() const;
+
+		/**
+		* @brief Sets the structure of the spatial index of this group
+		*
+		* The spatial index is built at each update if at least one modifier needs it (see getOctree()).<br>
+		* The adaptive octree suits groups with a very uneven density.
+		* The uniform grids are built in linear time and are faster to build and query for most groups.
+		* The dense grid bounds its number of cells and therefore enlarges its cells when particles are far apart.
+		* The morton grid only stores its active cells and keeps small cells on larger areas.
+		* The cells of both grids are never smaller than the diameter of the largest particle.<br>
+		* <br>
+		* All structures are queried the same way through Octree::getNeighborCells(size_t) and Octree::getCell(size_t).
+		*
+		* @param type : the type of spatial index
+		*/
+		void setSpatialIndexType(SpatialIndexType type);
+		SpatialIndexType getSpatialIndexType() const;
+
+		/**
+		* @brief Sets the algorithm used to sort the particles of this group
+		*
+		* The sorting only occurs if it is enabled (see enableSorting(bool)).<br>
+		* The radix sort computes the sorted order of the particles in linear time without moving them,
+		* then moves each attribute array and each additional data once.<br>
+		* The incremental mode relies on particles being already sorted by the previous update and suits slowly moving cameras.
+		* It costs almost nothing when the order did not change.
+		* The few particles far from their place (typically born particles or particles moved by the removal of dead ones) are sorted apart and merged,
+		* and the whole group is radix sorted when the order changed too much.
+		*
+		* @param mode : the sorting algorithm
+		*/
+		void setSortingMode(SortingMode mode);
+		SortingMode getSortingMode() const;
+
+		/**
+		* @brief Tells whether the sorting of this group only sorts indices used for rendering
+		*
+		* By default, the sorting moves the data of the particles in memory so that they are stored from back to front.
+		* This invalidates the order of the particles that some modifiers or renderers may rely on from an update to the next one
+		* and moves all the attributes and additional data of particles at each update.<br>
+		* <br>
+		* When index sorting is enabled, the particles remain in their order of simulation
+		* and the back to front order is only stored in an array of indices (see getSortedIndices()) read by the renderers supporting it.
+		* The quick sort mode is not available with index sorting, the radix sort is used instead.
+		*
+		* @param indexSorting : true to only sort indices, false to sort the data of particles
+		*/
+		void enableIndexSorting(bool indexSorting);
+		bool isIndexSortingEnabled() const;
+
+		/**
+		* @brief Gets the indices of the particles sorted from back to front
+		*
+		* The indices are only available when both sorting and index sorting are enabled (see enableIndexSorting(bool)).
+		* They are computed at the end of each update and hold one index per particle.<br>
+		* Renderers must draw particles in the order of the indices when they are available.
+		*
+		* @return the sorted indices or NULL if they are not available
+		*/
+		const unsigned int* getSortedIndices() const;
+
 		const void* getColorAddress() const;
 		const void* getPositionAddress() const;
+		const void* getOldPositionAddress() const;
 		const void* getVelocityAddress() const;
 		const void* getParamAddress(Param param) const;
 
@@ -294,6 +422,28 @@ namespace SPK
 
 		Ref<System> getSystem() const;
 
+		/**
+		* @brief Gets the thread pool used to update this group
+		* Unlike getSystem(), this method can safely be called by modifiers while groups are updated concurrently.
+		* @return the thread pool of the system or NULL if the group is updated by a single thread
+		*/
+		ThreadPool* getThreadPool() const;
+
+		/**
+		* @brief Seeds the random generator of this group
+		* The random generator of the group is used for the births and the update of its particles.
+		* Note that System::setSeed(uint32) seeds all the groups of a system at once.
+		* @param seed : the seed of the generator
+		* @param stream : the index of the stream of the generator
+		*/
+		void setSeed(uint32 seed,uint32 stream = 0);
+
+		/**
+		* @brief Gets the random generator of this group
+		* @return the random generator of this group
+		*/
+		RandomGenerator& getRandomGenerator();
+
 		/////////////
 		// Actions //
 		/////////////
@@ -376,6 +526,11 @@ namespace SPK
 			spk_attribute(bool, still, setStill, isStill);
 			spk_attribute(bool, computeDistances, enableDistanceComputation, isDistanceComputationEnabled);
 			spk_attribute(bool, sortParticles, enableSorting, isSortingEnabled);
+			spk_attribute(bool, sortIndices, enableIndexSorting, isIndexSortingEnabled);
+			spk_attribute(SortingMode, sortingMode, setSortingMode, getSortingMode);
+			spk_attribute(SpatialIndexType, spatialIndexType, setSpatialIndexType, getSpatialIndexType);
+			spk_attribute(bool, streamedUpdate, enableStreamedUpdate, isStreamedUpdateEnabled);
+			spk_attribute(bool, modifierFusion, enableModifierFusion, isModifierFusionEnabled);
 			spk_attribute(float, physicalRadius, setPhysicalRadius, getPhysicalRadius);
 			spk_attribute(float, graphicalRadius, setGraphicalRadius, getGraphicalRadius);
 			spk_attribute(Ref<ColorInterpolator>, colorInterpolator, setColorInterpolator, getColorInterpolator);
@@ -396,6 +551,32 @@ namespace SPK
 		static const size_t NB_PARAMETERS = 5;
 		static const float DEFAULT_VALUES[NB_PARAMETERS];
 
+		// Number of particles updated at once by a thread (the update is split in chunks when a thread pool is used)
+		static const size_t CHUNK_SIZE = 4096;
+
+		// Number of particles transposed at once in streams in a streamed update (the streams are allocated on the stack)
+		static const size_t STREAM_BLOCK_SIZE = 256;
+
+		// Number of particles initialized at once by each stage of the birth of particles
+		static const size_t BIRTH_BLOCK_SIZE = 256;
+
+		// Maximum number of positions a particle can be moved by the insertion sort of the incremental sorting
+		// Particles further from their place (born, moved by the compaction...) are sorted apart and merged
+		static const size_t MAX_INCREMENTAL_SHIFTS = 16;
+
+		// Number of bits of the keys sorted by each pass of the radix sort
+		static const size_t RADIX_BITS = 11;
+
+		class ChunkJob;
+
+		// A pass of the pipeline of modifiers
+		struct ModifierPass
+		{
+			size_t first;	// The index of the first modifier of the pass within the active modifiers
+			size_t nb;		// The number of modifiers of the pass
+			bool chunkSafe;	// true if the modifiers of the pass are chunk safe, false for a single modifier processed at once
+		};
+
 		// This holds the structure of arrays (SOA) containing data of particles
 		struct ParticleData
 		{
@@ -418,6 +599,11 @@ namespace SPK
 			Color* colors;
 			float* parameters[NB_PARAMETERS];
 
+			// All the arrays are placed within a single block
+			void* block;
+			size_t blockSize;
+			BlockAllocator* allocator; // the allocator of the block or NULL if allocated from the heap
+
 			ParticleData() :
 				initialized(false),
 				nbParticles(0),
@@ -429,7 +615,10 @@ namespace SPK
 				energies(NULL),
 				lifeTimes(NULL),
 				sqrDists(NULL),
-				colors(NULL)
+				colors(NULL),
+				block(NULL),
+				blockSize(0),
+				allocator(NULL)
 			{
 				for (size_t i = 0; i < NB_PARAMETERS; ++i)
 					parameters[i] = NULL;
@@ -533,6 +722,8 @@ namespace SPK
 
 		System* system;
 
+		RandomGenerator randomGenerator;
+
 		ParticleData particleData;
 		size_t enabledParamIndices[NB_PARAMETERS];
 		size_t nbEnabledParameters;
@@ -548,6 +739,11 @@ namespace SPK
 		mutable std::vector<WeakModifierDef> activeModifiers;
 		mutable std::vector<WeakModifierDef> initModifiers;
 
+		// The pipeline compiled from the active modifiers
+		std::vector<ModifierPass> modifierPasses;
+		std::vector<const Modifier*> pipelineModifiers;
+		bool pipelineValid;
+
 		RendererDef renderer;
 
 		Ref<Action> birthAction;
@@ -555,6 +751,18 @@ namespace SPK
 
 		std::list<DataSet> dataSets;
 
+		// Buffers reused by the compaction of dead particles
+		std::vector<size_t> deadIndices;
+		std::vector<size_t> compactionMoves;
+
+		// Buffers reused by the sorting of particles
+		std::vector<unsigned int> sortKeys;
+		std::vector<unsigned int> sortKeysBuffer;
+		std::vector<size_t> sortOrder;
+		std::vector<size_t> sortOrderBuffer;
+		std::vector<char> sortBuffer;
+		std::vector<unsigned int> sortedIndices;
+
 		float minLifeTime;
 		float maxLifeTime;
 		bool immortal;
@@ -562,6 +770,11 @@ namespace SPK
 
 		bool distanceComputationEnabled;
 		bool sortingEnabled;
+		bool indexSortingEnabled;
+		bool streamedUpdateEnabled;
+		bool modifierFusionEnabled;
+		SpatialIndexType spatialIndexType;
+		SortingMode sortingMode;
 
 		Vector3D AABBMin;
 		Vector3D AABBMax;
@@ -577,18 +790,36 @@ namespace SPK
 		bool updateParticles(float deltaTime);
 		void renderParticles();
 
-		bool initParticle(size_t index,size_t& emitterIndex,size_t& nbManualBorn);
+		void processChunks(ChunkJob& job);
+		void updateChunk(size_t start,size_t end,float deltaTime);
+		void computeDistances(size_t start,size_t end);
+		void processPass(size_t start,size_t end,float deltaTime,bool integrate,const ModifierPass* pass);
+		bool isStreamModifier(size_t index) const;
+		void compileModifierPipeline();
+
+		void initParticles(size_t start,size_t end,size_t& emitterIndex,size_t& nbManualBorn);
+		void initParticleBlock(size_t start,size_t end,size_t& emitterIndex,size_t& nbManualBorn);
 		void swapParticles(size_t index0,size_t index1);
+		void compactParticles();
 
 		void recomputeEnabledParamIndices();
 
+		void reallocateData(size_t capacity,size_t copySize);
+		BlockAllocator* getAllocator() const;
+
+		template<typename T>
+		static void compactArray(T* t,const size_t* moves,size_t nbMoves);
+
 		template<typename T>
-		void reallocateArray(T*& t,size_t newSize,size_t copySize);
+		static void reorderArray(T* t,const size_t* order,size_t nb,void* buffer);
 
 		DataSet* attachDataSet(DataHandler* dataHandler);
 		void detachDataSet(DataSet* dataHandler);
 
 		void sortParticles(int start,int end);
+		bool sortOrderIncrementally();
+		static bool radixSort(unsigned int* keys,size_t* order,unsigned int* keysBuffer,size_t* orderBuffer,size_t nb);
+		void reorderParticles();
 		virtual void propagateUpdateTransform();
 
 		void sortParticles();
@@ -620,13 +851,19 @@ namespace SPK
 	}
 
 	template<typename T>
-	void Group::reallocateArray(T*& t,size_t newSize,size_t copySize)
+	void Group::compactArray(T* t,const size_t* moves,size_t nbMoves)
+	{
+		for (size_t i = 0; i < nbMoves; ++i)
+			t[moves[(i << 1) + 1]] = t[moves[i << 1]];
+	}
+
+	template<typename T>
+	void Group::reorderArray(T* t,const size_t* order,size_t nb,void* buffer)
 	{
-		T* oldT = t;
-		t = SPK_NEW_ARRAY(T,newSize);
-		if (oldT != NULL && copySize != 0)
-			std::memcpy(oldT,t,copySize * sizeof(T));
-		SPK_DELETE_ARRAY(oldT);
+		T* sorted = static_cast<T*>(buffer);
+		for (size_t i = 0; i < nb; ++i)
+			sorted[i] = t[order[i]];
+		std::memcpy(t,sorted,nb * sizeof(T));
 	}
 
 	inline bool Group::isInitialized() const
@@ -634,6 +871,11 @@ namespace SPK
 		return system != NULL && system->isInitialized();
 	}
 
+	inline BlockAllocator* Group::getAllocator() const
+	{
+		return system != NULL ? system->getAllocator() : SPKContext::get().getAllocator();
+	}
+
 	inline void Group::setImmortal(bool immortal)
 	{
 		this->immortal = immortal;
@@ -796,6 +1038,67 @@ namespace SPK
 		return sortingEnabled;
 	}
 
+	inline void Group::enableStreamedUpdate(bool streamedUpdate)
+	{
+		streamedUpdateEnabled = streamedUpdate;
+	}
+
+	inline bool Group::isStreamedUpdateEnabled() const
+	{
+		return streamedUpdateEnabled;
+	}
+
+	inline void Group::enableModifierFusion(bool fusion)
+	{
+		modifierFusionEnabled = fusion;
+		pipelineValid = false;
+	}
+
+	inline bool Group::isModifierFusionEnabled() const
+	{
+		return modifierFusionEnabled;
+	}
+
+	inline void Group::setSpatialIndexType(SpatialIndexType type)
+	{
+		spatialIndexType = type;
+	}
+
+	inline SpatialIndexType Group::getSpatialIndexType() const
+	{
+		return spatialIndexType;
+	}
+
+	inline void Group::setSortingMode(SortingMode mode)
+	{
+		sortingMode = mode;
+	}
+
+	inline SortingMode Group::getSortingMode() const
+	{
+		return sortingMode;
+	}
+
+	inline void Group::enableIndexSorting(bool indexSorting)
+	{
+		indexSortingEnabled = indexSorting;
+		if (!indexSorting)
+			sortedIndices.clear();
+	}
+
+	inline bool Group::isIndexSortingEnabled() const
+	{
+		return indexSortingEnabled;
+	}
+
+	inline const unsigned int* Group::getSortedIndices() const
+	{
+		// Indices are not available until the next sorting if particles were added or removed since
+		if (!sortingEnabled || !indexSortingEnabled || sortedIndices.size() != particleData.nbParticles || sortedIndices.empty())
+			return NULL;
+		return &sortedIndices[0];
+	}
+
 	inline const void* Group::getColorAddress() const
 	{
 		return particleData.colors;
@@ -806,6 +1109,11 @@ namespace SPK
 		return particleData.positions;
 	}
 
+	inline const void* Group::getOldPositionAddress() const
+	{
+		return particleData.oldPositions;
+	}
+
 	inline const void* Group::getVelocityAddress() const
 	{
 		return particleData.velocities;
@@ -852,6 +1160,16 @@ namespace SPK
 		return system;
 	}
 
+	inline void Group::setSeed(uint32 seed,uint32 stream)
+	{
+		randomGenerator.setSeed(seed,stream);
+	}
+
+	inline RandomGenerator& Group::getRandomGenerator()
+	{
+		return randomGenerator;
+	}
+
 	inline const Ref<Action>& Group::getBirthAction() const
 	{
 		return birthAction;
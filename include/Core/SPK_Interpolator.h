@@ -36,6 +36,14 @@ namespace SPK
 	public :
 		virtual ~Interpolator() {}
 
+		/**
+		* @brief Tells whether this interpolator can interpolate the data of a group by independent chunks
+		* A chunk safe interpolator interpolates the data of each particle independently of the others.
+		* Its interpolateRange(T*,Group&,DataSet*,size_t,size_t) method can therefore be called concurrently on distinct ranges of particles.
+		* @return true if the interpolator is chunk safe, false if not
+		*/
+		bool isChunkSafe() const;
+
 	public :
 		spark_description(Interpolator, SPKObject)
 		(
@@ -46,8 +54,9 @@ namespace SPK
 		/**
 		* @brief Constructor of interpolator
 		* @param NEEDS_DATASET : true if the interpolator needs additional data, false otherwise
+		* @param CHUNK_SAFE : true if the interpolator implements interpolateRange(T*,Group&,DataSet*,size_t,size_t) instead of interpolate(T*,Group&,DataSet*)
 		*/
-		Interpolator(bool NEEDS_DATASET);
+		Interpolator(bool NEEDS_DATASET,bool CHUNK_SAFE = false);
 
 		/**
 		* @brief A helper method that linearly interpolates a value
@@ -61,10 +70,12 @@ namespace SPK
 		
 	private :
 
+		const bool CHUNK_SAFE;
+
 		/**
 		* @brief Interpolates the given data of the particles of a group
 		* 
-		* This is a pure virtual method that must be overriden in inherited interpolators.<br>
+		* This method must be overriden in inherited interpolators that are not chunk safe (the default implementation reports an error).<br>
 		* The array of data passed must be interpolated. The number of data to interpolate is the number of active particles of the group.<br>
 		* If NEEDS_DATASET was set to true, a dataset is passed to the method, else NULL is passed.
 		*
@@ -72,7 +83,21 @@ namespace SPK
 		* @param group : the group from which to interpolate the data
 		* @param dataSet : the associated dataset of the pair interpolator/group. Will be NULL if NEEDS_DATASET is false
 		*/
-		virtual void interpolate(T* data,Group& group,DataSet* dataSet) const = 0;
+		virtual void interpolate(T* data,Group& group,DataSet* dataSet) const;
+
+		/**
+		* @brief Interpolates the given data of a range of particles of a group
+		*
+		* This method must be overriden in inherited interpolators that are chunk safe (the default implementation reports an error).<br>
+		* It may be called concurrently on distinct ranges and must therefore only access the data of the particles within [start,end[.
+		*
+		* @param data : the array of data to interpolate
+		* @param group : the group from which to interpolate the data
+		* @param dataSet : the associated dataset of the pair interpolator/group. Will be NULL if NEEDS_DATASET is false
+		* @param start : the index of the first particle to interpolate
+		* @param end : the index after the last particle to interpolate
+		*/
+		virtual void interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const;
 
 		/**
 		* @brief Initializes the given data for the given particle
@@ -82,17 +107,58 @@ namespace SPK
 		* @param dataset : the associated dataset of the pair interpolator/group. Will be NULL if NEEDS_DATASET is false 
 		*/
 		virtual void init(T& data,Particle& particle,DataSet* dataSet) const = 0;
+
+		/**
+		* @brief Initializes the given data for a range of particles born in the same batch
+		* The default implementation calls init(T&,Particle&,DataSet*) for each particle.
+		* Inherited interpolators can override it to initialize the data in a tight loop.
+		* @param data : the array of data to initialize
+		* @param group : the group of the particles
+		* @param dataSet : the associated dataset of the pair interpolator/group. Will be NULL if NEEDS_DATASET is false
+		* @param start : the index of the first particle to initialize
+		* @param end : the index after the last particle to initialize
+		*/
+		virtual void initBatch(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const;
 	};
 
 	typedef Interpolator<Color> ColorInterpolator; /**< @brief Abstract interpolator of colors */
 	typedef Interpolator<float> FloatInterpolator; /**< @brief Abstract interpolator of floats */
 
 	template<typename T>
-	inline Interpolator<T>::Interpolator(bool NEEDS_DATASET) :
+	inline Interpolator<T>::Interpolator(bool NEEDS_DATASET,bool CHUNK_SAFE) :
 		SPKObject(),
-		DataHandler(NEEDS_DATASET)
+		DataHandler(NEEDS_DATASET),
+		CHUNK_SAFE(CHUNK_SAFE)
 	{}
 
+	template<typename T>
+	inline bool Interpolator<T>::isChunkSafe() const
+	{
+		return CHUNK_SAFE;
+	}
+
+	template<typename T>
+	void Interpolator<T>::interpolate(T* data,Group& group,DataSet* dataSet) const
+	{
+		SPK_ASSERT(CHUNK_SAFE,"Interpolator::interpolate(T*,Group&,DataSet*) - An interpolator that is not chunk safe must override this method");
+	}
+
+	template<typename T>
+	void Interpolator<T>::interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const
+	{
+		SPK_ASSERT(!CHUNK_SAFE,"Interpolator::interpolateRange(T*,Group&,DataSet*,size_t,size_t) - A chunk safe interpolator must override this method");
+	}
+
+	template<typename T>
+	void Interpolator<T>::initBatch(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const
+	{
+		for (size_t i = start; i < end; ++i)
+		{
+			Particle particle(group,i);
+			init(data[i],particle,dataSet);
+		}
+	}
+
 	template<typename T>
 	inline void Interpolator<T>::interpolateParam(T& result,const T& start,const T& end,float ratio) const
 	{
@@ -37,6 +37,15 @@ namespace SPK
 		*/
 		Iterator(T& t);
 
+		/**
+		* @brief Constructor of iterator over a range of the collection
+		* The iterator points at the start of the range
+		* @param t : the collection over which to iterate
+		* @param start : the index of the first particle of the range
+		* @param end : the index after the last particle of the range
+		*/
+		Iterator(T& t,size_t start,size_t end);
+
 		/**
 		* @brief Gets the particle on which points by the iterator
 		* @return the particle on which points by the iterator
@@ -70,6 +79,7 @@ namespace SPK
 	private :
 
 		mutable Particle particle;
+		size_t endIndex;
 	};
 
 	/** @brief A generic class to iterate over a constant collection of particles */
@@ -85,6 +95,15 @@ namespace SPK
 		*/
 		ConstIterator(const T& t);
 
+		/**
+		* @brief Constructor of iterator over a range of the collection
+		* The iterator points at the start of the range
+		* @param t : the collection over which to iterate
+		* @param start : the index of the first particle of the range
+		* @param end : the index after the last particle of the range
+		*/
+		ConstIterator(const T& t,size_t start,size_t end);
+
 		/**
 		* @brief Gets the particle on which points by the iterator
 		* @return the particle on which points by the iterator
@@ -118,6 +137,7 @@ namespace SPK
 	private :
 
 		const Particle particle;
+		size_t endIndex;
 	};
 
 	typedef Iterator<Group> GroupIterator;				/**< @brief Iterator of a Group */
@@ -134,11 +154,21 @@ namespace SPK
 
 	template<>
 	inline Iterator<Group>::Iterator(Group& group) :
-		particle(group,0)
+		particle(group,0),
+		endIndex(group.getNbParticles())
 	{
 		SPK_ASSERT(group.isInitialized(),"Iterator::Iterator(Group&) - An iterator from an uninitialized group cannot be retrieved");
 	}
 
+	template<>
+	inline Iterator<Group>::Iterator(Group& group,size_t start,size_t end) :
+		particle(group,start),
+		endIndex(end)
+	{
+		SPK_ASSERT(group.isInitialized(),"Iterator::Iterator(Group&,size_t,size_t) - An iterator from an uninitialized group cannot be retrieved");
+		SPK_ASSERT(end <= group.getNbParticles(),"Iterator::Iterator(Group&,size_t,size_t) - The range is out of bounds : " << end);
+	}
+
 	template<>
 	inline Particle& Iterator<Group>::operator*() const
 	{ 
@@ -168,16 +198,26 @@ namespace SPK
 	template<>
 	inline bool Iterator<Group>::end() const
 	{ 
-		return particle.index >= particle.group.getNbParticles();
+		return particle.index >= endIndex;
 	}
 
 	template<>
 	inline ConstIterator<Group>::ConstIterator(const Group& group) :
-		particle(const_cast<Group&>(group),0)
+		particle(const_cast<Group&>(group),0),
+		endIndex(group.getNbParticles())
 	{
 		SPK_ASSERT(group.isInitialized(),"ConstIterator::ConstIterator(Group&) - An const iterator from a uninitialized group cannot be retrieved");	
 	}
 
+	template<>
+	inline ConstIterator<Group>::ConstIterator(const Group& group,size_t start,size_t end) :
+		particle(const_cast<Group&>(group),start),
+		endIndex(end)
+	{
+		SPK_ASSERT(group.isInitialized(),"ConstIterator::ConstIterator(Group&,size_t,size_t) - An const iterator from a uninitialized group cannot be retrieved");
+		SPK_ASSERT(end <= group.getNbParticles(),"ConstIterator::ConstIterator(Group&,size_t,size_t) - The range is out of bounds : " << end);
+	}
+
 	template<>
 	inline const Particle& ConstIterator<Group>::operator*() const
 	{ 
@@ -207,7 +247,7 @@ namespace SPK
 	template<>
 	inline bool ConstIterator<Group>::end() const
 	{ 
-		return particle.index >= particle.group.getNbParticles();
+		return particle.index >= endIndex;
 	}
 }
 
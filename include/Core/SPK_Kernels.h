@@ -0,0 +1,290 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_KERNELS
+#define H_SPK_KERNELS
+
+// Selection of the instruction sets compiled in the kernels
+#ifndef SPK_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPK_SIMD_SSE2
+#endif
+#if defined(__AVX2__)
+#define SPK_SIMD_AVX2
+#endif
+#endif
+
+namespace SPK
+{
+	/**
+	* @enum InstructionSet
+	* @brief Constants defining the instruction sets used by the particle kernels
+	*/
+	enum InstructionSet
+	{
+		INSTRUCTION_SET_SCALAR,	/**< Plain C++ code, always available */
+		INSTRUCTION_SET_SSE2,	/**< SSE2 code working on 4 floats at once */
+		INSTRUCTION_SET_AVX2	/**< AVX2 code working on 8 floats at once */
+	};
+
+	/** @brief The coordinates of an array of vectors stored as a structure of arrays */
+	struct Vector3DStreams
+	{
+		float* x;	/**< @brief The stream of x coordinates */
+		float* y;	/**< @brief The stream of y coordinates */
+		float* z;	/**< @brief The stream of z coordinates */
+	};
+
+	/**
+	* @brief The low level kernels used to update the particle arrays of groups
+	*
+	* The kernels work on plain arrays of floats.
+	* As a Vector3D is made of 3 contiguous floats, arrays of vectors are processed as arrays of 3 times more floats
+	* which allows to vectorize the integration whatever the layout of the vector.<br>
+	* <br>
+	* The instruction sets are selected at compilation :
+	* <ul>
+	* <li>SSE2 is compiled when targeting a processor supporting it (always the case on x86-64)</li>
+	* <li>AVX2 is compiled when the compiler targets AVX2 (-mavx2 with gcc or clang, /arch:AVX2 with msvc)</li>
+	* <li>defining SPK_NO_SIMD only compiles the scalar code</li>
+	* </ul>
+	* The kernels use the best compiled instruction set by default.
+	* A lower one can be chosen with setInstructionSet(InstructionSet), mainly for testing and benchmarking purpose.
+	* Note that the instruction set must not be changed while systems are updated.
+	*/
+	class SPK_PREFIX Kernels
+	{
+	public :
+
+		/**
+		* @brief Tells whether an instruction set is compiled in the kernels
+		* @param instructionSet : the instruction set
+		* @return true if the instruction set can be used, false otherwise
+		*/
+		static bool isInstructionSetSupported(InstructionSet instructionSet);
+
+		/**
+		* @brief Sets the instruction set used by the kernels
+		* If the instruction set is not supported, the call is ignored.
+		* @param instructionSet : the instruction set to use
+		* @return true if the instruction set is set, false if it is not supported
+		*/
+		static bool setInstructionSet(InstructionSet instructionSet);
+
+		/**
+		* @brief Gets the instruction set used by the kernels
+		* @return the instruction set in use
+		*/
+		static InstructionSet getInstructionSet();
+
+		/**
+		* @brief Gets the best instruction set compiled in the kernels
+		* @return the best instruction set
+		*/
+		static InstructionSet getBestInstructionSet();
+
+		/**
+		* @brief Adds a value to all the elements of an array
+		*
+		* data[i] += value
+		*
+		* @param data : the array
+		* @param value : the value to add
+		* @param nb : the number of elements
+		*/
+		static void add(float* data,float value,size_t nb);
+
+		/**
+		* @brief Multiplies all the elements of an array by a value
+		*
+		* data[i] *= value
+		*
+		* @param data : the array
+		* @param value : the value to multiply by
+		* @param nb : the number of elements
+		*/
+		static void multiply(float* data,float value,size_t nb);
+
+		/**
+		* @brief Computes the energies of particles function of their age
+		*
+		* energies[i] = 1 - ages[i] / lifeTimes[i]
+		*
+		* @param energies : the energies to compute
+		* @param ages : the ages of the particles
+		* @param lifeTimes : the life times of the particles
+		* @param nb : the number of particles
+		*/
+		static void computeEnergies(float* energies,const float* ages,const float* lifeTimes,size_t nb);
+
+		/**
+		* @brief Integrates the positions of particles function of their velocities
+		*
+		* oldPositions[i] = positions[i]<br>
+		* positions[i] += velocities[i] * deltaTime
+		*
+		* @param positions : the positions of the particles
+		* @param oldPositions : the positions of the particles at the previous step
+		* @param velocities : the velocities of the particles
+		* @param deltaTime : the time step
+		* @param nb : the number of particles
+		*/
+		static void integrate(Vector3D* positions,Vector3D* oldPositions,const Vector3D* velocities,float deltaTime,size_t nb);
+
+		/**
+		* @brief Integrates a coordinate of particles function of their velocities
+		*
+		* This is the same as integrate(Vector3D*,Vector3D*,const Vector3D*,float,size_t) but for a single stream of coordinates.
+		*
+		* @param positions : the coordinates of the positions of the particles
+		* @param oldPositions : the coordinates of the positions of the particles at the previous step
+		* @param velocities : the coordinates of the velocities of the particles
+		* @param deltaTime : the time step
+		* @param nb : the number of particles
+		*/
+		static void integrate(float* positions,float* oldPositions,const float* velocities,float deltaTime,size_t nb);
+
+		/**
+		* @brief Copies an array of vectors in streams of coordinates
+		* @param vectors : the vectors to copy
+		* @param streams : the streams to fill
+		* @param nb : the number of vectors
+		*/
+		static void toStreams(const Vector3D* vectors,const Vector3DStreams& streams,size_t nb);
+
+		/**
+		* @brief Copies streams of coordinates in an array of vectors
+		* @param streams : the streams to copy
+		* @param vectors : the vectors to fill
+		* @param nb : the number of vectors
+		*/
+		static void fromStreams(const Vector3DStreams& streams,Vector3D* vectors,size_t nb);
+
+		/**
+		* @brief Computes the signed distances of points along an axis
+		*
+		* distances[i] = dotProduct(axis,positions[i] - origin)
+		*
+		* @param positions : the points
+		* @param origin : the origin of the axis
+		* @param axis : the direction of the axis
+		* @param distances : the array receiving the distances
+		* @param nb : the number of points
+		*/
+		static void computeDistances(const Vector3D* positions,const Vector3D& origin,const Vector3D& axis,float* distances,size_t nb);
+
+		/**
+		* @brief Computes the square distances of points to a center
+		*
+		* sqrDistances[i] = getSqrDist(positions[i],center)
+		*
+		* @param positions : the points
+		* @param center : the center
+		* @param sqrDistances : the array receiving the square distances
+		* @param nb : the number of points
+		*/
+		static void computeSqrDistances(const Vector3D* positions,const Vector3D& center,float* sqrDistances,size_t nb);
+
+		/**
+		* @brief Computes the sines and cosines of angles
+		*
+		* sines[i] = sin(angles[i])<br>
+		* cosines[i] = cos(angles[i])
+		*
+		* The angles are reduced to [-PI/4,PI/4] where the functions are approximated by polynomials.
+		* The precision is about the one of std::sin and std::cos for angles up to a few thousands radians.
+		* The scalar and vectorized versions give the same results.
+		*
+		* @param angles : the angles in radians
+		* @param sines : the array receiving the sines
+		* @param cosines : the array receiving the cosines
+		* @param nb : the number of angles
+		*/
+		static void computeSinCos(const float* angles,float* sines,float* cosines,size_t nb);
+
+		/**
+		* @brief Trilinearly interpolates a regular grid of vectors at points
+		*
+		* The vectors of the grid are padded to 4 floats (the last one is unused) so that a node is read at once.
+		* The node (x,y,z) starts at nodes[4 * (x + nbX * (y + nbY * z))].<br>
+		* The points are given in grid coordinates : the node (x,y,z) is at the coordinates (x,y,z).
+		* They must be within the grid and there must be at least 2 nodes along each axis.
+		*
+		* @param nodes : the padded vectors of the grid
+		* @param nbX : the number of nodes along the x axis
+		* @param nbY : the number of nodes along the y axis
+		* @param nbZ : the number of nodes along the z axis
+		* @param x : the x coordinates of the points within [0,nbX - 1]
+		* @param y : the y coordinates of the points within [0,nbY - 1]
+		* @param z : the z coordinates of the points within [0,nbZ - 1]
+		* @param vx : the array receiving the x coordinates of the interpolated vectors
+		* @param vy : the array receiving the y coordinates of the interpolated vectors
+		* @param vz : the array receiving the z coordinates of the interpolated vectors
+		* @param nb : the number of points
+		*/
+		static void sampleGrid(const float* nodes,size_t nbX,size_t nbY,size_t nbZ,const float* x,const float* y,const float* z,float* vx,float* vy,float* vz,size_t nb);
+
+		/**
+		* @brief Computes 3D simplex noise and its gradient at points
+		*
+		* The noise is made of cells of about 1 unit and lies within [-1,1].
+		* Its gradient is computed analytically.<br>
+		* The lattice is hashed arithmetically so that the noise needs no table and does not repeat within the range of integers.
+		*
+		* @param x : the x coordinates of the points
+		* @param y : the y coordinates of the points
+		* @param z : the z coordinates of the points
+		* @param values : the array receiving the noise at the points
+		* @param gx : the array receiving the x coordinates of the gradients
+		* @param gy : the array receiving the y coordinates of the gradients
+		* @param gz : the array receiving the z coordinates of the gradients
+		* @param nb : the number of points
+		*/
+		static void computeNoise(const float* x,const float* y,const float* z,float* values,float* gx,float* gy,float* gz,size_t nb);
+
+		/**
+		* @brief Computes the curl of a 3D simplex noise potential at points
+		*
+		* The potential is made of 3 independent simplex noises, one per coordinate.
+		* They share the simplices and the hashes of computeNoise(const float*,const float*,const float*,float*,float*,float*,float*,size_t)
+		* but take their gradients from distinct bits of the hashes so that the curl costs much less than 3 noises.<br>
+		* The curl is free of divergence.
+		*
+		* @param x : the x coordinates of the points
+		* @param y : the y coordinates of the points
+		* @param z : the z coordinates of the points
+		* @param cx : the array receiving the x coordinates of the curls
+		* @param cy : the array receiving the y coordinates of the curls
+		* @param cz : the array receiving the z coordinates of the curls
+		* @param nb : the number of points
+		*/
+		static void computeCurlNoise(const float* x,const float* y,const float* z,float* cx,float* cy,float* cz,size_t nb);
+
+	private :
+
+		static InstructionSet instructionSet;
+
+		// Not instanciable
+		Kernels();
+	};
+}
+
+#endif
@@ -32,82 +32,202 @@
 #define SPK_DELETE(name) delete name
 #define SPK_DELETE_ARRAY(name) delete[] name
 #define SPK_DUMP_MEMORY {}
+#define SPK_TRACE_SYSTEM(system) {}
 #else
 #define SPK_NEW(name,...) (name*)SPK::SPKMemoryTracer::get().registerAllocation(new name(__VA_ARGS__),sizeof(name),#name,__FILE__,__LINE__)
-#define SPK_NEW_ARRAY(name,nb) (name*)SPK::SPKMemoryTracer::get().registerAllocation(new name[nb],sizeof(name) * nb,std::string(#name).append("[]"),__FILE__,__LINE__)
+#define SPK_NEW_ARRAY(name,nb) (name*)SPK::SPKMemoryTracer::get().registerAllocation(new name[nb],sizeof(name) * (nb),#name "[]",__FILE__,__LINE__)
 #define SPK_DELETE(name) { SPK::SPKMemoryTracer::get().unregisterAllocation(name); delete name; }
 #define SPK_DELETE_ARRAY(name) { SPK::SPKMemoryTracer::get().unregisterAllocation(name); delete[] name; }
 #define SPK_DUMP_MEMORY { SPK::SPKMemoryTracer::get().dumpMemory(); }
+#define SPK_TRACE_SYSTEM(system) SPK::SPKMemoryTracer::SystemScope spkSystemScope(system);
 
 #include <string>
-#include <set>
+#include <map>
 
 namespace SPK
 {
-	// Note: don't forget to verify static objects that depends on the tracer.
-	// For the moment, only SPKContext and IO::Manager depends on it
+	class System;
+
+	/**
+	* @brief A class tracing the dynamic memory allocated by SPARK
+	*
+	* The tracer is enabled when SPK_TRACE_MEMORY is defined (which is the case in debug).
+	* Each allocation made with SPK_NEW or SPK_NEW_ARRAY is then registered with its size, its type and its location in the code.<br>
+	* <br>
+	* The tracer can be used by several threads at once : the blocks are held by a hash map split in shards locked independently.
+	* The types and file names are not copied, they must be static strings (as given by the macros).<br>
+	* <br>
+	* The memory is accounted per type and per system. An allocation is attributed to a system when it occurs while the system
+	* updates or renders its groups or while a group is reallocated (see SystemScope).
+	* The system is known per thread : the allocations made by the worker threads of a ThreadPool are not attributed to the system
+	* that dispatched the work and end up under NULL.<br>
+	* The statistics of a system are dropped, cumulative counts included, as soon as it holds no block and is not traced anymore.
+	* This way destroyed systems do not accumulate and a new system at the address of a destroyed one starts with empty statistics.<br>
+	* <br>
+	* A snapshot of the statistics can be taken at any time and compared to a previous one (see getSnapshot()).
+	*/
 	class SPK_PREFIX SPKMemoryTracer
 	{
-	struct BlockInfo;
+	public :
+
+		/** @brief Statistics about a set of blocks */
+		struct Statistics
+		{
+			long long nbBlocks;			/**< @brief The number of blocks currently allocated */
+			long long size;				/**< @brief The size in bytes of the blocks currently allocated */
+			long long nbAllocations;	/**< @brief The total number of blocks allocated so far */
+			long long allocatedSize;	/**< @brief The total size in bytes of the blocks allocated so far */
 
-	friend bool operator==(const BlockInfo&,const BlockInfo&);
-	friend bool operator<(const BlockInfo&,const BlockInfo&);
-	friend bool compareAllocTime(const BlockInfo&,const BlockInfo&);
+			Statistics();
 
-	public :
+			bool isEmpty() const;
+
+			Statistics& operator+=(const Statistics& statistics);
+			Statistics& operator-=(const Statistics& statistics);
+		};
+
+		/**
+		* @brief Statistics about the memory at a given time
+		* The difference between 2 snapshots gives the memory allocated and freed in between.
+		*/
+		struct Snapshot
+		{
+			Statistics total;								/**< @brief The statistics of all blocks */
+			long long peakSize;								/**< @brief The maximum size in bytes allocated at once so far */
+			std::map<std::string,Statistics> types;			/**< @brief The statistics per type */
+			std::map<const System*,Statistics> systems;		/**< @brief The statistics per system holding blocks or traced (NULL for the blocks not attributed to a system) */
+
+			Snapshot();
+
+			/**
+			* @brief Gets the difference with a previous snapshot
+			* Only the types and systems with a difference are kept. The peak size of the difference is the growth of the peak size.
+			* @param previous : the previous snapshot
+			* @return the difference between this snapshot and the previous one
+			*/
+			Snapshot operator-(const Snapshot& previous) const;
+		};
+
+		/** @brief The statistics of a system, internal to the tracer */
+		struct SystemEntry;
+
+		/**
+		* @brief Attributes the allocations of the calling thread to a system for the lifetime of the scope
+		* The previous system is restored at destruction. This is used through the SPK_TRACE_SYSTEM(system) macro.
+		* Only the calling thread is affected, the threads it dispatches work to are not.
+		*/
+		class SPK_PREFIX SystemScope
+		{
+		public :
+
+			explicit SystemScope(const System* system);
+			~SystemScope();
+
+		private :
+
+			SystemEntry* previous;
+			SystemEntry* entry;
+
+			SystemScope(const SystemScope&); // Not used
+			SystemScope& operator=(const SystemScope&); // Not used
+		};
 
 		static SPKMemoryTracer& get();
 
-		void* registerAllocation(void* position, size_t size, const std::string& type, const std::string& file, size_t line);
+		/**
+		* @brief Registers an allocated block
+		* @param position : the address of the block
+		* @param size : the size of the block in bytes
+		* @param type : the type of the block (must be a static string)
+		* @param file : the file where the block is allocated (must be a static string)
+		* @param line : the line where the block is allocated
+		* @return the address of the block
+		*/
+		void* registerAllocation(void* position,size_t size,const char* type,const char* file,size_t line);
+
+		/**
+		* @brief Unregisters a block about to be freed
+		* @param position : the address of the block
+		*/
 		void unregisterAllocation(void* position);
-		std::string formatSize(unsigned int s);
+
+		/**
+		* @brief Takes a snapshot of the statistics
+		* @return the current statistics
+		*/
+		Snapshot getSnapshot() const;
+
+		/**
+		* @brief Gets the size currently allocated
+		* @return the size in bytes of the blocks currently allocated
+		*/
+		long long getSize() const;
+
+		/**
+		* @brief Gets the maximum size allocated at once so far
+		* @return the peak size in bytes
+		*/
+		long long getPeakSize() const;
+
+		/** @brief Sets the peak size back to the size currently allocated */
+		void resetPeakSize();
+
+		std::string formatSize(long long s);
+
+		/**
+		* @brief Appends the statistics and the list of blocks currently allocated to the file SPARK_Memory_Dump.txt
+		*/
 		void dumpMemory();
 
 	private :
 
-		struct BlockInfo
-		{
-			void* position;
-			size_t size;
-			std::string type;
-			std::string fileName;
-			size_t lineNb;
-			float time;
-			unsigned long index;
-
-			BlockInfo(void* position) : position(position) {}
-		};
+		struct Context;
+		Context* context;
 
-		SPKMemoryTracer() :
-			nextIndex(0),
-			totalMemorySize(0),
-			maxMemorySize(0)
-		{}
+		SystemEntry* acquireSystemEntry(const System* system);
+		void releaseSystemEntry(const System* system,SystemEntry* entry,bool endOfScope);
+
+		SPKMemoryTracer();
+		~SPKMemoryTracer();
 
 		SPKMemoryTracer(const SPKMemoryTracer&); // Not used
 		SPKMemoryTracer& operator=(const SPKMemoryTracer&); // Not used
-
-		unsigned long nextIndex;
-		unsigned long totalMemorySize;
-		unsigned long maxMemorySize;
-
-		std::set<BlockInfo> blocks;
 	};
 
-	inline bool operator==(const SPKMemoryTracer::BlockInfo& block0,const SPKMemoryTracer::BlockInfo& block1)
+	inline SPKMemoryTracer::Statistics::Statistics() :
+		nbBlocks(0),
+		size(0),
+		nbAllocations(0),
+		allocatedSize(0)
+	{}
+
+	inline bool SPKMemoryTracer::Statistics::isEmpty() const
 	{
-		return block0.position == block1.position;
+		return nbBlocks == 0 && size == 0 && nbAllocations == 0 && allocatedSize == 0;
 	}
 
-	inline bool operator<(const SPKMemoryTracer::BlockInfo& block0,const SPKMemoryTracer::BlockInfo& block1)
+	inline SPKMemoryTracer::Statistics& SPKMemoryTracer::Statistics::operator+=(const Statistics& statistics)
 	{
-		return block0.position < block1.position;
+		nbBlocks += statistics.nbBlocks;
+		size += statistics.size;
+		nbAllocations += statistics.nbAllocations;
+		allocatedSize += statistics.allocatedSize;
+		return *this;
 	}
 
-	inline bool compareAllocTime(const SPKMemoryTracer::BlockInfo& block0,const SPKMemoryTracer::BlockInfo& block1)
+	inline SPKMemoryTracer::Statistics& SPKMemoryTracer::Statistics::operator-=(const Statistics& statistics)
 	{
-		return block0.index < block1.index;
+		nbBlocks -= statistics.nbBlocks;
+		size -= statistics.size;
+		nbAllocations -= statistics.nbAllocations;
+		allocatedSize -= statistics.allocatedSize;
+		return *this;
 	}
+
+	inline SPKMemoryTracer::Snapshot::Snapshot() :
+		total(),
+		peakSize(0)
+	{}
 }
 #endif
 #endif
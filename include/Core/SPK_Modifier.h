@@ -37,6 +37,17 @@ namespace SPK
 		MODIFIER_PRIORITY_CHECK = 50,			/**< The modifier performs checks over parameters */
 	};
 
+	/**
+	* @brief The vectors of a block of particles stored as streams of coordinates
+	* The streams are aligned on 32 bytes. The index 0 of the streams is the first particle of the block.
+	*/
+	struct ParticleStreams
+	{
+		Vector3DStreams positions;		/**< @brief The streams of the positions */
+		Vector3DStreams velocities;		/**< @brief The streams of the velocities */
+		Vector3DStreams oldPositions;	/**< @brief The streams of the old positions */
+	};
+
 	/**
 	* @brief An abstract class that allows to modify the behaviour of a group of particles over time
 	*
@@ -74,6 +85,32 @@ namespace SPK
 		*/
 		unsigned int getPriority() const;
 
+		/**
+		* @brief Tells whether this modifier can modify the particles of a group by independent chunks
+		* A chunk safe modifier modifies each particle independently of the others.
+		* Its modifyRange(Group&,DataSet*,float,size_t,size_t) method can therefore be called concurrently on distinct ranges of particles.
+		* @return true if the modifier is chunk safe, false if not
+		*/
+		bool isChunkSafe() const;
+
+		/**
+		* @brief Tells whether this modifier can work on the streams of a group updated in streams
+		* A group with a streamed update (see Group::enableStreamedUpdate(bool)) calls
+		* modifyStreams(Group&,DataSet*,float,const ParticleStreams&,size_t,size_t) on the modifiers compatible with SOA
+		* and modifyRange(Group&,DataSet*,float,size_t,size_t) on the other ones.<br>
+		* Only chunk safe modifiers can be compatible with SOA.
+		* @return true if the modifier is compatible with SOA, false if not
+		*/
+		bool isSoACompatible() const;
+
+		/**
+		* @brief Gets the groups, other than the one holding this modifier, that this modifier writes to
+		* A system uses this information to know which groups can be updated concurrently (see System::setThreadPool(ThreadPool*)).<br>
+		* A modifier that adds particles to or modifies another group must override this method.
+		* @param targets : the vector in which to add the target groups
+		*/
+		virtual void getTargetGroups(std::vector<const Group*>& targets) const {}
+
 	public :
 		spark_description(Modifier, Transformable)
 		(
@@ -83,26 +120,98 @@ namespace SPK
 
 	protected :
 
-		Modifier(unsigned int PRIORITY,bool NEEDS_DATASET,bool CALL_INIT,bool NEEDS_OCTREE);
+		/**
+		* @brief Constructor of modifier
+		* @param PRIORITY : the priority of the modifier
+		* @param NEEDS_DATASET : true if the modifier needs additional data, false otherwise
+		* @param CALL_INIT : true if init(Particle&,DataSet*) must be called at the birth of particles
+		* @param NEEDS_OCTREE : true if the modifier needs an octree to be built within the group
+		* @param CHUNK_SAFE : true if the modifier implements modifyRange(Group&,DataSet*,float,size_t,size_t) instead of modify(Group&,DataSet*,float)
+		* @param SOA_COMPATIBLE : true if the chunk safe modifier also implements modifyStreams(Group&,DataSet*,float,const ParticleStreams&,size_t,size_t)
+		*/
+		Modifier(unsigned int PRIORITY,bool NEEDS_DATASET,bool CALL_INIT,bool NEEDS_OCTREE,bool CHUNK_SAFE = false,bool SOA_COMPATIBLE = false);
 
 	private :
 
 		const unsigned int PRIORITY;
 		const bool CALL_INIT;
 		const bool NEEDS_OCTREE;
+		const bool CHUNK_SAFE;
+		const bool SOA_COMPATIBLE;
 		
 		bool active;
 		bool local;
 
 		virtual void init(Particle& particle,DataSet* dataSet) const {};
-		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const = 0;
+
+		/**
+		* @brief Initializes a range of particles born in the same batch
+		* This is only called if CALL_INIT is true.
+		* The default implementation calls init(Particle&,DataSet*) for each particle.
+		* @param group : the group of the particles
+		* @param dataSet : the dataSet of the pair modifier/group. Will be NULL if NEEDS_DATASET is false
+		* @param start : the index of the first particle to initialize
+		* @param end : the index after the last particle to initialize
+		*/
+		virtual void initBatch(Group& group,DataSet* dataSet,size_t start,size_t end) const;
+
+		/**
+		* @brief Prepares the modification of the particles of a group
+		* This is called once per update of the group for each active modifier, serially by the thread updating the group,
+		* before the particles are split in chunks processed in parallel and before any particle is modified.
+		* It allows chunk safe modifiers to update the data they share between all the chunks without any synchronization.
+		* @param group : the group whose particles are going to be modified
+		* @param dataSet : the dataSet of the pair modifier/group. Will be NULL if NEEDS_DATASET is false
+		* @param deltaTime : the time step
+		*/
+		virtual void prepareModify(Group& group,DataSet* dataSet,float deltaTime) const {}
+
+		/**
+		* @brief Modifies the particles of a group
+		* This method must be overriden by modifiers that are not chunk safe.
+		* The default implementation reports an error.
+		* @param group : the group whose particles are modified
+		* @param dataSet : the dataSet of the pair modifier/group. Will be NULL if NEEDS_DATASET is false
+		* @param deltaTime : the time step
+		*/
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		/**
+		* @brief Modifies a range of particles of a group
+		* This method must be overriden by chunk safe modifiers.
+		* It may be called concurrently on distinct ranges and must therefore only access the particles within [start,end[.
+		* The default implementation reports an error.
+		* @param group : the group whose particles are modified
+		* @param dataSet : the dataSet of the pair modifier/group. Will be NULL if NEEDS_DATASET is false
+		* @param deltaTime : the time step
+		* @param start : the index of the first particle to modify
+		* @param end : the index after the last particle to modify
+		*/
+		virtual void modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const;
+
+		/**
+		* @brief Modifies a block of particles of a group held in streams
+		* This method must be overriden by modifiers compatible with SOA.
+		* The positions, velocities and old positions of the block must only be accessed through the streams.
+		* The other data of the particles are accessed as usual.
+		* The default implementation reports an error.
+		* @param group : the group whose particles are modified
+		* @param dataSet : the dataSet of the pair modifier/group. Will be NULL if NEEDS_DATASET is false
+		* @param deltaTime : the time step
+		* @param streams : the streams of the block
+		* @param start : the index of the first particle of the block (index 0 in the streams)
+		* @param end : the index after the last particle of the block
+		*/
+		virtual void modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const;
 	};
 
-	inline Modifier::Modifier(unsigned int PRIORITY,bool NEEDS_DATASET,bool CALL_INIT,bool NEEDS_OCTREE) :
+	inline Modifier::Modifier(unsigned int PRIORITY,bool NEEDS_DATASET,bool CALL_INIT,bool NEEDS_OCTREE,bool CHUNK_SAFE,bool SOA_COMPATIBLE) :
 		DataHandler(NEEDS_DATASET),
 		PRIORITY(PRIORITY),
 		CALL_INIT(CALL_INIT),
 		NEEDS_OCTREE(NEEDS_OCTREE),
+		CHUNK_SAFE(CHUNK_SAFE),
+		SOA_COMPATIBLE(CHUNK_SAFE && SOA_COMPATIBLE),
 		active(true),
 		local(false)
 	{}
@@ -131,6 +240,16 @@ namespace SPK
 	{
 		return PRIORITY;
 	}
+
+	inline bool Modifier::isChunkSafe() const
+	{
+		return CHUNK_SAFE;
+	}
+
+	inline bool Modifier::isSoACompatible() const
+	{
+		return SOA_COMPATIBLE;
+	}
 }
 
 #endif
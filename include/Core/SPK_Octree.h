@@ -23,6 +23,7 @@
 #define H_SPK_OCTREE
 
 #include <set>
+#include <vector>
 
 namespace SPK
 {
@@ -37,7 +38,11 @@ namespace SPK
 	* Typically algorithms where each particle is affected by every other particles in the group (particle vs particle collision, flocking, nbody simulations...).<br>
 	* <br>
 	* A Octree is automatically generated within a group if at least one of its modifiers needs it (by setting its NEEDS_OCTREE constant to true at init).<br>
-	* If no more modifiers need an octree and an octree exists within the group, it is deleted.
+	* If no more modifiers need an octree and an octree exists within the group, it is deleted.<br>
+	* <br>
+	* Depending on the spatial index type of the group (see Group::setSpatialIndexType(SpatialIndexType)), the cells are either
+	* the leaves of an adaptive octree or the cells of a uniform grid built in linear time.
+	* The cells are queried the same way in all cases.
 	*/
 	class SPK_PREFIX Octree
 	{
@@ -231,12 +236,31 @@ namespace SPK
 				value[1] = static_cast<int>(v.y);
 				value[2] = static_cast<int>(v.z);
 			}
+
+			void clamp(const size_t* resolution)
+			{
+				for (size_t i = 0; i < 3; ++i)
+					if (value[i] < 0)
+						value[i] = 0;
+					else if (value[i] >= static_cast<int>(resolution[i]))
+						value[i] = static_cast<int>(resolution[i]) - 1;
+			}
+		};
+
+		struct MortonEntry
+		{
+			unsigned int code;
+			size_t particleIndex;
 		};
 
 		static const size_t MAX_LEVEL_INDEX;
 		static const size_t MAX_PARTICLES_NB_PER_CELL;
 		static const float OPTIMAL_CELL_SIZE_FACTOR;
 		static const float MIN_CELL_SIZE;
+		static const float OPTIMAL_GRID_PARTICLES_PER_CELL;
+		static const size_t MAX_GRID_CELLS_PER_PARTICLE;
+		static const size_t MIN_GRID_CELLS;
+		static const size_t MORTON_BITS;
 
 		Group& group;
 
@@ -254,6 +278,12 @@ namespace SPK
 		Vector3D AABBMin;
 		Vector3D AABBMax;
 
+		// Buffers of the grids
+		std::vector<size_t> gridCounts;
+		std::vector<size_t> gridEntries;
+		std::vector<MortonEntry> mortonEntries;
+		std::vector<MortonEntry> mortonBuffer;
+
 		// Octree life time is managed by Group
 		Octree(const Ref<Group>& group);
 		~Octree();
@@ -263,9 +293,13 @@ namespace SPK
 
 		void update();  // Used by Group only
 
+		void buildTree(float minCellSize);
+		void buildGrid(float minCellSize,bool morton);
+
 		size_t initNextCell(size_t level,size_t offsetX,size_t offsetY,size_t offsetZ);
 		void addToCell(size_t cellIndex,size_t particleIndex,size_t maxLevel);
 		void addToChildrenCells(size_t parentIndex,size_t particleIndex,size_t maxLevel);
+		void addGridCell(size_t offsetX,size_t offsetY,size_t offsetZ,const size_t* particles,size_t nb);
 	};
 }
 
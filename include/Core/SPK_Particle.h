@@ -43,6 +43,8 @@ namespace SPK
 	friend class Iterator;
 	template<typename T>
 	friend class ConstIterator;
+	template<typename T>
+	friend class Interpolator;
 
 	public :
 
@@ -0,0 +1,212 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_RANDOMGENERATOR
+#define H_SPK_RANDOMGENERATOR
+
+namespace SPK
+{
+	class Vector3D;
+
+	/**
+	* @brief A fast and seedable pseudo random number generator
+	*
+	* The generator implements the xoshiro128** algorithm : it has a period of 2^128 - 1 and only
+	* needs a few integer operations per number. Its state is initialized from a seed and a stream index,
+	* so that generators built from the same seed but different streams give independent sequences.<br>
+	* <br>
+	* Each thread has a current generator used by SPK_RANDOM(min,max) (see getCurrent()).
+	* By default it is a generator owned by the thread and seeded from the time.
+	* While a group is updated, its own generator is the current one and each chunk of particles processed
+	* in parallel uses a generator derived from the one of the group and from the index of the chunk.
+	* Therefore, once seeded (see System::setSeed(uint32)), a system always gives the same results
+	* whatever the number of threads used to update it.
+	*/
+	class SPK_PREFIX RandomGenerator
+	{
+	public :
+
+		/**
+		* @brief Sets a generator as the current one of the calling thread for the lifetime of the scope
+		* The previous current generator is restored at destruction.
+		*/
+		class SPK_PREFIX Scope
+		{
+		public :
+
+			explicit Scope(RandomGenerator& generator);
+			~Scope();
+
+		private :
+
+			RandomGenerator* previous;
+
+			Scope(const Scope&); // Not used
+			Scope& operator=(const Scope&); // Not used
+		};
+
+		/**
+		* @brief Constructor of random generator
+		* @param seed : the seed of the generator
+		* @param stream : the index of the stream of the generator
+		*/
+		explicit RandomGenerator(uint32 seed = 0,uint32 stream = 0);
+
+		/**
+		* @brief Reinitializes the generator
+		* @param seed : the seed of the generator
+		* @param stream : the index of the stream of the generator
+		*/
+		void setSeed(uint32 seed,uint32 stream = 0);
+
+		/**
+		* @brief Generates a random 32 bits integer
+		* @return a random integer within [0,2^32[
+		*/
+		uint32 generateUInt();
+
+		/**
+		* @brief Generates a random float
+		* @return a random float within [0,1[
+		*/
+		float generateFloat();
+
+		/**
+		* @brief Generates a random double
+		* @return a random double within [0,1[
+		*/
+		double generateDouble();
+
+		/**
+		* @brief Gets a random value within the interval [min,max[
+		* The value is computed in double precision (53 bits) except for floats computed in single precision (24 bits).
+		* The whole range of integer types is therefore reachable.
+		* @param min : the minimum bound of the interval (inclusive)
+		* @param max : the maximum bound of the interval (exclusive)
+		* @return a random number within [min,max[
+		*/
+		template<typename T>
+		T generate(const T& min,const T& max);
+
+		/**
+		* @brief Fills an array with random floats within the interval [min,max[
+		* This is faster than generating the values one by one.
+		* @param values : the array to fill
+		* @param nb : the number of values to generate
+		* @param min : the minimum bound of the interval (inclusive)
+		* @param max : the maximum bound of the interval (exclusive)
+		*/
+		void fillUniform(float* values,size_t nb,float min,float max);
+
+		/**
+		* @brief Fills an array with random unit vectors
+		*
+		* The directions are uniformly distributed on the part of the unit sphere whose z coordinate is within [minZ,maxZ[.
+		* They are generated without any rejection (and therefore in a constant time) :
+		* the z coordinate of a uniform direction is itself uniform and so is its angle around the z axis.<br>
+		* With the default bounds, the directions cover the whole sphere.
+		*
+		* @param directions : the array to fill
+		* @param nb : the number of directions to generate
+		* @param minZ : the minimum z coordinate of the directions (inclusive)
+		* @param maxZ : the maximum z coordinate of the directions (exclusive)
+		*/
+		void fillDirections(Vector3D* directions,size_t nb,float minZ = -1.0f,float maxZ = 1.0f);
+
+		/**
+		* @brief Gets the current generator of the calling thread
+		* @return the current generator
+		*/
+		static RandomGenerator& getCurrent();
+
+		/**
+		* @brief Seeds the generator owned by the calling thread
+		* This generator is the current one when no other is set (typically outside of the update of a group).
+		* @param seed : the seed of the generator
+		*/
+		static void setThreadSeed(uint32 seed);
+
+	private :
+
+		uint32 state[4];
+
+		static uint32 rotate(uint32 x,int k);
+	};
+
+	inline RandomGenerator::RandomGenerator(uint32 seed,uint32 stream)
+	{
+		setSeed(seed,stream);
+	}
+
+	inline uint32 RandomGenerator::rotate(uint32 x,int k)
+	{
+		return (x << k) | (x >> (32 - k));
+	}
+
+	inline uint32 RandomGenerator::generateUInt()
+	{
+		const uint32 result = rotate(state[1] * 5,7) * 9;
+		const uint32 t = state[1] << 9;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotate(state[3],11);
+
+		return result;
+	}
+
+	inline float RandomGenerator::generateFloat()
+	{
+		// The 24 upper bits fill the mantissa exactly
+		return (generateUInt() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	inline double RandomGenerator::generateDouble()
+	{
+		// 27 and 26 upper bits of 2 integers fill the 53 bits mantissa
+		const uint32 high = generateUInt() >> 5;
+		const uint32 low = generateUInt() >> 6;
+		return (high * 67108864.0 + low) * (1.0 / 9007199254740992.0);
+	}
+
+	template<typename T>
+	inline T RandomGenerator::generate(const T& min,const T& max)
+	{
+		return static_cast<T>(min + generateDouble() * (max - min));
+	}
+
+	template<>
+	inline float RandomGenerator::generate(const float& min,const float& max)
+	{
+		return min + generateFloat() * (max - min);
+	}
+
+	template<typename T>
+	inline T SPKContext::generateRandom(const T& min,const T& max)
+	{
+		return RandomGenerator::getCurrent().generate(min,max);
+	}
+}
+
+#endif
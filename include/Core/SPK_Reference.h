@@ -26,6 +26,25 @@
 
 #define SPK_NULL_REF SPK::NullReferenceValue()
 
+// When SPK_ATOMIC_REFERENCES is defined, the number of references of objects is modified atomically
+// This is needed to share objects between systems used in different threads (see the thread safety of System)
+// The define must be the same when compiling SPARK and the code using it
+#ifdef SPK_ATOMIC_REFERENCES
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SPK_INCREMENT_REFERENCES(nb) _InterlockedIncrement(reinterpret_cast<volatile long*>(&(nb)))
+#define SPK_DECREMENT_REFERENCES(nb) _InterlockedDecrement(reinterpret_cast<volatile long*>(&(nb)))
+#elif defined(__GNUC__)
+#define SPK_INCREMENT_REFERENCES(nb) __atomic_add_fetch(&(nb),1,__ATOMIC_RELAXED)
+#define SPK_DECREMENT_REFERENCES(nb) __atomic_sub_fetch(&(nb),1,__ATOMIC_ACQ_REL)
+#else
+#error SPK_ATOMIC_REFERENCES is not supported by this compiler
+#endif
+#else
+#define SPK_INCREMENT_REFERENCES(nb) ++(nb)
+#define SPK_DECREMENT_REFERENCES(nb) --(nb)
+#endif
+
 namespace SPK
 {
 	// Hack to allow easy null reference initialization
@@ -41,7 +60,11 @@ namespace SPK
 	* Moreover implicit conversions exists between Ref and standard pointer.<br>
 	* Implicit downcasting is also implemented. Upcasting can be performed with a call to cast<T> (equivalent to dynamic_cast<T>)<br>
 	* <br>
-	* In practice, An SPKObject must always be manipulated through a reference.
+	* In practice, An SPKObject must always be manipulated through a reference.<br>
+	* <br>
+	* The reference counting is not thread safe unless SPARK is compiled with SPK_ATOMIC_REFERENCES defined
+	* (SPARK_ATOMIC_REFERENCES in CMake), in which case references to a same object can be taken and released concurrently.
+	* Note that the reference itself is not thread safe : a same Ref must not be assigned from a thread while being read from another one.
 	*/
 	template<typename T>
 	class Ref
@@ -123,9 +146,8 @@ namespace SPK
 
 	private :
 
-		// TODO In order to be thread safe, nbReferences must be volatile and increment/decrement must be atomic
-		void increment() { if (ptr != NULL) ++(ptr->nbReferences); }
-		void decrement() { if (ptr != NULL && --(ptr->nbReferences) == 0) SPK_DELETE(ptr); }
+		void increment() { if (ptr != NULL) SPK_INCREMENT_REFERENCES(ptr->nbReferences); }
+		void decrement() { if (ptr != NULL && SPK_DECREMENT_REFERENCES(ptr->nbReferences) == 0) SPK_DELETE(ptr); }
 
 		T* ptr;
 	};
@@ -43,6 +43,8 @@ bool isInitializedSPK() const { return SPKSystem->isInitialized(); }
 
 namespace SPK
 {
+	class SystemRecorder;
+
 	/**
 	* @enum StepMode
 	* @brief Enumeration defining how to handle the step time of particle systems
@@ -56,9 +58,31 @@ namespace SPK
 
 	/**
 	* @brief A class defining a complete system of particles
+	*
+	* <b>Thread safety</b><br>
+	* A system and the objects it owns must only be used by one thread at a time, although its update can be split
+	* between the threads of a thread pool (see setThreadPool(ThreadPool*)).<br>
+	* Different systems can be updated concurrently in different threads as long as the objects they share follow these rules :
+	* <ul>
+	* <li>SPARK must be compiled with SPK_ATOMIC_REFERENCES defined (see Ref), as references to the shared objects
+	* are taken and released while the systems are updated, copied or destroyed.</li>
+	* <li>Zones, modifiers, interpolators and renderers can be shared (see SPKObject::setShared(bool)) :
+	* their data per particle is held by the groups (see DataSet) and shared zones and modifiers are not transformed by their parents.
+	* They must not be modified while a system using them is updated.</li>
+	* <li>Emitters must not be shared, as their tank is consumed by the update. Neither must actions emitting particles (see SpawnParticlesAction).</li>
+	* <li>A group belongs to a single system and modifiers or actions adding particles to groups
+	* (see Modifier::getTargetGroups(std::vector<const Group*>&)) must target groups of their own system.</li>
+	* <li>Controllers must not be connected to objects of systems updated in other threads.</li>
+	* <li>A same object must not be copied by several threads at once (see SPKObject::copy(const Ref<T>&)).</li>
+	* <li>The logger is not thread safe.</li>
+	* </ul>
+	* Thread pools, block allocators and the default random generators can be used by several systems at once.
+	* Systems must be rendered by a single thread.
 	*/
 	class SPK_PREFIX System : public Transformable
 	{
+	friend class Group;
+	friend class SystemRecorder;
 
 	public :
 
@@ -164,6 +188,17 @@ namespace SPK
 		*/
 		virtual bool updateParticles(float deltaTime);
 
+		/**
+		* @brief Skips the update of the particles of this system for the current time step
+		*
+		* The time step is clamped as in updateParticles(float) and accumulated with the time deferred by the update interval.
+		* The system catches up at its next update, in a single step that is not clamped again.<br>
+		* This allows a scheduler to skip updates without losing time (see SystemScheduler).
+		*
+		* @param deltaTime : the time step
+		*/
+		void deferUpdate(float deltaTime);
+
 		/**
 		* @brief Renders particles in the System
 		*
@@ -171,6 +206,18 @@ namespace SPK
 		*/
 		virtual void renderParticles() const;
 
+		/**
+		* @brief Resets the system to its starting state
+		*
+		* All the groups are reset (see Group::reset()) and the time deferred by a reduced update frequency is dropped.
+		* The system is active again.<br>
+		* The transform and the settings of the system are left untouched.<br>
+		* <br>
+		* This costs far less than a new copy of the system and does not allocate memory, which allows to reuse instances
+		* of short lived effects (see SystemPool).
+		*/
+		void reset();
+
 		//////////////////
 		// Bounding Box //
 		//////////////////
@@ -292,6 +339,215 @@ namespace SPK
 		*/
 		static StepMode getStepMode();
 
+		/**
+		* @brief Enables or not the clamping on the deltaTime for this system only
+		*
+		* The step settings set with the static methods above are used by default by all the systems.
+		* A system can override them with its own settings so that, for instance, distant effects use a coarse adaptive step
+		* while close effects use a fine constant step.<br>
+		* The first call to a local step method copies the default settings to the system.
+		* See setClampStep(bool,float) for a description of the clamp step.
+		*
+		* @param useClampStep : true to use a clamp value on the step, false not to
+		* @param clamp : the clamp value
+		*/
+		void setLocalClampStep(bool useClampStep,float clamp = 1.0f);
+
+		/**
+		* @brief Uses a constant step to update this system only
+		* See useConstantStep(float) and setLocalClampStep(bool,float).
+		* @param constantStep : the value of the step
+		*/
+		void useLocalConstantStep(float constantStep);
+
+		/**
+		* @brief Uses an adaptive step to update this system only
+		* See useAdaptiveStep(float,float) and setLocalClampStep(bool,float).
+		* @param minStep : the minimal time step
+		* @param maxStep : the maximal time step
+		*/
+		void useLocalAdaptiveStep(float minStep,float maxStep);
+
+		/**
+		* @brief Uses the real step to update this system only
+		* See useRealStep() and setLocalClampStep(bool,float).
+		*/
+		void useLocalRealStep();
+
+		/**
+		* @brief Sets the step mode of this system only, keeping its step values
+		* See useLocalConstantStep(float), useLocalAdaptiveStep(float,float) and useLocalRealStep().
+		* @param mode : the step mode of this system
+		*/
+		void setLocalStepMode(StepMode mode);
+
+		/**
+		* @brief Sets the clamp value of this system only, keeping whether the clamp is enabled
+		* See setLocalClampStep(bool,float).
+		* @param clamp : the clamp value
+		*/
+		void setLocalClampValue(float clamp);
+
+		/**
+		* @brief Enables or not the clamping of this system only, keeping its clamp value
+		* See setLocalClampStep(bool,float).
+		* @param useClampStep : true to use a clamp value on the step, false not to
+		*/
+		void enableLocalClampStep(bool useClampStep);
+
+		/** @brief Uses the default step settings again to update this system */
+		void useDefaultStep();
+
+		/**
+		* @brief Tells whether this system has its own step settings or uses the default ones
+		* Enabling them copies the default settings to the system if it has none yet.
+		* @param localStep : true for the system to use its own step settings, false to use the default ones
+		*/
+		void enableLocalStep(bool localStep);
+
+		/**
+		* @brief Tells whether this system has its own step settings
+		* @return true if the system has its own step settings, false if it uses the default ones
+		*/
+		bool isLocalStepEnabled() const;
+
+		/**
+		* @brief Gets the step mode used by this system
+		* @return the step mode of this system or the default one if the system has no step settings of its own
+		*/
+		StepMode getLocalStepMode() const;
+
+		/**
+		* @brief Gets the constant step used by this system
+		* @return the constant step of this system or the default one if the system has no step settings of its own
+		*/
+		float getLocalConstantStep() const;
+
+		/**
+		* @brief Gets the minimal adaptive step used by this system
+		* @return the minimal step of this system or the default one if the system has no step settings of its own
+		*/
+		float getLocalMinStep() const;
+
+		/**
+		* @brief Gets the maximal adaptive step used by this system
+		* @return the maximal step of this system or the default one if the system has no step settings of its own
+		*/
+		float getLocalMaxStep() const;
+
+		/**
+		* @brief Tells whether the clamp step is used by this system
+		* @return whether the clamp step is used by this system or by default if the system has no step settings of its own
+		*/
+		bool isLocalClampStepEnabled() const;
+
+		/**
+		* @brief Gets the clamp value used by this system
+		* @return the clamp value of this system or the default one if the system has no step settings of its own
+		*/
+		float getLocalClampStep() const;
+
+		/////////////////////
+		// Level of detail //
+		/////////////////////
+
+		/**
+		* @brief Sets the minimum interval between two updates of this system
+		*
+		* This allows to update far or hidden systems at a reduced frequency (see UpdateLOD).<br>
+		* The delta times passed to updateParticles(float) are accumulated until the interval is reached.
+		* The system then catches up with a single step of the accumulated time, whatever its step mode.
+		* The clamp step applies to each delta time before it is accumulated and not to the step itself, so that no time is lost.<br>
+		* <br>
+		* An interval of 0 (the default) updates the system at each call.
+		*
+		* @param interval : the minimum interval between two updates
+		*/
+		void setUpdateInterval(float interval);
+
+		/**
+		* @brief Gets the minimum interval between two updates of this system
+		* @return the minimum interval between two updates
+		*/
+		float getUpdateInterval() const;
+
+		/**
+		* @brief Gets the time accumulated since the last update of this system
+		* @return the time not simulated yet
+		*/
+		float getDeferredTime() const;
+
+		////////////////////
+		// Multithreading //
+		////////////////////
+
+		/**
+		* @brief Sets the thread pool used to update this system
+		*
+		* When a thread pool is used, the groups of the system are updated concurrently.<br>
+		* Groups depending on each other (a modifier or an action of a group adding particles to another group,
+		* or groups sharing an emitter) are always updated in the same thread in the order they have in the system.
+		* See Modifier::getTargetGroups(std::vector<const Group*>&) and Action::getTargetGroups(std::vector<const Group*>&).<br>
+		* <br>
+		* If no thread pool is set, the one of the SPKContext is used (see SPKContext::setThreadPool(ThreadPool*)).
+		* If none is set either, the system is updated in the calling thread only.<br>
+		* The thread pool is not owned by the system.
+		* @param threadPool : the thread pool to use for this system or NULL to use the one by default
+		*/
+		void setThreadPool(ThreadPool* threadPool);
+
+		/**
+		* @brief Gets the thread pool used to update this system
+		* @return the thread pool used or NULL if the system is updated in the calling thread only
+		*/
+		ThreadPool* getThreadPool() const;
+
+		/**
+		* @brief Seeds the random generators of the groups of this system
+		* Each group gets its own stream derived from the seed and from its index within the system.
+		* A seeded system gives the same results at each run, whatever the number of threads used to update it.<br>
+		* The groups added afterwards are seeded the same way.
+		* The seed is copied with the system : copies give the same particles unless they are reseeded (as done by SystemPool).
+		* @param seed : the seed of the system
+		*/
+		void setSeed(uint32 seed);
+
+		/**
+		* @brief Tells whether this system is seeded
+		* @return true if setSeed(uint32) was called on this system or on the system it is copied from
+		*/
+		bool isSeeded() const;
+
+		/**
+		* @brief Gets the seed of this system
+		* @return the seed of this system (meaningless if not seeded)
+		*/
+		uint32 getSeed() const;
+
+		/////////////////////
+		// Memory handling //
+		/////////////////////
+
+		/**
+		* @brief Sets the allocator of the particle data of this system
+		*
+		* The allocator recycles the blocks of particle data freed by the groups (see BlockAllocator).
+		* Sharing an allocator between short lived systems lets them reuse the memory of the previous ones.<br>
+		* <br>
+		* If no allocator is set, the one of the SPKContext is used (see SPKContext::setAllocator(BlockAllocator*)).
+		* If none is set either, the particle data is allocated from the heap.<br>
+		* The allocator only applies to the data allocated afterwards. The data allocated before is still freed by the allocator it comes from.<br>
+		* The allocator is not owned by the system.
+		* @param allocator : the allocator to use for this system or NULL to use the one by default
+		*/
+		void setAllocator(BlockAllocator* allocator);
+
+		/**
+		* @brief Gets the allocator of the particle data of this system
+		* @return the allocator used or NULL if the particle data is allocated from the heap
+		*/
+		BlockAllocator* getAllocator() const;
+
 		//////////
 		// Misc //
 		//////////
@@ -304,6 +560,14 @@ namespace SPK
 		*/
 		bool isActive() const;
 
+		/**
+		* @brief Computes a hash of the state of the particles of this system
+		* The hash covers the number of particles of each group and their positions, velocities, ages, life times, colors and parameters.
+		* Two systems with the same hash are in the same state. This is used to check that a run is reproduced exactly (see SystemRecorder).
+		* @return the hash of the state of the system
+		*/
+		uint32 computeStateHash() const;
+
 		void initialize();
 		bool isInitialized() const;
 
@@ -313,6 +577,14 @@ namespace SPK
 		spark_description(System, Transformable)
 		(
 			spk_attribute(bool, computeAABB, enableAABBComputation, isAABBComputationEnabled);
+			spk_attribute(float, updateInterval, setUpdateInterval, getUpdateInterval);
+			// The step values are set first as their setters change the mode, the mode and whether the settings are used are set last
+			spk_attribute(float, localConstantStep, useLocalConstantStep, getLocalConstantStep);
+			spk_attribute(Pair<float>, localAdaptiveStep, useLocalAdaptiveStep, getLocalMinStep, getLocalMaxStep);
+			spk_attribute(float, localClampValue, setLocalClampValue, getLocalClampStep);
+			spk_attribute(bool, localClampStep, enableLocalClampStep, isLocalClampStepEnabled);
+			spk_attribute(StepMode, localStepMode, setLocalStepMode, getLocalStepMode);
+			spk_attribute(bool, localStep, enableLocalStep, isLocalStepEnabled);
 			spk_array(Ref<Group>, groups, addGroup, removeGroup, removeAllGroups, getGroup, getNbGroups);
 			spk_array(Ref<Controller>, controllers, addController, removeController, removeAllControllers, getController, getNbControllers);
 		);
@@ -329,19 +601,32 @@ namespace SPK
 
 	private :
 
+		class UpdateJob;
+		class FinalizeJob;
+
 		Vector3D cameraPosition;
 
 		// Step mode
-		static StepMode stepMode;
-		static float constantStep;
-		static float minStep;
-		static float maxStep;
-
-		static bool clampStepEnabled;
-		static float clampStep;
+		struct StepSettings
+		{
+			StepMode mode;
+			float constantStep;
+			float minStep;
+			float maxStep;
+			bool clampStepEnabled;
+			float clampStep;
+		};
+
+		static StepSettings defaultStepSettings;
+		StepSettings localStepSettings;
+		bool localStepEnabled;
 
 		float deltaStep;
 
+		// Level of detail
+		float updateInterval;
+		float deferredTime;
+
 		bool initialized;
 		bool active;
 
@@ -350,7 +635,33 @@ namespace SPK
 		Vector3D AABBMin;
 		Vector3D AABBMax;
 
+		// Multithreading
+		ThreadPool* threadPool;
+		std::vector<size_t> clusterGroups;	// indices of groups sorted by clusters of dependent groups
+		std::vector<size_t> clusterOffsets;	// start of each cluster in clusterGroups (plus the end)
+
+		// Memory handling
+		BlockAllocator* allocator;
+
+		// Random generation
+		uint32 seed;
+		bool seeded;
+
+		// Recording
+		SystemRecorder* recorder;
+		bool updating;
+
 		bool innerUpdate(float deltaTime);
+		void seedGroup(size_t index);
+
+		const StepSettings& getStepSettings() const;
+		StepSettings& getLocalStepSettings();
+
+		// Gets the recorder to notify of the changes made from outside of the update or NULL if none
+		SystemRecorder* getExternalRecorder() const;
+
+		void computeClusters();
+		bool updateCluster(size_t index,float deltaTime);
 
 		static void setGroupSystem(const Ref<Group>& group,System* system,bool remove = true);
 	};
@@ -430,31 +741,186 @@ namespace SPK
 
 	inline void System::setClampStep(bool enableClampStep,float clamp)
 	{
-		clampStepEnabled = enableClampStep;
-		clampStep = clamp;
+		defaultStepSettings.clampStepEnabled = enableClampStep;
+		defaultStepSettings.clampStep = clamp;
 	}
 
 	inline void System::useConstantStep(float constantStep)
 	{
-		stepMode = STEP_MODE_CONSTANT;
-		System::constantStep = constantStep;
+		defaultStepSettings.mode = STEP_MODE_CONSTANT;
+		defaultStepSettings.constantStep = constantStep;
 	}
 
 	inline void System::useAdaptiveStep(float minStep,float maxStep)
 	{
-		stepMode = STEP_MODE_ADAPTIVE;
-		System::minStep = minStep;
-		System::maxStep = maxStep;
+		defaultStepSettings.mode = STEP_MODE_ADAPTIVE;
+		defaultStepSettings.minStep = minStep;
+		defaultStepSettings.maxStep = maxStep;
 	}
 
 	inline void System::useRealStep()
 	{
-		stepMode = STEP_MODE_REAL;
+		defaultStepSettings.mode = STEP_MODE_REAL;
 	}
 
 	inline StepMode System::getStepMode()
 	{
-		return stepMode;
+		return defaultStepSettings.mode;
+	}
+
+	inline void System::setLocalClampStep(bool enableClampStep,float clamp)
+	{
+		StepSettings& settings = getLocalStepSettings();
+		settings.clampStepEnabled = enableClampStep;
+		settings.clampStep = clamp;
+	}
+
+	inline void System::useLocalConstantStep(float constantStep)
+	{
+		StepSettings& settings = getLocalStepSettings();
+		settings.mode = STEP_MODE_CONSTANT;
+		settings.constantStep = constantStep;
+	}
+
+	inline void System::useLocalAdaptiveStep(float minStep,float maxStep)
+	{
+		StepSettings& settings = getLocalStepSettings();
+		settings.mode = STEP_MODE_ADAPTIVE;
+		settings.minStep = minStep;
+		settings.maxStep = maxStep;
+	}
+
+	inline void System::useLocalRealStep()
+	{
+		getLocalStepSettings().mode = STEP_MODE_REAL;
+	}
+
+	inline void System::setLocalStepMode(StepMode mode)
+	{
+		getLocalStepSettings().mode = mode;
+	}
+
+	inline void System::setLocalClampValue(float clamp)
+	{
+		getLocalStepSettings().clampStep = clamp;
+	}
+
+	inline void System::enableLocalClampStep(bool useClampStep)
+	{
+		getLocalStepSettings().clampStepEnabled = useClampStep;
+	}
+
+	inline void System::useDefaultStep()
+	{
+		localStepEnabled = false;
+	}
+
+	inline void System::enableLocalStep(bool localStep)
+	{
+		if (localStep)
+			getLocalStepSettings();
+		else
+			useDefaultStep();
+	}
+
+	inline bool System::isLocalStepEnabled() const
+	{
+		return localStepEnabled;
+	}
+
+	inline StepMode System::getLocalStepMode() const
+	{
+		return getStepSettings().mode;
+	}
+
+	inline float System::getLocalConstantStep() const
+	{
+		return getStepSettings().constantStep;
+	}
+
+	inline float System::getLocalMinStep() const
+	{
+		return getStepSettings().minStep;
+	}
+
+	inline float System::getLocalMaxStep() const
+	{
+		return getStepSettings().maxStep;
+	}
+
+	inline bool System::isLocalClampStepEnabled() const
+	{
+		return getStepSettings().clampStepEnabled;
+	}
+
+	inline float System::getLocalClampStep() const
+	{
+		return getStepSettings().clampStep;
+	}
+
+	inline void System::setUpdateInterval(float interval)
+	{
+		updateInterval = interval;
+	}
+
+	inline float System::getUpdateInterval() const
+	{
+		return updateInterval;
+	}
+
+	inline float System::getDeferredTime() const
+	{
+		return deferredTime;
+	}
+
+	inline const System::StepSettings& System::getStepSettings() const
+	{
+		return localStepEnabled ? localStepSettings : defaultStepSettings;
+	}
+
+	inline System::StepSettings& System::getLocalStepSettings()
+	{
+		if (!localStepEnabled)
+		{
+			localStepSettings = defaultStepSettings;
+			localStepEnabled = true;
+		}
+		return localStepSettings;
+	}
+
+	inline void System::setThreadPool(ThreadPool* threadPool)
+	{
+		this->threadPool = threadPool;
+	}
+
+	inline ThreadPool* System::getThreadPool() const
+	{
+		return threadPool != NULL ? threadPool : SPKContext::get().getThreadPool();
+	}
+
+	inline bool System::isSeeded() const
+	{
+		return seeded;
+	}
+
+	inline uint32 System::getSeed() const
+	{
+		return seed;
+	}
+
+	inline void System::setAllocator(BlockAllocator* allocator)
+	{
+		this->allocator = allocator;
+	}
+
+	inline BlockAllocator* System::getAllocator() const
+	{
+		return allocator != NULL ? allocator : SPKContext::get().getAllocator();
+	}
+
+	inline SystemRecorder* System::getExternalRecorder() const
+	{
+		return updating ? NULL : recorder;
 	}
 
 	inline bool System::isInitialized() const
@@ -0,0 +1,208 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_SYSTEMPOOL
+#define H_SPK_SYSTEMPOOL
+
+#include <vector>
+
+namespace SPK
+{
+	class System;
+
+	/**
+	* @brief A pool of instances of a system used for short lived effects
+	*
+	* Spawning an effect by copying a system template deep copies all its groups, emitters, modifiers, zones...
+	* and allocates all the particle data. The pool keeps instances copied from a prototype and hands them out
+	* reset instead (see System::reset()) : the particles are cleared, the tanks of the emitters are refilled and the
+	* transform is set back to the one of the prototype. Acquiring an instance does not allocate memory and costs
+	* a time proportional to the number of groups only, as long as a free instance is available.<br>
+	* <br>
+	* The pool updates the instances in use (see updateParticles(float)) and takes them back once they are inactive
+	* and no longer referenced out of the pool. An effect can therefore be fired and forgotten :
+	* the reference returned by acquire() is used to place the effect, then released.<br>
+	* An instance can also be handed back explicitly with release(const Ref<System>&).<br>
+	* <br>
+	* If the prototype is seeded (see System::setSeed(uint32)), each instance handed out is reseeded from the seed of the prototype
+	* and from the number of instances handed out so far. The effects spawned therefore differ from one another while
+	* the sequence of effects stays the same at each run.
+	*/
+	class SPK_PREFIX SystemPool
+	{
+	public :
+
+		/**
+		* @brief Constructor of system pool
+		* @param prototype : the system the instances are copied from
+		* @param nbInstances : the number of instances to create at once
+		*/
+		explicit SystemPool(const Ref<System>& prototype = SPK_NULL_REF,size_t nbInstances = 0);
+
+		/**
+		* @brief Sets the system the instances are copied from
+		* All the instances of the previous prototype are dropped by the pool.
+		* @param prototype : the system the instances are copied from
+		*/
+		void setPrototype(const Ref<System>& prototype);
+
+		/**
+		* @brief Gets the system the instances are copied from
+		* @return the prototype of the pool
+		*/
+		const Ref<System>& getPrototype() const;
+
+		/**
+		* @brief Sets the maximum number of instances of the pool
+		* When the maximum is reached, acquire() fails instead of creating a new instance.
+		* @param maxNbInstances : the maximum number of instances (0 for no limit)
+		*/
+		void setMaxNbInstances(size_t maxNbInstances);
+
+		/**
+		* @brief Gets the maximum number of instances of the pool
+		* @return the maximum number of instances (0 for no limit)
+		*/
+		size_t getMaxNbInstances() const;
+
+		/**
+		* @brief Creates instances in advance
+		* Free instances are created until the pool holds the given number of instances.
+		* @param nbInstances : the number of instances the pool must hold
+		*/
+		void reserve(size_t nbInstances);
+
+		/**
+		* @brief Hands out an instance of the prototype
+		* A free instance is reset and returned. If there is none, a new instance is copied from the prototype unless the maximum is reached.
+		* The instance is reseeded if the prototype is seeded.
+		* @return the instance or SPK_NULL_REF if the pool is exhausted or has no prototype
+		*/
+		Ref<System> acquire();
+
+		/**
+		* @brief Hands back an instance to the pool
+		* The instance must not be used anymore by the caller.
+		* @param system : the instance to hand back
+		*/
+		void release(const Ref<System>& system);
+
+		/**
+		* @brief Takes back the instances that are inactive and no longer referenced out of the pool
+		* This is called by updateParticles(float). It is only needed when the instances are updated by the user.
+		* @return the number of instances taken back
+		*/
+		size_t collect();
+
+		/**
+		* @brief Updates the instances in use
+		* The instances that become inactive are then taken back if no longer referenced out of the pool (see collect()).
+		* @param deltaTime : the time step
+		* @return true if at least one instance is still in use
+		*/
+		bool updateParticles(float deltaTime);
+
+		/** @brief Renders the instances in use */
+		void renderParticles() const;
+
+		/**
+		* @brief Gets the number of instances held by the pool
+		* @return the number of instances
+		*/
+		size_t getNbInstances() const;
+
+		/**
+		* @brief Gets the number of instances in use
+		* @return the number of instances handed out and not taken back yet
+		*/
+		size_t getNbUsedInstances() const;
+
+		/**
+		* @brief Gets an instance in use
+		* @param index : the index of the instance
+		* @return the instance at the given index
+		*/
+		const Ref<System>& getUsedInstance(size_t index) const;
+
+		/**
+		* @brief Gets the number of free instances
+		* @return the number of instances ready to be handed out
+		*/
+		size_t getNbFreeInstances() const;
+
+	private :
+
+		Ref<System> prototype;
+		size_t maxNbInstances;
+		uint32 nbAcquisitions;
+
+		std::vector<Ref<System> > usedInstances;
+		std::vector<Ref<System> > freeInstances;
+
+		bool canCreateInstance() const;
+
+		SystemPool(const SystemPool&); // Not used
+		SystemPool& operator=(const SystemPool&); // Not used
+	};
+
+	inline const Ref<System>& SystemPool::getPrototype() const
+	{
+		return prototype;
+	}
+
+	inline void SystemPool::setMaxNbInstances(size_t maxNbInstances)
+	{
+		this->maxNbInstances = maxNbInstances;
+	}
+
+	inline size_t SystemPool::getMaxNbInstances() const
+	{
+		return maxNbInstances;
+	}
+
+	inline size_t SystemPool::getNbInstances() const
+	{
+		return usedInstances.size() + freeInstances.size();
+	}
+
+	inline size_t SystemPool::getNbUsedInstances() const
+	{
+		return usedInstances.size();
+	}
+
+	inline const Ref<System>& SystemPool::getUsedInstance(size_t index) const
+	{
+		SPK_ASSERT(index < usedInstances.size(),"SystemPool::getUsedInstance(size_t) - Index of instance is out of bounds : " << index);
+		return usedInstances[index];
+	}
+
+	inline size_t SystemPool::getNbFreeInstances() const
+	{
+		return freeInstances.size();
+	}
+
+	inline bool SystemPool::canCreateInstance() const
+	{
+		return prototype && (maxNbInstances == 0 || getNbInstances() < maxNbInstances);
+	}
+}
+
+#endif
@@ -0,0 +1,196 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_SYSTEMRECORDER
+#define H_SPK_SYSTEMRECORDER
+
+#include <vector>
+
+namespace SPK
+{
+	class System;
+	class Group;
+	class Zone;
+	class Emitter;
+
+	/**
+	* @brief A class recording the updates of a system so that they can be replayed deterministically
+	*
+	* While a system is recorded, the recorder logs the delta time of each update, the particles added manually
+	* to its groups between updates (see Group::addParticles(unsigned int,const Vector3D&,const Vector3D&)) and a hash
+	* of the state of the system after each update (see System::computeStateHash()).<br>
+	* The recording can then be replayed on another instance of the system, built the same way, to check frame by frame
+	* that it reaches the same states. This allows to reproduce a run exactly or to detect regressions.<br>
+	* <br>
+	* To be reproducible, the recorded system is seeded when the recording starts (see System::setSeed(uint32)) and
+	* its step settings and update interval are given to the system to replay.
+	* Note that emitters draw their initial tank and emission fraction at creation : the system to replay must therefore
+	* be built after seeding the calling thread the same way as for the recorded system (see RandomGenerator::setThreadSeed(uint32)).<br>
+	* Only the updates and the manual additions of particles are recorded. Other changes made to the system between updates
+	* (transforms, parameters, camera position...) must be made again by the caller.<br>
+	* <br>
+	* A recorder records a single system at a time and is not owned by it.
+	*/
+	class SPK_PREFIX SystemRecorder
+	{
+	friend class System;
+	friend class Group;
+
+	public :
+
+		/** @brief Constructor of system recorder */
+		SystemRecorder();
+
+		/** @brief Destructor of system recorder (stops the recording if any) */
+		~SystemRecorder();
+
+		/**
+		* @brief Starts recording a system
+		* The previous recording is cleared and the system is seeded.<br>
+		* The system should not have been updated yet so that the recording can be replayed from a new instance.
+		* @param system : the system to record
+		* @param seed : the seed of the system
+		*/
+		void startRecording(System& system,uint32 seed);
+
+		/** @brief Stops the recording */
+		void stopRecording();
+
+		/**
+		* @brief Tells whether a system is being recorded
+		* @return true if a system is being recorded, false if not
+		*/
+		bool isRecording() const;
+
+		/** @brief Clears the recording */
+		void clear();
+
+		/**
+		* @brief Gets the number of frames recorded
+		* @return the number of frames recorded
+		*/
+		size_t getNbFrames() const;
+
+		/**
+		* @brief Gets the delta time of a recorded frame
+		* @param index : the index of the frame
+		* @return the delta time passed to System::updateParticles(float) or System::deferUpdate(float) for this frame
+		*/
+		float getDeltaTime(size_t index) const;
+
+		/**
+		* @brief Gets the state hash of a recorded frame
+		* @param index : the index of the frame
+		* @return the hash of the state of the system after this frame
+		*/
+		uint32 getStateHash(size_t index) const;
+
+		/**
+		* @brief Replays the recording on a system
+		*
+		* The system is seeded with the seed of the recording, it is given the step settings and the update interval
+		* of the recorded system and the recorded frames are replayed one by one.
+		* The replay stops at the first frame whose state differs from the recorded one.
+		*
+		* @param system : the system to replay the recording on, built the same way as the recorded system
+		* @return the index of the first frame whose state differs or the number of frames if the replay matches the recording
+		*/
+		size_t replay(System& system) const;
+
+	private :
+
+		// Reference to an emitter or a zone that can be found back in another instance of the system
+		enum Source
+		{
+			SOURCE_NONE,		// no emitter or zone
+			SOURCE_EXTERNAL,	// an object not belonging to the system, reused as is when replaying
+			SOURCE_GROUP,		// an emitter of a group of the system (or its zone)
+		};
+
+		// A manual addition of particles or a flush of the particles added (if nb is 0)
+		struct Addition
+		{
+			size_t groupIndex;
+			unsigned int nb;
+			Vector3D position;
+			Vector3D velocity;
+			Source emitterSource;
+			Ref<Emitter> emitter;
+			size_t emitterGroupIndex;
+			size_t emitterIndex;
+			int emitterTank;
+			float emitterFraction;
+			Source zoneSource;
+			Ref<Zone> zone;
+			bool full;
+		};
+
+		struct Frame
+		{
+			float deltaTime;
+			bool deferred;			// whether the update was skipped by System::deferUpdate(float)
+			uint32 stateHash;
+			size_t additionsEnd;	// end of the additions made before this frame
+		};
+
+		System* system;
+
+		uint32 seed;
+		System::StepSettings stepSettings;
+		float updateInterval;
+
+		std::vector<Frame> frames;
+		std::vector<Addition> additions;
+
+		void recordAddition(const Group& group,unsigned int nb,const Vector3D& position,const Vector3D& velocity,const Ref<Zone>& zone,const Ref<Emitter>& emitter,bool full);
+		void recordFlush(const Group& group);
+		void recordFrame(float deltaTime,bool deferred = false);
+
+		void replayAddition(System& system,const Addition& addition) const;
+
+		SystemRecorder(const SystemRecorder&); // Not used
+		SystemRecorder& operator=(const SystemRecorder&); // Not used
+	};
+
+	inline bool SystemRecorder::isRecording() const
+	{
+		return system != NULL;
+	}
+
+	inline size_t SystemRecorder::getNbFrames() const
+	{
+		return frames.size();
+	}
+
+	inline float SystemRecorder::getDeltaTime(size_t index) const
+	{
+		SPK_ASSERT(index < getNbFrames(),"SystemRecorder::getDeltaTime(size_t) - Index of frame is out of bounds : " << index);
+		return frames[index].deltaTime;
+	}
+
+	inline uint32 SystemRecorder::getStateHash(size_t index) const
+	{
+		SPK_ASSERT(index < getNbFrames(),"SystemRecorder::getStateHash(size_t) - Index of frame is out of bounds : " << index);
+		return frames[index].stateHash;
+	}
+}
+
+#endif
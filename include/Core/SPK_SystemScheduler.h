@@ -0,0 +1,252 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_SYSTEMSCHEDULER
+#define H_SPK_SYSTEMSCHEDULER
+
+#include <vector>
+
+namespace SPK
+{
+	class System;
+
+	/**
+	* @brief A class updating many systems within a time budget
+	*
+	* The scheduler holds a set of systems and updates them in a single call to updateParticles(float).
+	* It measures the cost of the update of each system and, when a time budget is set, updates the systems
+	* by decreasing priority as long as the budget allows it. The other systems are deferred : the time they
+	* missed is accumulated by the systems (see System::deferUpdate(float)) and they catch up at their next update,
+	* in a single step or in several ones depending on their step settings (see System::useLocalConstantStep(float)).
+	* The clamp step applies to each time step and not to the accumulated time, so that a deferred system never loses time.<br>
+	* <br>
+	* The priority of a system is its importance (given by the user, typically function of its distance and of
+	* its visibility) multiplied by the time it lags behind, so that deferred systems get more and more priority.
+	* A system lagging behind for more than the maximum deferred time is updated whatever the budget.<br>
+	* <br>
+	* Statistics about the last update are exposed for telemetry (see getStatistics()).
+	*/
+	class SPK_PREFIX SystemScheduler
+	{
+	public :
+
+		/** @brief Statistics about the last update of a scheduler */
+		struct Statistics
+		{
+			size_t nbUpdatedSystems;	/**< @brief The number of systems updated */
+			size_t nbDeferredSystems;	/**< @brief The number of systems deferred */
+			size_t nbForcedSystems;		/**< @brief The number of systems updated over the budget as they were deferred for too long */
+			float updateTime;			/**< @brief The time spent to update the systems in milliseconds */
+			float maxDeferredTime;		/**< @brief The maximum time a system lags behind in seconds */
+		};
+
+		/**
+		* @brief Constructor of system scheduler
+		* @param budget : the time budget of an update in milliseconds (0 for no budget)
+		*/
+		explicit SystemScheduler(float budget = 0.0f);
+
+		/**
+		* @brief Adds a system to the scheduler
+		* @param system : the system to add
+		* @param importance : the importance of the system
+		*/
+		void addSystem(const Ref<System>& system,float importance = 1.0f);
+
+		/**
+		* @brief Removes a system from the scheduler
+		* @param system : the system to remove
+		*/
+		void removeSystem(const Ref<System>& system);
+
+		/** @brief Removes all the systems from the scheduler */
+		void removeAllSystems();
+
+		/**
+		* @brief Gets the number of systems of the scheduler
+		* @return the number of systems
+		*/
+		size_t getNbSystems() const;
+
+		/**
+		* @brief Gets a system of the scheduler
+		* @param index : the index of the system
+		* @return the system at index
+		*/
+		const Ref<System>& getSystem(size_t index) const;
+
+		/**
+		* @brief Sets the importance of a system
+		* The importance is typically updated each frame function of the distance of the system from the viewer and of its visibility.
+		* A system with an importance of 0 is only updated when no other system needs the budget or when it is deferred for too long.
+		* @param index : the index of the system
+		* @param importance : the importance of the system
+		*/
+		void setImportance(size_t index,float importance);
+
+		/**
+		* @brief Gets the importance of a system
+		* @param index : the index of the system
+		* @return the importance of the system
+		*/
+		float getImportance(size_t index) const;
+
+		/**
+		* @brief Gets the measured cost of the update of a system
+		* @param index : the index of the system
+		* @return the average time of an update of the system in milliseconds
+		*/
+		float getCost(size_t index) const;
+
+		/**
+		* @brief Gets the time a system lags behind
+		* @param index : the index of the system
+		* @return the time accumulated since the last update of the system in seconds
+		*/
+		float getDeferredTime(size_t index) const;
+
+		/**
+		* @brief Sets the time budget of an update
+		* @param budget : the time budget in milliseconds (0 for no budget)
+		*/
+		void setBudget(float budget);
+
+		/**
+		* @brief Gets the time budget of an update
+		* @return the time budget in milliseconds
+		*/
+		float getBudget() const;
+
+		/**
+		* @brief Sets the maximum time a system can lag behind
+		* A system deferred for longer is updated whatever the budget.
+		* The deferred time can exceed the clamp step of the systems : it is caught up in full.
+		* @param maxDeferredTime : the maximum deferred time in seconds
+		*/
+		void setMaxDeferredTime(float maxDeferredTime);
+
+		/**
+		* @brief Gets the maximum time a system can lag behind
+		* @return the maximum deferred time in seconds
+		*/
+		float getMaxDeferredTime() const;
+
+		/**
+		* @brief Updates the systems within the time budget
+		* @param deltaTime : the time step
+		* @return true if at least one system is still active
+		*/
+		bool updateParticles(float deltaTime);
+
+		/**
+		* @brief Gets the statistics about the last update
+		* @return the statistics of the last update
+		*/
+		const Statistics& getStatistics() const;
+
+	private :
+
+		// The weight of the last measure in the average cost of a system
+		static const float COST_SMOOTHING;
+
+		struct Entry
+		{
+			Ref<System> system;
+			float importance;
+			float priority;
+			float cost;
+			bool costMeasured;
+			float deferredTime;
+			bool alive;
+		};
+
+		class PriorityCompare;
+
+		std::vector<Entry> entries;
+		std::vector<size_t> order;	// buffer of the indices of the entries sorted by priority
+
+		float budget;
+		float maxDeferredTime;
+		Statistics statistics;
+	};
+
+	inline size_t SystemScheduler::getNbSystems() const
+	{
+		return entries.size();
+	}
+
+	inline const Ref<System>& SystemScheduler::getSystem(size_t index) const
+	{
+		SPK_ASSERT(index < getNbSystems(),"SystemScheduler::getSystem(size_t) - Index of system is out of bounds : " << index);
+		return entries[index].system;
+	}
+
+	inline void SystemScheduler::setImportance(size_t index,float importance)
+	{
+		SPK_ASSERT(index < getNbSystems(),"SystemScheduler::setImportance(size_t,float) - Index of system is out of bounds : " << index);
+		entries[index].importance = importance;
+	}
+
+	inline float SystemScheduler::getImportance(size_t index) const
+	{
+		SPK_ASSERT(index < getNbSystems(),"SystemScheduler::getImportance(size_t) - Index of system is out of bounds : " << index);
+		return entries[index].importance;
+	}
+
+	inline float SystemScheduler::getCost(size_t index) const
+	{
+		SPK_ASSERT(index < getNbSystems(),"SystemScheduler::getCost(size_t) - Index of system is out of bounds : " << index);
+		return entries[index].cost;
+	}
+
+	inline float SystemScheduler::getDeferredTime(size_t index) const
+	{
+		SPK_ASSERT(index < getNbSystems(),"SystemScheduler::getDeferredTime(size_t) - Index of system is out of bounds : " << index);
+		return entries[index].deferredTime;
+	}
+
+	inline void SystemScheduler::setBudget(float budget)
+	{
+		this->budget = budget;
+	}
+
+	inline float SystemScheduler::getBudget() const
+	{
+		return budget;
+	}
+
+	inline void SystemScheduler::setMaxDeferredTime(float maxDeferredTime)
+	{
+		this->maxDeferredTime = maxDeferredTime;
+	}
+
+	inline float SystemScheduler::getMaxDeferredTime() const
+	{
+		return maxDeferredTime;
+	}
+
+	inline const SystemScheduler::Statistics& SystemScheduler::getStatistics() const
+	{
+		return statistics;
+	}
+}
+
+#endif
@@ -0,0 +1,116 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_THREADPOOL
+#define H_SPK_THREADPOOL
+
+namespace SPK
+{
+	/**
+	* @brief A pool of worker threads used to update particles in parallel
+	*
+	* The thread pool is built upon a work stealing scheduler : each worker owns a queue of tasks,
+	* pops its own tasks in LIFO order and steals tasks from the others in FIFO order when idle.<br>
+	* The thread calling parallelFor(size_t,Job&) takes part to the work until all the tasks of the call are done.
+	* Therefore parallelFor(size_t,Job&) can safely be called from within a job (nested parallelism).<br>
+	* <br>
+	* A thread pool is not used by default by SPARK. It must be set explicitly either to a given system
+	* (see System::setThreadPool(ThreadPool*)) or to every systems at once (see SPKContext::setThreadPool(ThreadPool*)).<br>
+	* The pool is not owned by SPARK : the user is responsible for its destruction once no system refers to it anymore.<br>
+	* <br>
+	* If SPK_NO_THREADS is defined at compilation, no thread is ever created and all jobs are run in the calling thread.
+	*/
+	class SPK_PREFIX ThreadPool
+	{
+	public :
+
+		/**
+		* @brief A job that can be run by a thread pool
+		*
+		* A job is split in a given number of independent tasks.
+		* The run(size_t) method is called once per task with the index of the task.
+		* Tasks may be run concurrently in any order.
+		*/
+		class Job
+		{
+		public :
+
+			virtual ~Job() {}
+
+			/**
+			* @brief Runs a task of the job
+			* @param index : the index of the task to run
+			*/
+			virtual void run(size_t index) = 0;
+		};
+
+		/**
+		* @brief Constructor of thread pool
+		* @param nbWorkers : the number of worker threads to create (0 to create one worker less than the number of hardware threads)
+		*/
+		explicit ThreadPool(size_t nbWorkers = 0);
+
+		/** @brief Destructor of thread pool (waits for the workers to terminate) */
+		~ThreadPool();
+
+		/**
+		* @brief Gets the number of worker threads of this pool
+		* @return the number of workers
+		*/
+		size_t getNbWorkers() const;
+
+		/**
+		* @brief Gets the number of threads that can take part to a job
+		* This is the number of workers plus the calling thread.
+		* @return the number of threads
+		*/
+		size_t getNbThreads() const;
+
+		/**
+		* @brief Runs a job split in several tasks and waits for its completion
+		* The calling thread takes part to the work.
+		* @param nbTasks : the number of tasks to run
+		* @param job : the job to run
+		*/
+		void parallelFor(size_t nbTasks,Job& job);
+
+		/**
+		* @brief Gets the number of hardware threads available
+		* @return the number of hardware threads (at least 1)
+		*/
+		static size_t getHardwareConcurrency();
+
+	private :
+
+		struct Context;
+		Context* context;
+
+		ThreadPool(const ThreadPool&); // Not used
+		ThreadPool& operator=(const ThreadPool&); // Not used
+	};
+
+	inline size_t ThreadPool::getNbThreads() const
+	{
+		return getNbWorkers() + 1;
+	}
+}
+
+#endif
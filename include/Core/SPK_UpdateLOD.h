@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_UPDATELOD
+#define H_SPK_UPDATELOD
+
+#include <vector>
+
+namespace SPK
+{
+	class System;
+
+	/**
+	* @brief A level of detail policy for the update of systems
+	*
+	* The update LOD gives an update interval to systems function of their distance from the viewer and of their visibility
+	* (see System::setUpdateInterval(float)). Far or hidden systems are therefore updated at a reduced frequency and catch up
+	* with a single larger step when they are updated.<br>
+	* <br>
+	* Each level defines a distance from which systems are updated at most once per given interval.
+	* Systems closer than the distance of the first level are updated at each call.
+	* Hidden systems are given a specific interval whatever their distance.<br>
+	* <br>
+	* The policy is applied by the user each frame, typically after the culling of the systems :
+	* <i>lod.apply(*system,distance,visible)</i>
+	*/
+	class SPK_PREFIX UpdateLOD
+	{
+	public :
+
+		/** @brief Constructor of update LOD */
+		UpdateLOD();
+
+		/**
+		* @brief Adds a level of detail
+		* @param distance : the distance from which the level applies
+		* @param interval : the minimum interval between two updates of the systems at this level
+		*/
+		void addLevel(float distance,float interval);
+
+		/** @brief Removes all the levels of detail */
+		void clearLevels();
+
+		/**
+		* @brief Gets the number of levels of detail
+		* @return the number of levels
+		*/
+		size_t getNbLevels() const;
+
+		/**
+		* @brief Sets the interval between two updates of hidden systems
+		* @param interval : the minimum interval between two updates of hidden systems (0 to apply the levels to hidden systems as well)
+		*/
+		void setHiddenInterval(float interval);
+
+		/**
+		* @brief Gets the interval between two updates of hidden systems
+		* @return the minimum interval between two updates of hidden systems
+		*/
+		float getHiddenInterval() const;
+
+		/**
+		* @brief Computes the update interval of a system
+		* @param distance : the distance of the system from the viewer
+		* @param visible : true if the system is visible, false if not
+		* @return the minimum interval between two updates of the system
+		*/
+		float computeInterval(float distance,bool visible = true) const;
+
+		/**
+		* @brief Sets the update interval of a system
+		* @param system : the system
+		* @param distance : the distance of the system from the viewer
+		* @param visible : true if the system is visible, false if not
+		*/
+		void apply(System& system,float distance,bool visible = true) const;
+
+	private :
+
+		struct Level
+		{
+			float distance;
+			float interval;
+		};
+
+		std::vector<Level> levels; // sorted by distance
+		float hiddenInterval;
+	};
+
+	inline void UpdateLOD::clearLevels()
+	{
+		levels.clear();
+	}
+
+	inline size_t UpdateLOD::getNbLevels() const
+	{
+		return levels.size();
+	}
+
+	inline void UpdateLOD::setHiddenInterval(float interval)
+	{
+		hiddenInterval = interval;
+	}
+
+	inline float UpdateLOD::getHiddenInterval() const
+	{
+		return hiddenInterval;
+	}
+}
+
+#endif
@@ -929,12 +929,12 @@ namespace SPK
 
 	// Specialization of the random generation of vectors 3D
 	template<>
-	inline Vector3D SPKContext::generateRandom(const Vector3D& v0,const Vector3D& v1)
+	inline Vector3D RandomGenerator::generate(const Vector3D& v0,const Vector3D& v1)
 	{
 		return Vector3D(
-			generateRandom(v0.x,v1.x),
-			generateRandom(v0.y,v1.y),
-			generateRandom(v0.z,v1.z));
+			generate(v0.x,v1.x),
+			generate(v0.y,v1.y),
+			generate(v0.z,v1.z));
 	}
 }
 
@@ -58,6 +58,9 @@ namespace SPK
 	{
 	public :
 
+		/** @brief The maximum number of particles tested at once by the batched checks of zones */
+		static const size_t BATCH_SIZE = 256;
+
 		////////////////
 		// Destructor //
 		////////////////
@@ -80,6 +83,16 @@ namespace SPK
 		virtual bool contains(const Vector3D& v,float radius = 0.0f) const = 0;
 		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const = 0;
 		virtual Vector3D computeNormal(const Vector3D& v) const = 0;
+
+		/**
+		* @brief Generates several positions at once
+		* This is used to emit a batch of particles. The default implementation calls generatePosition(Vector3D&,bool,float) for each position.
+		* @param positions : the array of positions to generate
+		* @param nb : the number of positions to generate
+		* @param full : true to generate the positions in the whole zone, false to generate them only at its border
+		* @param radii : the radius of each position or NULL for a radius of 0
+		*/
+		virtual void generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii = NULL) const;
 		
 		/**
 		* Performs a check for a particle on the zone
@@ -90,6 +103,22 @@ namespace SPK
 		*/
 		bool check(const Particle& particle,ZoneTest zoneTest,Vector3D* normal = NULL) const;
 
+		/**
+		* @brief Performs a check for several particles at once
+		*
+		* This gives the same results as check(const Particle&,ZoneTest,Vector3D*) called for each particle
+		* but works directly on the arrays of the particles, which allows zones to vectorize the tests.
+		*
+		* @param zoneTest : the type of test to perform
+		* @param positions : the positions of the particles
+		* @param oldPositions : the positions of the particles at the previous step (only used by the tests intersect, enter and leave)
+		* @param radii : the radius of each particle or NULL for a radius of 0
+		* @param nb : the number of particles
+		* @param mask : the array receiving the results (1 if the test is fullfilled, 0 otherwise)
+		* @param normals : the array receiving the normals of the particles fullfilling the test (if NULL, the normals wont be computed)
+		*/
+		void checkBatch(ZoneTest zoneTest,const Vector3D* positions,const Vector3D* oldPositions,const float* radii,size_t nb,uint8* mask,Vector3D* normals = NULL) const;
+
 	public :
 		spark_description(Zone, Transformable)
 		(
@@ -103,6 +132,32 @@ namespace SPK
 		virtual  void innerUpdateTransform();
 		static  void normalizeOrRandomize(Vector3D& v);
 
+		/**
+		* @brief Tells whether several points are within the zone
+		* This is called by checkBatch() with at most BATCH_SIZE points.
+		* The default implementation calls contains(const Vector3D&,float) for each point.
+		* @param positions : the points
+		* @param radii : the radius of each point or NULL for a radius of 0
+		* @param radiusFactor : the factor applied to the radii (1 or -1)
+		* @param nb : the number of points
+		* @param mask : the array receiving the results
+		*/
+		virtual void containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const;
+
+		/**
+		* @brief Tells whether several segments intersect the zone
+		* This is called by checkBatch() with at most BATCH_SIZE segments.
+		* Only the segments whose mask is not 0 are tested, the mask of the others is left to 0.
+		* The default implementation calls intersects(const Vector3D&,const Vector3D&,float,Vector3D*) for each tested segment.
+		* @param v0 : the start of the segments
+		* @param v1 : the end of the segments
+		* @param radii : the radius of each segment or NULL for a radius of 0
+		* @param nb : the number of segments
+		* @param mask : the segments to test, receives the results
+		* @param normals : the array receiving the normals of the intersections or NULL
+		*/
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const;
+
 	private :
 
 		Vector3D position;
@@ -107,9 +107,11 @@ namespace SPK
 		* @param PRIORITY : see Modifier
 		* @param NEEDS_DATASET : see Modifier
 		* @param CALL_INIT : see Modifier
+		* @param NEEDS_OCTREE : see Modifier
 		* @param ZONE_TEST_FLAG : the test flag specifying which zone tests are valid for this zonedModifier
 		* @param zoneTest : the zone test by default
 		* @param zone : the zone
+		* @param CHUNK_SAFE : see Modifier
 		*/
 		ZonedModifier(
 			unsigned int PRIORITY,
@@ -118,7 +120,8 @@ namespace SPK
 			bool NEEDS_OCTREE,
 			int ZONE_TEST_FLAG,
 			ZoneTest zoneTest,
-			const Ref<Zone>& zone = SPK_NULL_REF);
+			const Ref<Zone>& zone = SPK_NULL_REF,
+			bool CHUNK_SAFE = false);
 
 		ZonedModifier(const ZonedModifier& zonedModifier);
 
@@ -128,6 +131,17 @@ namespace SPK
 		*/
 		bool checkZone(const Particle& particle,Vector3D* normal = NULL) const;
 
+		/**
+		* @brief Checks whether the zone test passes for a block of particles at once
+		* This is the batched version of checkZone(const Particle&,Vector3D*) (see Zone::checkBatch()).
+		* @param group : the group of the particles
+		* @param start : the index of the first particle of the block
+		* @param nb : the number of particles of the block (at most Zone::BATCH_SIZE)
+		* @param mask : the array receiving the results (1 if the zone test passes, 0 if not)
+		* @param normals : the array receiving the normals (if NULL, the normals wont be computed)
+		*/
+		void checkZoneBatch(const Group& group,size_t start,size_t nb,uint8* mask,Vector3D* normals = NULL) const;
+
 		virtual void propagateUpdateTransform();
 
 	private :
@@ -134,6 +134,7 @@ namespace SPK
 		void resetPool();
 
 		virtual void apply(Particle& particle) const;
+		virtual void getTargetGroups(std::vector<const Group*>& targets) const;
 		virtual Ref<SPKObject> findByName(const std::string& name);
 
 	public :
@@ -195,6 +196,12 @@ namespace SPK
 		return baseEmitter;
 	}
 
+	inline void SpawnParticlesAction::getTargetGroups(std::vector<const Group*>& targets) const
+	{
+		if (targetGroup)
+			targets.push_back(targetGroup.get());
+	}
+
 	inline void SpawnParticlesAction::setTargetGroup(const Ref<Group>& group)
 	{
 		targetGroup = group;
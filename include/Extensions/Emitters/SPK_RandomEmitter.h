@@ -44,6 +44,8 @@ namespace SPK
 			float forceMin = 1.0f,
 			float forceMax = 1.0f);
 
+		virtual void generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const;
+
 	public :
 		spark_description(RandomEmitter, Emitter)
 		(
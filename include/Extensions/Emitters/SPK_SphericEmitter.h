@@ -108,6 +108,8 @@ namespace SPK
 		*/
 		float getAngleMax() const;
 
+		virtual void generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const;
+
 	public :
 		spark_description(SphericEmitter, Emitter)
 		(
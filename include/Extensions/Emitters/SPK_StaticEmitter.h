@@ -42,6 +42,8 @@ namespace SPK
 			int tank = -1,
 			float flow = 1.0f);
 
+		virtual void generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const;
+
 	public :
 		spark_description(StaticEmitter, Emitter)
 		(
@@ -75,6 +77,12 @@ namespace SPK
 	{
 		particle.velocity().set(0.0f,0.0f,0.0f); // no initial velocity
 	}
+
+	inline void StaticEmitter::generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const
+	{
+		for (GroupIterator particleIt(group,start,start + nb); !particleIt.end(); ++particleIt)
+			particleIt->velocity().set(0.0f,0.0f,0.0f); // no initial velocity
+	}
 }
 
 #endif
@@ -67,6 +67,8 @@ namespace SPK
 		*/
 		const Vector3D& getTransformedDirection() const;
 
+		virtual void generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const;
+
 	public :
 		spark_description(StraightEmitter, Emitter)
 		(
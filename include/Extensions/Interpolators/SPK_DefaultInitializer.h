@@ -49,13 +49,14 @@ namespace SPK
 		DefaultInitializer<T>(Tv value = T());
 		DefaultInitializer<T>(const DefaultInitializer<T>& interpolator);
 
-		virtual  void interpolate(T* data,Group& group,DataSet* dataSet) const {}
+		virtual  void interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const {}
 		virtual  void init(T& data,Particle& particle,DataSet* dataSet) const;
+		virtual  void initBatch(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const;
 	};
 
 	template<typename T>
 	DefaultInitializer<T>::DefaultInitializer(Tv value) :
-		Interpolator<T>(false),
+		Interpolator<T>(false,true),
 		defaultValue(value)
 	{}
 
@@ -89,6 +90,13 @@ namespace SPK
 		data = defaultValue;
 	}
 
+	template<typename T>
+	inline void DefaultInitializer<T>::initBatch(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const
+	{
+		for (size_t i = start; i < end; ++i)
+			data[i] = defaultValue;
+	}
+
 	// Typedefs
 	typedef DefaultInitializer<Color> ColorDefaultInitializer;
 	typedef DefaultInitializer<float> FloatDefaultInitializer;
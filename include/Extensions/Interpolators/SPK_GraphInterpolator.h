@@ -280,7 +280,7 @@ namespace SPK
 
 		virtual void createData(DataSet& dataSet,const Group& group) const;
 
-		virtual void interpolate(T* data, Group& group, DataSet* dataSet) const;
+		virtual void interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const;
 		virtual void init(T& data, Particle& particle, DataSet* dataSet) const;
 
 		void sortGraph(unsigned int start);
@@ -316,7 +316,7 @@ namespace SPK
 
 	template<typename T>
 	GraphInterpolator<T>::GraphInterpolator() :
-		Interpolator<T>(true),
+		Interpolator<T>(true,true),
 		type(INTERPOLATOR_LIFETIME),
 		param(PARAM_SCALE),
 		scaleXVariation(0.0f),
@@ -652,15 +652,15 @@ namespace SPK
 	}
 
 	template<typename T>
-	void GraphInterpolator<T>::interpolate(T* data, Group& group, DataSet* dataSet) const
+	void GraphInterpolator<T>::interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const
 	{
-		SPK_ASSERT(!graph.empty(),"GraphInterpolator<T>::interpolate(T*,Group&,DataSet*) const - The graph of the interpolator is empty. Cannot interpolate");
+		SPK_ASSERT(!graph.empty(),"GraphInterpolator<T>::interpolateRange(T*,Group&,DataSet*,size_t,size_t) const - The graph of the interpolator is empty. Cannot interpolate");
 
 		FloatArrayData& offsetXData = SPK_GET_DATA(FloatArrayData,dataSet,OFFSET_X_DATA_INDEX);
 		FloatArrayData& scaleXData = SPK_GET_DATA(FloatArrayData,dataSet,SCALE_X_DATA_INDEX);
 		FloatArrayData& ratioYData = SPK_GET_DATA(FloatArrayData,dataSet,RATIO_Y_DATA_INDEX);
 
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
 		{
 			size_t index = particleIt->getIndex();
 			interpolateParticle(data[index],*particleIt,offsetXData[index],scaleXData[index],ratioYData[index]);
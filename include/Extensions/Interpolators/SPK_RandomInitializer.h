@@ -51,8 +51,9 @@ namespace SPK
 		RandomInitializer<T>(Tv min = T(),Tv max = T());
 		RandomInitializer<T>(const RandomInitializer<T>& interpolator);
 
-		virtual void interpolate(T* data,Group& group,DataSet* dataSet) const {}
+		virtual void interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const {}
 		virtual void init(T& data,Particle& particle,DataSet* dataSet) const;
+		virtual void initBatch(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const;
 	};
 
 	typedef RandomInitializer<Color> ColorRandomInitializer;
@@ -63,7 +64,7 @@ namespace SPK
 
 	template<typename T>
 	RandomInitializer<T>::RandomInitializer(Tv minValue,Tv maxValue) :
-		Interpolator<T>(false),
+		Interpolator<T>(false,true),
 		minValue(minValue),
 		maxValue(maxValue)
 	{}
@@ -105,6 +106,13 @@ namespace SPK
 	{
 		data = SPK_RANDOM(minValue,maxValue);
 	}
+
+	template<typename T>
+	inline void RandomInitializer<T>::initBatch(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const
+	{
+		for (size_t i = start; i < end; ++i)
+			data[i] = SPK_RANDOM(minValue,maxValue);
+	}
 }
 
 #endif
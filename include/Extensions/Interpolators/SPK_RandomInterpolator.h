@@ -67,7 +67,7 @@ namespace SPK
 
 		virtual void createData(DataSet& dataSet,const Group& group) const;
 
-		virtual void interpolate(T* data,Group& group,DataSet* dataSet) const;
+		virtual void interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const;
 		virtual void init(T& data,Particle& particle,DataSet* dataSet) const;
 	};
 
@@ -85,7 +85,7 @@ namespace SPK
 
 	template<typename T>
 	RandomInterpolator<T>::RandomInterpolator(const T& minBirthValue,const T& maxBirthValue,const T& minDeathValue,const T& maxDeathValue) :
-		Interpolator<T>(true),
+		Interpolator<T>(true,true),
 		minBirthValue(minBirthValue),
 		maxBirthValue(maxBirthValue),
 		minDeathValue(minDeathValue),
@@ -153,15 +153,15 @@ namespace SPK
 	}
 
 	template<typename T>
-	void RandomInterpolator<T>::interpolate(T* data,Group& group,DataSet* dataSet) const
+	void RandomInterpolator<T>::interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const
 	{
 		const ArrayData<T>& birthValuesData = SPK_GET_DATA(ArrayData<T>,dataSet,BIRTH_VALUE_DATA_INDEX);
 		const ArrayData<T>& deathValuesData = SPK_GET_DATA(ArrayData<T>,dataSet,DEATH_VALUE_DATA_INDEX);
 
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
 		{
 			size_t index = particleIt->getIndex();
-			interpolateParam(data[index],deathValuesData[index],birthValuesData[index],particleIt->getEnergy());
+			this->interpolateParam(data[index],deathValuesData[index],birthValuesData[index],particleIt->getEnergy());
 		}
 	}
 
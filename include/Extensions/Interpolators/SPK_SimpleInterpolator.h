@@ -51,8 +51,9 @@ namespace SPK
 		SimpleInterpolator<T>(Tv birthValue = T(),Tv deathValue = T());
 		SimpleInterpolator<T>(const SimpleInterpolator<T>& interpolator);
 
-		virtual void interpolate(T* data,Group& group,DataSet* dataSet) const;
+		virtual void interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const;
 		virtual  void init(T& data,Particle& particle,DataSet* dataSet) const;
+		virtual  void initBatch(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const;
 	};
 
 	typedef SimpleInterpolator<Color> ColorSimpleInterpolator;
@@ -63,7 +64,7 @@ namespace SPK
 
 	template<typename T>
 	SimpleInterpolator<T>::SimpleInterpolator(Tv birthValue,Tv deathValue) :
-		Interpolator<T>(false),
+		Interpolator<T>(false,true),
 		birthValue(birthValue),
 		deathValue(deathValue)
 	{}
@@ -107,10 +108,17 @@ namespace SPK
 	}
 
 	template<typename T>
-	void SimpleInterpolator<T>::interpolate(T* data,Group& group,DataSet* dataSet) const
+	inline void SimpleInterpolator<T>::initBatch(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const
 	{
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-			interpolateParam(data[particleIt->getIndex()],deathValue,birthValue,particleIt->getEnergy());
+		for (size_t i = start; i < end; ++i)
+			data[i] = birthValue;
+	}
+
+	template<typename T>
+	void SimpleInterpolator<T>::interpolateRange(T* data,Group& group,DataSet* dataSet,size_t start,size_t end) const
+	{
+		for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
+			this->interpolateParam(data[particleIt->getIndex()],deathValue,birthValue,particleIt->getEnergy());
 	}
 }
 
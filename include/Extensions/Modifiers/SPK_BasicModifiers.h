@@ -52,7 +52,8 @@ namespace SPK
 		Gravity(const Vector3D& value = Vector3D());
 		Gravity(const Gravity& gravity);
 
-		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+		virtual void modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const;
+		virtual void modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const;
 	};
 
 	class SPK_PREFIX Friction : public Modifier
@@ -77,11 +78,12 @@ namespace SPK
 		Friction(float value = 0.0f);
 		Friction(const Friction& friction);
 
-		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+		virtual void modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const;
+		virtual void modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const;
 	};
 
 	inline Gravity::Gravity(const Vector3D& value) :
-		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false)
+		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false,true,true)
 	{
 		setValue(value);	
 	}
@@ -119,7 +121,7 @@ namespace SPK
 	}
 
 	inline Friction::Friction(float value) :
-		Modifier(MODIFIER_PRIORITY_FRICTION,false,false,false),
+		Modifier(MODIFIER_PRIORITY_FRICTION,false,false,false,true,true),
 		value(value)
 	{}
 
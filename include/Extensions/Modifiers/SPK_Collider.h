@@ -45,7 +45,10 @@ namespace SPK
 	* Tries to limitate the number of particles to perform collision on. More than 1000 particles can require a lot of processing time even of recent hardware.<br>
 	* <br>
 	* The accuracy of the collisions is better with small update steps.
-	* Therefore try to keep the update time small by for instance multiplying the number of updates per frame.
+	* Therefore try to keep the update time small by for instance multiplying the number of updates per frame.<br>
+	* <br>
+	* By default the collisions are resolved one after the other, each collision seeing the velocities modified by the previous ones.
+	* A parallel solver can be enabled instead (see enableParallelSolving(bool)).
 	*/
 	class SPK_PREFIX Collider : public Modifier
 	{
@@ -81,31 +84,83 @@ namespace SPK
 		*/
 		float getElasticity() const;
 
+		////////////
+		// Solver //
+		////////////
+
+		/**
+		* @brief Enables or disables the parallel solver
+		*
+		* The parallel solver resolves the collisions in two phases.
+		* The velocity changes of every particle are first computed from the state of the particles at the beginning of the step,
+		* then they are applied to all the particles at once.<br>
+		* Each phase is split in chunks of particles that are processed by the thread pool of the system if any (see System::setThreadPool(ThreadPool*)).
+		* The result does not depend on the number of threads.<br>
+		* <br>
+		* The positions, velocities, sizes and masses are read directly from the arrays of the group.
+		* A pair of particles sharing several cells of the spatial index is resolved only once.<br>
+		* <br>
+		* Both solvers apply the same momentum conserving equations to each pair of colliding particles.
+		* However, in the serial solver each collision sees the velocities and positions modified by the previous collisions of the step,
+		* whereas in the parallel solver all collisions of a step see the state at its beginning.
+		* The results of both solvers therefore differ when a particle collides with several others within a step.<br>
+		* <br>
+		* The parallel solver stores the changes of the particles in the dataset of the group. This data is only allocated while the parallel solver is enabled.
+		*
+		* @param parallelSolving : true to enable the parallel solver, false to use the serial one
+		*/
+		void enableParallelSolving(bool parallelSolving);
+
+		/**
+		* @brief Tells whether the parallel solver is enabled or not
+		* @return true if the parallel solver is enabled, false if not
+		*/
+		bool isParallelSolvingEnabled() const;
+
 	public :
 		spark_description(Collider, Modifier)
 		(
 			spk_attribute(float, elasticity, setElasticity, getElasticity);
+			spk_attribute(bool, parallelSolving, enableParallelSolving, isParallelSolvingEnabled);
 		);
 
 	private :
 
+		static const size_t NB_DATA = 2;
+		static const size_t VELOCITY_DELTA_INDEX = 0;
+		static const size_t RESET_POSITION_INDEX = 1;
+
+		// Number of particles solved at once by a thread
+		static const size_t SOLVER_CHUNK_SIZE = 1024;
+
+		class SolverJob;
+
 		float elasticity;
+		bool parallelSolvingEnabled;
 
 		Collider(float elasticity = 1.0f);
 		Collider(const Collider& collider);
 
+		virtual void createData(DataSet& dataSet,const Group& group) const;
+		virtual void checkData(DataSet& dataSet,const Group& group) const;
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		void solveSerial(Group& group) const;
+		void solveRange(Group& group,DataSet* dataSet,size_t start,size_t end) const;
+		void applyRange(Group& group,DataSet* dataSet,size_t start,size_t end) const;
 	};
 
 	inline Collider::Collider(float elasticity) :
-		Modifier(MODIFIER_PRIORITY_COLLISION,false,false,true)
+		Modifier(MODIFIER_PRIORITY_COLLISION,true,false,true),
+		parallelSolvingEnabled(false)
 	{
 		setElasticity(elasticity);
 	}
 
 	inline Collider::Collider(const Collider& collider) :
 		Modifier(collider),
-		elasticity(collider.elasticity)
+		elasticity(collider.elasticity),
+		parallelSolvingEnabled(collider.parallelSolvingEnabled)
 	{}
 
 	inline Ref<Collider> Collider::create(float elasticity)
@@ -117,6 +172,16 @@ namespace SPK
 	{
 		return elasticity;
 	}
+
+	inline void Collider::enableParallelSolving(bool parallelSolving)
+	{
+		parallelSolvingEnabled = parallelSolving;
+	}
+
+	inline bool Collider::isParallelSolvingEnabled() const
+	{
+		return parallelSolvingEnabled;
+	}
 }
 
 #endif
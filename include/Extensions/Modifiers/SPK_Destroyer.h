@@ -47,8 +47,10 @@ namespace SPK
 		Destroyer(const Ref<Zone>& zone = SPK_NULL_REF,ZoneTest zoneTest = ZONE_TEST_INSIDE);
 		Destroyer(const Destroyer& destroyer);
 
-		virtual void init(Particle& particle,DataSet* dataSet) const;
+		virtual void initBatch(Group& group,DataSet* dataSet,size_t start,size_t end) const;
 		virtual  void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		void destroyRange(Group& group,size_t start,size_t end) const;
 	};
 
 	inline Ref<Destroyer> Destroyer::create(const Ref<Zone>& zone,ZoneTest zoneTest)
@@ -64,17 +66,29 @@ namespace SPK
 		ZonedModifier(destroyer)
 	{}
 
-	inline void Destroyer::init(Particle& particle,DataSet* dataSet) const
+	inline void Destroyer::initBatch(Group& group,DataSet* dataSet,size_t start,size_t end) const
 	{
-		if (checkZone(particle))
-			particle.kill();
+		destroyRange(group,start,end);
 	}
 
 	inline void Destroyer::modify(Group& group,DataSet* dataSet,float deltaTime) const
 	{
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-			if (checkZone(*particleIt))
-				particleIt->kill();
+		destroyRange(group,0,group.getNbParticles());
+	}
+
+	inline void Destroyer::destroyRange(Group& group,size_t start,size_t end) const
+	{
+		uint8 mask[Zone::BATCH_SIZE];
+		for (size_t blockStart = start; blockStart < end; blockStart += Zone::BATCH_SIZE)
+		{
+			const size_t blockEnd = end - blockStart < Zone::BATCH_SIZE ? end : blockStart + Zone::BATCH_SIZE;
+			checkZoneBatch(group,blockStart,blockEnd - blockStart,mask);
+			const uint8* particleMask = mask;
+
+			for (GroupIterator particleIt(group,blockStart,blockEnd); !particleIt.end(); ++particleIt, ++particleMask)
+				if (*particleMask != 0)
+					particleIt->kill();
+		}
 	}
 }
 
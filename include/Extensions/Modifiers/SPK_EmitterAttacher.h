@@ -49,6 +49,8 @@ namespace SPK
 		bool isEmitterOrientationEnabled() const;
 		bool isEmitterRotationEnabled() const;
 
+		virtual void getTargetGroups(std::vector<const Group*>& targets) const;
+
 	public :
 		spark_description(EmitterAttacher, Modifier)
 		(
@@ -144,6 +146,12 @@ namespace SPK
 		return targetGroup;
 	}
 
+	inline void EmitterAttacher::getTargetGroups(std::vector<const Group*>& targets) const
+	{
+		if (targetGroup)
+			targets.push_back(targetGroup.get());
+	}
+
 	inline void EmitterAttacher::enableEmitterRotation(bool rotate)
 	{
 		rotationEnabled = rotate;
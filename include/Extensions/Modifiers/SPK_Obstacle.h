@@ -92,7 +92,7 @@ namespace SPK
 
 		Obstacle(const Obstacle& obstacle);
 
-		virtual void init(Particle& particle,DataSet* dataSet) const;
+		virtual void initBatch(Group& group,DataSet* dataSet,size_t start,size_t end) const;
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
 	};
 
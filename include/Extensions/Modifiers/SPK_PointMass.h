@@ -132,7 +132,8 @@ namespace SPK
 		PointMass(const Vector3D& pos = Vector3D(),float mass = 1.0f,float offset = 0.01f);
 		PointMass(const PointMass& pointMass);
 
-		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+		virtual void modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const;
+		virtual void modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const;
 	};
 
 	inline Ref<PointMass> PointMass::create(const Vector3D& pos,float mass,float offset)
@@ -55,11 +55,12 @@ namespace SPK
 		Rotator();
 		Rotator(const Rotator& rotator);
 
-		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+		virtual void modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const;
+		virtual void modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const;
 	};
 
 	inline Rotator::Rotator() :
-		Modifier(MODIFIER_PRIORITY_POSITION,false,false,false)
+		Modifier(MODIFIER_PRIORITY_POSITION,false,false,false,true,true)
 	{}
 
 	inline Rotator::Rotator(const Rotator& rotator) :
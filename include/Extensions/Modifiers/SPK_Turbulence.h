@@ -0,0 +1,295 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_TURBULENCE
+#define H_SPK_TURBULENCE
+
+namespace SPK
+{
+	/**
+	* @brief A Modifier applying a turbulent field computed from curl noise
+	*
+	* The field is the curl of a vector potential made of 3D simplex noise.
+	* It is therefore free of divergence : particles swirl around without gathering or spreading, like in an incompressible fluid.<br>
+	* <br>
+	* The noise is made of several octaves.
+	* The first one has the base frequency of the turbulence (about the inverse of the size of the swirls).
+	* The frequency of each next octave is multiplied by the lacunarity and its amplitude by the persistence.
+	* The field is normalized so that its average magnitude is about 1 whatever the octaves.<br>
+	* <br>
+	* The noise scrolls over time at the scroll speed. The time is kept per group and advanced by its updates.<br>
+	* <br>
+	* Like the VectorFieldForce, the field is either an acceleration (VECTOR_FIELD_FORCE) or a target velocity (VECTOR_FIELD_VELOCITY).<br>
+	* <br>
+	* Unlike the RandomForce, the turbulence does not store anything per particle : the field is evaluated at the positions of the particles
+	* by a vectorized noise kernel (see Kernels::computeCurlNoise(const float*,const float*,const float*,float*,float*,float*,size_t)).<br>
+	* The field is defined in world space and does not follow the transform of the modifier.
+	*/
+	class SPK_PREFIX Turbulence : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates a new turbulence
+		* @param strength : the strength of the turbulence
+		* @param frequency : the base frequency of the noise
+		* @param nbOctaves : the number of octaves of the noise
+		* @param mode : the way the field acts on particles
+		* @return a new turbulence
+		*/
+		static Ref<Turbulence> create(
+			float strength = 1.0f,
+			float frequency = 1.0f,
+			unsigned int nbOctaves = 1,
+			VectorFieldMode mode = VECTOR_FIELD_FORCE);
+
+		///////////
+		// Noise //
+		///////////
+
+		/**
+		* @brief Sets the base frequency of the noise
+		* @param frequency : the frequency of the first octave (strictly positive)
+		*/
+		void setFrequency(float frequency);
+
+		/**
+		* @brief Gets the base frequency of the noise
+		* @return the frequency of the first octave
+		*/
+		float getFrequency() const;
+
+		/**
+		* @brief Sets the number of octaves of the noise
+		* Each octave adds a level of detail but costs as much as the first one.
+		* @param nbOctaves : the number of octaves (at least 1)
+		*/
+		void setNbOctaves(unsigned int nbOctaves);
+
+		/**
+		* @brief Gets the number of octaves of the noise
+		* @return the number of octaves
+		*/
+		unsigned int getNbOctaves() const;
+
+		/**
+		* @brief Sets the persistence of the noise
+		* The amplitude of an octave is the one of the previous octave multiplied by the persistence.
+		* @param persistence : the persistence (positive)
+		*/
+		void setPersistence(float persistence);
+
+		/**
+		* @brief Gets the persistence of the noise
+		* @return the persistence
+		*/
+		float getPersistence() const;
+
+		/**
+		* @brief Sets the lacunarity of the noise
+		* The frequency of an octave is the one of the previous octave multiplied by the lacunarity.
+		* @param lacunarity : the lacunarity (strictly positive)
+		*/
+		void setLacunarity(float lacunarity);
+
+		/**
+		* @brief Gets the lacunarity of the noise
+		* @return the lacunarity
+		*/
+		float getLacunarity() const;
+
+		/**
+		* @brief Sets the scroll speed of the noise
+		* The field moves along this velocity over time.
+		* @param scrollSpeed : the scroll speed in units per second
+		*/
+		void setScrollSpeed(const Vector3D& scrollSpeed);
+
+		/**
+		* @brief Gets the scroll speed of the noise
+		* @return the scroll speed
+		*/
+		const Vector3D& getScrollSpeed() const;
+
+		/**
+		* @brief Samples the field at a position and a time
+		* The strength is not applied.
+		* @param position : the position
+		* @param time : the time since the start of the scrolling
+		* @return the vector of the field
+		*/
+		Vector3D sample(const Vector3D& position,float time = 0.0f) const;
+
+		///////////////
+		// Behaviour //
+		///////////////
+
+		/**
+		* @brief Sets the way the field acts on particles
+		* @param mode : the mode of the field
+		*/
+		void setMode(VectorFieldMode mode);
+
+		/**
+		* @brief Gets the way the field acts on particles
+		* @return the mode of the field
+		*/
+		VectorFieldMode getMode() const;
+
+		/**
+		* @brief Sets the strength of the turbulence
+		*
+		* In VECTOR_FIELD_FORCE mode, the field is scaled by the strength.<br>
+		* In VECTOR_FIELD_VELOCITY mode, the strength is the rate per second at which the velocity of particles reaches the velocity of the field.
+		*
+		* @param strength : the strength of the turbulence
+		*/
+		void setStrength(float strength);
+
+		/**
+		* @brief Gets the strength of the turbulence
+		* @return the strength of the turbulence
+		*/
+		float getStrength() const;
+
+	public :
+		spark_description(Turbulence, Modifier)
+		(
+			spk_attribute(float, frequency, setFrequency, getFrequency);
+			spk_attribute(unsigned int, nbOctaves, setNbOctaves, getNbOctaves);
+			spk_attribute(float, persistence, setPersistence, getPersistence);
+			spk_attribute(float, lacunarity, setLacunarity, getLacunarity);
+			spk_attribute(Vector3D, scrollSpeed, setScrollSpeed, getScrollSpeed);
+			spk_attribute(VectorFieldMode, mode, setMode, getMode);
+			spk_attribute(float, strength, setStrength, getStrength);
+		);
+
+	private :
+
+		// The number of particles sampled at once
+		static const size_t BATCH_SIZE = 64;
+
+		// Data indices
+		static const size_t NB_DATA = 1;
+		static const size_t TIME_INDEX = 0;
+
+		// The time of the scrolling of a group
+		// It does not depend on the particles which are therefore swapped at no cost
+		class TimeData : public Data
+		{
+		public :
+
+			float time;
+
+			TimeData();
+
+		private :
+
+			virtual void swap(size_t index0,size_t index1) {}
+			virtual void compact(const size_t* moves,size_t nbMoves) {}
+			virtual void reorder(const size_t* order,size_t nb) {}
+		};
+
+		float frequency;
+		unsigned int nbOctaves;
+		float persistence;
+		float lacunarity;
+		Vector3D scrollSpeed;
+
+		// The factor normalizing the field function of the octaves
+		float normalization;
+
+		VectorFieldMode mode;
+		float strength;
+
+		Turbulence(
+			float strength = 1.0f,
+			float frequency = 1.0f,
+			unsigned int nbOctaves = 1,
+			VectorFieldMode mode = VECTOR_FIELD_FORCE);
+
+		void computeNormalization();
+		void sampleBatch(const float* x,const float* y,const float* z,float* vx,float* vy,float* vz,float time,size_t nb) const;
+
+		virtual void createData(DataSet& dataSet,const Group& group) const;
+
+		virtual void prepareModify(Group& group,DataSet* dataSet,float deltaTime) const;
+		virtual void modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const;
+		virtual void modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const;
+	};
+
+	inline Ref<Turbulence> Turbulence::create(float strength,float frequency,unsigned int nbOctaves,VectorFieldMode mode)
+	{
+		return SPK_NEW(Turbulence,strength,frequency,nbOctaves,mode);
+	}
+
+	inline float Turbulence::getFrequency() const
+	{
+		return frequency;
+	}
+
+	inline unsigned int Turbulence::getNbOctaves() const
+	{
+		return nbOctaves;
+	}
+
+	inline float Turbulence::getPersistence() const
+	{
+		return persistence;
+	}
+
+	inline float Turbulence::getLacunarity() const
+	{
+		return lacunarity;
+	}
+
+	inline void Turbulence::setScrollSpeed(const Vector3D& scrollSpeed)
+	{
+		this->scrollSpeed = scrollSpeed;
+	}
+
+	inline const Vector3D& Turbulence::getScrollSpeed() const
+	{
+		return scrollSpeed;
+	}
+
+	inline void Turbulence::setMode(VectorFieldMode mode)
+	{
+		this->mode = mode;
+	}
+
+	inline VectorFieldMode Turbulence::getMode() const
+	{
+		return mode;
+	}
+
+	inline void Turbulence::setStrength(float strength)
+	{
+		this->strength = strength;
+	}
+
+	inline float Turbulence::getStrength() const
+	{
+		return strength;
+	}
+}
+
+#endif
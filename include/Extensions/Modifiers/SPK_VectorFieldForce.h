@@ -0,0 +1,452 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_VECTORFIELDFORCE
+#define H_SPK_VECTORFIELDFORCE
+
+namespace SPK
+{
+	/** @brief Constants defining how the vectors of a VectorFieldForce act on particles */
+	enum VectorFieldMode
+	{
+		VECTOR_FIELD_FORCE,		/**< The vectors are accelerations added to the velocity of particles */
+		VECTOR_FIELD_VELOCITY,	/**< The vectors are velocities towards which the velocity of particles is pulled */
+	};
+
+	/**
+	* @brief A Modifier applying a field of vectors sampled in a regular 3D grid
+	*
+	* The grid is a box defined by its position (its minimum corner) and its dimension, divided in nodes along each axis.<br>
+	* A vector is stored at each node and the field is trilinearly interpolated between the nodes.<br>
+	* A single vector field can therefore replace a whole set of modifiers (point masses, linear forces...)
+	* by a single pass over the particles whose cost does not depend on the complexity of the field.<br>
+	* <br>
+	* The vectors are either accelerations (VECTOR_FIELD_FORCE) or target velocities (VECTOR_FIELD_VELOCITY).
+	* In the second mode, the strength defines how fast the velocity of particles reaches the velocity of the field.<br>
+	* <br>
+	* The position and orientation of the grid follow the transform of the modifier, its dimension does not.
+	* The vectors are defined in the space of the grid and are rotated along with it.<br>
+	* Particles outside the grid are not affected unless the border is clamped, in which case they get the vectors of the nearest border.<br>
+	* <br>
+	* The vectors can be saved to and loaded from a binary file (see saveField(const std::string&) and loadField(const std::string&)).
+	* They can also be baked from other modifiers (see bake(const std::vector<Ref<Modifier> >&,float)).
+	*/
+	class SPK_PREFIX VectorFieldForce : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates a new vector field force
+		* The vectors of the field are set to zero.
+		* @param nbX : the number of nodes along the x axis
+		* @param nbY : the number of nodes along the y axis
+		* @param nbZ : the number of nodes along the z axis
+		* @param position : the minimum corner of the grid
+		* @param dimension : the dimension of the grid
+		* @param mode : the way the vectors act on particles
+		* @param strength : the strength of the field
+		* @return a new vector field force
+		*/
+		static Ref<VectorFieldForce> create(
+			unsigned int nbX = 2,
+			unsigned int nbY = 2,
+			unsigned int nbZ = 2,
+			const Vector3D& position = Vector3D(),
+			const Vector3D& dimension = Vector3D(1.0f,1.0f,1.0f),
+			VectorFieldMode mode = VECTOR_FIELD_FORCE,
+			float strength = 1.0f);
+
+		//////////
+		// Grid //
+		//////////
+
+		/**
+		* @brief Sets the number of nodes of the grid along each axis
+		*
+		* There must be at least 2 nodes along each axis.<br>
+		* Note that the vectors of the field are reset to zero.
+		*
+		* @param nbX : the number of nodes along the x axis
+		* @param nbY : the number of nodes along the y axis
+		* @param nbZ : the number of nodes along the z axis
+		*/
+		void setResolution(unsigned int nbX,unsigned int nbY,unsigned int nbZ);
+
+		/**
+		* @brief Gets the number of nodes of the grid along the x axis
+		* @return the number of nodes along the x axis
+		*/
+		unsigned int getResolutionX() const;
+
+		/**
+		* @brief Gets the number of nodes of the grid along the y axis
+		* @return the number of nodes along the y axis
+		*/
+		unsigned int getResolutionY() const;
+
+		/**
+		* @brief Gets the number of nodes of the grid along the z axis
+		* @return the number of nodes along the z axis
+		*/
+		unsigned int getResolutionZ() const;
+
+		/**
+		* @brief Gets the number of vectors of the field
+		* @return the number of nodes of the grid
+		*/
+		size_t getNbVectors() const;
+
+		/**
+		* @brief Sets the box covered by the grid
+		* @param position : the minimum corner of the grid
+		* @param dimension : the dimension of the grid (strictly positive along each axis)
+		*/
+		void setBounds(const Vector3D& position,const Vector3D& dimension);
+
+		/**
+		* @brief Gets the minimum corner of the grid
+		* @return the minimum corner of the grid
+		*/
+		const Vector3D& getPosition() const;
+
+		/**
+		* @brief Gets the transformed minimum corner of the grid
+		* @return the transformed minimum corner of the grid
+		*/
+		const Vector3D& getTransformedPosition() const;
+
+		/**
+		* @brief Gets the dimension of the grid
+		* @return the dimension of the grid
+		*/
+		const Vector3D& getDimension() const;
+
+		/**
+		* @brief Gets the position of a node of the grid
+		* The position is in the space of the modifier (not transformed).
+		* @param x : the index of the node along the x axis
+		* @param y : the index of the node along the y axis
+		* @param z : the index of the node along the z axis
+		* @return the position of the node
+		*/
+		Vector3D getNodePosition(unsigned int x,unsigned int y,unsigned int z) const;
+
+		/////////////
+		// Vectors //
+		/////////////
+
+		/**
+		* @brief Sets the vector at a node of the grid
+		* @param x : the index of the node along the x axis
+		* @param y : the index of the node along the y axis
+		* @param z : the index of the node along the z axis
+		* @param v : the vector
+		*/
+		void setVector(unsigned int x,unsigned int y,unsigned int z,const Vector3D& v);
+
+		/**
+		* @brief Gets the vector at a node of the grid
+		* @param x : the index of the node along the x axis
+		* @param y : the index of the node along the y axis
+		* @param z : the index of the node along the z axis
+		* @return the vector
+		*/
+		const Vector3D& getVector(unsigned int x,unsigned int y,unsigned int z) const;
+
+		/**
+		* @brief Sets all the vectors of the field
+		*
+		* The vectors are ordered by x first, then y and then z (the index of the node (x,y,z) is x + nbX * (y + nbY * z)).<br>
+		* The number of vectors must be the number of nodes of the grid.
+		*
+		* @param vectors : the vectors
+		*/
+		void setVectors(const std::vector<Vector3D>& vectors);
+
+		/**
+		* @brief Gets all the vectors of the field
+		* See setVectors(const std::vector<Vector3D>&) for the order of the vectors.
+		* @return the vectors
+		*/
+		const std::vector<Vector3D>& getVectors() const;
+
+		/**
+		* @brief Samples the field at a position
+		* The position and the returned vector are in world space. The strength is not applied.
+		* @param position : the position
+		* @return the trilinearly interpolated vector of the field at the position
+		*/
+		Vector3D sample(const Vector3D& position) const;
+
+		///////////////
+		// Behaviour //
+		///////////////
+
+		/**
+		* @brief Sets the way the vectors act on particles
+		* @param mode : the mode of the field
+		*/
+		void setMode(VectorFieldMode mode);
+
+		/**
+		* @brief Gets the way the vectors act on particles
+		* @return the mode of the field
+		*/
+		VectorFieldMode getMode() const;
+
+		/**
+		* @brief Sets the strength of the field
+		*
+		* In VECTOR_FIELD_FORCE mode, the vectors are scaled by the strength.<br>
+		* In VECTOR_FIELD_VELOCITY mode, the strength is the rate per second at which the velocity of particles reaches the velocity of the field.
+		*
+		* @param strength : the strength of the field
+		*/
+		void setStrength(float strength);
+
+		/**
+		* @brief Gets the strength of the field
+		* @return the strength of the field
+		*/
+		float getStrength() const;
+
+		/**
+		* @brief Sets whether the border of the grid is clamped
+		* If the border is clamped, particles outside the grid get the vectors of the nearest border, otherwise they are not affected.
+		* @param clamped : true to clamp the border, false not to
+		*/
+		void setBorderClamped(bool clamped);
+
+		/**
+		* @brief Tells whether the border of the grid is clamped
+		* @return true if the border is clamped, false if not
+		*/
+		bool isBorderClamped() const;
+
+		////////
+		// IO //
+		////////
+
+		/**
+		* @brief Loads the grid and the vectors of the field from a stream
+		* The stream must be opened in binary mode and contain a field saved with saveField(std::ostream&).
+		* @param is : the input stream
+		* @return true if the field was loaded, false if not
+		*/
+		bool loadField(std::istream& is);
+
+		/**
+		* @brief Loads the grid and the vectors of the field from a binary file
+		* @param path : the path of the file
+		* @return true if the field was loaded, false if not
+		*/
+		bool loadField(const std::string& path);
+
+		/**
+		* @brief Saves the grid and the vectors of the field to a stream
+		* The stream must be opened in binary mode.
+		* @param os : the output stream
+		* @return true if the field was saved, false if not
+		*/
+		bool saveField(std::ostream& os) const;
+
+		/**
+		* @brief Saves the grid and the vectors of the field to a binary file
+		* @param path : the path of the file
+		* @return true if the field was saved, false if not
+		*/
+		bool saveField(const std::string& path) const;
+
+		//////////
+		// Bake //
+		//////////
+
+		/**
+		* @brief Rasterizes the effect of a set of modifiers in the vectors of the field
+		*
+		* A particle is placed at each node of the grid with no velocity and the modifiers are applied once on them with the given time step.<br>
+		* The vector of a node is the velocity acquired by its particle divided by the time step.
+		* The baked field is therefore meant to be used in VECTOR_FIELD_FORCE mode with a strength of 1.<br>
+		* <br>
+		* Only the modifiers changing the velocity of particles function of their position are meaningfully baked
+		* (point masses, linear forces, random forces...). Modifiers moving particles directly, like vortices, are not.<br>
+		* The particles have the default parameters of a group. If a modifier kills some of them, the field is left unchanged.<br>
+		* The current transform of the field is used to place the nodes.<br>
+		* <br>
+		* The modifiers are baked through copies and are left untouched.
+		* The copies are placed in a system with an identity transform, so local modifiers are baked with their local transform.
+		* Their shared children (a shared zone for instance) are not copied and get their transform updated by the copies.
+		*
+		* @param modifiers : the modifiers to bake
+		* @param timeStep : the time step used to apply the modifiers
+		*/
+		void bake(const std::vector<Ref<Modifier> >& modifiers,float timeStep = 0.01f);
+
+	public :
+		spark_description(VectorFieldForce, Modifier)
+		(
+			spk_attribute(Triplet<unsigned int>, resolution, setResolution, getResolutionX, getResolutionY, getResolutionZ);
+			spk_attribute(Pair<Vector3D>, bounds, setBounds, getPosition, getDimension);
+			spk_attribute(std::vector<Vector3D>, vectors, setVectors, getVectors);
+			spk_attribute(VectorFieldMode, mode, setMode, getMode);
+			spk_attribute(float, strength, setStrength, getStrength);
+			spk_attribute(bool, borderClamped, setBorderClamped, isBorderClamped);
+		);
+
+	protected :
+
+		virtual void innerUpdateTransform();
+
+	private :
+
+		// The number of particles sampled at once
+		static const size_t BATCH_SIZE = 64;
+
+		unsigned int nbX;
+		unsigned int nbY;
+		unsigned int nbZ;
+
+		Vector3D position;
+		Vector3D tPosition;
+		Vector3D dimension;
+		Vector3D tAxis[3];
+
+		// The vectors as set by the user and the same vectors padded to 4 floats (see Kernels::sampleGrid(...))
+		std::vector<Vector3D> vectors;
+		std::vector<float> nodes;
+
+		VectorFieldMode mode;
+		float strength;
+		bool borderClamped;
+
+		VectorFieldForce(
+			unsigned int nbX = 2,
+			unsigned int nbY = 2,
+			unsigned int nbZ = 2,
+			const Vector3D& position = Vector3D(),
+			const Vector3D& dimension = Vector3D(1.0f,1.0f,1.0f),
+			VectorFieldMode mode = VECTOR_FIELD_FORCE,
+			float strength = 1.0f);
+
+		VectorFieldForce(const VectorFieldForce& vectorField);
+
+		size_t getIndex(unsigned int x,unsigned int y,unsigned int z) const;
+		void sampleBatch(const float* x,const float* y,const float* z,float* vx,float* vy,float* vz,float* weights,size_t nb) const;
+
+		virtual void modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const;
+		virtual void modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const;
+	};
+
+	inline Ref<VectorFieldForce> VectorFieldForce::create(
+		unsigned int nbX,
+		unsigned int nbY,
+		unsigned int nbZ,
+		const Vector3D& position,
+		const Vector3D& dimension,
+		VectorFieldMode mode,
+		float strength)
+	{
+		return SPK_NEW(VectorFieldForce,nbX,nbY,nbZ,position,dimension,mode,strength);
+	}
+
+	inline unsigned int VectorFieldForce::getResolutionX() const
+	{
+		return nbX;
+	}
+
+	inline unsigned int VectorFieldForce::getResolutionY() const
+	{
+		return nbY;
+	}
+
+	inline unsigned int VectorFieldForce::getResolutionZ() const
+	{
+		return nbZ;
+	}
+
+	inline size_t VectorFieldForce::getNbVectors() const
+	{
+		return vectors.size();
+	}
+
+	inline const Vector3D& VectorFieldForce::getPosition() const
+	{
+		return position;
+	}
+
+	inline const Vector3D& VectorFieldForce::getTransformedPosition() const
+	{
+		return tPosition;
+	}
+
+	inline const Vector3D& VectorFieldForce::getDimension() const
+	{
+		return dimension;
+	}
+
+	inline const Vector3D& VectorFieldForce::getVector(unsigned int x,unsigned int y,unsigned int z) const
+	{
+		return vectors[getIndex(x,y,z)];
+	}
+
+	inline const std::vector<Vector3D>& VectorFieldForce::getVectors() const
+	{
+		return vectors;
+	}
+
+	inline void VectorFieldForce::setMode(VectorFieldMode mode)
+	{
+		this->mode = mode;
+	}
+
+	inline VectorFieldMode VectorFieldForce::getMode() const
+	{
+		return mode;
+	}
+
+	inline void VectorFieldForce::setStrength(float strength)
+	{
+		this->strength = strength;
+	}
+
+	inline float VectorFieldForce::getStrength() const
+	{
+		return strength;
+	}
+
+	inline void VectorFieldForce::setBorderClamped(bool clamped)
+	{
+		borderClamped = clamped;
+	}
+
+	inline bool VectorFieldForce::isBorderClamped() const
+	{
+		return borderClamped;
+	}
+
+	inline size_t VectorFieldForce::getIndex(unsigned int x,unsigned int y,unsigned int z) const
+	{
+		SPK_ASSERT(x < nbX && y < nbY && z < nbZ,"VectorFieldForce::getIndex(unsigned int,unsigned int,unsigned int) - The node is out of the grid");
+		return x + nbX * (y + static_cast<size_t>(nbY) * z);
+	}
+}
+
+#endif
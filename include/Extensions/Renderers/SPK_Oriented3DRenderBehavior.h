@@ -189,6 +189,10 @@ namespace SPK
 		const Vector3D& quadUp() const;
 		const Vector3D& quadSide() const;
 
+		// Orientation of the quads before scaling and rotation (scaled by the graphical radius of the group)
+		const Vector3D& orientationUp() const;
+		const Vector3D& orientationSide() const;
+
 		//////////////////
 		// Constructors //
 		//////////////////
@@ -246,6 +250,16 @@ namespace SPK
 		return sideQuad;
 	}
 
+	inline const Vector3D& Oriented3DRenderBehavior::orientationUp() const
+	{
+		return up;
+	}
+
+	inline const Vector3D& Oriented3DRenderBehavior::orientationSide() const
+	{
+		return side;
+	}
+
 	inline bool Oriented3DRenderBehavior::precomputeOrientation3D(const Group& group,const Vector3D& modelViewLook,const Vector3D& modelViewUp,const Vector3D& modelViewPos) const
 	{
 		mVLook = modelViewLook;
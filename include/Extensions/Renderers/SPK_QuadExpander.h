@@ -0,0 +1,193 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_QUADEXPANDER
+#define H_SPK_QUADEXPANDER
+
+#include "Extensions/Renderers/SPK_QuadRenderBehavior.h"
+
+namespace SPK
+{
+	/**
+	* @brief The destination of the vertices of the quads expanded by a QuadExpander
+	*
+	* Each attribute is given by the address of its first element and the number of bytes between two consecutive elements.
+	* This allows to write either in separate arrays or in an interleaved vertex format.<br>
+	* An attribute whose address is NULL is not written.
+	*/
+	struct QuadVertexArrays
+	{
+		void* positions;		/**< @brief The positions of the vertices (3 floats) */
+		size_t positionStride;	/**< @brief The number of bytes between two positions */
+		void* colors;			/**< @brief The colors of the vertices (a Color) */
+		size_t colorStride;		/**< @brief The number of bytes between two colors */
+		void* texCoords;		/**< @brief The texture coordinates of the vertices (2 floats in 2D, 3 floats in 3D) */
+		size_t texCoordStride;	/**< @brief The number of bytes between two texture coordinates */
+	};
+
+	/**
+	* @brief Expands the particles of a group into quads
+	*
+	* The expander computes the 4 vertices of the quad of each particle from the arrays of the group.
+	* It does not depend on any rendering API and writes in arrays given by the caller (see QuadVertexArrays),
+	* so that renderers can expand their quads directly into their vertex buffers.<br>
+	* <br>
+	* All the quads share the same orientation, given by the side and up vectors already scaled by the graphical radius of the group
+	* (see Oriented3DRenderBehavior). Particles whose orientation is computed one by one cannot be expanded by this class.<br>
+	* Below are the parameters of Particle that are used (others have no effects) :
+	* <ul>
+	* <li>SPK::PARAM_SCALE</li>
+	* <li>SPK::PARAM_ANGLE</li>
+	* <li>SPK::PARAM_TEXTURE_INDEX (only if not in TEXTURE_NONE mode)</li>
+	* </ul>
+	* <br>
+	* The vertices of the particle at index i are written at indices 4 * i to 4 * i + 3, in the order top right, top left, bottom left and bottom right.<br>
+	* The positions and colors are computed with the instruction set selected in Kernels.
+	* The expansion is split in chunks run in parallel if the group has a thread pool.
+	*/
+	class SPK_PREFIX QuadExpander
+	{
+	public :
+
+		/** @brief The number of particles expanded at once by a thread */
+		static const size_t CHUNK_SIZE = 4096;
+
+		/////////////////
+		// Constructor //
+		/////////////////
+
+		/** @brief Constructor of QuadExpander */
+		QuadExpander();
+
+		/////////////
+		// Setters //
+		/////////////
+
+		/**
+		* @brief Sets the orientation of the quads
+		* @param side : the side vector of the quads, scaled by the graphical radius
+		* @param up : the up vector of the quads, scaled by the graphical radius
+		*/
+		void setOrientation(const Vector3D& side,const Vector3D& up);
+
+		/**
+		* @brief Sets the scale of the quads
+		* See QuadRenderBehavior::setScale(float,float)
+		* @param scaleX : the scale of the width of the quads
+		* @param scaleY : the scale of the height of the quads
+		*/
+		void setScale(float scaleX,float scaleY);
+
+		/**
+		* @brief Sets the way texture coordinates are computed
+		*
+		* In TEXTURE_MODE_2D, the coordinates of the atlas cell of the particle are computed if the texture index is enabled in the group.
+		* Otherwise the coordinates of the corners are written.<br>
+		* In TEXTURE_MODE_3D, the third coordinate is the texture index of the particle.<br>
+		* In TEXTURE_MODE_NONE, no texture coordinates are written.
+		*
+		* @param mode : the texturing mode
+		* @param atlasNbX : the number of cuts of the atlas in the X axis
+		* @param atlasNbY : the number of cuts of the atlas in the Y axis
+		*/
+		void setTexturing(TextureMode mode,size_t atlasNbX = 1,size_t atlasNbY = 1);
+
+		/**
+		* @brief Sets the texture coordinates of the 4 corners of a quad
+		*
+		* The coordinates are given as 4 pairs (u,v) in the order of the vertices and are expressed within the atlas cell of the particle.<br>
+		* By default, they are set to (1,0), (0,0), (0,1), (1,1) which is the convention of OpenGL.
+		*
+		* @param texCoords : an array of 8 floats
+		*/
+		void setCornerTexCoords(const float* texCoords);
+
+		///////////////
+		// Expansion //
+		///////////////
+
+		/**
+		* @brief Expands all the particles of a group
+		*
+		* The arrays must be able to hold 4 vertices per particle of the group.
+		*
+		* @param group : the group whose particles are expanded
+		* @param arrays : the arrays in which vertices are written
+		*/
+		void expand(const Group& group,const QuadVertexArrays& arrays) const;
+
+		/**
+		* @brief Expands a range of particles of a group
+		*
+		* This method is called by expand(const Group&,const QuadVertexArrays&) for each chunk.
+		* It can be called concurrently on distinct ranges.
+		*
+		* @param group : the group whose particles are expanded
+		* @param arrays : the arrays in which vertices are written
+		* @param start : the index of the first particle
+		* @param end : the index after the last particle
+		*/
+		void expand(const Group& group,const QuadVertexArrays& arrays,size_t start,size_t end) const;
+
+	private :
+
+		class Job;
+
+		Vector3D side;
+		Vector3D up;
+
+		float scaleX;
+		float scaleY;
+
+		TextureMode texturingMode;
+		size_t atlasNbX;
+		size_t atlasNbY;
+
+		float cornerTexCoords[8];
+	};
+
+	inline void QuadExpander::setOrientation(const Vector3D& side,const Vector3D& up)
+	{
+		this->side = side;
+		this->up = up;
+	}
+
+	inline void QuadExpander::setScale(float scaleX,float scaleY)
+	{
+		this->scaleX = scaleX;
+		this->scaleY = scaleY;
+	}
+
+	inline void QuadExpander::setTexturing(TextureMode mode,size_t atlasNbX,size_t atlasNbY)
+	{
+		texturingMode = mode;
+		this->atlasNbX = atlasNbX;
+		this->atlasNbY = atlasNbY;
+	}
+
+	inline void QuadExpander::setCornerTexCoords(const float* texCoords)
+	{
+		for (size_t i = 0; i < 8; ++i)
+			cornerTexCoords[i] = texCoords[i];
+	}
+}
+
+#endif
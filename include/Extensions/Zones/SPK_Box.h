@@ -52,6 +52,7 @@ namespace SPK
 		///////////////
 
 		virtual void generatePosition(Vector3D& v,bool full,float radius = 0.0f) const;
+		virtual void generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii = NULL) const;
 		virtual bool contains(const Vector3D& v,float radius = 0.0f) const;
 		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const;
 		virtual Vector3D computeNormal(const Vector3D& v) const;
@@ -67,6 +68,9 @@ namespace SPK
 
 		virtual void innerUpdateTransform();
 
+		virtual void containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const;
+
 	private :
 
 		Vector3D dimensions;
@@ -82,6 +86,7 @@ namespace SPK
 		Box(const Box& box);
 
 		bool intersectSlab(float dist0,float dist1,float slab,const Vector3D& axis,float& minRatio,Vector3D* normal) const;
+		bool intersectsFromDists(const float* dists0,const float* dists1,float radius,Vector3D* normal) const;
 		Vector3D generateRandomDim(bool full,float radius) const; 
 	};
 
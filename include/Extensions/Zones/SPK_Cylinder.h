@@ -44,6 +44,7 @@ namespace SPK
 		const Vector3D& getTransformedAxis() const	{ return tAxis; }
 
 		virtual void generatePosition(Vector3D& v,bool full,float radius = 0.0f) const;
+		virtual void generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii = NULL) const;
 		virtual bool contains(const Vector3D& v,float radius = 0.0f) const;
 		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const;
 		virtual Vector3D computeNormal(const Vector3D& v) const;
@@ -60,6 +61,9 @@ namespace SPK
 
 		virtual void innerUpdateTransform();
 
+		virtual void containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const;
+
 	private :
 
 		float height;
@@ -114,6 +114,7 @@ namespace SPK
 		void pushBound(const Vector3D& bound);
 
 		virtual void generatePosition(Vector3D& v, bool full, float radius = 0.0f) const;
+		virtual void generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii = NULL) const;
 		virtual bool contains(const Vector3D& v, float radius = 0.0f) const;
 		virtual bool intersects(const Vector3D& v0, const Vector3D& v1, float radius = 0.0f, Vector3D* normal = NULL) const;
 		virtual void moveAtBorder(Vector3D& v,bool inside) const;
@@ -129,6 +130,9 @@ namespace SPK
 
 		virtual void innerUpdateTransform();
 
+		virtual void containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const;
+
 	private :
 
 		Vector3D bounds[2];
@@ -172,6 +176,18 @@ namespace SPK
 
 	inline void Line::moveAtBorder(Vector3D& v,bool inside) const {}
 
+	inline void Line::containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = 0;
+	}
+
+	inline void Line::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = 0;
+	}
+
 	inline void Line::computeDist()
 	{
 		tDist = tBounds[1] - tBounds[0];		
@@ -98,6 +98,9 @@ namespace SPK
 
 		virtual void innerUpdateTransform();
 
+		virtual void containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const;
+
 	private :
 
 		Vector3D normal;	// normal
@@ -105,6 +108,8 @@ namespace SPK
 
 		Plane(const Vector3D& position = Vector3D(0.0f,0.0f,0.0f),const Vector3D& normal = Vector3D(0.0f,1.0f,0.0f));
 		Plane(const Plane& plane);
+
+		bool intersectsFromDists(float dist0,float dist1,float radius,Vector3D* normal) const;
 	};
 
 	inline Plane::Plane(const Vector3D& position,const Vector3D& normal) :
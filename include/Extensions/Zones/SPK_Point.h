@@ -40,6 +40,11 @@ namespace SPK
 		(
 		);
 
+	protected :
+
+		virtual void containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const;
+
 	private :
 
 		Point(const Vector3D& position = Vector3D());
@@ -74,6 +79,18 @@ namespace SPK
 		return false;
 	}
 
+	inline void Point::containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = 0;
+	}
+
+	inline void Point::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = 0;
+	}
+
 	inline Vector3D Point::computeNormal(const Vector3D& v) const
 	{
 		Vector3D normal(v - getTransformedPosition());
@@ -115,6 +115,7 @@ namespace SPK
 		///////////////
 
 		virtual void generatePosition(Vector3D& v,bool full,float radius = 0.0f) const;
+		virtual void generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii = NULL) const;
 		virtual bool contains(const Vector3D& v,float radius = 0.0f) const;
 		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const;
 		virtual Vector3D computeNormal(const Vector3D& v) const;
@@ -130,14 +131,22 @@ namespace SPK
 
 		virtual void innerUpdateTransform();
 
+		virtual void containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const;
+
 	private :
 
 		Vector3D normal;	// normal
 		Vector3D tNormal;	// transformed normal
+		Vector3D tTangent;	// transformed tangent
+		Vector3D tCoTangent;	// transformed cotangent
 
 		float minRadius;
 		float maxRadius;
 
+		void computeTransformedBase();
+		bool intersectsFromDists(const Vector3D& v0,const Vector3D& v1,float dist0,float dist1,float radius,Vector3D* normal) const;
+
 		Ring(
 			const Vector3D& position = Vector3D(0.0f,0.0f,0.0f),
 			const Vector3D& normal = Vector3D(0.0f,1.0f,0.0f),
@@ -42,6 +42,7 @@ namespace SPK
 		///////////////
 
 		virtual void generatePosition(Vector3D& v,bool full,float radius = 0.0f) const;
+		virtual void generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii = NULL) const;
 		virtual bool contains(const Vector3D& v,float radius = 0.0f) const;
 		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const;
 		virtual Vector3D computeNormal(const Vector3D& v) const;
@@ -52,12 +53,19 @@ namespace SPK
 			spk_attribute(float, radius, setRadius, getRadius);
 		);
 
+	protected :
+
+		virtual void containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const;
+
 	private :
 
 		float radius;
 
 		Sphere(const Vector3D& position = Vector3D(),float radius = 1.0f);
 		Sphere(const Sphere& sphere);
+
+		bool intersectsFromSqrDists(float dist0,float dist1,const Vector3D& v0,float radius,Vector3D* normal) const;
 	};
 
 	inline Sphere::Sphere(const Vector3D& position,float radius) :
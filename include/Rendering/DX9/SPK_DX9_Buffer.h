@@ -71,6 +71,10 @@ namespace DX9
 		void setNbTexCoords(size_t nb);
 		size_t getNbTexCoords();
 
+		// Direct access to the locked buffers, to fill them without going through the setters
+		D3DXVECTOR3* getLockedVertexBuffer();
+		float* getLockedTexCoordBuffer();
+
 		// WARNING : le draw en dx prend en compte le nombre de primitives pas le nombre de sommets !!!
 		// WARNING : draw call takes primitive number not vertex number
 		void render(D3DPRIMITIVETYPE primitive, size_t nbPrimitives);
@@ -209,6 +213,16 @@ namespace DX9
 	{
 		return nbTexCoords;
 	}
+
+	inline D3DXVECTOR3* DX9Buffer::getLockedVertexBuffer()
+	{
+		return ptrVertexBuffer;
+	}
+
+	inline float* DX9Buffer::getLockedTexCoordBuffer()
+	{
+		return ptrTexCoordBuffer;
+	}
 }}
 
 #endif
@@ -97,6 +97,9 @@ namespace DX9
 		virtual void render(const Group& group,const DataSet* dataSet,RenderBuffer* renderBuffer) const;
 		virtual void computeAABB(Vector3D& AABBMin,Vector3D& AABBMax,const Group& group,const DataSet* dataSet) const;
 
+		// Expands all the quads at once when they share the same orientation (see QuadExpander)
+		void expandQuads(const Group& group,DX9Buffer& renderBuffer) const;
+
 		void DX9CallColorAndVertex(const Particle& particle,DX9Buffer& renderBuffer) const;	// DirectX 9.0 calls for color and position
 		void DX9CallTexture2DAtlas(const Particle& particle,DX9Buffer& renderBuffer) const;	// DirectX 9.0 calls for 2D atlastexturing 
 		void DX9CallTexture3D(const Particle& particle,DX9Buffer& renderBuffer) const;		// DirectX 9.0 calls for 3D texturing
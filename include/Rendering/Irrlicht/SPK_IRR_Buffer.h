@@ -55,6 +55,19 @@ namespace IRR
 
 		void setUsed(size_t nb);
 
+		/**
+		* @brief Sets the order in which the particles are drawn
+		*
+		* The indices of each particle are rewritten from the given pattern so that the vertices do not need to be reordered
+		* (see Group::getSortedIndices()).<br>
+		* The natural order is restored when no indices are given. Nothing is done if the order is already the natural one.
+		*
+		* @param indexPattern : the indices of the vertices of a particle relative to its first vertex (one per index of a particle)
+		* @param particleIndices : the indices of the particles in the order they must be drawn or NULL for the natural order
+		* @param nb : the number of particles to order
+		*/
+		void setParticleOrder(const int* indexPattern,const unsigned int* particleIndices,size_t nb);
+
 	private :
 
 		irr::scene::CDynamicMeshBuffer* meshBuffer;
@@ -68,6 +81,8 @@ namespace IRR
 		size_t currentVertexIndex;
 		size_t currentColorIndex;
 		size_t currentTexCoordIndex;
+
+		bool naturalOrder;
 	};
 
 	inline irr::video::E_INDEX_TYPE IRRBuffer::getIndiceType() const
@@ -48,8 +48,60 @@ namespace GL
 		void setNbTexCoords(size_t nb);
 		size_t getNbTexCoords();
 
+		// Direct access to the arrays, to fill them without going through the setters
+		Vector3D* getVertexBuffer();
+		Color* getColorBuffer();
+		float* getTexCoordBuffer();
+
 		void render(GLuint primitive,size_t nbVertices);
 
+		/**
+		* @brief Renders the vertices of particles in a given order
+		*
+		* The vertices of each particle must be consecutive in the buffer.
+		* They are drawn by indices so that the vertices themselves do not need to be reordered (see Group::getSortedIndices()).
+		*
+		* @param primitive : the primitive to draw
+		* @param nbVerticesPerParticle : the number of vertices of each particle
+		* @param particleIndices : the indices of the particles in the order they must be drawn
+		* @param nbParticles : the number of particles to draw
+		*/
+		void render(GLuint primitive,size_t nbVerticesPerParticle,const unsigned int* particleIndices,size_t nbParticles);
+
+		/**
+		* @brief Gets a temporary storage of at least the given size in bytes
+		* The storage is reused from a render to the next one and is only reallocated when it must grow.
+		* @param size : the size of the storage in bytes
+		* @return the storage
+		*/
+		void* getScratchBuffer(size_t size);
+
+		/**
+		* @brief Binds the streamed buffer object of this buffer and reallocates its storage
+		*
+		* The storage is reallocated at each call so that the previous content is orphaned
+		* and the driver does not have to wait for the previous draws to end before the new content is uploaded.<br>
+		* The buffer object is created at the first call.<br>
+		* Note that this method does not exist if the macro SPK_GL_NO_EXT is defined.
+		*
+		* @param size : the size of the storage in bytes
+		*/
+#ifndef SPK_GL_NO_EXT
+		void bindStreamBuffer(size_t size);
+#endif
+
+		/**
+		* @brief Releases the OpenGL objects of this buffer
+		*
+		* The streamed buffer object is created in the OpenGL context current at its first use (see bindStreamBuffer(size_t)).
+		* This method deletes it and must be called while this context is current. The buffer object is created again at the next use.<br>
+		* The buffer of a group is reached with Group::getRenderBuffer().<br>
+		* <br>
+		* No OpenGL call is made when the buffer is destroyed, as the context is often gone by then.
+		* A buffer object not released is freed with its context.
+		*/
+		void releaseGLResources();
+
 	private :
 
 		const size_t nbVertices;
@@ -58,14 +110,28 @@ namespace GL
 		Vector3D* vertexBuffer;
 		Color* colorBuffer;
 		float* texCoordBuffer;
+		GLuint* elementBuffer;
+
+		char* scratchBuffer;
+		size_t scratchSize;
 
 		size_t currentVertexIndex;
 		size_t currentColorIndex;
 		size_t currentTexCoordIndex;
+
+		GLuint streamBufferID;
+
+		void allocateVertices();
+
+		void enableArrays();
+		void disableArrays();
 	};
 
 	inline void GLBuffer::positionAtStart()
 	{
+		if (vertexBuffer == NULL) // The vertices are allocated at first use as renderers streaming instances do not need them
+			allocateVertices();
+
 		currentVertexIndex = 0;
 		currentColorIndex = 0;
 		currentTexCoordIndex = 0;
@@ -100,6 +166,21 @@ namespace GL
 	{
 		return nbTexCoords;
 	}
+
+	inline Vector3D* GLBuffer::getVertexBuffer()
+	{
+		return vertexBuffer;
+	}
+
+	inline Color* GLBuffer::getColorBuffer()
+	{
+		return colorBuffer;
+	}
+
+	inline float* GLBuffer::getTexCoordBuffer()
+	{
+		return texCoordBuffer;
+	}
 }}
 
 #endif
@@ -37,6 +37,7 @@ namespace GL
 	*
 	* the orientation of the quads depends on the orientation parameters set.
 	* This orientation is computed during rendering by the CPU (further improvement of SPARK will allow to make the computation on GPU side).<br>
+	* When the orientation is the same for the whole group, the quads are expanded at once by a QuadExpander.<br>
 	* <br>
 	* Below are the parameters of Particle that are used in this Renderer (others have no effects) :
 	* <ul>
@@ -44,6 +45,13 @@ namespace GL
 	* <li>SPK::PARAM_ANGLE</li>
 	* <li>SPK::PARAM_TEXTURE_INDEX (only if not in TEXTURE_NONE mode)</li>
 	* </ul>
+	* <br>
+	* If a shader hint is set (see Renderer::useShaderHint(ShaderHint)) and the hardware supports shaders and instanced arrays,
+	* the quads are expanded on the GPU by a vertex shader when their orientation is the same for the whole group.
+	* Only the position, color, scale, angle and texture index of each particle are then sent to OpenGL, instead of the 4 vertices of each quad.
+	* The VBO hint (see Renderer::useVBOHint(bool)) tells whether these data are streamed into a buffer object or read from the particles by OpenGL.
+	* The fragments are still processed by the fixed pipeline.<br>
+	* The program expanding the quads belongs to the renderer and to the OpenGL context in which it was built (see releaseGLResources()).
 	*/
 	class SPK_GL_PREFIX GLQuadRenderer :	public GLRenderer,
 											public QuadRenderBehavior,
@@ -99,6 +107,24 @@ namespace GL
 		*/
 		GLuint getTexture() const;
 
+		///////////////
+		// Resources //
+		///////////////
+
+		/**
+		* @brief Releases the OpenGL objects of this renderer
+		*
+		* The program expanding the quads on the GPU is built at the first render needing it, in the current OpenGL context.
+		* This method deletes it and must be called while this context is current, typically before destroying or losing it.
+		* The program is then built again at the next render needing it, in the context current at that time.<br>
+		* <br>
+		* The program is not released when the renderer is destroyed, as no OpenGL call is made at destruction
+		* (the context is often gone by then). A program not released is freed with its context.
+		* A renderer rendering in several contexts requires these contexts to share their objects.<br>
+		* The buffer objects streaming the particles are held by the render buffers of the groups (see GLBuffer::releaseGLResources()).
+		*/
+		void releaseGLResources();
+
 	public :
 		spark_description(GLQuadRenderer, GLRenderer)
 		(
@@ -117,6 +143,34 @@ namespace GL
 
 		static GLboolean* const SPK_GL_TEXTURE_3D_EXT;
 
+#ifndef SPK_GL_NO_EXT
+		static GLboolean* const SPK_GL_SHADERS_EXT;
+		static GLboolean* const SPK_GL_INSTANCED_ARRAYS_EXT;
+		static GLboolean* const SPK_GL_VBO_EXT;
+
+		// The program expanding the quads and the locations of its uniforms
+		struct InstancingProgram
+		{
+			enum ProgramStatus
+			{
+				PROGRAM_UNLOADED,	// Not yet built
+				PROGRAM_LINKED,		// Built correctly
+				PROGRAM_FAILED		// Error during compilation or link
+			};
+
+			ProgramStatus status;
+			GLuint id;
+			GLint sideLocation;
+			GLint upLocation;
+			GLint quadScaleLocation;
+			GLint atlasDimensionsLocation;
+			GLint atlasEnabledLocation;
+			GLint texture3DEnabledLocation;
+		};
+
+		mutable InstancingProgram instancingProgram;
+#endif
+
 		mutable float modelView[16];
 		mutable float invModelView[16];
 
@@ -132,6 +186,15 @@ namespace GL
 
 		void invertModelView() const;
 
+		// Expands all the quads at once when they share the same orientation (see QuadExpander)
+		void expandQuads(const Group& group,GLBuffer& renderBuffer) const;
+
+#ifndef SPK_GL_NO_EXT
+		void initInstancingProgram() const;
+		bool isInstancingUsable() const;
+		void renderInstances(const Group& group,GLBuffer& renderBuffer) const;
+#endif
+
 		void GLCallColorAndVertex(const Particle& particle,GLBuffer& renderBuffer) const;	// OpenGL calls for color and position
 		void GLCallTexture2DAtlas(const Particle& particle,GLBuffer& renderBuffer) const;	// OpenGL calls for 2D atlastexturing 
 		void GLCallTexture3D(const Particle& particle,GLBuffer& renderBuffer) const;		// OpenGL calls for 3D texturing
@@ -197,24 +260,17 @@ namespace GL
 	{
 		float textureIndex = particle.getParam(PARAM_TEXTURE_INDEX);
 
-		//renderBuffer.skipNextTexCoords(2);
-		renderBuffer.setNextTexCoord(textureIndex);
-		renderBuffer.setNextTexCoord(textureIndex);
+		// The 2 first coordinates are the constant ones set at the creation of the buffer
+		renderBuffer.skipNextTexCoords(2);
 		renderBuffer.setNextTexCoord(textureIndex);
 		
-		//renderBuffer.skipNextTexCoords(2);
-		renderBuffer.setNextTexCoord(textureIndex);
-		renderBuffer.setNextTexCoord(textureIndex);
+		renderBuffer.skipNextTexCoords(2);
 		renderBuffer.setNextTexCoord(textureIndex);
 
-		//renderBuffer.skipNextTexCoords(2);
-		renderBuffer.setNextTexCoord(textureIndex);
-		renderBuffer.setNextTexCoord(textureIndex);
+		renderBuffer.skipNextTexCoords(2);
 		renderBuffer.setNextTexCoord(textureIndex);
 
-		//renderBuffer.skipNextTexCoords(2);
-		renderBuffer.setNextTexCoord(textureIndex);
-		renderBuffer.setNextTexCoord(textureIndex);
+		renderBuffer.skipNextTexCoords(2);
 		renderBuffer.setNextTexCoord(textureIndex);
 	}
 
@@ -59,6 +59,8 @@
 #include "Extensions/Modifiers/SPK_PointMass.h"
 #include "Extensions/Modifiers/SPK_RandomForce.h"
 #include "Extensions/Modifiers/SPK_LinearForce.h"
+#include "Extensions/Modifiers/SPK_VectorFieldForce.h"
+#include "Extensions/Modifiers/SPK_Turbulence.h"
 
 // Actions
 #include "Extensions/Actions/SPK_ActionSet.h"
@@ -69,6 +71,7 @@
 #include "Extensions/Renderers/SPK_LineRenderBehavior.h"
 #include "Extensions/Renderers/SPK_QuadRenderBehavior.h"
 #include "Extensions/Renderers/SPK_Oriented3DRenderBehavior.h"
+#include "Extensions/Renderers/SPK_QuadExpander.h"
 
 // IOConverters
 #include "Extensions/IOConverters/SPK_IO_XMLSaver.h"
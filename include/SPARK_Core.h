@@ -23,9 +23,13 @@
 #define H_SPARK_CORE
 
 #include "Core/SPK_DEF.h"
+#include "Core/SPK_RandomGenerator.h"
 #include "Core/SPK_Logger.h"
 #include "Core/SPK_Vector3D.h"
 #include "Core/SPK_Color.h"
+#include "Core/SPK_ThreadPool.h"
+#include "Core/SPK_BlockAllocator.h"
+#include "Core/SPK_Kernels.h"
 #include "Core/SPK_Meta.h"
 #include "Core/SPK_Types.h"
 #include "Core/SPK_TypeOperations.h"
@@ -59,6 +63,10 @@
 #include "Core/SPK_Action.h"
 #include "Core/SPK_System.h"
 #include "Core/SPK_Group.h"
+#include "Core/SPK_SystemPool.h"
+#include "Core/SPK_SystemRecorder.h"
+#include "Core/SPK_SystemScheduler.h"
+#include "Core/SPK_UpdateLOD.h"
 #include "Core/SPK_Particle.h"
 #include "Core/SPK_Iterator.h"
 #include "Core/SPK_Octree.h"
@@ -0,0 +1,254 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+#ifndef SPK_NO_THREADS
+#include <mutex>
+#endif
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	namespace
+	{
+#ifndef SPK_NO_THREADS
+		thread_local BlockAllocator* currentAllocator = NULL;
+#else
+		BlockAllocator* currentAllocator = NULL;
+#endif
+	}
+
+	struct BlockAllocator::Cache
+	{
+#ifndef SPK_NO_THREADS
+		mutable std::mutex mutex;
+#endif
+		std::map<size_t,std::vector<void*> > freeBlocks; // freed blocks per size class
+
+		size_t cachedSize;
+		size_t maxCachedSize;
+
+		size_t nbUsedBlocks;
+		size_t nbHeapAllocations;
+		size_t nbRecycledAllocations;
+	};
+
+#ifndef SPK_NO_THREADS
+#define SPK_LOCK_CACHE std::lock_guard<std::mutex> lock(cache->mutex);
+#else
+#define SPK_LOCK_CACHE
+#endif
+
+	BlockAllocator::Scope::Scope(BlockAllocator* allocator) :
+		previous(currentAllocator)
+	{
+		currentAllocator = allocator;
+	}
+
+	BlockAllocator::Scope::~Scope()
+	{
+		currentAllocator = previous;
+	}
+
+	BlockAllocator::BlockAllocator(size_t maxCachedSize) :
+		cache(SPK_NEW(Cache))
+	{
+		cache->cachedSize = 0;
+		cache->maxCachedSize = maxCachedSize;
+		cache->nbUsedBlocks = 0;
+		cache->nbHeapAllocations = 0;
+		cache->nbRecycledAllocations = 0;
+	}
+
+	BlockAllocator::~BlockAllocator()
+	{
+		if (cache->nbUsedBlocks != 0)
+			SPK_LOG_WARNING("BlockAllocator::~BlockAllocator() - " << cache->nbUsedBlocks << " blocks are still in use");
+
+		releaseCache();
+		SPK_DELETE(cache);
+	}
+
+	void* BlockAllocator::allocate(size_t size)
+	{
+		const size_t blockSize = getBlockSize(size);
+
+		{
+			SPK_LOCK_CACHE
+			++cache->nbUsedBlocks;
+
+			std::map<size_t,std::vector<void*> >::iterator it = cache->freeBlocks.find(blockSize);
+			if (it != cache->freeBlocks.end() && !it->second.empty())
+			{
+				void* block = it->second.back();
+				it->second.pop_back();
+				cache->cachedSize -= blockSize;
+				++cache->nbRecycledAllocations;
+				return block;
+			}
+
+			++cache->nbHeapAllocations;
+		}
+
+		// The heap is accessed out of the lock
+		return allocateAligned(blockSize);
+	}
+
+	void BlockAllocator::deallocate(void* block,size_t size)
+	{
+		if (block == NULL)
+			return;
+
+		const size_t blockSize = getBlockSize(size);
+
+		{
+			SPK_LOCK_CACHE
+			--cache->nbUsedBlocks;
+
+			if (cache->maxCachedSize == 0 || cache->cachedSize + blockSize <= cache->maxCachedSize)
+			{
+				cache->freeBlocks[blockSize].push_back(block);
+				cache->cachedSize += blockSize;
+				return;
+			}
+		}
+
+		deallocateAligned(block);
+	}
+
+	void BlockAllocator::releaseCache()
+	{
+		SPK_LOCK_CACHE
+		for (std::map<size_t,std::vector<void*> >::iterator it = cache->freeBlocks.begin(); it != cache->freeBlocks.end(); ++it)
+			for (std::vector<void*>::iterator blockIt = it->second.begin(); blockIt != it->second.end(); ++blockIt)
+				deallocateAligned(*blockIt);
+
+		cache->freeBlocks.clear();
+		cache->cachedSize = 0;
+	}
+
+	void BlockAllocator::setMaxCachedSize(size_t maxCachedSize)
+	{
+		SPK_LOCK_CACHE
+		cache->maxCachedSize = maxCachedSize;
+		trimCache();
+	}
+
+	size_t BlockAllocator::getMaxCachedSize() const
+	{
+		SPK_LOCK_CACHE
+		return cache->maxCachedSize;
+	}
+
+	size_t BlockAllocator::getCachedSize() const
+	{
+		SPK_LOCK_CACHE
+		return cache->cachedSize;
+	}
+
+	size_t BlockAllocator::getNbUsedBlocks() const
+	{
+		SPK_LOCK_CACHE
+		return cache->nbUsedBlocks;
+	}
+
+	size_t BlockAllocator::getNbHeapAllocations() const
+	{
+		SPK_LOCK_CACHE
+		return cache->nbHeapAllocations;
+	}
+
+	size_t BlockAllocator::getNbRecycledAllocations() const
+	{
+		SPK_LOCK_CACHE
+		return cache->nbRecycledAllocations;
+	}
+
+	void BlockAllocator::trimCache()
+	{
+		// The largest blocks are released first
+		while (cache->maxCachedSize != 0 && cache->cachedSize > cache->maxCachedSize)
+		{
+			std::map<size_t,std::vector<void*> >::iterator it = --cache->freeBlocks.end();
+			deallocateAligned(it->second.back());
+			it->second.pop_back();
+			cache->cachedSize -= it->first;
+			if (it->second.empty())
+				cache->freeBlocks.erase(it);
+		}
+	}
+
+	size_t BlockAllocator::getBlockSize(size_t size)
+	{
+		if (size <= ALIGNMENT)
+			return ALIGNMENT;
+
+		// Finds the highest bit set and rounds up to a quarter of its power of two
+		size_t highestBit = 0;
+		for (size_t s = size - 1; s > 1; s >>= 1)
+			++highestBit;
+		const size_t step = static_cast<size_t>(1) << (highestBit - 2);
+		return (size + step - 1) & ~(step - 1);
+	}
+
+	BlockAllocator* BlockAllocator::getCurrent()
+	{
+		return currentAllocator;
+	}
+
+	void* BlockAllocator::allocateAligned(size_t size)
+	{
+		// The original address is stored just before the aligned block
+		char* memory = static_cast<char*>(std::malloc(size + ALIGNMENT + sizeof(void*)));
+		if (memory == NULL)
+		{
+			SPK_LOG_FATAL("BlockAllocator::allocateAligned(size_t) - Unable to allocate " << size << " bytes");
+			return NULL;
+		}
+
+		char* block = memory + sizeof(void*);
+		block += (ALIGNMENT - reinterpret_cast<size_t>(block) % ALIGNMENT) % ALIGNMENT;
+		reinterpret_cast<void**>(block)[-1] = memory;
+
+#ifdef SPK_TRACE_MEMORY
+		SPKMemoryTracer::get().registerAllocation(block,size,"BlockAllocator block",__FILE__,__LINE__);
+#endif
+
+		return block;
+	}
+
+	void BlockAllocator::deallocateAligned(void* block)
+	{
+		if (block == NULL)
+			return;
+
+#ifdef SPK_TRACE_MEMORY
+		SPKMemoryTracer::get().unregisterAllocation(block);
+#endif
+
+		std::free(reinterpret_cast<void**>(block)[-1]);
+	}
+
+#undef SPK_LOCK_CACHE
+}
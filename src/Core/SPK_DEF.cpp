@@ -19,9 +19,6 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
-#include <ctime>
-#include <limits>
-
 #include <SPARK.h>
 #include "Extensions/Zones/SPK_Point.h" // for default zone
 
@@ -40,18 +37,14 @@ namespace SPK
 
 	// This allows SPARK initialization at application start up
 	SPKContext::SPKContext() :
-		defaultZone()
+		defaultZone(),
+		threadPool(NULL),
+		allocator(NULL)
 	{
 		// Ensure MemoryTracer is created before the context, because it will be used in the destructor
 #ifdef SPK_TRACE_MEMORY
 		SPK::SPKMemoryTracer::get();
 #endif
-
-		// Inits the random seed
-		randomSeed = static_cast<unsigned int>(std::time(NULL));
-		// little tweak to ensure the randomSeed is uniformly distributed along all the range
-		for (size_t i = 0; i < 2; ++i)
-			randomSeed = generateRandom(static_cast<unsigned int>(1),std::numeric_limits<unsigned int>::max());
 	}
 
 	// This allows SPARK finalization at application exit
@@ -100,10 +100,35 @@ namespace SPK
 			zone->updateTransform(this);
 	}
 
-	void Emitter::emitIt(Particle& particle) const
+	void Emitter::emitBatch(Group& group,size_t start,size_t end,const float* radii) const
 	{
-		zone->generatePosition(particle.position(),full,particle.getRadius());
-		generateVelocity(particle,SPK_RANDOM(forceMin,forceMax) / particle.getParam(PARAM_MASS));
+		zone->generatePositions(group.particleData.positions + start,end - start,full,radii);
+		initVelocities(group,start,end);
+	}
+
+	void Emitter::initVelocities(Group& group,size_t start,size_t end) const
+	{
+		// The forces are generated in bulk by blocks and turned into speeds before the velocities
+		float speeds[Group::BIRTH_BLOCK_SIZE];
+
+		RandomGenerator& generator = RandomGenerator::getCurrent();
+		for (size_t blockStart = start; blockStart < end; blockStart += Group::BIRTH_BLOCK_SIZE)
+		{
+			const size_t blockEnd = std::min(blockStart + Group::BIRTH_BLOCK_SIZE,end);
+			generator.fillUniform(speeds,blockEnd - blockStart,forceMin,forceMax);
+
+			float* speed = speeds;
+			for (ConstGroupIterator particleIt(group,blockStart,blockEnd); !particleIt.end(); ++particleIt)
+				*(speed++) /= particleIt->getParam(PARAM_MASS);
+
+			generateVelocities(group,blockStart,blockEnd - blockStart,speeds);
+		}
+	}
+
+	void Emitter::generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const
+	{
+		for (GroupIterator particleIt(group,start,start + nb); !particleIt.end(); ++particleIt)
+			generateVelocity(*particleIt,*(speeds++));
 	}
 
 	Ref<SPKObject> Emitter::findByName(const std::string& name)
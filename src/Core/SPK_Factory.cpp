@@ -83,6 +83,8 @@ namespace SPK
 		registerType<PointMass>();
 		registerType<RandomForce>();
 		registerType<LinearForce>();
+		registerType<VectorFieldForce>();
+		registerType<Turbulence>();
 
 		// Actions
 		registerType<ActionSet>();
@@ -35,16 +35,129 @@ namespace SPK
 		0.0f,	// PARAM_ROTATION_SPEED
 	};
 
+	namespace
+	{
+		// Gets the size of an array within the block of a group (each array starts on an aligned address)
+		inline size_t getAlignedSize(size_t size)
+		{
+			return (size + BlockAllocator::ALIGNMENT - 1) & ~(BlockAllocator::ALIGNMENT - 1);
+		}
+
+		template<typename T>
+		inline T* placeArray(char*& position,size_t nb)
+		{
+			T* t = reinterpret_cast<T*>(position);
+			position += getAlignedSize(nb * sizeof(T));
+			return t;
+		}
+
+		template<typename T>
+		inline void copyArray(T* dst,const T* src,size_t nb)
+		{
+			if (src != NULL && nb != 0)
+				std::memcpy(dst,src,nb * sizeof(T));
+		}
+
+		void deallocateBlock(void* block,size_t size,BlockAllocator* allocator)
+		{
+			if (allocator != NULL)
+				allocator->deallocate(block,size);
+			else
+				BlockAllocator::deallocateAligned(block);
+		}
+	}
+
+	// Processes a stage of the update on a chunk of particles
+	class Group::ChunkJob : public ThreadPool::Job
+	{
+	public :
+
+		enum Stage
+		{
+			STAGE_UPDATE,
+			STAGE_MODIFIER,
+			STAGE_DISTANCE,
+		};
+
+		ChunkJob(Group& group,float deltaTime) :
+			group(group),
+			deltaTime(deltaTime),
+			stage(STAGE_UPDATE),
+			pass(NULL),
+			integrate(false),
+			seed(0)
+		{}
+
+		// The stage is followed by the given pass of modifiers on each chunk
+		// If integrate is true, the positions are integrated in streams before the pass (streamed update)
+		void setStage(Stage stage,const ModifierPass* pass = NULL,bool integrate = false)
+		{
+			this->stage = stage;
+			this->pass = pass;
+			this->integrate = integrate;
+		}
+
+		// Sets the seed from which the random generator of each chunk is derived
+		void setSeed(uint32 seed)
+		{
+			this->seed = seed;
+		}
+
+		virtual void run(size_t index)
+		{
+			size_t start = index * CHUNK_SIZE;
+			size_t end = std::min(start + CHUNK_SIZE,group.particleData.nbParticles);
+
+			// Each chunk has its own random stream so that the results do not depend on the number of threads
+			RandomGenerator generator(seed,static_cast<uint32>(index));
+			RandomGenerator::Scope randomScope(generator);
+
+			switch (stage)
+			{
+			case STAGE_UPDATE :
+				group.updateChunk(start,end,deltaTime);
+				break;
+
+			case STAGE_MODIFIER :
+				break;
+
+			case STAGE_DISTANCE :
+				group.computeDistances(start,end);
+				break;
+			}
+
+			if (pass != NULL || integrate)
+				group.processPass(start,end,deltaTime,integrate,pass);
+		}
+
+	private :
+
+		Group& group;
+		float deltaTime;
+		Stage stage;
+		const ModifierPass* pass;
+		bool integrate;
+		uint32 seed;
+	};
+
+
 	Group::Group(const Ref<System>& system,size_t capacity) :
 		Transformable(SHARE_POLICY_FALSE),
 		system(system.get()),
+		randomGenerator(RandomGenerator::getCurrent().generateUInt()),
 		nbEnabledParameters(0),
+		pipelineValid(false),
 		minLifeTime(1.0f),
 		maxLifeTime(1.0f),
 		immortal(false),
 		still(false),
 		distanceComputationEnabled(false),
 		sortingEnabled(false),
+		indexSortingEnabled(false),
+		streamedUpdateEnabled(false),
+		modifierFusionEnabled(true),
+		spatialIndexType(SPATIAL_INDEX_OCTREE),
+		sortingMode(SORTING_RADIX),
 		AABBMin(),
 		AABBMax(),
 		graphicalRadius(1.0f),
@@ -60,13 +173,20 @@ namespace SPK
 	Group::Group(const Group& group) :
 		Transformable(group),
 		system(NULL),
+		randomGenerator(RandomGenerator::getCurrent().generateUInt()),
 		nbEnabledParameters(0),
+		pipelineValid(false),
 		minLifeTime(group.minLifeTime),
 		maxLifeTime(group.maxLifeTime),
 		immortal(group.immortal),
 		still(group.still),
 		distanceComputationEnabled(group.distanceComputationEnabled),
 		sortingEnabled(group.sortingEnabled),
+		indexSortingEnabled(group.indexSortingEnabled),
+		streamedUpdateEnabled(group.streamedUpdateEnabled),
+		modifierFusionEnabled(group.modifierFusionEnabled),
+		spatialIndexType(group.spatialIndexType),
+		sortingMode(group.sortingMode),
 		AABBMin(group.AABBMin),
 		AABBMax(group.AABBMax),
 		graphicalRadius(group.graphicalRadius),
@@ -100,18 +220,7 @@ namespace SPK
 	Group::~Group()
 	{
 		destroyAllAdditionnalData();
-
-		SPK_DELETE_ARRAY(particleData.positions);
-		SPK_DELETE_ARRAY(particleData.velocities);
-		SPK_DELETE_ARRAY(particleData.oldPositions);
-		SPK_DELETE_ARRAY(particleData.ages);
-		SPK_DELETE_ARRAY(particleData.lifeTimes);
-		SPK_DELETE_ARRAY(particleData.energies);
-		SPK_DELETE_ARRAY(particleData.sqrDists);
-		SPK_DELETE_ARRAY(particleData.colors);
-
-		for (size_t i = 0; i < NB_PARAMETERS; ++i)
-			SPK_DELETE_ARRAY(particleData.parameters[i]);
+		deallocateBlock(particleData.block,particleData.blockSize,particleData.allocator);
 
 		SPK_DELETE(octree);
 
@@ -148,8 +257,14 @@ namespace SPK
 
 	bool Group::updateParticles(float deltaTime)
 	{
+		// The random numbers of the update are generated by the generator of the group
+		RandomGenerator::Scope randomScope(randomGenerator);
+		SPK_TRACE_SYSTEM(system)
+
 		// Prepares the additionnal data
 		prepareAdditionnalData();
+		for (std::vector<WeakModifierDef>::const_iterator it = activeModifiers.begin(); it != activeModifiers.end(); ++it)
+			it->obj->prepareModify(*this,it->dataSet,deltaTime);
 
 		size_t nbAutoBorn = 0;
 		size_t nbManualBorn = nbBufferedParticles;
@@ -174,45 +289,58 @@ namespace SPK
 		size_t emitterIndex = 0;
 		size_t nbBorn = nbAutoBorn + nbManualBorn;
 
-		// Updates the age of the particles function of the delta time
-		for (size_t i = 0; i < particleData.nbParticles; ++i)
-			particleData.ages[i] += deltaTime;
-
-		// Computes the energy of the particles (if they are not immortal)
-		if (!immortal)
-			for (size_t i = 0; i < particleData.nbParticles; ++i)
-				particleData.energies[i] = 1.0f - particleData.ages[i] / particleData.lifeTimes[i];
-
-		// Updates the position of particles function of their velocity
-		if (!still)
-			for (size_t i = 0; i < particleData.nbParticles; ++i)
-			{
-				particleData.oldPositions[i] = particleData.positions[i];
-				particleData.positions[i] += particleData.velocities[i] * deltaTime;
-			}
-
-		// Interpolates the parameters
-		if (colorInterpolator.obj)
-			colorInterpolator.obj->interpolate(particleData.colors,*this,colorInterpolator.dataSet);
+		bool hasSerialInterpolators = colorInterpolator.obj && !colorInterpolator.obj->isChunkSafe();
 		for (size_t i = 0; i < nbEnabledParameters; ++i)
+			hasSerialInterpolators |= !paramInterpolators[enabledParamIndices[i]].obj->isChunkSafe();
+
+		// Updates the age, energy and position of particles and interpolates their parameters by chunks
+		// The first pass of modifiers is fused with the update if nothing has to be done in between
+		ChunkJob chunkJob(*this,deltaTime);
+		size_t nbProcessedPasses = 0;
+		if (modifierFusionEnabled && !hasSerialInterpolators && octree == NULL && !modifierPasses.empty() && modifierPasses[0].chunkSafe)
+			nbProcessedPasses = 1;
+		chunkJob.setStage(ChunkJob::STAGE_UPDATE,nbProcessedPasses > 0 ? &modifierPasses[0] : NULL,streamedUpdateEnabled && !still);
+		processChunks(chunkJob);
+
+		// Interpolates the parameters with the interpolators that cannot be processed by chunks
+		if (hasSerialInterpolators)
 		{
-			FloatInterpolatorDef& interpolator = paramInterpolators[enabledParamIndices[i]];
-			interpolator.obj->interpolate(particleData.parameters[enabledParamIndices[i]],*this,interpolator.dataSet);
+			if (colorInterpolator.obj && !colorInterpolator.obj->isChunkSafe())
+				colorInterpolator.obj->interpolate(particleData.colors,*this,colorInterpolator.dataSet);
+			for (size_t i = 0; i < nbEnabledParameters; ++i)
+			{
+				FloatInterpolatorDef& interpolator = paramInterpolators[enabledParamIndices[i]];
+				if (!interpolator.obj->isChunkSafe())
+					interpolator.obj->interpolate(particleData.parameters[enabledParamIndices[i]],*this,interpolator.dataSet);
+			}
 		}
 
 		// Updates the octree if one
 		if (octree != NULL)
 			octree->update();
 
-		// Modifies the particles with specific active modifiers behavior
-		for (std::vector<WeakModifierDef>::const_iterator it = activeModifiers.begin(); it != activeModifiers.end(); ++it)
-			it->obj->modify(*this,it->dataSet,deltaTime);
+		// Modifies the particles with the passes of the pipeline of modifiers
+		for (size_t i = nbProcessedPasses; i < modifierPasses.size(); ++i)
+		{
+			const ModifierPass& pass = modifierPasses[i];
+			if (pass.chunkSafe)
+			{
+				chunkJob.setStage(ChunkJob::STAGE_MODIFIER,&pass);
+				processChunks(chunkJob);
+			}
+			else
+			{
+				const WeakModifierDef& modifier = activeModifiers[pass.first];
+				modifier.obj->modify(*this,modifier.dataSet,deltaTime);
+			}
+		}
 
 		// Updates the renderer data
 		if (renderer.obj)
 			renderer.obj->update(*this,renderer.dataSet);
 
-		// Checks dead particles and reinits or swaps
+		// Checks dead particles and marks them for compaction
+		deadIndices.clear();
 		for (size_t i = 0; i < particleData.nbParticles; ++i)
 			if (particleData.energies[i] <= 0.0f)
 			{
@@ -223,35 +351,47 @@ namespace SPK
 					deathAction->apply(particle);
 				}
 
-				bool replaceDeadParticle = false;
-				while (!replaceDeadParticle && nbBorn > 0)
-				{
-					if (initParticle(i,emitterIndex,nbManualBorn))
-						replaceDeadParticle = true;
-					--nbBorn;
-				}
-
-				if (!replaceDeadParticle)
-				{
-					swapParticles(i,particleData.nbParticles - 1);
-					--particleData.nbParticles;
-					--i; // As we need to test the swapped particle
-				}
+				deadIndices.push_back(i);
 			}
 
-		// Emits new particles if some left
-		while (nbBorn > 0 && particleData.maxParticles - particleData.nbParticles > 0)
+		// Replaces the dead particles by new born ones in place, by runs of consecutive indices
+		const size_t nbDead = deadIndices.size();
+		const size_t nbReplaced = std::min(nbBorn,nbDead);
+		for (size_t i = 0; i < nbReplaced;)
+		{
+			size_t j = i + 1;
+			while (j < nbReplaced && deadIndices[j] == deadIndices[j - 1] + 1)
+				++j;
+			initParticles(deadIndices[i],deadIndices[i] + j - i,emitterIndex,nbManualBorn);
+			i = j;
+		}
+		nbBorn -= nbReplaced;
+
+		// Emits the new particles left in a single batch at the end of the group
+		nbBorn = std::min(nbBorn,particleData.maxParticles - particleData.nbParticles);
+		if (nbBorn > 0)
+		{
+			const size_t start = particleData.nbParticles;
+			particleData.nbParticles += nbBorn;
+			initParticles(start,particleData.nbParticles,emitterIndex,nbManualBorn);
+		}
+
+		// Removes all the dead particles at once (born-dead particles were added after the others)
+		if (!deadIndices.empty())
 		{
-			if (!initParticle(particleData.nbParticles++,emitterIndex,nbManualBorn))
-				--particleData.nbParticles;
-			--nbBorn;
+			const bool hasBornDead = deadIndices.size() > nbDead;
+			deadIndices.erase(deadIndices.begin(),deadIndices.begin() + nbReplaced);
+			if (hasBornDead)
+				std::sort(deadIndices.begin(),deadIndices.end());
+			if (!deadIndices.empty())
+				compactParticles();
 		}
 
 		// Computes the distance of particles from the camera
 		if (distanceComputationEnabled)
 		{
-			for (size_t i = 0; i < particleData.nbParticles; ++i)
-				particleData.sqrDists[i] = getSqrDist(particleData.positions[i],system->getCameraPosition());
+			chunkJob.setStage(ChunkJob::STAGE_DISTANCE);
+			processChunks(chunkJob);
 		}
 
 		emptyBufferedParticles();
@@ -259,10 +399,172 @@ namespace SPK
 		return hasAliveEmitters || particleData.nbParticles > 0;
 	}
 
+	void Group::processChunks(ChunkJob& job)
+	{
+		const size_t nbChunks = (particleData.nbParticles + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		ThreadPool* threadPool = getThreadPool();
+
+		job.setSeed(randomGenerator.generateUInt());
+
+		if (threadPool != NULL && nbChunks > 1)
+			threadPool->parallelFor(nbChunks,job);
+		else
+			for (size_t i = 0; i < nbChunks; ++i)
+				job.run(i);
+	}
+
+	void Group::updateChunk(size_t start,size_t end,float deltaTime)
+	{
+		size_t nb = end - start;
+
+		// Updates the age of the particles function of the delta time
+		Kernels::add(particleData.ages + start,deltaTime,nb);
+
+		// Computes the energy of the particles (if they are not immortal)
+		if (!immortal)
+			Kernels::computeEnergies(particleData.energies + start,particleData.ages + start,particleData.lifeTimes + start,nb);
+
+		// Updates the position of particles function of their velocity (in a streamed update, this is done later in streams)
+		if (!still && !streamedUpdateEnabled)
+			Kernels::integrate(particleData.positions + start,particleData.oldPositions + start,particleData.velocities + start,deltaTime,nb);
+
+		// Interpolates the parameters
+		if (colorInterpolator.obj && colorInterpolator.obj->isChunkSafe())
+			colorInterpolator.obj->interpolateRange(particleData.colors,*this,colorInterpolator.dataSet,start,end);
+		for (size_t i = 0; i < nbEnabledParameters; ++i)
+		{
+			FloatInterpolatorDef& interpolator = paramInterpolators[enabledParamIndices[i]];
+			if (interpolator.obj->isChunkSafe())
+				interpolator.obj->interpolateRange(particleData.parameters[enabledParamIndices[i]],*this,interpolator.dataSet,start,end);
+		}
+	}
+
+	void Group::computeDistances(size_t start,size_t end)
+	{
+		const Vector3D& cameraPosition = system->getCameraPosition();
+		for (size_t i = start; i < end; ++i)
+			particleData.sqrDists[i] = getSqrDist(particleData.positions[i],cameraPosition);
+	}
+
+	void Group::processPass(size_t start,size_t end,float deltaTime,bool integrate,const ModifierPass* pass)
+	{
+		const size_t first = pass != NULL ? pass->first : 0;
+		const size_t last = pass != NULL ? pass->first + pass->nb : 0;
+
+		// A single modifier not working on streams processes the whole range at once
+		if (!integrate && last - first == 1 && !isStreamModifier(first))
+		{
+			activeModifiers[first].obj->modifyRange(*this,activeModifiers[first].dataSet,deltaTime,start,end);
+			return;
+		}
+
+		// Else the range is processed by blocks remaining in cache on which the modifiers are applied in turn
+		// The streams of a block are allocated on the stack to remain in cache
+		// They are padded so that they do not start at addresses distant of a multiple of 4KB (which slows down the processor)
+		const size_t STREAM_STRIDE = STREAM_BLOCK_SIZE + 16;
+		float buffer[STREAM_STRIDE * 9 + 7];
+		float* stream = reinterpret_cast<float*>((reinterpret_cast<size_t>(buffer) + 31) & ~static_cast<size_t>(31));
+
+		ParticleStreams streams;
+		Vector3DStreams* vectorStreams[3] = { &streams.positions,&streams.velocities,&streams.oldPositions };
+		for (size_t i = 0; i < 3; ++i)
+		{
+			vectorStreams[i]->x = stream;
+			vectorStreams[i]->y = stream + STREAM_STRIDE;
+			vectorStreams[i]->z = stream + STREAM_STRIDE * 2;
+			stream += STREAM_STRIDE * 3;
+		}
+
+		for (size_t blockStart = start; blockStart < end; blockStart += STREAM_BLOCK_SIZE)
+		{
+			size_t blockEnd = std::min(blockStart + STREAM_BLOCK_SIZE,end);
+			size_t nb = blockEnd - blockStart;
+
+			// The vectors of the block are only copied in streams while modifiers compatible with SOA follow each other
+			bool inStreams = integrate;
+			if (integrate) // the old positions are computed by the integration
+			{
+				Kernels::toStreams(particleData.positions + blockStart,streams.positions,nb);
+				Kernels::toStreams(particleData.velocities + blockStart,streams.velocities,nb);
+				Kernels::integrate(streams.positions.x,streams.oldPositions.x,streams.velocities.x,deltaTime,nb);
+				Kernels::integrate(streams.positions.y,streams.oldPositions.y,streams.velocities.y,deltaTime,nb);
+				Kernels::integrate(streams.positions.z,streams.oldPositions.z,streams.velocities.z,deltaTime,nb);
+			}
+
+			for (size_t i = first; i < last; ++i)
+			{
+				const WeakModifierDef& modifier = activeModifiers[i];
+				if (isStreamModifier(i))
+				{
+					if (!inStreams)
+					{
+						Kernels::toStreams(particleData.positions + blockStart,streams.positions,nb);
+						Kernels::toStreams(particleData.velocities + blockStart,streams.velocities,nb);
+						Kernels::toStreams(particleData.oldPositions + blockStart,streams.oldPositions,nb);
+						inStreams = true;
+					}
+					modifier.obj->modifyStreams(*this,modifier.dataSet,deltaTime,streams,blockStart,blockEnd);
+				}
+				else
+				{
+					if (inStreams)
+					{
+						Kernels::fromStreams(streams.positions,particleData.positions + blockStart,nb);
+						Kernels::fromStreams(streams.velocities,particleData.velocities + blockStart,nb);
+						Kernels::fromStreams(streams.oldPositions,particleData.oldPositions + blockStart,nb);
+						inStreams = false;
+					}
+					modifier.obj->modifyRange(*this,modifier.dataSet,deltaTime,blockStart,blockEnd);
+				}
+			}
+
+			if (inStreams)
+			{
+				Kernels::fromStreams(streams.positions,particleData.positions + blockStart,nb);
+				Kernels::fromStreams(streams.velocities,particleData.velocities + blockStart,nb);
+				Kernels::fromStreams(streams.oldPositions,particleData.oldPositions + blockStart,nb);
+			}
+		}
+	}
+
+	bool Group::isStreamModifier(size_t index) const
+	{
+		return streamedUpdateEnabled && index < activeModifiers.size() && activeModifiers[index].obj->isSoACompatible();
+	}
+
+	void Group::compileModifierPipeline()
+	{
+		// The pipeline is only compiled again when the active modifiers change
+		bool changed = !pipelineValid || pipelineModifiers.size() != activeModifiers.size();
+		for (size_t i = 0; !changed && i < activeModifiers.size(); ++i)
+			changed = pipelineModifiers[i] != activeModifiers[i].obj;
+		if (!changed)
+			return;
+
+		modifierPasses.clear();
+		pipelineModifiers.clear();
+		for (size_t i = 0; i < activeModifiers.size(); ++i)
+		{
+			const bool chunkSafe = activeModifiers[i].obj->isChunkSafe();
+			if (modifierFusionEnabled && chunkSafe && !modifierPasses.empty() && modifierPasses.back().chunkSafe)
+				++modifierPasses.back().nb; // the consecutive chunk safe modifiers are fused
+			else
+			{
+				ModifierPass pass = { i,1,chunkSafe };
+				modifierPasses.push_back(pass);
+			}
+			pipelineModifiers.push_back(activeModifiers[i].obj);
+		}
+
+		pipelineValid = true;
+	}
+
 	void Group::renderParticles()
 	{
 		if (renderer.obj && renderer.obj->isActive())
 		{
+			BlockAllocator::Scope allocatorScope(getAllocator());
+			SPK_TRACE_SYSTEM(system)
 			renderer.obj->prepareData(*this,renderer.dataSet);
 			if (renderer.renderBuffer == NULL)
 				renderer.renderBuffer = renderer.obj->attachRenderBuffer(*this);
@@ -276,30 +578,80 @@ namespace SPK
 
 		if (isInitialized() && (!particleData.initialized || capacity != particleData.maxParticles))
 		{
+			SPK_TRACE_SYSTEM(system)
 			destroyAllAdditionnalData();
 
 			size_t copySize = particleData.nbParticles;
 			if (capacity < copySize)
 				copySize = capacity;
 
-			reallocateArray(particleData.positions,capacity,copySize);
-			reallocateArray(particleData.velocities,capacity,copySize);
-			reallocateArray(particleData.oldPositions,capacity,copySize);
-			reallocateArray(particleData.ages,capacity,copySize);
-			reallocateArray(particleData.lifeTimes,capacity,copySize);
-			reallocateArray(particleData.energies,capacity,copySize);
-			reallocateArray(particleData.sqrDists,capacity,copySize);
-			reallocateArray(particleData.colors,capacity,copySize);
-
-			for (size_t i = 0; i < nbEnabledParameters; ++i)
-				reallocateArray(particleData.parameters[enabledParamIndices[i]],capacity,copySize);
-
+			reallocateData(capacity,copySize);
+			particleData.nbParticles = copySize; // the particles beyond the new capacity are lost
 			particleData.initialized = true;
 		}
 
 		particleData.maxParticles = capacity;
 	}
 
+	void Group::reallocateData(size_t capacity,size_t copySize)
+	{
+		const size_t vectorArraySize = getAlignedSize(capacity * sizeof(Vector3D));
+		const size_t floatArraySize = getAlignedSize(capacity * sizeof(float));
+		const size_t colorArraySize = getAlignedSize(capacity * sizeof(Color));
+		const size_t blockSize = vectorArraySize * 3 + floatArraySize * (4 + nbEnabledParameters) + colorArraySize;
+
+		BlockAllocator* allocator = getAllocator();
+		char* block = static_cast<char*>(allocator != NULL ? allocator->allocate(blockSize) : BlockAllocator::allocateAligned(blockSize));
+
+		const ParticleData oldData(particleData);
+
+		// Places the arrays within the new block
+		char* position = block;
+		particleData.positions = placeArray<Vector3D>(position,capacity);
+		particleData.velocities = placeArray<Vector3D>(position,capacity);
+		particleData.oldPositions = placeArray<Vector3D>(position,capacity);
+		particleData.ages = placeArray<float>(position,capacity);
+		particleData.energies = placeArray<float>(position,capacity);
+		particleData.lifeTimes = placeArray<float>(position,capacity);
+		particleData.sqrDists = placeArray<float>(position,capacity);
+		particleData.colors = placeArray<Color>(position,capacity);
+
+		for (size_t i = 0; i < NB_PARAMETERS; ++i)
+			particleData.parameters[i] = NULL;
+		for (size_t i = 0; i < nbEnabledParameters; ++i)
+			particleData.parameters[enabledParamIndices[i]] = placeArray<float>(position,capacity);
+
+		particleData.block = block;
+		particleData.blockSize = blockSize;
+		particleData.allocator = allocator;
+
+		// Copies the particles from the old block
+		copyArray(particleData.positions,oldData.positions,copySize);
+		copyArray(particleData.velocities,oldData.velocities,copySize);
+		copyArray(particleData.oldPositions,oldData.oldPositions,copySize);
+		copyArray(particleData.ages,oldData.ages,copySize);
+		copyArray(particleData.energies,oldData.energies,copySize);
+		copyArray(particleData.lifeTimes,oldData.lifeTimes,copySize);
+		copyArray(particleData.sqrDists,oldData.sqrDists,copySize);
+		copyArray(particleData.colors,oldData.colors,copySize);
+
+		for (size_t i = 0; i < nbEnabledParameters; ++i)
+			copyArray(particleData.parameters[enabledParamIndices[i]],oldData.parameters[enabledParamIndices[i]],copySize);
+
+		deallocateBlock(oldData.block,oldData.blockSize,oldData.allocator);
+	}
+
+	void Group::reset()
+	{
+		empty();
+		emptyBufferedParticles();
+
+		RandomGenerator::Scope randomScope(randomGenerator);
+		for (std::vector<Ref<Emitter> >::const_iterator it = emitters.begin(); it != emitters.end(); ++it)
+			if (!(*it)->isShared())
+				(*it)->resetTank();
+	}
+
 	void Group::setColorInterpolator(const Ref<ColorInterpolator>& interpolator)
 	{
 		if (colorInterpolator.obj != interpolator)
@@ -314,26 +666,7 @@ namespace SPK
 	{
 		if (paramInterpolators[param].obj != interpolator)
 		{
-			if (!paramInterpolators[param].obj && interpolator)
-			{
-				if (particleData.parameters[param] != NULL)
-					SPK_LOG_FATAL("Group::setParamInterpolator(Param,FloatInterpolator*) - Unexpected memory leak happened");
-
-				// Creates the data for the parameter
-				if (isInitialized())
-					particleData.parameters[param] = SPK_NEW_ARRAY(float,particleData.maxParticles);
-			}
-			else if (paramInterpolators[param].obj && !interpolator)
-			{
-				if (particleData.parameters[param] == NULL)
-				{
-					SPK_LOG_FATAL("Group::setParamInterpolator(Param,FloatInterpolator*) - Unexpected error happened");
-				}
-
-				// Destroys the data for the parameter
-				SPK_DELETE_ARRAY(particleData.parameters[param]);
-				particleData.parameters[param] = NULL;
-			}
+			const bool layoutChanged = !paramInterpolators[param].obj != !interpolator;
 
 			detachDataSet(paramInterpolators[param].dataSet);
 
@@ -341,6 +674,13 @@ namespace SPK
 			paramInterpolators[param].dataSet = attachDataSet(interpolator.get());
 
 			recomputeEnabledParamIndices();
+
+			// The parameter arrays are placed within the block of the group so that the block must be rebuilt
+			if (layoutChanged && particleData.initialized)
+			{
+				SPK_TRACE_SYSTEM(system)
+				reallocateData(particleData.maxParticles,particleData.nbParticles);
+			}
 		}
 	}
 
@@ -397,6 +737,7 @@ namespace SPK
 
 		ModifierDef modifierDef(modifier,attachDataSet(modifier.get()));
 		modifiers.push_back(modifierDef);
+		pipelineValid = false;
 		if (isInitialized())
 		{
 			sortedModifiers.push_back(modifierDef);
@@ -420,6 +761,7 @@ namespace SPK
 							break;
 						}
 				modifiers.erase(it);
+				pipelineValid = false;
 				return;
 			}
 		}
@@ -460,75 +802,101 @@ namespace SPK
 				enabledParamIndices[nbEnabledParameters++] = i;
 	}
 
-	bool Group::initParticle(size_t index,size_t& emitterIndex,size_t& nbManualBorn)
+	void Group::initParticles(size_t start,size_t end,size_t& emitterIndex,size_t& nbManualBorn)
 	{
-		Particle particle(getParticle(index));
+		// Particles are initialized by blocks so that each stage works on data still in cache
+		// The born-dead particles are added to the dead indices
+		for (size_t blockStart = start; blockStart < end; blockStart += BIRTH_BLOCK_SIZE)
+			initParticleBlock(blockStart,std::min(blockStart + BIRTH_BLOCK_SIZE,end),emitterIndex,nbManualBorn);
+	}
 
-		particleData.ages[index] = 0.0f;
-		particleData.energies[index] = 1.0f;
-		particleData.lifeTimes[index] = SPK_RANDOM(minLifeTime,maxLifeTime);
+	void Group::initParticleBlock(size_t start,size_t end,size_t& emitterIndex,size_t& nbManualBorn)
+	{
+		for (size_t i = start; i < end; ++i)
+		{
+			particleData.ages[i] = 0.0f;
+			particleData.energies[i] = 1.0f;
+		}
+		randomGenerator.fillUniform(particleData.lifeTimes + start,end - start,minLifeTime,maxLifeTime);
 
+		// Initializes the parameters first as the radius and the mass are needed for the emission
 		if (colorInterpolator.obj)
-			colorInterpolator.obj->init(particleData.colors[index],particle,colorInterpolator.dataSet);
+			colorInterpolator.obj->initBatch(particleData.colors,*this,colorInterpolator.dataSet,start,end);
 		else
-			particleData.colors[index] = 0xFFFFFFFF;
+			for (size_t i = start; i < end; ++i)
+				particleData.colors[i] = 0xFFFFFFFF;
 
 		for (size_t i = 0; i < nbEnabledParameters; ++i)
 		{
 			FloatInterpolatorDef& interpolator = paramInterpolators[enabledParamIndices[i]];
-			interpolator.obj->init(particleData.parameters[enabledParamIndices[i]][index],particle,interpolator.dataSet);
+			interpolator.obj->initBatch(particleData.parameters[enabledParamIndices[i]],*this,interpolator.dataSet,start,end);
 		}
 
-		if (nbManualBorn == 0)
-		{
-			activeEmitters[emitterIndex].obj->emitIt(particle);
-			if (--activeEmitters[emitterIndex].nbBorn == 0)
-				++emitterIndex;
-		}
-		else
+		float radii[BIRTH_BLOCK_SIZE];
+		for (size_t i = start; i < end; ++i)
+			radii[i - start] = getParticle(i).getRadius();
+
+		// Generates the positions and velocities of the particles created manually first and then of the emitted ones
+		size_t index = start;
+		while (index < end && nbManualBorn > 0)
 		{
 			CreationData& creationData = creationBuffer.front();
+			const size_t nb = std::min(std::min(static_cast<size_t>(creationData.nb),nbManualBorn),end - index);
 
 			if (creationData.zone)
-				creationData.zone->generatePosition(particle.position(),creationData.full,particle.getRadius());
+				creationData.zone->generatePositions(particleData.positions + index,nb,creationData.full,radii + index - start);
 			else
-				particle.position() = creationData.position;
+				for (size_t i = index; i < index + nb; ++i)
+					particleData.positions[i] = creationData.position;
 
 			if (creationData.emitter)
-			{
-				float speed = SPK_RANDOM(creationData.emitter->getForceMin(),creationData.emitter->getForceMax()) / particle.getParam(PARAM_MASS);
-				creationData.emitter->generateVelocity(particle,speed);
-			}
+				creationData.emitter->initVelocities(*this,index,index + nb);
 			else
-				particle.velocity() = creationData.velocity;
-
-			--creationBuffer.front().nb;
-			--nbManualBorn;
-			--nbBufferedParticles;
-			if (creationBuffer.front().nb <= 0)
+				for (size_t i = index; i < index + nb; ++i)
+					particleData.velocities[i] = creationData.velocity;
+
+			index += nb;
+			creationData.nb -= static_cast<unsigned int>(nb);
+			nbManualBorn -= nb;
+			nbBufferedParticles -= nb;
+			if (creationData.nb <= 0)
 				creationBuffer.pop_front();
 		}
 
-		particleData.oldPositions[index] = particleData.positions[index];
-
-		for (std::vector<WeakModifierDef>::iterator it = initModifiers.begin(); it != initModifiers.end(); ++it)
-			it->obj->init(particle,it->dataSet);
-
-		if (particle.isAlive())
+		while (index < end)
 		{
-			if (renderer.obj && renderer.obj->isActive())
-				renderer.obj->init(particle,renderer.dataSet);
+			WeakEmitterPair& emitter = activeEmitters[emitterIndex];
+			const size_t nb = std::min(emitter.nbBorn,end - index);
 
-			// birth action
-			if (birthAction && birthAction->isActive())
-				birthAction->apply(particle);
+			emitter.obj->emitBatch(*this,index,index + nb,radii + index - start);
 
-			return true;
+			index += nb;
+			if ((emitter.nbBorn -= nb) == 0)
+				++emitterIndex;
 		}
-		else
+
+		std::memcpy(particleData.oldPositions + start,particleData.positions + start,(end - start) * sizeof(Vector3D));
+
+		for (std::vector<WeakModifierDef>::iterator it = initModifiers.begin(); it != initModifiers.end(); ++it)
+			it->obj->initBatch(*this,it->dataSet,start,end);
+
+		for (size_t i = start; i < end; ++i)
 		{
-			SPK_LOG_DEBUG("Particle " << index << " of Group " << this << " is born-dead");
-			return false; // No birth neither death actions on born-dead particles
+			Particle particle(getParticle(i));
+			if (particle.isAlive())
+			{
+				if (renderer.obj && renderer.obj->isActive())
+					renderer.obj->init(particle,renderer.dataSet);
+
+				// birth action
+				if (birthAction && birthAction->isActive())
+					birthAction->apply(particle);
+			}
+			else
+			{
+				SPK_LOG_DEBUG("Particle " << i << " of Group " << this << " is born-dead");
+				deadIndices.push_back(i); // No birth neither death actions on born-dead particles
+			}
 		}
 	}
 
@@ -553,6 +921,56 @@ namespace SPK
 			it->swap(index0,index1);
 	}
 
+	void Group::compactParticles()
+	{
+		const size_t nbDead = deadIndices.size();
+		const size_t newNbParticles = particleData.nbParticles - nbDead;
+
+		// Fills the holes left by the dead particles before the new end with the alive particles after it.
+		// Dead indices are sorted so the alive particles are taken from the end while skipping the dead ones.
+		compactionMoves.clear();
+		size_t source = particleData.nbParticles;
+		size_t lastDead = nbDead;
+		for (size_t i = 0; i < nbDead && deadIndices[i] < newNbParticles; ++i)
+		{
+			--source;
+			while (lastDead > 0 && deadIndices[lastDead - 1] == source)
+			{
+				--lastDead;
+				--source;
+			}
+
+			compactionMoves.push_back(source);
+			compactionMoves.push_back(deadIndices[i]);
+		}
+
+		const size_t nbMoves = compactionMoves.size() >> 1;
+		if (nbMoves > 0)
+		{
+			const size_t* moves = &compactionMoves[0];
+
+			// Compacts particles attributes, one array at a time
+			compactArray(particleData.positions,moves,nbMoves);
+			compactArray(particleData.velocities,moves,nbMoves);
+			compactArray(particleData.oldPositions,moves,nbMoves);
+			compactArray(particleData.ages,moves,nbMoves);
+			compactArray(particleData.energies,moves,nbMoves);
+			compactArray(particleData.lifeTimes,moves,nbMoves);
+			compactArray(particleData.sqrDists,moves,nbMoves);
+			compactArray(particleData.colors,moves,nbMoves);
+
+			// Compacts particles enabled parameters
+			for (size_t i = 0; i < nbEnabledParameters; ++i)
+				compactArray(particleData.parameters[enabledParamIndices[i]],moves,nbMoves);
+
+			// Compacts particles additionnal data
+			for (std::list<DataSet>::iterator it = dataSets.begin(); it != dataSets.end(); ++it)
+				it->compact(moves,nbMoves);
+		}
+
+		particleData.nbParticles = newNbParticles;
+	}
+
 	DataSet* Group::attachDataSet(DataHandler* dataHandler)
 	{
 		if (!isInitialized())
@@ -615,8 +1033,71 @@ namespace SPK
 
 	void Group::sortParticles()
 	{
-		if (sortingEnabled)
-			sortParticles(0,particleData.nbParticles - 1);
+		if (!sortingEnabled)
+			return;
+
+		const size_t nb = particleData.nbParticles;
+		if (nb < 2)
+		{
+			if (indexSortingEnabled)
+				sortedIndices.assign(nb,0);
+			return;
+		}
+
+		if (sortingMode == SORTING_QUICK && !indexSortingEnabled)
+		{
+			sortParticles(0,nb - 1);
+			return;
+		}
+
+		sortOrder.resize(nb);
+		if (indexSortingEnabled && sortingMode == SORTING_INCREMENTAL)
+		{
+			// Particles are not moved so the previous order is held by the sorted indices.
+			// Indices are only used as a starting order : those of particles removed since are dropped and those of new particles are appended
+			size_t nbIndices = 0;
+			for (size_t i = 0; i < sortedIndices.size(); ++i)
+				if (sortedIndices[i] < nb)
+					sortOrder[nbIndices++] = sortedIndices[i];
+			for (size_t i = sortedIndices.size(); i < nb; ++i)
+				sortOrder[nbIndices++] = i;
+		}
+		else
+			for (size_t i = 0; i < nb; ++i)
+				sortOrder[i] = i;
+
+		// Maps the distances to unsigned integers whose ascending order is the descending order of the distances
+		sortKeys.resize(nb);
+		for (size_t i = 0; i < nb; ++i)
+		{
+			unsigned int bits;
+			std::memcpy(&bits,particleData.sqrDists + sortOrder[i],sizeof(float));
+			sortKeys[i] = (bits & 0x80000000) != 0 ? bits : ~bits & 0x7FFFFFFF;
+		}
+
+		sortKeysBuffer.resize(nb);
+		sortOrderBuffer.resize(nb);
+		if ((sortingMode != SORTING_INCREMENTAL || !sortOrderIncrementally())
+			&& radixSort(&sortKeys[0],&sortOrder[0],&sortKeysBuffer[0],&sortOrderBuffer[0],nb))
+		{
+			sortKeys.swap(sortKeysBuffer);
+			sortOrder.swap(sortOrderBuffer);
+		}
+
+		if (indexSortingEnabled)
+		{
+			sortedIndices.resize(nb);
+			for (size_t i = 0; i < nb; ++i)
+				sortedIndices[i] = static_cast<unsigned int>(sortOrder[i]);
+			return;
+		}
+
+		for (size_t i = 0; i < nb; ++i)
+			if (sortOrder[i] != i)
+			{
+				reorderParticles();
+				break;
+			}
 	}
 
 	void Group::computeAABB()
@@ -627,6 +1108,7 @@ namespace SPK
 
 		if (renderer.obj && renderer.obj->isActive())
 		{
+			BlockAllocator::Scope allocatorScope(getAllocator());
 			renderer.obj->prepareData(*this,renderer.dataSet);
 			renderer.obj->computeAABB(AABBMin,AABBMax,*this,renderer.dataSet);
 		}
@@ -662,6 +1144,152 @@ namespace SPK
 		}
 	}
 
+	bool Group::sortOrderIncrementally()
+	{
+		// Particles were sorted by the previous update so most of them are expected to move by a few positions only.
+		// They are sorted in place by insertion whereas the particles too far from their place are set apart in the buffers
+		const size_t nb = particleData.nbParticles;
+		unsigned int* keys = &sortKeys[0];
+		size_t* order = &sortOrder[0];
+		unsigned int* outlierKeys = &sortKeysBuffer[0];
+		size_t* outlierOrder = &sortOrderBuffer[0];
+		size_t nbSorted = 0;
+		size_t nbOutliers = 0;
+
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const unsigned int key = keys[i];
+			const size_t index = order[i];
+
+			size_t j = nbSorted;
+			const size_t minJ = j > MAX_INCREMENTAL_SHIFTS ? j - MAX_INCREMENTAL_SHIFTS : 0;
+			while (j > minJ && keys[j - 1] > key)
+				--j;
+
+			if (j > 0 && keys[j - 1] > key)
+			{
+				outlierKeys[nbOutliers] = key;
+				outlierOrder[nbOutliers] = index;
+				if (++nbOutliers > nb >> 2)
+				{
+					// Too many particles moved, the outliers are put back in the free slots so that the radix sort can go on from there
+					std::memcpy(keys + nbSorted,outlierKeys,nbOutliers * sizeof(unsigned int));
+					std::memcpy(order + nbSorted,outlierOrder,nbOutliers * sizeof(size_t));
+					return false;
+				}
+				continue;
+			}
+
+			for (size_t k = nbSorted; k > j; --k)
+			{
+				keys[k] = keys[k - 1];
+				order[k] = order[k - 1];
+			}
+			keys[j] = key;
+			order[j] = index;
+			++nbSorted;
+		}
+
+		if (nbOutliers == 0)
+			return true;
+
+		// Sorts the outliers using the free slots at the end of the arrays as buffers and moves them there
+		unsigned int* sortedKeys = keys + nbSorted;
+		size_t* sortedOrder = order + nbSorted;
+		if (!radixSort(outlierKeys,outlierOrder,sortedKeys,sortedOrder,nbOutliers))
+		{
+			std::memcpy(sortedKeys,outlierKeys,nbOutliers * sizeof(unsigned int));
+			std::memcpy(sortedOrder,outlierOrder,nbOutliers * sizeof(size_t));
+		}
+
+		// Merges the 2 sorted sequences in the buffers
+		size_t i0 = 0;
+		size_t i1 = nbSorted;
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const size_t src = i1 == nb || (i0 < nbSorted && keys[i0] <= keys[i1]) ? i0++ : i1++;
+			outlierKeys[i] = keys[src];
+			outlierOrder[i] = order[src];
+		}
+
+		sortKeys.swap(sortKeysBuffer);
+		sortOrder.swap(sortOrderBuffer);
+		return true;
+	}
+
+	bool Group::radixSort(unsigned int* keys,size_t* order,unsigned int* keysBuffer,size_t* orderBuffer,size_t nb)
+	{
+		const size_t NB_BUCKETS = 1 << RADIX_BITS;
+		const size_t NB_PASSES = (32 + RADIX_BITS - 1) / RADIX_BITS;
+
+		// Counts the digits of all the passes at once
+		size_t counts[NB_PASSES][NB_BUCKETS] = {};
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const unsigned int key = keys[i];
+			for (size_t pass = 0; pass < NB_PASSES; ++pass)
+				++counts[pass][(key >> (pass * RADIX_BITS)) & (NB_BUCKETS - 1)];
+		}
+
+		bool inBuffers = false;
+		for (size_t pass = 0; pass < NB_PASSES; ++pass)
+		{
+			// A pass where all the keys share the same digit would not change anything
+			const size_t shift = pass * RADIX_BITS;
+			if (counts[pass][(keys[0] >> shift) & (NB_BUCKETS - 1)] == nb)
+				continue;
+
+			size_t offsets[NB_BUCKETS];
+			size_t offset = 0;
+			for (size_t i = 0; i < NB_BUCKETS; ++i)
+			{
+				offsets[i] = offset;
+				offset += counts[pass][i];
+			}
+
+			for (size_t i = 0; i < nb; ++i)
+			{
+				const size_t dst = offsets[(keys[i] >> shift) & (NB_BUCKETS - 1)]++;
+				keysBuffer[dst] = keys[i];
+				orderBuffer[dst] = order[i];
+			}
+
+			std::swap(keys,keysBuffer);
+			std::swap(order,orderBuffer);
+			inBuffers = !inBuffers;
+		}
+
+		return inBuffers;
+	}
+
+	void Group::reorderParticles()
+	{
+		const size_t nb = particleData.nbParticles;
+		const size_t* order = &sortOrder[0];
+
+		// The buffer is large enough for the largest attribute
+		sortBuffer.resize(nb * sizeof(Vector3D));
+		void* buffer = &sortBuffer[0];
+
+		// Moves particles attributes, one array at a time
+		reorderArray(particleData.positions,order,nb,buffer);
+		reorderArray(particleData.velocities,order,nb,buffer);
+		reorderArray(particleData.oldPositions,order,nb,buffer);
+		reorderArray(particleData.ages,order,nb,buffer);
+		reorderArray(particleData.energies,order,nb,buffer);
+		reorderArray(particleData.lifeTimes,order,nb,buffer);
+		reorderArray(particleData.sqrDists,order,nb,buffer);
+		reorderArray(particleData.colors,order,nb,buffer);
+
+		// Moves particles enabled parameters
+		for (size_t i = 0; i < nbEnabledParameters; ++i)
+			reorderArray(particleData.parameters[enabledParamIndices[i]],order,nb,buffer);
+
+		// Moves particles additionnal data
+		for (std::list<DataSet>::iterator it = dataSets.begin(); it != dataSets.end(); ++it)
+			it->reorder(order,nb);
+	}
+
 	void Group::propagateUpdateTransform()
 	{
 		for (std::vector<Ref<Emitter> >::const_iterator it = emitters.begin(); it != emitters.end(); ++it)
@@ -764,6 +1392,11 @@ namespace SPK
 
 		SPK_ASSERT(isInitialized(),"Group::addParticles(unsigned int,const Vector3D&,const Vector3D&,Zone*,Emitter*,bool) - Particles cannot be added to an uninitialized group");
 
+		// Only the particles added from outside of the update of the system are recorded
+		SystemRecorder* recorder = system != NULL ? system->getExternalRecorder() : NULL;
+		if (recorder != NULL)
+			recorder->recordAddition(*this,nb,position,velocity,zone,emitter,full);
+
 		CreationData data = {nb,position,velocity,zone,emitter,full};
 		creationBuffer.push_back(data);
 		nbBufferedParticles += nb;
@@ -774,18 +1407,36 @@ namespace SPK
 		if (nbBufferedParticles == 0)
 			return;
 
+		SystemRecorder* recorder = system != NULL ? system->getExternalRecorder() : NULL;
+		if (recorder != NULL)
+			recorder->recordFlush(*this);
+
+		RandomGenerator::Scope randomScope(randomGenerator);
 		prepareAdditionnalData();
 
 		size_t nbManualBorn = nbBufferedParticles;
 
-		size_t dummy;
-		while (nbManualBorn > 0 && particleData.maxParticles - particleData.nbParticles > 0)
-			if (!initParticle(particleData.nbParticles++,dummy,nbManualBorn))
-				--particleData.nbParticles;
+		size_t dummy = 0;
+		const size_t nbBorn = std::min(nbManualBorn,particleData.maxParticles - particleData.nbParticles);
+		if (nbBorn > 0)
+		{
+			const size_t start = particleData.nbParticles;
+			particleData.nbParticles += nbBorn;
+
+			deadIndices.clear();
+			initParticles(start,particleData.nbParticles,dummy,nbManualBorn);
+			if (!deadIndices.empty())
+				compactParticles();
+		}
 
 		emptyBufferedParticles();
 	}
 
+	ThreadPool* Group::getThreadPool() const
+	{
+		return system->getThreadPool();
+	}
+
 	void Group::emptyBufferedParticles()
 	{
 		creationBuffer.clear();
@@ -794,6 +1445,9 @@ namespace SPK
 
 	inline void Group::prepareAdditionnalData()
 	{
+		// The data created by the data handlers are allocated by the allocator of the system
+		BlockAllocator::Scope allocatorScope(getAllocator());
+
 		if (renderer.obj)
 			renderer.obj->prepareData(*this,renderer.dataSet);
 
@@ -812,6 +1466,7 @@ namespace SPK
 		}
 
 		manageOctreeInstance(needsOctree);
+		compileModifierPipeline();
 
 		if (colorInterpolator.obj)
 			colorInterpolator.obj->prepareData(*this,colorInterpolator.dataSet);
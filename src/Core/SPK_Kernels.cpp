@@ -0,0 +1,953 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm> // for min
+#include <cmath> // for floor and fabs
+#include <cstring>
+
+#include <SPARK_Core.h>
+
+#ifdef SPK_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef SPK_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+namespace SPK
+{
+	namespace
+	{
+#if defined(SPK_SIMD_AVX2)
+		const InstructionSet BEST_INSTRUCTION_SET = INSTRUCTION_SET_AVX2;
+#elif defined(SPK_SIMD_SSE2)
+		const InstructionSet BEST_INSTRUCTION_SET = INSTRUCTION_SET_SSE2;
+#else
+		const InstructionSet BEST_INSTRUCTION_SET = INSTRUCTION_SET_SCALAR;
+#endif
+
+		// Constants of the single precision sine and cosine of the cephes library
+		// The angles are reduced to [-PI/4,PI/4] by subtracting a multiple of PI/4 split in 3 parts to keep the precision
+		const float FOUR_OVER_PI = 1.27323954473516f;
+		const float DP1 = -0.78515625f;
+		const float DP2 = -2.4187564849853515625e-4f;
+		const float DP3 = -3.77489497744594108e-8f;
+		const float SIN_P0 = -1.9515295891e-4f;
+		const float SIN_P1 = 8.3321608736e-3f;
+		const float SIN_P2 = -1.6666654611e-1f;
+		const float COS_P0 = 2.443315711809948e-5f;
+		const float COS_P1 = -1.388731625493765e-3f;
+		const float COS_P2 = 4.166664568298827e-2f;
+
+		// Constants of the simplex noise
+		// The space is skewed to be cut in tetrahedrons whose corners are hashed to the gradients of the noise
+		const float NOISE_SKEW = 1.0f / 3.0f;
+		const float NOISE_UNSKEW = 1.0f / 6.0f;
+		const float NOISE_UNSKEW2 = 2.0f / 6.0f;
+		const float NOISE_UNSKEW3 = 3.0f / 6.0f;
+		const float NOISE_SQR_RADIUS = 0.5f; // the square radius of influence of a corner
+		const float NOISE_SCALE = 62.0f; // brings the noise within about [-1,1]
+		const uint32 NOISE_PRIMES[3] = { 0x8da6b343u,0xd8163841u,0xcb1ab31fu };
+		const uint32 NOISE_MIX = 0x7feb352du;
+
+		// Scalar kernels
+		// They are also used for the remainders of the vectorized kernels
+
+		void addScalar(float* data,float value,size_t nb)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				data[i] += value;
+		}
+
+		void multiplyScalar(float* data,float value,size_t nb)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				data[i] *= value;
+		}
+
+		void computeEnergiesScalar(float* energies,const float* ages,const float* lifeTimes,size_t nb)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				energies[i] = 1.0f - ages[i] / lifeTimes[i];
+		}
+
+		void integrateScalar(float* positions,const float* velocities,float deltaTime,size_t nb)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				positions[i] += velocities[i] * deltaTime;
+		}
+
+		void toStreamsScalar(const Vector3D* vectors,float* x,float* y,float* z,size_t nb)
+		{
+			for (size_t i = 0; i < nb; ++i)
+			{
+				x[i] = vectors[i].x;
+				y[i] = vectors[i].y;
+				z[i] = vectors[i].z;
+			}
+		}
+
+		void fromStreamsScalar(const float* x,const float* y,const float* z,Vector3D* vectors,size_t nb)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				vectors[i].set(x[i],y[i],z[i]);
+		}
+
+		void computeDistancesScalar(const Vector3D* positions,const Vector3D& origin,const Vector3D& axis,float* distances,size_t nb)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				distances[i] = dotProduct(axis,positions[i] - origin);
+		}
+
+		void computeSqrDistancesScalar(const Vector3D* positions,const Vector3D& center,float* sqrDistances,size_t nb)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				sqrDistances[i] = getSqrDist(positions[i],center);
+		}
+
+		void computeSinCosScalar(const float* angles,float* sines,float* cosines,size_t nb)
+		{
+			// The polynoms and signs are selected by indexing rather than by branches as the octants of successive angles are often random
+			static const float SIGNS[2] = { 1.0f,-1.0f };
+
+			for (size_t i = 0; i < nb; ++i)
+			{
+				const float angle = angles[i];
+				float x = std::fabs(angle);
+				const int octant = (static_cast<int>(x * FOUR_OVER_PI) + 1) & ~1;
+				const float y = static_cast<float>(octant);
+				x = ((x + y * DP1) + y * DP2) + y * DP3;
+
+				const float z = x * x;
+				const float cosPoly = ((COS_P0 * z + COS_P1) * z + COS_P2) * z * z - z * 0.5f + 1.0f;
+				const float sinPoly = ((SIN_P0 * z + SIN_P1) * z + SIN_P2) * z * x + x;
+
+				const float polys[2] = { sinPoly,cosPoly };
+				const int swap = (octant >> 1) & 1;
+				sines[i] = polys[swap] * SIGNS[((octant >> 2) ^ (angle < 0.0f ? 1 : 0)) & 1];
+				cosines[i] = polys[swap ^ 1] * SIGNS[(~(octant - 2) >> 2) & 1];
+			}
+		}
+
+		void sampleGridScalar(const float* nodes,size_t nbX,size_t nbY,size_t nbZ,const float* x,const float* y,const float* z,float* vx,float* vy,float* vz,size_t nb)
+		{
+			const size_t strideY = nbX * 4;
+			const size_t strideZ = nbX * nbY * 4;
+			float* const outputs[3] = { vx,vy,vz };
+
+			for (size_t i = 0; i < nb; ++i)
+			{
+				// The points on the upper borders are interpolated in the last cells
+				const size_t cellX = std::min(static_cast<size_t>(x[i]),nbX - 2);
+				const size_t cellY = std::min(static_cast<size_t>(y[i]),nbY - 2);
+				const size_t cellZ = std::min(static_cast<size_t>(z[i]),nbZ - 2);
+				const float fx = x[i] - cellX;
+				const float fy = y[i] - cellY;
+				const float fz = z[i] - cellZ;
+
+				const float* n = nodes + cellX * 4 + cellY * strideY + cellZ * strideZ;
+				for (size_t j = 0; j < 3; ++j)
+				{
+					const float v00 = n[j] + (n[4 + j] - n[j]) * fx;
+					const float v10 = n[strideY + j] + (n[strideY + 4 + j] - n[strideY + j]) * fx;
+					const float v01 = n[strideZ + j] + (n[strideZ + 4 + j] - n[strideZ + j]) * fx;
+					const float v11 = n[strideZ + strideY + j] + (n[strideZ + strideY + 4 + j] - n[strideZ + strideY + j]) * fx;
+					const float v0 = v00 + (v10 - v00) * fy;
+					const float v1 = v01 + (v11 - v01) * fy;
+					outputs[j][i] = v0 + (v1 - v0) * fz;
+				}
+			}
+		}
+
+		inline uint32 hashNoiseCorner(uint32 h)
+		{
+			h ^= h >> 16;
+			h *= NOISE_MIX;
+			return h ^ (h >> 15);
+		}
+
+		// Finds the simplex containing a point
+		// The hashes of the lattice points at its 4 corners and the positions of the point relative to them are returned
+		inline void findNoiseSimplexScalar(float x,float y,float z,uint32* hashes,float* cornersX,float* cornersY,float* cornersZ)
+		{
+			// The cell of the point is found in the skewed space
+			const float s = (x + y + z) * NOISE_SKEW;
+			const float i = std::floor(x + s);
+			const float j = std::floor(y + s);
+			const float k = std::floor(z + s);
+			const float t = (i + j + k) * NOISE_UNSKEW;
+			const float x0 = x - (i - t);
+			const float y0 = y - (j - t);
+			const float z0 = z - (k - t);
+
+			// The order of the coordinates within the cell gives its simplex
+			const bool a = x0 >= y0;
+			const bool b = y0 >= z0;
+			const bool c = x0 >= z0;
+			const bool i1 = a && c;
+			const bool j1 = !a && b;
+			const bool k1 = !i1 && !j1;
+			const bool i2 = a || c;
+			const bool j2 = !a || b;
+			const bool k2 = !(b && c);
+
+			const uint32 hx = static_cast<uint32>(static_cast<int>(i)) * NOISE_PRIMES[0];
+			const uint32 hy = static_cast<uint32>(static_cast<int>(j)) * NOISE_PRIMES[1];
+			const uint32 hz = static_cast<uint32>(static_cast<int>(k)) * NOISE_PRIMES[2];
+			hashes[0] = hx ^ hy ^ hz;
+			hashes[1] = (hx + (i1 ? NOISE_PRIMES[0] : 0)) ^ (hy + (j1 ? NOISE_PRIMES[1] : 0)) ^ (hz + (k1 ? NOISE_PRIMES[2] : 0));
+			hashes[2] = (hx + (i2 ? NOISE_PRIMES[0] : 0)) ^ (hy + (j2 ? NOISE_PRIMES[1] : 0)) ^ (hz + (k2 ? NOISE_PRIMES[2] : 0));
+			hashes[3] = (hx + NOISE_PRIMES[0]) ^ (hy + NOISE_PRIMES[1]) ^ (hz + NOISE_PRIMES[2]);
+
+			cornersX[0] = x0;
+			cornersY[0] = y0;
+			cornersZ[0] = z0;
+			cornersX[1] = x0 - (i1 ? 1.0f : 0.0f) + NOISE_UNSKEW;
+			cornersY[1] = y0 - (j1 ? 1.0f : 0.0f) + NOISE_UNSKEW;
+			cornersZ[1] = z0 - (k1 ? 1.0f : 0.0f) + NOISE_UNSKEW;
+			cornersX[2] = x0 - (i2 ? 1.0f : 0.0f) + NOISE_UNSKEW2;
+			cornersY[2] = y0 - (j2 ? 1.0f : 0.0f) + NOISE_UNSKEW2;
+			cornersZ[2] = z0 - (k2 ? 1.0f : 0.0f) + NOISE_UNSKEW2;
+			cornersX[3] = x0 - 1.0f + NOISE_UNSKEW3;
+			cornersY[3] = y0 - 1.0f + NOISE_UNSKEW3;
+			cornersZ[3] = z0 - 1.0f + NOISE_UNSKEW3;
+		}
+
+		// Gets the gradient of a corner from 3 bits of its hash
+		// The 8 possible values give the directions to the corners of a cube so that the products by the gradient are only changes of signs
+		inline void getNoiseGradientScalar(uint32 h,float& gx,float& gy,float& gz)
+		{
+			gx = (h & 1) != 0 ? -1.0f : 1.0f;
+			gy = (h & 2) != 0 ? -1.0f : 1.0f;
+			gz = (h & 4) != 0 ? -1.0f : 1.0f;
+		}
+
+		// Gets the gradient of the noise due to a corner
+		inline void getNoiseSlopeScalar(uint32 h,float x,float y,float z,float falloff,float derivative,float* slope)
+		{
+			float gx,gy,gz;
+			getNoiseGradientScalar(h,gx,gy,gz);
+			const float d = derivative * (gx * x + gy * y + gz * z);
+			slope[0] = d * x + falloff * gx;
+			slope[1] = d * y + falloff * gy;
+			slope[2] = d * z + falloff * gz;
+		}
+
+		// Gets the falloff t^4 of a corner and the factor -8t^3 giving its derivative along with the relative position
+		inline void getNoiseFalloffScalar(float x,float y,float z,float& falloff,float& derivative)
+		{
+			float t = NOISE_SQR_RADIUS - x * x - y * y - z * z;
+			t = t > 0.0f ? t : 0.0f;
+			const float t2 = t * t;
+			falloff = t2 * t2;
+			derivative = -8.0f * (t2 * t);
+		}
+
+		void computeNoiseScalar(const float* x,const float* y,const float* z,float* values,float* gx,float* gy,float* gz,size_t nb)
+		{
+			uint32 hashes[4];
+			float cornersX[4];
+			float cornersY[4];
+			float cornersZ[4];
+
+			for (size_t n = 0; n < nb; ++n)
+			{
+				findNoiseSimplexScalar(x[n],y[n],z[n],hashes,cornersX,cornersY,cornersZ);
+
+				float value = 0.0f;
+				float dx = 0.0f;
+				float dy = 0.0f;
+				float dz = 0.0f;
+				for (size_t c = 0; c < 4; ++c)
+				{
+					float falloff,derivative,gx,gy,gz;
+					getNoiseFalloffScalar(cornersX[c],cornersY[c],cornersZ[c],falloff,derivative);
+					getNoiseGradientScalar(hashNoiseCorner(hashes[c]),gx,gy,gz);
+					const float dot = gx * cornersX[c] + gy * cornersY[c] + gz * cornersZ[c];
+					const float d = derivative * dot;
+					value += falloff * dot;
+					dx += d * cornersX[c] + falloff * gx;
+					dy += d * cornersY[c] + falloff * gy;
+					dz += d * cornersZ[c] + falloff * gz;
+				}
+
+				values[n] = value * NOISE_SCALE;
+				gx[n] = dx * NOISE_SCALE;
+				gy[n] = dy * NOISE_SCALE;
+				gz[n] = dz * NOISE_SCALE;
+			}
+		}
+
+		void computeCurlNoiseScalar(const float* x,const float* y,const float* z,float* cx,float* cy,float* cz,size_t nb)
+		{
+			uint32 hashes[4];
+			float cornersX[4];
+			float cornersY[4];
+			float cornersZ[4];
+
+			for (size_t n = 0; n < nb; ++n)
+			{
+				findNoiseSimplexScalar(x[n],y[n],z[n],hashes,cornersX,cornersY,cornersZ);
+
+				float curlX = 0.0f;
+				float curlY = 0.0f;
+				float curlZ = 0.0f;
+				for (size_t c = 0; c < 4; ++c)
+				{
+					float falloff,derivative;
+					getNoiseFalloffScalar(cornersX[c],cornersY[c],cornersZ[c],falloff,derivative);
+
+					// The gradients of the 3 coordinates of the potential are taken from distinct bits of the same hash
+					const uint32 hash = hashNoiseCorner(hashes[c]);
+					float slopeX[3],slopeY[3],slopeZ[3];
+					getNoiseSlopeScalar(hash,cornersX[c],cornersY[c],cornersZ[c],falloff,derivative,slopeX);
+					getNoiseSlopeScalar(hash >> 3,cornersX[c],cornersY[c],cornersZ[c],falloff,derivative,slopeY);
+					getNoiseSlopeScalar(hash >> 6,cornersX[c],cornersY[c],cornersZ[c],falloff,derivative,slopeZ);
+
+					// curl(P) = (dPz/dy - dPy/dz,dPx/dz - dPz/dx,dPy/dx - dPx/dy)
+					curlX += slopeZ[1] - slopeY[2];
+					curlY += slopeX[2] - slopeZ[0];
+					curlZ += slopeY[0] - slopeX[1];
+				}
+
+				cx[n] = curlX * NOISE_SCALE;
+				cy[n] = curlY * NOISE_SCALE;
+				cz[n] = curlZ * NOISE_SCALE;
+			}
+		}
+
+#ifdef SPK_SIMD_SSE2
+		// SSE2 kernels (4 floats at once)
+
+		void addSSE2(float* data,float value,size_t nb)
+		{
+			const __m128 v = _mm_set1_ps(value);
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4)
+				_mm_storeu_ps(data + i,_mm_add_ps(_mm_loadu_ps(data + i),v));
+			addScalar(data + i,value,nb - i);
+		}
+
+		void multiplySSE2(float* data,float value,size_t nb)
+		{
+			const __m128 v = _mm_set1_ps(value);
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4)
+				_mm_storeu_ps(data + i,_mm_mul_ps(_mm_loadu_ps(data + i),v));
+			multiplyScalar(data + i,value,nb - i);
+		}
+
+		void computeEnergiesSSE2(float* energies,const float* ages,const float* lifeTimes,size_t nb)
+		{
+			const __m128 one = _mm_set1_ps(1.0f);
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4)
+				_mm_storeu_ps(energies + i,_mm_sub_ps(one,_mm_div_ps(_mm_loadu_ps(ages + i),_mm_loadu_ps(lifeTimes + i))));
+			computeEnergiesScalar(energies + i,ages + i,lifeTimes + i,nb - i);
+		}
+
+		void integrateSSE2(float* positions,const float* velocities,float deltaTime,size_t nb)
+		{
+			const __m128 dt = _mm_set1_ps(deltaTime);
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4)
+				_mm_storeu_ps(positions + i,_mm_add_ps(_mm_loadu_ps(positions + i),_mm_mul_ps(_mm_loadu_ps(velocities + i),dt)));
+			integrateScalar(positions + i,velocities + i,deltaTime,nb - i);
+		}
+
+		// 4 vectors (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) are transposed at once with shuffles
+		inline void loadVectorsSSE2(const float* data,__m128& x,__m128& y,__m128& z)
+		{
+			__m128 a = _mm_loadu_ps(data);
+			__m128 b = _mm_loadu_ps(data + 4);
+			__m128 c = _mm_loadu_ps(data + 8);
+			x = _mm_shuffle_ps(a,_mm_shuffle_ps(b,c,_MM_SHUFFLE(1,1,2,2)),_MM_SHUFFLE(2,0,3,0));
+			y = _mm_shuffle_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(0,0,1,1)),_mm_shuffle_ps(b,c,_MM_SHUFFLE(2,2,3,3)),_MM_SHUFFLE(2,0,2,0));
+			z = _mm_shuffle_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(1,1,2,2)),c,_MM_SHUFFLE(3,0,2,0));
+		}
+
+		void toStreamsSSE2(const Vector3D* vectors,float* x,float* y,float* z,size_t nb)
+		{
+			const float* data = reinterpret_cast<const float*>(vectors);
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4, data += 12)
+			{
+				__m128 vx,vy,vz;
+				loadVectorsSSE2(data,vx,vy,vz);
+				_mm_storeu_ps(x + i,vx);
+				_mm_storeu_ps(y + i,vy);
+				_mm_storeu_ps(z + i,vz);
+			}
+			toStreamsScalar(vectors + i,x + i,y + i,z + i,nb - i);
+		}
+
+		void fromStreamsSSE2(const float* x,const float* y,const float* z,Vector3D* vectors,size_t nb)
+		{
+			float* data = reinterpret_cast<float*>(vectors);
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4, data += 12)
+			{
+				__m128 vx = _mm_loadu_ps(x + i);
+				__m128 vy = _mm_loadu_ps(y + i);
+				__m128 vz = _mm_loadu_ps(z + i);
+				_mm_storeu_ps(data,_mm_shuffle_ps(_mm_shuffle_ps(vx,vy,_MM_SHUFFLE(0,0,0,0)),_mm_shuffle_ps(vz,vx,_MM_SHUFFLE(1,1,0,0)),_MM_SHUFFLE(2,0,2,0)));
+				_mm_storeu_ps(data + 4,_mm_shuffle_ps(_mm_shuffle_ps(vy,vz,_MM_SHUFFLE(1,1,1,1)),_mm_shuffle_ps(vx,vy,_MM_SHUFFLE(2,2,2,2)),_MM_SHUFFLE(2,0,2,0)));
+				_mm_storeu_ps(data + 8,_mm_shuffle_ps(_mm_shuffle_ps(vz,vx,_MM_SHUFFLE(3,3,2,2)),_mm_shuffle_ps(vy,vz,_MM_SHUFFLE(3,3,3,3)),_MM_SHUFFLE(2,0,2,0)));
+			}
+			fromStreamsScalar(x + i,y + i,z + i,vectors + i,nb - i);
+		}
+
+		// The operations are done in the same order as in the scalar code so that the results are identical
+		void computeDistancesSSE2(const Vector3D* positions,const Vector3D& origin,const Vector3D& axis,float* distances,size_t nb)
+		{
+			const __m128 ox = _mm_set1_ps(origin.x);
+			const __m128 oy = _mm_set1_ps(origin.y);
+			const __m128 oz = _mm_set1_ps(origin.z);
+			const __m128 ax = _mm_set1_ps(axis.x);
+			const __m128 ay = _mm_set1_ps(axis.y);
+			const __m128 az = _mm_set1_ps(axis.z);
+
+			const float* data = reinterpret_cast<const float*>(positions);
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4, data += 12)
+			{
+				__m128 x,y,z;
+				loadVectorsSSE2(data,x,y,z);
+				__m128 d = _mm_add_ps(_mm_mul_ps(ax,_mm_sub_ps(x,ox)),_mm_mul_ps(ay,_mm_sub_ps(y,oy)));
+				_mm_storeu_ps(distances + i,_mm_add_ps(d,_mm_mul_ps(az,_mm_sub_ps(z,oz))));
+			}
+			computeDistancesScalar(positions + i,origin,axis,distances + i,nb - i);
+		}
+
+		void computeSqrDistancesSSE2(const Vector3D* positions,const Vector3D& center,float* sqrDistances,size_t nb)
+		{
+			const __m128 cx = _mm_set1_ps(center.x);
+			const __m128 cy = _mm_set1_ps(center.y);
+			const __m128 cz = _mm_set1_ps(center.z);
+
+			const float* data = reinterpret_cast<const float*>(positions);
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4, data += 12)
+			{
+				__m128 x,y,z;
+				loadVectorsSSE2(data,x,y,z);
+				x = _mm_sub_ps(x,cx);
+				y = _mm_sub_ps(y,cy);
+				z = _mm_sub_ps(z,cz);
+				__m128 d = _mm_add_ps(_mm_mul_ps(x,x),_mm_mul_ps(y,y));
+				_mm_storeu_ps(sqrDistances + i,_mm_add_ps(d,_mm_mul_ps(z,z)));
+			}
+			computeSqrDistancesScalar(positions + i,center,sqrDistances + i,nb - i);
+		}
+
+		void computeSinCosSSE2(const float* angles,float* sines,float* cosines,size_t nb)
+		{
+			const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4)
+			{
+				// Same operations as the scalar kernel, the signs of the results are set by flipping their sign bit
+				const __m128 a = _mm_loadu_ps(angles + i);
+				__m128 x = _mm_andnot_ps(signMask,a);
+				__m128i octants = _mm_cvttps_epi32(_mm_mul_ps(x,_mm_set1_ps(FOUR_OVER_PI)));
+				octants = _mm_and_si128(_mm_add_epi32(octants,_mm_set1_epi32(1)),_mm_set1_epi32(~1));
+				const __m128 y = _mm_cvtepi32_ps(octants);
+				x = _mm_add_ps(x,_mm_mul_ps(y,_mm_set1_ps(DP1)));
+				x = _mm_add_ps(x,_mm_mul_ps(y,_mm_set1_ps(DP2)));
+				x = _mm_add_ps(x,_mm_mul_ps(y,_mm_set1_ps(DP3)));
+
+				const __m128 z = _mm_mul_ps(x,x);
+				__m128 cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_P0),z),_mm_set1_ps(COS_P1));
+				cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly,z),_mm_set1_ps(COS_P2));
+				cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly,z),z);
+				cosPoly = _mm_add_ps(_mm_sub_ps(cosPoly,_mm_mul_ps(z,_mm_set1_ps(0.5f))),_mm_set1_ps(1.0f));
+				__m128 sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P0),z),_mm_set1_ps(SIN_P1));
+				sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly,z),_mm_set1_ps(SIN_P2));
+				sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly,z),x),x);
+
+				const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octants,_mm_set1_epi32(2)),_mm_set1_epi32(2)));
+				const __m128 sinSign = _mm_xor_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octants,_mm_set1_epi32(4)),29)),_mm_and_ps(a,signMask));
+				const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octants,_mm_set1_epi32(2)),_mm_set1_epi32(4)),29));
+
+				_mm_storeu_ps(sines + i,_mm_xor_ps(_mm_or_ps(_mm_and_ps(swap,cosPoly),_mm_andnot_ps(swap,sinPoly)),sinSign));
+				_mm_storeu_ps(cosines + i,_mm_xor_ps(_mm_or_ps(_mm_and_ps(swap,sinPoly),_mm_andnot_ps(swap,cosPoly)),cosSign));
+			}
+			computeSinCosScalar(angles + i,sines + i,cosines + i,nb - i);
+		}
+
+		inline __m128 lerpSSE2(__m128 a,__m128 b,__m128 f)
+		{
+			return _mm_add_ps(a,_mm_mul_ps(_mm_sub_ps(b,a),f));
+		}
+
+		// Interpolates the vector of a single point, the 3 coordinates being processed at once
+		inline __m128 sampleNodeSSE2(const float* nodes,size_t nbX,size_t nbY,size_t nbZ,size_t strideY,size_t strideZ,float x,float y,float z)
+		{
+			const size_t cellX = std::min(static_cast<size_t>(x),nbX - 2);
+			const size_t cellY = std::min(static_cast<size_t>(y),nbY - 2);
+			const size_t cellZ = std::min(static_cast<size_t>(z),nbZ - 2);
+			const __m128 fx = _mm_set1_ps(x - cellX);
+			const __m128 fy = _mm_set1_ps(y - cellY);
+			const __m128 fz = _mm_set1_ps(z - cellZ);
+
+			const float* n = nodes + cellX * 4 + cellY * strideY + cellZ * strideZ;
+			const __m128 v00 = lerpSSE2(_mm_loadu_ps(n),_mm_loadu_ps(n + 4),fx);
+			const __m128 v10 = lerpSSE2(_mm_loadu_ps(n + strideY),_mm_loadu_ps(n + strideY + 4),fx);
+			const __m128 v01 = lerpSSE2(_mm_loadu_ps(n + strideZ),_mm_loadu_ps(n + strideZ + 4),fx);
+			const __m128 v11 = lerpSSE2(_mm_loadu_ps(n + strideZ + strideY),_mm_loadu_ps(n + strideZ + strideY + 4),fx);
+			return lerpSSE2(lerpSSE2(v00,v10,fy),lerpSSE2(v01,v11,fy),fz);
+		}
+
+		void sampleGridSSE2(const float* nodes,size_t nbX,size_t nbY,size_t nbZ,const float* x,const float* y,const float* z,float* vx,float* vy,float* vz,size_t nb)
+		{
+			const size_t strideY = nbX * 4;
+			const size_t strideZ = nbX * nbY * 4;
+
+			size_t i = 0;
+			for (; i + 4 <= nb; i += 4)
+			{
+				// The vectors of 4 points are transposed into streams
+				__m128 v0 = sampleNodeSSE2(nodes,nbX,nbY,nbZ,strideY,strideZ,x[i],y[i],z[i]);
+				__m128 v1 = sampleNodeSSE2(nodes,nbX,nbY,nbZ,strideY,strideZ,x[i + 1],y[i + 1],z[i + 1]);
+				__m128 v2 = sampleNodeSSE2(nodes,nbX,nbY,nbZ,strideY,strideZ,x[i + 2],y[i + 2],z[i + 2]);
+				__m128 v3 = sampleNodeSSE2(nodes,nbX,nbY,nbZ,strideY,strideZ,x[i + 3],y[i + 3],z[i + 3]);
+				_MM_TRANSPOSE4_PS(v0,v1,v2,v3);
+				_mm_storeu_ps(vx + i,v0);
+				_mm_storeu_ps(vy + i,v1);
+				_mm_storeu_ps(vz + i,v2);
+			}
+			sampleGridScalar(nodes,nbX,nbY,nbZ,x + i,y + i,z + i,vx + i,vy + i,vz + i,nb - i);
+		}
+
+		// SSE2 has no multiplication of 32 bits integers : the even and odd lanes are multiplied separately
+		inline __m128i multiplySSE2(__m128i a,__m128i b)
+		{
+			const __m128i even = _mm_mul_epu32(a,b);
+			const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a,4),_mm_srli_si128(b,4));
+			return _mm_unpacklo_epi32(_mm_shuffle_epi32(even,_MM_SHUFFLE(0,0,2,0)),_mm_shuffle_epi32(odd,_MM_SHUFFLE(0,0,2,0)));
+		}
+
+		// SSE2 has no floor either : the truncation is corrected where it rounded up
+		inline __m128i floorSSE2(__m128 x,__m128& floored)
+		{
+			__m128i i = _mm_cvttps_epi32(x);
+			i = _mm_add_epi32(i,_mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i),x)));
+			floored = _mm_cvtepi32_ps(i);
+			return i;
+		}
+
+		inline __m128i hashNoiseCornerSSE2(__m128i h)
+		{
+			h = _mm_xor_si128(h,_mm_srli_epi32(h,16));
+			h = multiplySSE2(h,_mm_set1_epi32(static_cast<int>(NOISE_MIX)));
+			return _mm_xor_si128(h,_mm_srli_epi32(h,15));
+		}
+
+		inline void findNoiseSimplexSSE2(__m128 x,__m128 y,__m128 z,__m128i* hashes,__m128* cornersX,__m128* cornersY,__m128* cornersZ)
+		{
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 allSet = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			const __m128i primeX = _mm_set1_epi32(static_cast<int>(NOISE_PRIMES[0]));
+			const __m128i primeY = _mm_set1_epi32(static_cast<int>(NOISE_PRIMES[1]));
+			const __m128i primeZ = _mm_set1_epi32(static_cast<int>(NOISE_PRIMES[2]));
+
+			const __m128 s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(x,y),z),_mm_set1_ps(NOISE_SKEW));
+			__m128 i,j,k;
+			const __m128i hx = multiplySSE2(floorSSE2(_mm_add_ps(x,s),i),primeX);
+			const __m128i hy = multiplySSE2(floorSSE2(_mm_add_ps(y,s),j),primeY);
+			const __m128i hz = multiplySSE2(floorSSE2(_mm_add_ps(z,s),k),primeZ);
+			const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(i,j),k),_mm_set1_ps(NOISE_UNSKEW));
+			const __m128 x0 = _mm_sub_ps(x,_mm_sub_ps(i,t));
+			const __m128 y0 = _mm_sub_ps(y,_mm_sub_ps(j,t));
+			const __m128 z0 = _mm_sub_ps(z,_mm_sub_ps(k,t));
+
+			// The simplex is selected with masks instead of branches
+			const __m128 a = _mm_cmpge_ps(x0,y0);
+			const __m128 b = _mm_cmpge_ps(y0,z0);
+			const __m128 c = _mm_cmpge_ps(x0,z0);
+			const __m128 i1 = _mm_and_ps(a,c);
+			const __m128 j1 = _mm_andnot_ps(a,b);
+			const __m128 k1 = _mm_andnot_ps(_mm_or_ps(i1,j1),allSet);
+			const __m128 i2 = _mm_or_ps(a,c);
+			const __m128 j2 = _mm_or_ps(_mm_andnot_ps(a,allSet),b);
+			const __m128 k2 = _mm_andnot_ps(_mm_and_ps(b,c),allSet);
+
+			hashes[0] = _mm_xor_si128(_mm_xor_si128(hx,hy),hz);
+			hashes[1] = _mm_xor_si128(_mm_xor_si128(
+				_mm_add_epi32(hx,_mm_and_si128(_mm_castps_si128(i1),primeX)),
+				_mm_add_epi32(hy,_mm_and_si128(_mm_castps_si128(j1),primeY))),
+				_mm_add_epi32(hz,_mm_and_si128(_mm_castps_si128(k1),primeZ)));
+			hashes[2] = _mm_xor_si128(_mm_xor_si128(
+				_mm_add_epi32(hx,_mm_and_si128(_mm_castps_si128(i2),primeX)),
+				_mm_add_epi32(hy,_mm_and_si128(_mm_castps_si128(j2),primeY))),
+				_mm_add_epi32(hz,_mm_and_si128(_mm_castps_si128(k2),primeZ)));
+			hashes[3] = _mm_xor_si128(_mm_xor_si128(_mm_add_epi32(hx,primeX),_mm_add_epi32(hy,primeY)),_mm_add_epi32(hz,primeZ));
+
+			cornersX[0] = x0;
+			cornersY[0] = y0;
+			cornersZ[0] = z0;
+			cornersX[1] = _mm_add_ps(_mm_sub_ps(x0,_mm_and_ps(i1,one)),_mm_set1_ps(NOISE_UNSKEW));
+			cornersY[1] = _mm_add_ps(_mm_sub_ps(y0,_mm_and_ps(j1,one)),_mm_set1_ps(NOISE_UNSKEW));
+			cornersZ[1] = _mm_add_ps(_mm_sub_ps(z0,_mm_and_ps(k1,one)),_mm_set1_ps(NOISE_UNSKEW));
+			cornersX[2] = _mm_add_ps(_mm_sub_ps(x0,_mm_and_ps(i2,one)),_mm_set1_ps(NOISE_UNSKEW2));
+			cornersY[2] = _mm_add_ps(_mm_sub_ps(y0,_mm_and_ps(j2,one)),_mm_set1_ps(NOISE_UNSKEW2));
+			cornersZ[2] = _mm_add_ps(_mm_sub_ps(z0,_mm_and_ps(k2,one)),_mm_set1_ps(NOISE_UNSKEW2));
+			cornersX[3] = _mm_add_ps(_mm_sub_ps(x0,one),_mm_set1_ps(NOISE_UNSKEW3));
+			cornersY[3] = _mm_add_ps(_mm_sub_ps(y0,one),_mm_set1_ps(NOISE_UNSKEW3));
+			cornersZ[3] = _mm_add_ps(_mm_sub_ps(z0,one),_mm_set1_ps(NOISE_UNSKEW3));
+		}
+
+		// The gradients are sign masks : the products by the gradients are done with xors
+		inline void getNoiseGradientSSE2(__m128i h,__m128& sx,__m128& sy,__m128& sz)
+		{
+			sx = _mm_castsi128_ps(_mm_slli_epi32(h,31));
+			sy = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(h,1),31));
+			sz = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(h,2),31));
+		}
+
+		inline void getNoiseSlopeSSE2(__m128i h,__m128 x,__m128 y,__m128 z,__m128 falloff,__m128 derivative,__m128* slope)
+		{
+			__m128 sx,sy,sz;
+			getNoiseGradientSSE2(h,sx,sy,sz);
+			const __m128 d = _mm_mul_ps(derivative,_mm_add_ps(_mm_add_ps(_mm_xor_ps(x,sx),_mm_xor_ps(y,sy)),_mm_xor_ps(z,sz)));
+			slope[0] = _mm_add_ps(_mm_mul_ps(d,x),_mm_xor_ps(falloff,sx));
+			slope[1] = _mm_add_ps(_mm_mul_ps(d,y),_mm_xor_ps(falloff,sy));
+			slope[2] = _mm_add_ps(_mm_mul_ps(d,z),_mm_xor_ps(falloff,sz));
+		}
+
+		inline void getNoiseFalloffSSE2(__m128 x,__m128 y,__m128 z,__m128& falloff,__m128& derivative)
+		{
+			__m128 t = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_set1_ps(NOISE_SQR_RADIUS),_mm_mul_ps(x,x)),_mm_mul_ps(y,y)),_mm_mul_ps(z,z));
+			t = _mm_max_ps(t,_mm_setzero_ps());
+			const __m128 t2 = _mm_mul_ps(t,t);
+			falloff = _mm_mul_ps(t2,t2);
+			derivative = _mm_mul_ps(_mm_set1_ps(-8.0f),_mm_mul_ps(t2,t));
+		}
+
+		void computeNoiseSSE2(const float* x,const float* y,const float* z,float* values,float* gx,float* gy,float* gz,size_t nb)
+		{
+			const __m128 scale = _mm_set1_ps(NOISE_SCALE);
+			__m128i hashes[4];
+			__m128 cornersX[4];
+			__m128 cornersY[4];
+			__m128 cornersZ[4];
+
+			size_t n = 0;
+			for (; n + 4 <= nb; n += 4)
+			{
+				findNoiseSimplexSSE2(_mm_loadu_ps(x + n),_mm_loadu_ps(y + n),_mm_loadu_ps(z + n),hashes,cornersX,cornersY,cornersZ);
+
+				__m128 value = _mm_setzero_ps();
+				__m128 dx = _mm_setzero_ps();
+				__m128 dy = _mm_setzero_ps();
+				__m128 dz = _mm_setzero_ps();
+				for (size_t c = 0; c < 4; ++c)
+				{
+					__m128 falloff,derivative,sx,sy,sz;
+					getNoiseFalloffSSE2(cornersX[c],cornersY[c],cornersZ[c],falloff,derivative);
+					getNoiseGradientSSE2(hashNoiseCornerSSE2(hashes[c]),sx,sy,sz);
+					const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_xor_ps(cornersX[c],sx),_mm_xor_ps(cornersY[c],sy)),_mm_xor_ps(cornersZ[c],sz));
+					const __m128 d = _mm_mul_ps(derivative,dot);
+					value = _mm_add_ps(value,_mm_mul_ps(falloff,dot));
+					dx = _mm_add_ps(dx,_mm_add_ps(_mm_mul_ps(d,cornersX[c]),_mm_xor_ps(falloff,sx)));
+					dy = _mm_add_ps(dy,_mm_add_ps(_mm_mul_ps(d,cornersY[c]),_mm_xor_ps(falloff,sy)));
+					dz = _mm_add_ps(dz,_mm_add_ps(_mm_mul_ps(d,cornersZ[c]),_mm_xor_ps(falloff,sz)));
+				}
+
+				_mm_storeu_ps(values + n,_mm_mul_ps(value,scale));
+				_mm_storeu_ps(gx + n,_mm_mul_ps(dx,scale));
+				_mm_storeu_ps(gy + n,_mm_mul_ps(dy,scale));
+				_mm_storeu_ps(gz + n,_mm_mul_ps(dz,scale));
+			}
+			computeNoiseScalar(x + n,y + n,z + n,values + n,gx + n,gy + n,gz + n,nb - n);
+		}
+
+		void computeCurlNoiseSSE2(const float* x,const float* y,const float* z,float* cx,float* cy,float* cz,size_t nb)
+		{
+			const __m128 scale = _mm_set1_ps(NOISE_SCALE);
+			__m128i hashes[4];
+			__m128 cornersX[4];
+			__m128 cornersY[4];
+			__m128 cornersZ[4];
+
+			size_t n = 0;
+			for (; n + 4 <= nb; n += 4)
+			{
+				findNoiseSimplexSSE2(_mm_loadu_ps(x + n),_mm_loadu_ps(y + n),_mm_loadu_ps(z + n),hashes,cornersX,cornersY,cornersZ);
+
+				__m128 curlX = _mm_setzero_ps();
+				__m128 curlY = _mm_setzero_ps();
+				__m128 curlZ = _mm_setzero_ps();
+				for (size_t c = 0; c < 4; ++c)
+				{
+					__m128 falloff,derivative;
+					getNoiseFalloffSSE2(cornersX[c],cornersY[c],cornersZ[c],falloff,derivative);
+
+					const __m128i hash = hashNoiseCornerSSE2(hashes[c]);
+					__m128 slopeX[3],slopeY[3],slopeZ[3];
+					getNoiseSlopeSSE2(hash,cornersX[c],cornersY[c],cornersZ[c],falloff,derivative,slopeX);
+					getNoiseSlopeSSE2(_mm_srli_epi32(hash,3),cornersX[c],cornersY[c],cornersZ[c],falloff,derivative,slopeY);
+					getNoiseSlopeSSE2(_mm_srli_epi32(hash,6),cornersX[c],cornersY[c],cornersZ[c],falloff,derivative,slopeZ);
+
+					curlX = _mm_add_ps(curlX,_mm_sub_ps(slopeZ[1],slopeY[2]));
+					curlY = _mm_add_ps(curlY,_mm_sub_ps(slopeX[2],slopeZ[0]));
+					curlZ = _mm_add_ps(curlZ,_mm_sub_ps(slopeY[0],slopeX[1]));
+				}
+
+				_mm_storeu_ps(cx + n,_mm_mul_ps(curlX,scale));
+				_mm_storeu_ps(cy + n,_mm_mul_ps(curlY,scale));
+				_mm_storeu_ps(cz + n,_mm_mul_ps(curlZ,scale));
+			}
+			computeCurlNoiseScalar(x + n,y + n,z + n,cx + n,cy + n,cz + n,nb - n);
+		}
+#endif
+
+#ifdef SPK_SIMD_AVX2
+		// AVX2 kernels (8 floats at once)
+
+		void addAVX2(float* data,float value,size_t nb)
+		{
+			const __m256 v = _mm256_set1_ps(value);
+			size_t i = 0;
+			for (; i + 8 <= nb; i += 8)
+				_mm256_storeu_ps(data + i,_mm256_add_ps(_mm256_loadu_ps(data + i),v));
+			addScalar(data + i,value,nb - i);
+		}
+
+		void multiplyAVX2(float* data,float value,size_t nb)
+		{
+			const __m256 v = _mm256_set1_ps(value);
+			size_t i = 0;
+			for (; i + 8 <= nb; i += 8)
+				_mm256_storeu_ps(data + i,_mm256_mul_ps(_mm256_loadu_ps(data + i),v));
+			multiplyScalar(data + i,value,nb - i);
+		}
+
+		void computeEnergiesAVX2(float* energies,const float* ages,const float* lifeTimes,size_t nb)
+		{
+			const __m256 one = _mm256_set1_ps(1.0f);
+			size_t i = 0;
+			for (; i + 8 <= nb; i += 8)
+				_mm256_storeu_ps(energies + i,_mm256_sub_ps(one,_mm256_div_ps(_mm256_loadu_ps(ages + i),_mm256_loadu_ps(lifeTimes + i))));
+			computeEnergiesScalar(energies + i,ages + i,lifeTimes + i,nb - i);
+		}
+
+		void integrateAVX2(float* positions,const float* velocities,float deltaTime,size_t nb)
+		{
+			const __m256 dt = _mm256_set1_ps(deltaTime);
+			size_t i = 0;
+			for (; i + 8 <= nb; i += 8)
+				_mm256_storeu_ps(positions + i,_mm256_add_ps(_mm256_loadu_ps(positions + i),_mm256_mul_ps(_mm256_loadu_ps(velocities + i),dt)));
+			integrateScalar(positions + i,velocities + i,deltaTime,nb - i);
+		}
+#endif
+	}
+
+	InstructionSet Kernels::instructionSet = BEST_INSTRUCTION_SET;
+
+	bool Kernels::isInstructionSetSupported(InstructionSet instructionSet)
+	{
+		switch (instructionSet)
+		{
+		case INSTRUCTION_SET_SCALAR :
+			return true;
+#ifdef SPK_SIMD_SSE2
+		case INSTRUCTION_SET_SSE2 :
+			return true;
+#endif
+#ifdef SPK_SIMD_AVX2
+		case INSTRUCTION_SET_AVX2 :
+			return true;
+#endif
+		default :
+			return false;
+		}
+	}
+
+	bool Kernels::setInstructionSet(InstructionSet instructionSet)
+	{
+		if (!isInstructionSetSupported(instructionSet))
+		{
+			SPK_LOG_WARNING("Kernels::setInstructionSet(InstructionSet) - The instruction set " << instructionSet << " is not compiled. Call is ignored");
+			return false;
+		}
+
+		Kernels::instructionSet = instructionSet;
+		return true;
+	}
+
+	InstructionSet Kernels::getInstructionSet()
+	{
+		return instructionSet;
+	}
+
+	InstructionSet Kernels::getBestInstructionSet()
+	{
+		return BEST_INSTRUCTION_SET;
+	}
+
+	void Kernels::add(float* data,float value,size_t nb)
+	{
+		switch (instructionSet)
+		{
+#ifdef SPK_SIMD_AVX2
+		case INSTRUCTION_SET_AVX2 : addAVX2(data,value,nb); break;
+#endif
+#ifdef SPK_SIMD_SSE2
+		case INSTRUCTION_SET_SSE2 : addSSE2(data,value,nb); break;
+#endif
+		default : addScalar(data,value,nb); break;
+		}
+	}
+
+	void Kernels::multiply(float* data,float value,size_t nb)
+	{
+		switch (instructionSet)
+		{
+#ifdef SPK_SIMD_AVX2
+		case INSTRUCTION_SET_AVX2 : multiplyAVX2(data,value,nb); break;
+#endif
+#ifdef SPK_SIMD_SSE2
+		case INSTRUCTION_SET_SSE2 : multiplySSE2(data,value,nb); break;
+#endif
+		default : multiplyScalar(data,value,nb); break;
+		}
+	}
+
+	void Kernels::computeEnergies(float* energies,const float* ages,const float* lifeTimes,size_t nb)
+	{
+		switch (instructionSet)
+		{
+#ifdef SPK_SIMD_AVX2
+		case INSTRUCTION_SET_AVX2 : computeEnergiesAVX2(energies,ages,lifeTimes,nb); break;
+#endif
+#ifdef SPK_SIMD_SSE2
+		case INSTRUCTION_SET_SSE2 : computeEnergiesSSE2(energies,ages,lifeTimes,nb); break;
+#endif
+		default : computeEnergiesScalar(energies,ages,lifeTimes,nb); break;
+		}
+	}
+
+	void Kernels::integrate(Vector3D* positions,Vector3D* oldPositions,const Vector3D* velocities,float deltaTime,size_t nb)
+	{
+		// A vector is made of 3 contiguous floats : the arrays are processed as arrays of floats
+		integrate(reinterpret_cast<float*>(positions),reinterpret_cast<float*>(oldPositions),reinterpret_cast<const float*>(velocities),deltaTime,nb * 3);
+	}
+
+	void Kernels::integrate(float* positions,float* oldPositions,const float* velocities,float deltaTime,size_t nb)
+	{
+		std::memcpy(oldPositions,positions,nb * sizeof(float));
+
+		switch (instructionSet)
+		{
+#ifdef SPK_SIMD_AVX2
+		case INSTRUCTION_SET_AVX2 : integrateAVX2(positions,velocities,deltaTime,nb); break;
+#endif
+#ifdef SPK_SIMD_SSE2
+		case INSTRUCTION_SET_SSE2 : integrateSSE2(positions,velocities,deltaTime,nb); break;
+#endif
+		default : integrateScalar(positions,velocities,deltaTime,nb); break;
+		}
+	}
+
+	// The transpositions, the distances, the sines, the grids and the noise have no AVX2 version : the SSE2 one is used
+
+	void Kernels::toStreams(const Vector3D* vectors,const Vector3DStreams& streams,size_t nb)
+	{
+#ifdef SPK_SIMD_SSE2
+		if (instructionSet != INSTRUCTION_SET_SCALAR)
+			toStreamsSSE2(vectors,streams.x,streams.y,streams.z,nb);
+		else
+#endif
+			toStreamsScalar(vectors,streams.x,streams.y,streams.z,nb);
+	}
+
+	void Kernels::fromStreams(const Vector3DStreams& streams,Vector3D* vectors,size_t nb)
+	{
+#ifdef SPK_SIMD_SSE2
+		if (instructionSet != INSTRUCTION_SET_SCALAR)
+			fromStreamsSSE2(streams.x,streams.y,streams.z,vectors,nb);
+		else
+#endif
+			fromStreamsScalar(streams.x,streams.y,streams.z,vectors,nb);
+	}
+
+	void Kernels::computeDistances(const Vector3D* positions,const Vector3D& origin,const Vector3D& axis,float* distances,size_t nb)
+	{
+#ifdef SPK_SIMD_SSE2
+		if (instructionSet != INSTRUCTION_SET_SCALAR)
+			computeDistancesSSE2(positions,origin,axis,distances,nb);
+		else
+#endif
+			computeDistancesScalar(positions,origin,axis,distances,nb);
+	}
+
+	void Kernels::computeSqrDistances(const Vector3D* positions,const Vector3D& center,float* sqrDistances,size_t nb)
+	{
+#ifdef SPK_SIMD_SSE2
+		if (instructionSet != INSTRUCTION_SET_SCALAR)
+			computeSqrDistancesSSE2(positions,center,sqrDistances,nb);
+		else
+#endif
+			computeSqrDistancesScalar(positions,center,sqrDistances,nb);
+	}
+
+	void Kernels::computeSinCos(const float* angles,float* sines,float* cosines,size_t nb)
+	{
+#ifdef SPK_SIMD_SSE2
+		if (instructionSet != INSTRUCTION_SET_SCALAR)
+			computeSinCosSSE2(angles,sines,cosines,nb);
+		else
+#endif
+			computeSinCosScalar(angles,sines,cosines,nb);
+	}
+
+	void Kernels::sampleGrid(const float* nodes,size_t nbX,size_t nbY,size_t nbZ,const float* x,const float* y,const float* z,float* vx,float* vy,float* vz,size_t nb)
+	{
+#ifdef SPK_SIMD_SSE2
+		if (instructionSet != INSTRUCTION_SET_SCALAR)
+			sampleGridSSE2(nodes,nbX,nbY,nbZ,x,y,z,vx,vy,vz,nb);
+		else
+#endif
+			sampleGridScalar(nodes,nbX,nbY,nbZ,x,y,z,vx,vy,vz,nb);
+	}
+
+	void Kernels::computeNoise(const float* x,const float* y,const float* z,float* values,float* gx,float* gy,float* gz,size_t nb)
+	{
+#ifdef SPK_SIMD_SSE2
+		if (instructionSet != INSTRUCTION_SET_SCALAR)
+			computeNoiseSSE2(x,y,z,values,gx,gy,gz,nb);
+		else
+#endif
+			computeNoiseScalar(x,y,z,values,gx,gy,gz,nb);
+	}
+
+	void Kernels::computeCurlNoise(const float* x,const float* y,const float* z,float* cx,float* cy,float* cz,size_t nb)
+	{
+#ifdef SPK_SIMD_SSE2
+		if (instructionSet != INSTRUCTION_SET_SCALAR)
+			computeCurlNoiseSSE2(x,y,z,cx,cy,cz,nb);
+		else
+#endif
+			computeCurlNoiseScalar(x,y,z,cx,cy,cz,nb);
+	}
+}
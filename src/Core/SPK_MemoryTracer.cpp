@@ -24,53 +24,383 @@
 #ifdef SPK_TRACE_MEMORY
 
 #include <ctime>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <algorithm>
 #include <sstream>
+#ifndef SPK_NO_THREADS
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#endif
 
 namespace SPK
 {
+	namespace
+	{
+		// The blocks are split in shards locked independently to limit the contention between threads
+		const size_t NB_SHARDS = 64;
+
+		struct BlockInfo
+		{
+			const void* position;
+			size_t size;
+			const char* type;
+			const char* fileName;
+			size_t lineNb;
+			long long index;
+			const System* system;
+			SPKMemoryTracer::SystemEntry* systemEntry;
+		};
+
+		bool compareAllocIndex(const BlockInfo& block0,const BlockInfo& block1)
+		{
+			return block0.index < block1.index;
+		}
+
+		// The strings are static so that they can be sorted by address first
+		struct CompareString
+		{
+			bool operator()(const char* s0,const char* s1) const
+			{
+				return s0 != s1 && std::strcmp(s0,s1) < 0;
+			}
+		};
+
+		size_t getShardIndex(const void* position)
+		{
+			size_t hash = reinterpret_cast<size_t>(position) >> 4; // blocks are at least 16 bytes aligned
+			hash ^= hash >> 7;
+			hash ^= hash >> 13;
+			return hash % NB_SHARDS;
+		}
+
+#ifndef SPK_NO_THREADS
+		typedef std::atomic<long long> Counter;
+		typedef std::unordered_map<const void*,BlockInfo> BlockMap;
+#else
+		typedef long long Counter;
+		typedef std::map<const void*,BlockInfo> BlockMap;
+#endif
+
+		void addStatistics(SPKMemoryTracer::Statistics& statistics,size_t size)
+		{
+			++statistics.nbBlocks;
+			++statistics.nbAllocations;
+			statistics.size += size;
+			statistics.allocatedSize += size;
+		}
+
+		void removeStatistics(SPKMemoryTracer::Statistics& statistics,size_t size)
+		{
+			--statistics.nbBlocks;
+			statistics.size -= size;
+		}
+
+		template<typename T>
+		void diffStatistics(std::map<T,SPKMemoryTracer::Statistics>& result,const std::map<T,SPKMemoryTracer::Statistics>& current,const std::map<T,SPKMemoryTracer::Statistics>& previous)
+		{
+			for (typename std::map<T,SPKMemoryTracer::Statistics>::const_iterator it = current.begin(); it != current.end(); ++it)
+				result[it->first] += it->second;
+			for (typename std::map<T,SPKMemoryTracer::Statistics>::const_iterator it = previous.begin(); it != previous.end(); ++it)
+				result[it->first] -= it->second;
+
+			for (typename std::map<T,SPKMemoryTracer::Statistics>::iterator it = result.begin(); it != result.end();)
+				if (it->second.isEmpty())
+					result.erase(it++);
+				else
+					++it;
+		}
+	}
+
+	// The statistics of a system
+	// The entry is kept while blocks of the system are allocated or while the system is traced by a scope.
+	// It is then destroyed so that the entries do not accumulate with the systems and so that a system reusing the address of a destroyed one starts anew.
+	struct SPKMemoryTracer::SystemEntry
+	{
+		const System* system;
+		Counter nbBlocks;
+		Counter size;
+		Counter nbAllocations;
+		Counter allocatedSize;
+		size_t nbScopes; // guarded by the mutex of the systems
+
+		explicit SystemEntry(const System* system) :
+			system(system),
+			nbScopes(0)
+		{
+			nbBlocks = 0;
+			size = 0;
+			nbAllocations = 0;
+			allocatedSize = 0;
+		}
+
+		Statistics getStatistics() const
+		{
+			Statistics statistics;
+			statistics.nbBlocks = nbBlocks;
+			statistics.size = size;
+			statistics.nbAllocations = nbAllocations;
+			statistics.allocatedSize = allocatedSize;
+			return statistics;
+		}
+	};
+
+	namespace
+	{
+		// The system entry of the calling thread, NULL if its allocations are not attributed to a system
+#ifndef SPK_NO_THREADS
+		thread_local SPKMemoryTracer::SystemEntry* currentSystemEntry = NULL;
+#else
+		SPKMemoryTracer::SystemEntry* currentSystemEntry = NULL;
+#endif
+	}
+
+	struct SPKMemoryTracer::Context
+	{
+		struct Shard
+		{
+#ifndef SPK_NO_THREADS
+			std::mutex mutex;
+#endif
+			BlockMap blocks;
+			std::map<const char*,Statistics> types; // keyed by the address of the static type strings
+		};
+
+		Shard shards[NB_SHARDS];
+
+#ifndef SPK_NO_THREADS
+		std::mutex systemsMutex;
+#endif
+		std::map<const System*,SystemEntry*> systems;
+		SystemEntry unattributed; // the blocks allocated out of any system, never destroyed
+
+		Counter size;
+		Counter peakSize;
+		Counter nextIndex;
+
+		Context() :
+			unattributed(NULL)
+		{
+			size = 0;
+			peakSize = 0;
+			nextIndex = 0;
+		}
+
+		~Context()
+		{
+			for (std::map<const System*,SystemEntry*>::const_iterator it = systems.begin(); it != systems.end(); ++it)
+				delete it->second;
+		}
+	};
+
+#ifndef SPK_NO_THREADS
+#define SPK_LOCK_SHARD(shard) std::lock_guard<std::mutex> lock((shard).mutex);
+#define SPK_LOCK_SYSTEMS(context) std::lock_guard<std::mutex> lock((context).systemsMutex);
+#else
+#define SPK_LOCK_SHARD(shard)
+#define SPK_LOCK_SYSTEMS(context)
+#endif
+
+	SPKMemoryTracer::Snapshot SPKMemoryTracer::Snapshot::operator-(const Snapshot& previous) const
+	{
+		Snapshot result;
+		result.total = total;
+		result.total -= previous.total;
+		result.peakSize = peakSize - previous.peakSize;
+		diffStatistics(result.types,types,previous.types);
+		diffStatistics(result.systems,systems,previous.systems);
+		return result;
+	}
+
+	SPKMemoryTracer::SystemScope::SystemScope(const System* system) :
+		previous(currentSystemEntry),
+		entry(get().acquireSystemEntry(system))
+	{
+		currentSystemEntry = entry;
+	}
+
+	SPKMemoryTracer::SystemScope::~SystemScope()
+	{
+		currentSystemEntry = previous;
+		if (entry != NULL)
+			get().releaseSystemEntry(entry->system,entry,true);
+	}
+
+	SPKMemoryTracer::SystemEntry* SPKMemoryTracer::acquireSystemEntry(const System* system)
+	{
+		if (system == NULL || context == NULL)
+			return NULL;
+
+		SPK_LOCK_SYSTEMS(*context)
+		SystemEntry*& entry = context->systems[system];
+		if (entry == NULL)
+			entry = new SystemEntry(system); // Not traced
+		++entry->nbScopes;
+		return entry;
+	}
+
+	void SPKMemoryTracer::releaseSystemEntry(const System* system,SystemEntry* entry,bool endOfScope)
+	{
+		if (context == NULL)
+			return;
+
+		SPK_LOCK_SYSTEMS(*context)
+
+		// The entry is looked up before being accessed as another thread freeing the last block may have destroyed it meanwhile
+		std::map<const System*,SystemEntry*>::iterator it = context->systems.find(system);
+		if (it == context->systems.end() || it->second != entry)
+			return;
+
+		if (endOfScope)
+			--entry->nbScopes;
+
+		if (entry->nbScopes == 0 && entry->nbBlocks == 0)
+		{
+			context->systems.erase(it);
+			delete entry;
+		}
+	}
+
+	SPKMemoryTracer::SPKMemoryTracer() :
+		context(new Context) // The context itself is not traced
+	{}
+
+	SPKMemoryTracer::~SPKMemoryTracer()
+	{
+		Context* tmp = context;
+		context = NULL; // The blocks freed after the destruction of the tracer are ignored
+		delete tmp;
+	}
+
 	SPKMemoryTracer& SPKMemoryTracer::get()
 	{
 		static SPKMemoryTracer instance;
 		return instance;
 	}
 
-	void* SPKMemoryTracer::registerAllocation(void* position,size_t size,const std::string& type,const std::string& file,size_t line)
+	void* SPKMemoryTracer::registerAllocation(void* position,size_t size,const char* type,const char* file,size_t line)
 	{
-		if (position == NULL)
-			return NULL;
+		if (position == NULL || context == NULL)
+			return position;
 
-		BlockInfo info(position);
+		BlockInfo info;
+		info.position = position;
 		info.size = size;
 		info.type = type;
 		info.fileName = file;
 		info.lineNb = line;
-		info.time = static_cast<float>(clock()) / CLOCKS_PER_SEC;
-		info.index = nextIndex++;
+		info.index = context->nextIndex++;
+		info.systemEntry = currentSystemEntry != NULL ? currentSystemEntry : &context->unattributed;
+		info.system = info.systemEntry->system;
 
-		blocks.insert(info);
+		// The entry is accounted before the block is visible so that a concurrent free cannot destroy it
+		SystemEntry& entry = *info.systemEntry;
+		++entry.nbBlocks;
+		++entry.nbAllocations;
+		entry.size += size;
+		entry.allocatedSize += size;
+
+		Context::Shard& shard = context->shards[getShardIndex(position)];
+		{
+			SPK_LOCK_SHARD(shard)
+			shard.blocks[position] = info;
+			addStatistics(shard.types[type],size);
+		}
 
-		totalMemorySize += size;
-		if (totalMemorySize > maxMemorySize)
-			maxMemorySize = totalMemorySize;
+#ifndef SPK_NO_THREADS
+		const long long currentSize = context->size.fetch_add(size) + size;
+		long long peakSize = context->peakSize.load();
+		while (currentSize > peakSize && !context->peakSize.compare_exchange_weak(peakSize,currentSize)) {}
+#else
+		context->size += size;
+		if (context->size > context->peakSize)
+			context->peakSize = context->size;
+#endif
 
 		return position;
 	}
 
 	void SPKMemoryTracer::unregisterAllocation(void* position)
 	{
-		std::set<BlockInfo>::iterator it = blocks.find(BlockInfo(position));
-		if (it != blocks.end())
+		if (position == NULL || context == NULL)
+			return;
+
+		Context::Shard& shard = context->shards[getShardIndex(position)];
+		BlockInfo info;
+		{
+			SPK_LOCK_SHARD(shard)
+			BlockMap::iterator it = shard.blocks.find(position);
+			if (it == shard.blocks.end())
+				return;
+
+			info = it->second;
+			removeStatistics(shard.types[info.type],info.size);
+			shard.blocks.erase(it);
+		}
+
+		context->size -= info.size;
+
+		// The entry cannot be destroyed while it counts the block
+		SystemEntry* entry = info.systemEntry;
+		entry->size -= info.size;
+		if (--entry->nbBlocks == 0 && entry != &context->unattributed)
+			releaseSystemEntry(info.system,entry,false);
+	}
+
+	SPKMemoryTracer::Snapshot SPKMemoryTracer::getSnapshot() const
+	{
+		Snapshot snapshot;
+		if (context == NULL)
+			return snapshot;
+
+		// The per type statistics of the shards are merged by name as a type string may have several addresses
+		std::map<const char*,Statistics,CompareString> types;
+		for (size_t i = 0; i < NB_SHARDS; ++i)
+		{
+			Context::Shard& shard = context->shards[i];
+			SPK_LOCK_SHARD(shard)
+			for (std::map<const char*,Statistics>::const_iterator it = shard.types.begin(); it != shard.types.end(); ++it)
+				types[it->first] += it->second;
+		}
+
+		{
+			SPK_LOCK_SYSTEMS(*context)
+			for (std::map<const System*,SystemEntry*>::const_iterator it = context->systems.begin(); it != context->systems.end(); ++it)
+				snapshot.systems[it->first] = it->second->getStatistics();
+			if (context->unattributed.nbAllocations > 0)
+				snapshot.systems[NULL] = context->unattributed.getStatistics();
+		}
+
+		for (std::map<const char*,Statistics,CompareString>::const_iterator it = types.begin(); it != types.end(); ++it)
 		{
-			totalMemorySize -= it->size;
-			blocks.erase(it);
+			snapshot.types[it->first] = it->second;
+			snapshot.total += it->second;
 		}
+
+		snapshot.peakSize = context->peakSize;
+		return snapshot;
+	}
+
+	long long SPKMemoryTracer::getSize() const
+	{
+		return context != NULL ? static_cast<long long>(context->size) : 0;
+	}
+
+	long long SPKMemoryTracer::getPeakSize() const
+	{
+		return context != NULL ? static_cast<long long>(context->peakSize) : 0;
+	}
+
+	void SPKMemoryTracer::resetPeakSize()
+	{
+		if (context != NULL)
+			context->peakSize = static_cast<long long>(context->size);
 	}
 
-	std::string SPKMemoryTracer::formatSize(unsigned int s)
+	std::string SPKMemoryTracer::formatSize(long long s)
 	{
 		float sf = (float)s;
 		unsigned int q = 0;
@@ -82,7 +412,7 @@ namespace SPK
 			"GB",
 			"TB"
 		};
-		while(sf >= 1024 && q < sizeof(qualifiers) / sizeof(const char*))
+		while((sf >= 1024 || sf <= -1024) && q + 1 < sizeof(qualifiers) / sizeof(const char*))
 		{
 			sf /= 1024;
 			q++;
@@ -96,21 +426,48 @@ namespace SPK
 
 	void SPKMemoryTracer::dumpMemory()
 	{
+		if (context == NULL)
+			return;
+
 		std::ofstream file("SPARK_Memory_Dump.txt",std::ios::out | std::ios::app);
 
 		if (file)
 		{
-			std::vector<BlockInfo> sortedBlocks(blocks.begin(),blocks.end());
-			std::sort(sortedBlocks.begin(),sortedBlocks.end(),compareAllocTime);
+			const Snapshot snapshot = getSnapshot();
+
+			std::vector<BlockInfo> sortedBlocks;
+			for (size_t i = 0; i < NB_SHARDS; ++i)
+			{
+				Context::Shard& shard = context->shards[i];
+				SPK_LOCK_SHARD(shard)
+				for (BlockMap::const_iterator it = shard.blocks.begin(); it != shard.blocks.end(); ++it)
+					sortedBlocks.push_back(it->second);
+			}
+			std::sort(sortedBlocks.begin(),sortedBlocks.end(),compareAllocIndex);
 
 			time_t currentTime = time(NULL);
 			tm* timeinfo = localtime(&currentTime);
 			file << "-----------------------------------------------------------------------------------------------\n";
 			file << "SPARK MEMORY DUMP - " << asctime(timeinfo) << "\n\n";
 			file.precision(3);
-			file << "Dynamic memory used: " << totalMemorySize << " bytes allocated (" << formatSize(totalMemorySize) << ") in " << blocks.size() << " blocks\n";
-			file << "Maximum dynamic memory allocated: " << maxMemorySize << " bytes ("<< formatSize(maxMemorySize) << ")\n";
-			file << "Total number of allocated blocks: " << nextIndex << "\n\n";
+			file << "Dynamic memory used: " << snapshot.total.size << " bytes allocated (" << formatSize(snapshot.total.size) << ") in " << snapshot.total.nbBlocks << " blocks\n";
+			file << "Maximum dynamic memory allocated: " << snapshot.peakSize << " bytes ("<< formatSize(snapshot.peakSize) << ")\n";
+			file << "Total number of allocated blocks: " << snapshot.total.nbAllocations << " (" << formatSize(snapshot.total.allocatedSize) << ")\n\n";
+
+			for (std::map<std::string,Statistics>::const_iterator it = snapshot.types.begin(); it != snapshot.types.end(); ++it)
+			{
+				file.width(32);
+				file << std::left << it->first;
+
+				file.width(10);
+				file << std::right << it->second.size << " bytes in ";
+
+				file.width(6);
+				file << std::right << it->second.nbBlocks << " blocks - ";
+
+				file << it->second.nbAllocations << " allocated so far\n";
+			}
+			file << "\n";
 
 			std::vector<BlockInfo>::const_iterator it = sortedBlocks.begin();
 			std::vector<BlockInfo>::const_iterator end = sortedBlocks.end();
@@ -126,10 +483,10 @@ namespace SPK
 				typeStr << " of " << it->type;
 				file << std::right << typeStr.str();
 
-				file.width(18);
-				std::ostringstream timeStr;
-				timeStr << " at " << it->time << " sec";
-				file << std::right << timeStr.str();
+				file.width(12);
+				std::ostringstream indexStr;
+				indexStr << " #" << it->index;
+				file << std::right << indexStr.str();
 				file << "\t(" << it->fileName << " - line " << it->lineNb << ")\n";
 			}
 			file << "-----------------------------------------------------------------------------------------------\n\n";
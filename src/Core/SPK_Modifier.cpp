@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	void Modifier::initBatch(Group& group,DataSet* dataSet,size_t start,size_t end) const
+	{
+		for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
+			init(*particleIt,dataSet);
+	}
+
+	// The defaults are only reached by a modifier not overriding the method its flags require
+	void Modifier::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		SPK_ASSERT(CHUNK_SAFE,"Modifier::modify(Group&,DataSet*,float) - A modifier that is not chunk safe must override this method");
+	}
+
+	void Modifier::modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const
+	{
+		SPK_ASSERT(!CHUNK_SAFE,"Modifier::modifyRange(Group&,DataSet*,float,size_t,size_t) - A chunk safe modifier must override this method");
+	}
+
+	void Modifier::modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const
+	{
+		SPK_ASSERT(!SOA_COMPATIBLE,"Modifier::modifyStreams(Group&,DataSet*,float,const ParticleStreams&,size_t,size_t) - A modifier compatible with SOA must override this method");
+	}
+}
@@ -21,6 +21,8 @@
 
 #include <vector>
 #include <limits> // for max float value
+#include <algorithm> // for std::max and std::swap
+#include <cmath> // for pow
 
 #include <SPARK_Core.h>
 
@@ -31,6 +33,35 @@ namespace SPK
 	const size_t Octree::MAX_PARTICLES_NB_PER_CELL = 32;
 	const float Octree::OPTIMAL_CELL_SIZE_FACTOR = 4.0f; // optimal cell size is defined as : factor * mean radius
 	const float Octree::MIN_CELL_SIZE = 0.001f;
+	const float Octree::OPTIMAL_GRID_PARTICLES_PER_CELL = 8.0f;
+	const size_t Octree::MAX_GRID_CELLS_PER_PARTICLE = 2; // Bounds the memory used by the uniform grid
+	const size_t Octree::MIN_GRID_CELLS = 512;
+	const size_t Octree::MORTON_BITS = 10; // Bits per axis in a morton code
+
+	namespace
+	{
+		// Interleaves the bits of a coordinate with 2 zeros to build morton codes
+		unsigned int spreadBits(unsigned int v)
+		{
+			v &= 0x000003FF;
+			v = (v | (v << 16)) & 0x030000FF;
+			v = (v | (v << 8)) & 0x0300F00F;
+			v = (v | (v << 4)) & 0x030C30C3;
+			v = (v | (v << 2)) & 0x09249249;
+			return v;
+		}
+
+		// Inverse of spreadBits
+		unsigned int compactBits(unsigned int v)
+		{
+			v &= 0x09249249;
+			v = (v | (v >> 2)) & 0x030C30C3;
+			v = (v | (v >> 4)) & 0x0300F00F;
+			v = (v | (v >> 8)) & 0x030000FF;
+			v = (v | (v >> 16)) & 0x000003FF;
+			return v;
+		}
+	}
 
 	Octree::Octree(const Ref<Group>& group) :
 		group(*group),
@@ -70,6 +101,7 @@ namespace SPK
 
 		// First traversal in O(n) needed to init the octree
 		float meanRadius = 0.0f;
+		float maxRadius = 0.0f;
 		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
 		{
 			const Particle& particle = *particleIt;
@@ -77,6 +109,7 @@ namespace SPK
 			AABBMin.setMin(particle.position());
 			AABBMax.setMax(particle.position());
 			meanRadius += radius;
+			maxRadius = std::max(maxRadius,radius);
 			particleCells[particle.getIndex()].clear();
 		}
 
@@ -86,6 +119,17 @@ namespace SPK
 		if (minCellSize < MIN_CELL_SIZE)
 			minCellSize = MIN_CELL_SIZE;
 
+		switch (group.getSpatialIndexType())
+		{
+		// The cells of the grids are at least as large as the largest particle so that a particle never spans more than 2 cells per axis
+		case SPATIAL_INDEX_GRID : buildGrid(std::max(minCellSize,2.0f * maxRadius),false); break;
+		case SPATIAL_INDEX_MORTON : buildGrid(std::max(minCellSize,2.0f * maxRadius),true); break;
+		default : buildTree(minCellSize); break;
+		}
+	}
+
+	void Octree::buildTree(float minCellSize)
+	{
 		// Initial dimensions
 		Vector3D dimensions = AABBMax - AABBMin;
 		Vector3D offset = AABBMin;
@@ -144,6 +188,169 @@ namespace SPK
 			}
 	}
 
+	void Octree::buildGrid(float minCellSize,bool morton)
+	{
+		nbCells = 0;
+		activeCells.clear();
+
+		if (group.getNbParticles() == 0)
+			return;
+
+		// Finds the cell size : cells are large enough to hold a few particles on average and to limit the particles overlapping several cells
+		// The size is then enlarged until the grid fits in its bounds
+		const Vector3D dimensions = AABBMax - AABBMin;
+		const float volume = std::max(dimensions.x,minCellSize) * std::max(dimensions.y,minCellSize) * std::max(dimensions.z,minCellSize);
+		const size_t maxNbGridCells = std::max(group.getNbParticles() * MAX_GRID_CELLS_PER_PARTICLE,MIN_GRID_CELLS);
+		const size_t maxResolution = 1 << MORTON_BITS;
+		float cellSize = std::max(minCellSize,std::pow(volume * OPTIMAL_GRID_PARTICLES_PER_CELL / group.getNbParticles(),1.0f / 3.0f));
+		size_t resolution[3];
+		while (true)
+		{
+			resolution[0] = static_cast<size_t>(dimensions.x / cellSize) + 1;
+			resolution[1] = static_cast<size_t>(dimensions.y / cellSize) + 1;
+			resolution[2] = static_cast<size_t>(dimensions.z / cellSize) + 1;
+
+			if (morton)
+			{
+				if (resolution[0] <= maxResolution && resolution[1] <= maxResolution && resolution[2] <= maxResolution)
+					break;
+			}
+			else if (resolution[0] * resolution[1] * resolution[2] <= maxNbGridCells)
+				break;
+
+			cellSize *= 1.25f;
+		}
+
+		AABBMax = AABBMin + Vector3D(
+			static_cast<float>(resolution[0]),
+			static_cast<float>(resolution[1]),
+			static_cast<float>(resolution[2])) * cellSize;
+
+		// Computes the range of cells covered by each particle and counts the entries
+		const float invCellSize = 1.0f / cellSize;
+		size_t nbEntries = 0;
+		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		{
+			const Particle& particle = *particleIt;
+			const Vector3D position = particle.position() - AABBMin;
+			const float radius = particle.getRadius();
+
+			Triplet& min = minPos[particle.getIndex()];
+			Triplet& max = maxPos[particle.getIndex()];
+			min.set((position - radius) * invCellSize);
+			max.set((position + radius) * invCellSize);
+			min.clamp(resolution);
+			max.clamp(resolution);
+
+			nbEntries += (max.value[0] - min.value[0] + 1) * (max.value[1] - min.value[1] + 1) * (max.value[2] - min.value[2] + 1);
+		}
+
+		gridEntries.resize(nbEntries);
+
+		if (!morton)
+		{
+			// Counting sort of the particles by cell
+			// As particles are processed by increasing index, they are ordered by index within a cell
+			const size_t nbGridCells = resolution[0] * resolution[1] * resolution[2];
+			gridCounts.assign(nbGridCells + 1,0);
+
+			for (size_t i = 0; i < group.getNbParticles(); ++i)
+				for (int x = minPos[i].value[0]; x <= maxPos[i].value[0]; ++x)
+					for (int y = minPos[i].value[1]; y <= maxPos[i].value[1]; ++y)
+						for (int z = minPos[i].value[2]; z <= maxPos[i].value[2]; ++z)
+							++gridCounts[(x * resolution[1] + y) * resolution[2] + z + 1];
+
+			for (size_t i = 1; i <= nbGridCells; ++i)
+				gridCounts[i] += gridCounts[i - 1];
+
+			for (size_t i = 0; i < group.getNbParticles(); ++i)
+				for (int x = minPos[i].value[0]; x <= maxPos[i].value[0]; ++x)
+					for (int y = minPos[i].value[1]; y <= maxPos[i].value[1]; ++y)
+						for (int z = minPos[i].value[2]; z <= maxPos[i].value[2]; ++z)
+							gridEntries[gridCounts[(x * resolution[1] + y) * resolution[2] + z]++] = i;
+
+			// After the sort, a cell spans from the end of the previous one to its count
+			size_t start = 0;
+			for (size_t i = 0; i < nbGridCells; ++i)
+			{
+				const size_t end = gridCounts[i];
+				if (end > start)
+					addGridCell(i / (resolution[1] * resolution[2]),(i / resolution[2]) % resolution[1],i % resolution[2],&gridEntries[start],end - start);
+				start = end;
+			}
+		}
+		else
+		{
+			// Radix sort of the entries by morton code
+			// The sort is stable so particles remain ordered by index within a cell
+			mortonEntries.resize(nbEntries);
+			mortonBuffer.resize(nbEntries);
+
+			size_t index = 0;
+			for (size_t i = 0; i < group.getNbParticles(); ++i)
+				for (int x = minPos[i].value[0]; x <= maxPos[i].value[0]; ++x)
+					for (int y = minPos[i].value[1]; y <= maxPos[i].value[1]; ++y)
+						for (int z = minPos[i].value[2]; z <= maxPos[i].value[2]; ++z)
+						{
+							mortonEntries[index].code = (spreadBits(x) << 2) | (spreadBits(y) << 1) | spreadBits(z);
+							mortonEntries[index].particleIndex = i;
+							++index;
+						}
+
+			const size_t radix = 1 << MORTON_BITS;
+			gridCounts.resize(radix);
+			for (size_t pass = 0; pass < 3; ++pass)
+			{
+				const size_t shift = pass * MORTON_BITS;
+
+				std::fill(gridCounts.begin(),gridCounts.end(),0);
+				for (size_t i = 0; i < nbEntries; ++i)
+					++gridCounts[(mortonEntries[i].code >> shift) & (radix - 1)];
+
+				size_t offset = 0;
+				for (size_t i = 0; i < radix; ++i)
+				{
+					const size_t count = gridCounts[i];
+					gridCounts[i] = offset;
+					offset += count;
+				}
+
+				for (size_t i = 0; i < nbEntries; ++i)
+					mortonBuffer[gridCounts[(mortonEntries[i].code >> shift) & (radix - 1)]++] = mortonEntries[i];
+
+				std::swap(mortonEntries,mortonBuffer);
+			}
+
+			for (size_t i = 0; i < nbEntries; ++i)
+				gridEntries[i] = mortonEntries[i].particleIndex;
+
+			// Cells are runs of entries with the same code
+			size_t start = 0;
+			while (start < nbEntries)
+			{
+				const unsigned int code = mortonEntries[start].code;
+				size_t end = start + 1;
+				while (end < nbEntries && mortonEntries[end].code == code)
+					++end;
+
+				addGridCell(compactBits(code >> 2),compactBits(code >> 1),compactBits(code),&gridEntries[start],end - start);
+				start = end;
+			}
+		}
+	}
+
+	void Octree::addGridCell(size_t offsetX,size_t offsetY,size_t offsetZ,const size_t* particles,size_t nb)
+	{
+		const size_t cellIndex = initNextCell(0,offsetX,offsetY,offsetZ);
+		Cell& cell = cells[cellIndex];
+		for (size_t i = 0; i < nb; ++i)
+		{
+			cell.particles.push(particles[i]);
+			particleCells[particles[i]].push(cellIndex);
+		}
+		activeCells.push(cellIndex);
+	}
+
 	size_t Octree::initNextCell(size_t level,size_t offsetX,size_t offsetY,size_t offsetZ)
 	{
 		if (nbCells == cells.size())
@@ -211,6 +418,6 @@ namespace SPK
 		for (int x = minIndexX; x <= maxIndexX; ++x)
 			for (int y = minIndexY; y <= maxIndexY; ++y)
 				for (int z = minIndexZ; z <= maxIndexZ; ++z)
-					addToCell(parent.children[(x << 2) | (y << 1) | z],particleIndex,maxLevel);
+					addToCell(cells[parentIndex].children[(x << 2) | (y << 1) | z],particleIndex,maxLevel); // cells may be reallocated by addToCell
 	}
 }
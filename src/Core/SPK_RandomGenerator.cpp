@@ -0,0 +1,168 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#ifndef SPK_NO_THREADS
+#include <atomic>
+#endif
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	namespace
+	{
+		// Mixes the bits of a 32 bits integer (finalizer of murmur3)
+		inline uint32 mix(uint32 x)
+		{
+			x ^= x >> 16;
+			x *= 0x85EBCA6B;
+			x ^= x >> 13;
+			x *= 0xC2B2AE35;
+			x ^= x >> 16;
+			return x;
+		}
+
+		uint32 getTimeSeed()
+		{
+			return static_cast<uint32>(std::time(NULL));
+		}
+
+#ifndef SPK_NO_THREADS
+		thread_local RandomGenerator* currentGenerator = NULL;
+
+		// Each thread gets its own stream so that threads started at the same time do not share a sequence
+		std::atomic<uint32> nbThreadGenerators(0);
+
+		RandomGenerator& getThreadGenerator()
+		{
+			thread_local RandomGenerator generator(getTimeSeed(),nbThreadGenerators++);
+			return generator;
+		}
+#else
+		RandomGenerator* currentGenerator = NULL;
+
+		RandomGenerator& getThreadGenerator()
+		{
+			static RandomGenerator generator(getTimeSeed());
+			return generator;
+		}
+#endif
+	}
+
+	RandomGenerator::Scope::Scope(RandomGenerator& generator) :
+		previous(currentGenerator)
+	{
+		currentGenerator = &generator;
+	}
+
+	RandomGenerator::Scope::~Scope()
+	{
+		currentGenerator = previous;
+	}
+
+	void RandomGenerator::setSeed(uint32 seed,uint32 stream)
+	{
+		// The state is filled with a splitmix sequence starting from the seed mixed with the stream
+		uint32 x = seed ^ mix(stream + 0x9E3779B9);
+		for (size_t i = 0; i < 4; ++i)
+		{
+			x += 0x9E3779B9;
+			state[i] = mix(x);
+		}
+
+		// The state must not be 0 everywhere
+		if ((state[0] | state[1] | state[2] | state[3]) == 0)
+			state[0] = 1;
+	}
+
+	void RandomGenerator::fillUniform(float* values,size_t nb,float min,float max)
+	{
+		// The state is kept in local variables so that it lives in registers during the loop
+		uint32 s0 = state[0];
+		uint32 s1 = state[1];
+		uint32 s2 = state[2];
+		uint32 s3 = state[3];
+
+		const float scale = (max - min) * (1.0f / 16777216.0f);
+
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const uint32 result = rotate(s1 * 5,7) * 9;
+			const uint32 t = s1 << 9;
+
+			s2 ^= s0;
+			s3 ^= s1;
+			s1 ^= s2;
+			s0 ^= s3;
+			s2 ^= t;
+			s3 = rotate(s3,11);
+
+			values[i] = min + (result >> 8) * scale;
+		}
+
+		state[0] = s0;
+		state[1] = s1;
+		state[2] = s2;
+		state[3] = s3;
+	}
+
+	void RandomGenerator::fillDirections(Vector3D* directions,size_t nb,float minZ,float maxZ)
+	{
+		const float PI = 3.14159265f;
+
+		// The coordinates are generated in bulk by blocks
+		const size_t BLOCK_SIZE = 256;
+		float zs[BLOCK_SIZE];
+		float angles[BLOCK_SIZE];
+		float sines[BLOCK_SIZE];
+		float cosines[BLOCK_SIZE];
+
+		for (size_t start = 0; start < nb; start += BLOCK_SIZE)
+		{
+			const size_t blockSize = std::min(BLOCK_SIZE,nb - start);
+			fillUniform(zs,blockSize,minZ,maxZ);
+			fillUniform(angles,blockSize,-PI,PI);
+			Kernels::computeSinCos(angles,sines,cosines,blockSize);
+
+			Vector3D* direction = directions + start;
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				const float r = std::sqrt(std::max(0.0f,1.0f - zs[i] * zs[i]));
+				(direction++)->set(r * cosines[i],r * sines[i],zs[i]);
+			}
+		}
+	}
+
+	RandomGenerator& RandomGenerator::getCurrent()
+	{
+		if (currentGenerator == NULL)
+			currentGenerator = &getThreadGenerator();
+		return *currentGenerator;
+	}
+
+	void RandomGenerator::setThreadSeed(uint32 seed)
+	{
+		getThreadGenerator().setSeed(seed);
+	}
+}
@@ -28,11 +28,11 @@ namespace SPK
 
 	void Renderer::useShaderHint(ShaderHint hint)
 	{
-		SPK_LOG_INFO("Shader hint is not yet considered");
+		shaderHint = hint;
 	}
 
 	void Renderer::useVBOHint(bool hint)
 	{
-		SPK_LOG_INFO("VBO hint is not yet considered");
+		vboHint = hint;
 	}
 }
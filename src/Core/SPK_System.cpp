@@ -26,44 +26,152 @@
 
 namespace SPK
 {
-	StepMode System::stepMode(STEP_MODE_REAL);
-	float System::constantStep(0.0f);
-	float System::minStep(0.0f);
-	float System::maxStep(0.0f);
+	System::StepSettings System::defaultStepSettings =
+	{
+		STEP_MODE_REAL,	// mode
+		0.0f,			// constantStep
+		0.0f,			// minStep
+		0.0f,			// maxStep
+		false,			// clampStepEnabled
+		1.0f,			// clampStep
+	};
+
+	namespace
+	{
+		// FNV-1a hash of a block of memory
+		uint32 hashBytes(uint32 hash,const void* data,size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; ++i)
+				hash = (hash ^ bytes[i]) * 16777619U;
+			return hash;
+		}
+	}
+
+	// Updates the clusters of dependent groups concurrently
+	class System::UpdateJob : public ThreadPool::Job
+	{
+	public :
+
+		UpdateJob(System& system,float deltaTime) :
+			system(system),
+			deltaTime(deltaTime),
+			alive(system.clusterOffsets.size() - 1,0)
+		{}
+
+		virtual void run(size_t index)
+		{
+			alive[index] = system.updateCluster(index,deltaTime);
+		}
+
+		bool isAlive() const
+		{
+			return std::find(alive.begin(),alive.end(),1) != alive.end();
+		}
+
+	private :
+
+		System& system;
+		float deltaTime;
+		std::vector<char> alive;
+	};
+
+	// Sorts particles and computes the AABB of each group
+	class System::FinalizeJob : public ThreadPool::Job
+	{
+	public :
+
+		FinalizeJob(System& system) :
+			system(system)
+		{}
+
+		virtual void run(size_t index)
+		{
+			Group& group = *system.groups[index];
+			group.sortParticles();
+			if (system.isAABBComputationEnabled())
+				group.computeAABB();
+		}
 
-	bool System::clampStepEnabled(false);
-	float System::clampStep(1.0f);
+	private :
+
+		System& system;
+	};
+
+	namespace
+	{
+		size_t findClusterRoot(std::vector<size_t>& parents,size_t index)
+		{
+			while (parents[index] != index)
+				index = parents[index] = parents[parents[index]];
+			return index;
+		}
+
+		void linkClusters(std::vector<size_t>& parents,size_t index0,size_t index1)
+		{
+			index0 = findClusterRoot(parents,index0);
+			index1 = findClusterRoot(parents,index1);
+			if (index0 < index1)
+				parents[index1] = index0;
+			else
+				parents[index0] = index1;
+		}
+	}
 
 	System::System(bool initialize) :
 		Transformable(SHARE_POLICY_TRUE),
 		groups(),
+		localStepSettings(defaultStepSettings),
+		localStepEnabled(false),
 		deltaStep(0.0f),
+		updateInterval(0.0f),
+		deferredTime(0.0f),
 		AABBComputationEnabled(false),
 		AABBMin(),
 		AABBMax(),
 		initialized(initialize),
-		active(true)
+		active(true),
+		threadPool(NULL),
+		allocator(NULL),
+		seed(0),
+		seeded(false),
+		recorder(NULL),
+		updating(false)
 	{}
 
 	System::System(const System& system) :
 		Transformable(system),
+		localStepSettings(system.localStepSettings),
+		localStepEnabled(system.localStepEnabled),
 		deltaStep(0.0f),
+		updateInterval(system.updateInterval),
+		deferredTime(0.0f),
 		AABBComputationEnabled(system.AABBComputationEnabled),
 		AABBMin(system.AABBMin),
 		AABBMax(system.AABBMax),
 		initialized(system.initialized),
-		active(system.active)
+		active(system.active),
+		threadPool(system.threadPool),
+		allocator(system.allocator),
+		seed(system.seed),
+		seeded(system.seeded),
+		recorder(NULL),
+		updating(false)
 	{
 		for (std::vector<Ref<Group> >::const_iterator it = system.groups.begin(); it != system.groups.end(); ++it)
 		{
 			Ref<Group> group = system.copyChild(*it);
 			setGroupSystem(group,this);
 			groups.push_back(group);
+			seedGroup(groups.size() - 1);
 		}
 	}
 
 	System::~System()
 	{
+		if (recorder != NULL)
+			recorder->stopRecording();
+
 		while (groups.size() > 0)
 			removeGroup(groups.back());
 	}
@@ -76,8 +184,10 @@ namespace SPK
 			return SPK_NULL_REF;
 		}
 
+		SPK_TRACE_SYSTEM(this)
 		Ref<Group> newGroup = SPK_NEW(Group,this,capacity);
 		groups.push_back(newGroup);
+		seedGroup(groups.size() - 1);
 		return newGroup;
 	}
 
@@ -89,9 +199,11 @@ namespace SPK
 			return SPK_NULL_REF;
 		}
 
+		SPK_TRACE_SYSTEM(this)
 		Ref<Group> newGroup = copy(group);
 		setGroupSystem(newGroup,this);
 		groups.push_back(newGroup);
+		seedGroup(groups.size() - 1);
 		return newGroup;
 	}
 
@@ -105,6 +217,7 @@ namespace SPK
 
 		setGroupSystem(group,this);
 		groups.push_back(group);
+		seedGroup(groups.size() - 1);
 	}
 
 	void System::removeGroup(const Ref<Group>& group)
@@ -134,6 +247,20 @@ namespace SPK
 		}
 	}
 
+	void System::setSeed(uint32 seed)
+	{
+		this->seed = seed;
+		seeded = true;
+		for (size_t i = 0; i < groups.size(); ++i)
+			seedGroup(i);
+	}
+
+	void System::seedGroup(size_t index)
+	{
+		if (seeded)
+			groups[index]->setSeed(seed,static_cast<uint32>(index));
+	}
+
 	size_t System::getNbParticles() const
 	{
 		size_t nbParticles = 0;
@@ -150,27 +277,45 @@ namespace SPK
 			return true;
 		}
 
-		bool alive = true;
+		// The delta time passed is recorded before being modified by the step mode
+		const float recordedDeltaTime = deltaTime;
+
+		// The clamp step applies to the time of each call and not to the deferred time so that no time is lost when catching up
+		const StepSettings& settings = getStepSettings();
+		if (settings.clampStepEnabled && deltaTime > settings.clampStep)
+			deltaTime = settings.clampStep;
+
+		// At a reduced update frequency, the time is accumulated until the update interval is reached
+		deltaTime += deferredTime;
+		if (deltaTime < updateInterval)
+		{
+			deferredTime = deltaTime;
+			if (recorder != NULL)
+				recorder->recordFrame(recordedDeltaTime);
+			return active;
+		}
+		deferredTime = 0.0f;
 
-		if (clampStepEnabled && deltaTime > clampStep)
-			deltaTime = clampStep;
+		bool alive = true;
+		updating = true;
 
-		if (stepMode != STEP_MODE_REAL)
+		// A system updated at a reduced frequency catches up in a single step
+		if (settings.mode != STEP_MODE_REAL && updateInterval <= 0.0f)
 		{
 			deltaTime += deltaStep;
 
 			float updateStep;
-			if (stepMode == STEP_MODE_ADAPTIVE)
+			if (settings.mode == STEP_MODE_ADAPTIVE)
 			{
-				if (deltaTime > maxStep)
-					updateStep = maxStep;
-				else if (deltaTime < minStep)
-					updateStep = minStep;
+				if (deltaTime > settings.maxStep)
+					updateStep = settings.maxStep;
+				else if (deltaTime < settings.minStep)
+					updateStep = settings.minStep;
 				else
 					updateStep = deltaTime;
 			}
 			else
-				updateStep = constantStep;
+				updateStep = settings.constantStep;
 
 			while(deltaTime >= updateStep)
 			{
@@ -183,8 +328,13 @@ namespace SPK
 		else
 			alive = innerUpdate(deltaTime);
 
-		for (std::vector<Ref<Group> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
-			(*it)->sortParticles();
+		FinalizeJob finalizeJob(*this);
+		ThreadPool* pool = getThreadPool();
+		if (pool != NULL)
+			pool->parallelFor(groups.size(),finalizeJob);
+		else
+			for (size_t i = 0; i < groups.size(); ++i)
+				finalizeJob.run(i);
 
 		if (isAABBComputationEnabled())
 		{
@@ -194,8 +344,6 @@ namespace SPK
 
 			for (std::vector<Ref<Group> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
 			{
-				(*it)->computeAABB();
-
 				AABBMin.setMin((*it)->getAABBMin());
 				AABBMax.setMax((*it)->getAABBMax());
 			}
@@ -207,9 +355,35 @@ namespace SPK
 		}
 
 		active = alive;
+		updating = false;
+
+		if (recorder != NULL)
+			recorder->recordFrame(recordedDeltaTime);
+
 		return active;
 	}
 
+	uint32 System::computeStateHash() const
+	{
+		uint32 hash = 2166136261U;
+		for (std::vector<Ref<Group> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
+		{
+			const Group::ParticleData& data = (*it)->particleData;
+			const size_t nb = data.nbParticles;
+
+			hash = hashBytes(hash,&data.nbParticles,sizeof(size_t));
+			hash = hashBytes(hash,data.positions,nb * sizeof(Vector3D));
+			hash = hashBytes(hash,data.velocities,nb * sizeof(Vector3D));
+			hash = hashBytes(hash,data.ages,nb * sizeof(float));
+			hash = hashBytes(hash,data.lifeTimes,nb * sizeof(float));
+			hash = hashBytes(hash,data.colors,nb * sizeof(Color));
+			for (size_t i = 0; i < Group::NB_PARAMETERS; ++i)
+				if (data.parameters[i] != NULL)
+					hash = hashBytes(hash,data.parameters[i],nb * sizeof(float));
+		}
+		return hash;
+	}
+
 	void System::renderParticles() const
 	{
 		if (!initialized)
@@ -222,6 +396,28 @@ namespace SPK
 			(*it)->renderParticles();
 	}
 
+	void System::deferUpdate(float deltaTime)
+	{
+		if (recorder != NULL)
+			recorder->recordFrame(deltaTime,true);
+
+		const StepSettings& settings = getStepSettings();
+		if (settings.clampStepEnabled && deltaTime > settings.clampStep)
+			deltaTime = settings.clampStep;
+
+		deferredTime += deltaTime;
+	}
+
+	void System::reset()
+	{
+		for (std::vector<Ref<Group> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
+			(*it)->reset();
+
+		deltaStep = 0.0f;
+		deferredTime = 0.0f;
+		active = true;
+	}
+
 	void System::initialize()
 	{
 		if (initialized)
@@ -259,12 +455,86 @@ namespace SPK
 		}
 
 		// Particles
+		ThreadPool* pool = getThreadPool();
+		if (pool != NULL && pool->getNbWorkers() > 0 && groups.size() > 1)
+		{
+			computeClusters();
+			UpdateJob updateJob(*this,deltaTime);
+			pool->parallelFor(clusterOffsets.size() - 1,updateJob);
+			return updateJob.isAlive();
+		}
+
 		bool alive = false;
 		for (std::vector<Ref<Group> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
 			alive |= (*it)->updateParticles(deltaTime);
 		return alive;
 	}
 
+	void System::computeClusters()
+	{
+		const size_t nbGroups = groups.size();
+
+		std::vector<size_t> parents(nbGroups);
+		for (size_t i = 0; i < nbGroups; ++i)
+			parents[i] = i;
+
+		std::vector<const Group*> targets;
+		for (size_t i = 0; i < nbGroups; ++i)
+		{
+			const Group& group = *groups[i];
+
+			// Groups in which this group adds particles
+			targets.clear();
+			for (std::vector<Group::ModifierDef>::const_iterator it = group.modifiers.begin(); it != group.modifiers.end(); ++it)
+				it->obj->getTargetGroups(targets);
+			if (group.birthAction)
+				group.birthAction->getTargetGroups(targets);
+			if (group.deathAction)
+				group.deathAction->getTargetGroups(targets);
+
+			for (std::vector<const Group*>::const_iterator it = targets.begin(); it != targets.end(); ++it)
+				for (size_t j = 0; j < nbGroups; ++j)
+					if (groups[j] == *it)
+						linkClusters(parents,i,j);
+
+			// Groups sharing an emitter with this group (the emitter tank is modified at update)
+			for (std::vector<Ref<Emitter> >::const_iterator it = group.emitters.begin(); it != group.emitters.end(); ++it)
+				for (size_t j = 0; j < i; ++j)
+					if (std::find(groups[j]->emitters.begin(),groups[j]->emitters.end(),*it) != groups[j]->emitters.end())
+						linkClusters(parents,i,j);
+		}
+
+		// Groups of a cluster keep their order within the system
+		std::vector<size_t> clusterIndices(nbGroups,nbGroups);
+		clusterOffsets.assign(1,0);
+		for (size_t i = 0; i < nbGroups; ++i)
+		{
+			size_t root = findClusterRoot(parents,i);
+			if (clusterIndices[root] == nbGroups)
+			{
+				clusterIndices[root] = clusterOffsets.size() - 1;
+				clusterOffsets.push_back(0);
+			}
+			++clusterOffsets[clusterIndices[root] + 1];
+		}
+
+		for (size_t i = 1; i < clusterOffsets.size(); ++i)
+			clusterOffsets[i] += clusterOffsets[i - 1];
+
+		std::vector<size_t> positions(clusterOffsets.begin(),clusterOffsets.end() - 1);
+		clusterGroups.resize(nbGroups);
+		for (size_t i = 0; i < nbGroups; ++i)
+			clusterGroups[positions[clusterIndices[findClusterRoot(parents,i)]]++] = i;
+	}
+
+	bool System::updateCluster(size_t index,float deltaTime)
+	{
+		bool alive = false;
+		for (size_t i = clusterOffsets[index]; i < clusterOffsets[index + 1]; ++i)
+			alive |= groups[clusterGroups[i]]->updateParticles(deltaTime);
+		return alive;
+	}
+
 	void System::propagateUpdateTransform()
 	{
 		for (std::vector<Ref<Group> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
@@ -0,0 +1,125 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	SystemPool::SystemPool(const Ref<System>& prototype,size_t nbInstances) :
+		prototype(prototype),
+		maxNbInstances(0),
+		nbAcquisitions(0)
+	{
+		reserve(nbInstances);
+	}
+
+	void SystemPool::setPrototype(const Ref<System>& prototype)
+	{
+		this->prototype = prototype;
+		nbAcquisitions = 0;
+		usedInstances.clear();
+		freeInstances.clear();
+	}
+
+	void SystemPool::reserve(size_t nbInstances)
+	{
+		while (getNbInstances() < nbInstances && canCreateInstance())
+			freeInstances.push_back(SPKObject::copy(prototype));
+	}
+
+	Ref<System> SystemPool::acquire()
+	{
+		Ref<System> system;
+		if (!freeInstances.empty())
+		{
+			system = freeInstances.back();
+			freeInstances.pop_back();
+		}
+		else if (canCreateInstance())
+			system = SPKObject::copy(prototype);
+		else
+		{
+			SPK_LOG_WARNING("SystemPool::acquire() - The pool is exhausted, no instance can be handed out");
+			return SPK_NULL_REF;
+		}
+
+		// The prototype itself may have been updated so that even a new copy is reset
+		system->reset();
+		system->getTransform().set(prototype->getTransform().getLocal());
+
+		// Otherwise all the instances would copy the seed of the prototype and give the same particles
+		++nbAcquisitions;
+		if (prototype->isSeeded())
+			system->setSeed(prototype->getSeed() + nbAcquisitions);
+
+		usedInstances.push_back(system);
+		return system;
+	}
+
+	void SystemPool::release(const Ref<System>& system)
+	{
+		for (std::vector<Ref<System> >::iterator it = usedInstances.begin(); it != usedInstances.end(); ++it)
+			if (*it == system)
+			{
+				freeInstances.push_back(*it);
+				*it = usedInstances.back();
+				usedInstances.pop_back();
+				return;
+			}
+
+		SPK_LOG_WARNING("SystemPool::release(const Ref<System>&) - The system is not an instance in use of the pool");
+	}
+
+	size_t SystemPool::collect()
+	{
+		size_t nbCollected = 0;
+		for (size_t i = 0; i < usedInstances.size();)
+		{
+			// The reference of the pool is the only one left
+			if (!usedInstances[i]->isActive() && usedInstances[i]->getNbReferences() == 1)
+			{
+				freeInstances.push_back(usedInstances[i]);
+				usedInstances[i] = usedInstances.back();
+				usedInstances.pop_back();
+				++nbCollected;
+			}
+			else
+				++i;
+		}
+
+		return nbCollected;
+	}
+
+	bool SystemPool::updateParticles(float deltaTime)
+	{
+		for (std::vector<Ref<System> >::const_iterator it = usedInstances.begin(); it != usedInstances.end(); ++it)
+			(*it)->updateParticles(deltaTime);
+
+		collect();
+		return !usedInstances.empty();
+	}
+
+	void SystemPool::renderParticles() const
+	{
+		for (std::vector<Ref<System> >::const_iterator it = usedInstances.begin(); it != usedInstances.end(); ++it)
+			(*it)->renderParticles();
+	}
+}
@@ -0,0 +1,191 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	SystemRecorder::SystemRecorder() :
+		system(NULL),
+		seed(0),
+		stepSettings(System::defaultStepSettings),
+		updateInterval(0.0f)
+	{}
+
+	SystemRecorder::~SystemRecorder()
+	{
+		stopRecording();
+	}
+
+	void SystemRecorder::startRecording(System& system,uint32 seed)
+	{
+		stopRecording();
+		if (system.recorder != NULL)
+			system.recorder->stopRecording();
+
+		clear();
+
+		this->system = &system;
+		system.recorder = this;
+
+		this->seed = seed;
+		system.setSeed(seed);
+
+		stepSettings = system.getStepSettings();
+		updateInterval = system.updateInterval;
+	}
+
+	void SystemRecorder::stopRecording()
+	{
+		if (system != NULL)
+		{
+			system->recorder = NULL;
+			system = NULL;
+		}
+	}
+
+	void SystemRecorder::clear()
+	{
+		frames.clear();
+		additions.clear();
+	}
+
+	size_t SystemRecorder::replay(System& system) const
+	{
+		if (&system == this->system)
+		{
+			SPK_LOG_ERROR("SystemRecorder::replay(System&) - A recording cannot be replayed on the system being recorded");
+			return 0;
+		}
+
+		system.localStepSettings = stepSettings;
+		system.localStepEnabled = true;
+		system.updateInterval = updateInterval;
+		system.setSeed(seed);
+
+		size_t frameIndex = 0;
+		size_t additionIndex = 0;
+		for (; frameIndex < frames.size(); ++frameIndex)
+		{
+			const Frame& frame = frames[frameIndex];
+			for (; additionIndex < frame.additionsEnd; ++additionIndex)
+				replayAddition(system,additions[additionIndex]);
+
+			if (frame.deferred)
+				system.deferUpdate(frame.deltaTime);
+			else
+				system.updateParticles(frame.deltaTime);
+			if (system.computeStateHash() != frame.stateHash)
+				break;
+		}
+
+		return frameIndex;
+	}
+
+	void SystemRecorder::recordAddition(const Group& group,unsigned int nb,const Vector3D& position,const Vector3D& velocity,const Ref<Zone>& zone,const Ref<Emitter>& emitter,bool full)
+	{
+		Addition addition;
+		addition.groupIndex = std::find(system->groups.begin(),system->groups.end(),&group) - system->groups.begin();
+		addition.nb = nb;
+		addition.position = position;
+		addition.velocity = velocity;
+		addition.emitterSource = emitter ? SOURCE_EXTERNAL : SOURCE_NONE;
+		addition.emitterGroupIndex = 0;
+		addition.emitterIndex = 0;
+		addition.zoneSource = zone ? SOURCE_EXTERNAL : SOURCE_NONE;
+		addition.full = full;
+
+		// An emitter of the system is found back by its position in the system so that its copy can be used when replaying
+		// The state of its tank after the addition is kept as well
+		for (size_t i = 0; i < system->groups.size() && addition.emitterSource == SOURCE_EXTERNAL; ++i)
+		{
+			const std::vector<Ref<Emitter> >& emitters = system->groups[i]->emitters;
+			std::vector<Ref<Emitter> >::const_iterator it = std::find(emitters.begin(),emitters.end(),emitter);
+			if (it != emitters.end())
+			{
+				addition.emitterSource = SOURCE_GROUP;
+				addition.emitterGroupIndex = i;
+				addition.emitterIndex = it - emitters.begin();
+				addition.emitterTank = emitter->currentTank;
+				addition.emitterFraction = emitter->fraction;
+
+				if (zone == emitter->getZone())
+					addition.zoneSource = SOURCE_GROUP;
+			}
+		}
+
+		if (addition.emitterSource == SOURCE_EXTERNAL)
+			addition.emitter = emitter;
+		if (addition.zoneSource == SOURCE_EXTERNAL)
+			addition.zone = zone;
+
+		additions.push_back(addition);
+	}
+
+	void SystemRecorder::recordFlush(const Group& group)
+	{
+		recordAddition(group,0,Vector3D(),Vector3D(),SPK_NULL_REF,SPK_NULL_REF,false);
+	}
+
+	void SystemRecorder::recordFrame(float deltaTime,bool deferred)
+	{
+		Frame frame = {deltaTime,deferred,system->computeStateHash(),additions.size()};
+		frames.push_back(frame);
+	}
+
+	void SystemRecorder::replayAddition(System& system,const Addition& addition) const
+	{
+		if (addition.groupIndex >= system.groups.size())
+		{
+			SPK_LOG_ERROR("SystemRecorder::replayAddition(System&,const Addition&) - The group " << addition.groupIndex << " does not exist in the replayed system");
+			return;
+		}
+
+		Group& group = *system.groups[addition.groupIndex];
+		if (addition.nb == 0)
+		{
+			group.flushBufferedParticles();
+			return;
+		}
+
+		Ref<Emitter> emitter = addition.emitter;
+		Ref<Zone> zone = addition.zone;
+		if (addition.emitterSource == SOURCE_GROUP)
+		{
+			if (addition.emitterGroupIndex >= system.groups.size() || addition.emitterIndex >= system.groups[addition.emitterGroupIndex]->emitters.size())
+			{
+				SPK_LOG_ERROR("SystemRecorder::replayAddition(System&,const Addition&) - The emitter " << addition.emitterIndex << " of the group " << addition.emitterGroupIndex << " does not exist in the replayed system");
+				return;
+			}
+
+			emitter = system.groups[addition.emitterGroupIndex]->emitters[addition.emitterIndex];
+			emitter->currentTank = addition.emitterTank;
+			emitter->fraction = addition.emitterFraction;
+
+			if (addition.zoneSource == SOURCE_GROUP)
+				zone = emitter->getZone();
+		}
+
+		group.addParticles(addition.nb,addition.position,addition.velocity,zone,emitter,addition.full);
+	}
+}
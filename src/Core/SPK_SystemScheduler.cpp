@@ -0,0 +1,187 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#ifndef SPK_NO_THREADS
+#include <chrono>
+#else
+#include <ctime>
+#endif
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	namespace
+	{
+#ifndef SPK_NO_THREADS
+		typedef std::chrono::steady_clock::time_point TimePoint;
+
+		inline TimePoint getTime()
+		{
+			return std::chrono::steady_clock::now();
+		}
+
+		inline float getElapsedTime(const TimePoint& startTime)
+		{
+			return std::chrono::duration<float,std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		}
+#else
+		// Without threads, the processor time of the process is the time spent in the update
+		typedef std::clock_t TimePoint;
+
+		inline TimePoint getTime()
+		{
+			return std::clock();
+		}
+
+		inline float getElapsedTime(const TimePoint& startTime)
+		{
+			return static_cast<float>(std::clock() - startTime) * 1000.0f / CLOCKS_PER_SEC;
+		}
+#endif
+	}
+
+	// Sorts the indices of the entries by decreasing priority
+	class SystemScheduler::PriorityCompare
+	{
+	public :
+
+		PriorityCompare(const std::vector<Entry>& entries) :
+			entries(entries)
+		{}
+
+		bool operator()(size_t index0,size_t index1) const
+		{
+			return entries[index0].priority > entries[index1].priority;
+		}
+
+	private :
+
+		const std::vector<Entry>& entries;
+	};
+
+	const float SystemScheduler::COST_SMOOTHING = 0.25f;
+
+	SystemScheduler::SystemScheduler(float budget) :
+		budget(budget),
+		maxDeferredTime(0.5f)
+	{
+		statistics.nbUpdatedSystems = 0;
+		statistics.nbDeferredSystems = 0;
+		statistics.nbForcedSystems = 0;
+		statistics.updateTime = 0.0f;
+		statistics.maxDeferredTime = 0.0f;
+	}
+
+	void SystemScheduler::addSystem(const Ref<System>& system,float importance)
+	{
+		if (!system)
+		{
+			SPK_LOG_WARNING("SystemScheduler::addSystem(const Ref<System>&,float) - The system to add is NULL");
+			return;
+		}
+
+		Entry entry;
+		entry.system = system;
+		entry.importance = importance;
+		entry.priority = 0.0f;
+		entry.cost = 0.0f;
+		entry.costMeasured = false;
+		entry.deferredTime = 0.0f;
+		entry.alive = true;
+		entries.push_back(entry);
+	}
+
+	void SystemScheduler::removeSystem(const Ref<System>& system)
+	{
+		for (std::vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+			if (it->system == system)
+			{
+				entries.erase(it);
+				return;
+			}
+
+		SPK_LOG_WARNING("SystemScheduler::removeSystem(const Ref<System>&) - The system " << system.get() << " was not found in the scheduler and cannot be removed");
+	}
+
+	void SystemScheduler::removeAllSystems()
+	{
+		entries.clear();
+	}
+
+	bool SystemScheduler::updateParticles(float deltaTime)
+	{
+		statistics.nbUpdatedSystems = 0;
+		statistics.nbDeferredSystems = 0;
+		statistics.nbForcedSystems = 0;
+		statistics.maxDeferredTime = 0.0f;
+
+		// The systems lagging behind the most relatively to their importance are updated first
+		order.resize(entries.size());
+		for (size_t i = 0; i < entries.size(); ++i)
+		{
+			Entry& entry = entries[i];
+			entry.deferredTime += deltaTime;
+			entry.priority = entry.importance * entry.deferredTime;
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(),order.end(),PriorityCompare(entries));
+
+		bool alive = false;
+		const TimePoint startTime = getTime();
+		float elapsedTime = 0.0f;
+
+		for (std::vector<size_t>::const_iterator it = order.begin(); it != order.end(); ++it)
+		{
+			Entry& entry = entries[*it];
+
+			if (budget > 0.0f && elapsedTime + entry.cost > budget)
+			{
+				if (entry.deferredTime < maxDeferredTime)
+				{
+					// The system catches up later, the time is deferred by the system so that it is not clamped on catching up
+					entry.system->deferUpdate(deltaTime);
+					statistics.maxDeferredTime = std::max(statistics.maxDeferredTime,entry.deferredTime);
+					++statistics.nbDeferredSystems;
+					alive |= entry.alive;
+					continue;
+				}
+				++statistics.nbForcedSystems;
+			}
+
+			const TimePoint systemStartTime = getTime();
+			entry.alive = entry.system->updateParticles(deltaTime);
+			const float cost = getElapsedTime(systemStartTime);
+
+			entry.cost = entry.costMeasured ? entry.cost + (cost - entry.cost) * COST_SMOOTHING : cost;
+			entry.costMeasured = true;
+			entry.deferredTime = 0.0f;
+
+			alive |= entry.alive;
+			++statistics.nbUpdatedSystems;
+			elapsedTime = getElapsedTime(startTime);
+		}
+
+		statistics.updateTime = elapsedTime;
+		return alive;
+	}
+}
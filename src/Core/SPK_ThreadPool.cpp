@@ -0,0 +1,275 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPK_NO_THREADS
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#endif
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+#ifndef SPK_NO_THREADS
+
+	namespace
+	{
+		// The tasks of a single call to parallelFor
+		struct Batch
+		{
+			std::atomic<size_t> nbRemainingTasks;
+		};
+
+		struct Task
+		{
+			ThreadPool::Job* job;
+			size_t index;
+			Batch* batch;
+		};
+
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+	}
+
+	struct ThreadPool::Context
+	{
+		std::vector<std::thread> workers;
+		std::vector<WorkQueue*> queues;
+
+		std::mutex sleepMutex;
+		std::condition_variable sleepCondition;
+		std::atomic<size_t> nbPendingTasks;
+		std::atomic<size_t> nextQueueIndex;
+		bool running;
+
+		Context() :
+			nbPendingTasks(0),
+			nextQueueIndex(0),
+			running(true)
+		{}
+
+		void push(size_t queueIndex,const Task& task);
+		bool findTask(size_t queueIndex,Task& task);
+		void runTask(const Task& task);
+		void work(size_t queueIndex);
+	};
+
+	namespace
+	{
+		// Allows a worker to find back its own queue when it calls parallelFor (nested jobs)
+		thread_local const void* currentContext = NULL;
+		thread_local size_t currentQueueIndex = 0;
+	}
+
+	void ThreadPool::Context::push(size_t queueIndex,const Task& task)
+	{
+		WorkQueue& queue = *queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(task);
+	}
+
+	bool ThreadPool::Context::findTask(size_t queueIndex,Task& task)
+	{
+		if (nbPendingTasks.load() == 0)
+			return false;
+
+		const size_t nbQueues = queues.size();
+
+		// First, pops from the back of its own queue (most recent tasks, still hot in cache)
+		if (queueIndex < nbQueues)
+		{
+			WorkQueue& queue = *queues[queueIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = queue.tasks.back();
+				queue.tasks.pop_back();
+				--nbPendingTasks;
+				return true;
+			}
+		}
+
+		// Then steals from the front of the other queues
+		for (size_t i = 1; i <= nbQueues; ++i)
+		{
+			WorkQueue& queue = *queues[(queueIndex + i) % nbQueues];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = queue.tasks.front();
+				queue.tasks.pop_front();
+				--nbPendingTasks;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void ThreadPool::Context::runTask(const Task& task)
+	{
+		task.job->run(task.index);
+		task.batch->nbRemainingTasks.fetch_sub(1,std::memory_order_release);
+	}
+
+	void ThreadPool::Context::work(size_t queueIndex)
+	{
+		currentContext = this;
+		currentQueueIndex = queueIndex;
+
+		Task task;
+		while (true)
+		{
+			if (findTask(queueIndex,task))
+			{
+				runTask(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			while (running && nbPendingTasks.load() == 0)
+				sleepCondition.wait(lock);
+			if (!running && nbPendingTasks.load() == 0)
+				return;
+		}
+	}
+
+	ThreadPool::ThreadPool(size_t nbWorkers) :
+		context(SPK_NEW(Context))
+	{
+		if (nbWorkers == 0)
+			nbWorkers = getHardwareConcurrency() - 1;
+
+		context->queues.reserve(nbWorkers);
+		for (size_t i = 0; i < nbWorkers; ++i)
+			context->queues.push_back(SPK_NEW(WorkQueue));
+
+		context->workers.reserve(nbWorkers);
+		for (size_t i = 0; i < nbWorkers; ++i)
+			context->workers.push_back(std::thread(&Context::work,context,i));
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(context->sleepMutex);
+			context->running = false;
+		}
+		context->sleepCondition.notify_all();
+
+		for (size_t i = 0; i < context->workers.size(); ++i)
+			context->workers[i].join();
+
+		for (size_t i = 0; i < context->queues.size(); ++i)
+			SPK_DELETE(context->queues[i]);
+
+		SPK_DELETE(context);
+	}
+
+	size_t ThreadPool::getNbWorkers() const
+	{
+		return context->workers.size();
+	}
+
+	void ThreadPool::parallelFor(size_t nbTasks,Job& job)
+	{
+		const size_t nbQueues = context->queues.size();
+		if (nbQueues == 0 || nbTasks <= 1)
+		{
+			for (size_t i = 0; i < nbTasks; ++i)
+				job.run(i);
+			return;
+		}
+
+		Batch batch;
+		batch.nbRemainingTasks.store(nbTasks);
+
+		// A worker pushes the tasks in its own queue, other threads spread them among the workers
+		const bool isWorker = currentContext == context;
+		const size_t ownQueueIndex = isWorker ? currentQueueIndex : nbQueues;
+
+		// The first task is kept for the calling thread
+		for (size_t i = 1; i < nbTasks; ++i)
+		{
+			Task task = { &job,i,&batch };
+			++context->nbPendingTasks;
+			context->push(isWorker ? ownQueueIndex : context->nextQueueIndex++ % nbQueues,task);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(context->sleepMutex);
+		}
+		context->sleepCondition.notify_all();
+
+		Task task = { &job,0,&batch };
+		context->runTask(task);
+
+		// Takes part to the work until all the tasks of this call are done
+		while (batch.nbRemainingTasks.load(std::memory_order_acquire) > 0)
+		{
+			if (context->findTask(ownQueueIndex,task))
+				context->runTask(task);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	size_t ThreadPool::getHardwareConcurrency()
+	{
+		size_t nbThreads = std::thread::hardware_concurrency();
+		return nbThreads > 0 ? nbThreads : 1;
+	}
+
+#else
+
+	struct ThreadPool::Context {};
+
+	ThreadPool::ThreadPool(size_t nbWorkers) :
+		context(NULL)
+	{}
+
+	ThreadPool::~ThreadPool() {}
+
+	size_t ThreadPool::getNbWorkers() const
+	{
+		return 0;
+	}
+
+	void ThreadPool::parallelFor(size_t nbTasks,Job& job)
+	{
+		for (size_t i = 0; i < nbTasks; ++i)
+			job.run(i);
+	}
+
+	size_t ThreadPool::getHardwareConcurrency()
+	{
+		return 1;
+	}
+
+#endif
+}
@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	UpdateLOD::UpdateLOD() :
+		hiddenInterval(0.0f)
+	{}
+
+	void UpdateLOD::addLevel(float distance,float interval)
+	{
+		Level level = {distance,interval};
+
+		std::vector<Level>::iterator it = levels.begin();
+		while (it != levels.end() && it->distance <= distance)
+			++it;
+		levels.insert(it,level);
+	}
+
+	float UpdateLOD::computeInterval(float distance,bool visible) const
+	{
+		if (!visible && hiddenInterval > 0.0f)
+			return hiddenInterval;
+
+		float interval = 0.0f;
+		for (std::vector<Level>::const_iterator it = levels.begin(); it != levels.end() && it->distance <= distance; ++it)
+			interval = it->interval;
+		return interval;
+	}
+
+	void UpdateLOD::apply(System& system,float distance,bool visible) const
+	{
+		system.setUpdateInterval(computeInterval(distance,visible));
+	}
+}
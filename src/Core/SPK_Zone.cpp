@@ -19,6 +19,8 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <cstring> // for memset
+
 #include <SPARK_Core.h>
 
 namespace SPK
@@ -35,6 +37,74 @@ namespace SPK
 		&Zone::checkAlways,
 	};
 
+	void Zone::generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii) const
+	{
+		if (radii != NULL)
+			for (size_t i = 0; i < nb; ++i)
+				generatePosition(positions[i],full,radii[i]);
+		else
+			for (size_t i = 0; i < nb; ++i)
+				generatePosition(positions[i],full);
+	}
+
+	void Zone::checkBatch(ZoneTest zoneTest,const Vector3D* positions,const Vector3D* oldPositions,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		for (size_t start = 0; start < nb; start += BATCH_SIZE)
+		{
+			const size_t blockSize = nb - start < BATCH_SIZE ? nb - start : BATCH_SIZE;
+			const float* blockRadii = radii != NULL ? radii + start : NULL;
+			Vector3D* blockNormals = normals != NULL ? normals + start : NULL;
+			uint8* blockMask = mask + start;
+
+			switch (zoneTest)
+			{
+			case ZONE_TEST_INSIDE :
+				containsBatch(positions + start,blockRadii,1.0f,blockSize,blockMask);
+				break;
+
+			case ZONE_TEST_OUTSIDE :
+				containsBatch(positions + start,blockRadii,-1.0f,blockSize,blockMask);
+				for (size_t i = 0; i < blockSize; ++i)
+					blockMask[i] ^= 1;
+				break;
+
+			case ZONE_TEST_INTERSECT :
+				std::memset(blockMask,1,blockSize);
+				intersectsBatch(oldPositions + start,positions + start,blockRadii,blockSize,blockMask,blockNormals);
+				break;
+
+			case ZONE_TEST_ENTER :
+				containsBatch(oldPositions + start,NULL,1.0f,blockSize,blockMask);
+				for (size_t i = 0; i < blockSize; ++i)
+					blockMask[i] ^= 1;
+				intersectsBatch(oldPositions + start,positions + start,blockRadii,blockSize,blockMask,blockNormals);
+				break;
+
+			case ZONE_TEST_LEAVE :
+				containsBatch(oldPositions + start,NULL,1.0f,blockSize,blockMask);
+				intersectsBatch(oldPositions + start,positions + start,blockRadii,blockSize,blockMask,blockNormals);
+				break;
+
+			default : // ZONE_TEST_ALWAYS
+				std::memset(blockMask,1,blockSize);
+				break;
+			}
+		}
+	}
+
+	void Zone::containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = contains(positions[i],radii != NULL ? radii[i] * radiusFactor : 0.0f);
+	}
+
+	void Zone::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			if (mask[i] != 0)
+				mask[i] = intersects(v0[i],v1[i],radii != NULL ? radii[i] : 0.0f,normals != NULL ? normals + i : NULL);
+	}
+
 	bool Zone::checkInside(const Particle& particle,Vector3D* normal) const
 	{
 		return contains(particle.position(),particle.getRadius());
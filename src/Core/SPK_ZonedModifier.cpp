@@ -30,8 +30,9 @@ namespace SPK
 		bool NEEDS_OCTREE,
 		int ZONE_TEST_FLAG,
 		ZoneTest zoneTest,
-		const Ref<Zone>& zone) :
-		Modifier(PRIORITY,NEEDS_DATASET,CALL_INIT,NEEDS_OCTREE),
+		const Ref<Zone>& zone,
+		bool CHUNK_SAFE) :
+		Modifier(PRIORITY,NEEDS_DATASET,CALL_INIT,NEEDS_OCTREE,CHUNK_SAFE),
 		ZONE_TEST_FLAG(ZONE_TEST_FLAG),
 		zoneTest(zoneTest),
 		zone()
@@ -77,6 +78,31 @@ namespace SPK
 		}
 	}
 
+	void ZonedModifier::checkZoneBatch(const Group& group,size_t start,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		SPK_ASSERT(nb <= Zone::BATCH_SIZE,"ZonedModifier::checkZoneBatch(const Group&,size_t,size_t,uint8*,Vector3D*) - The block of particles is too large");
+
+		// The radius of a particle is the physical radius of its group scaled by its scale parameter (see Particle::getRadius())
+		float radii[Zone::BATCH_SIZE];
+		const float* scales = static_cast<const float*>(group.getParamAddress(PARAM_SCALE));
+		const float physicalRadius = group.getPhysicalRadius();
+		if (scales != NULL)
+			for (size_t i = 0; i < nb; ++i)
+				radii[i] = physicalRadius * scales[start + i];
+		else
+			for (size_t i = 0; i < nb; ++i)
+				radii[i] = physicalRadius; // the default scale is 1
+
+		zone->checkBatch(
+			zoneTest,
+			static_cast<const Vector3D*>(group.getPositionAddress()) + start,
+			static_cast<const Vector3D*>(group.getOldPositionAddress()) + start,
+			radii,
+			nb,
+			mask,
+			normals);
+	}
+
 	Ref<SPKObject> ZonedModifier::findByName(const std::string& name)
 	{
 		Ref<SPKObject> object = SPKObject::findByName(name);
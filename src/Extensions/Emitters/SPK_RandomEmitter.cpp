@@ -19,6 +19,7 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm> // for min
 #include <cmath> // for sqrt
 
 #include <SPARK_Core.h>
@@ -28,15 +29,35 @@ namespace SPK
 {
 	void RandomEmitter::generateVelocity(Particle& particle,float speed) const
 	{
+		RandomGenerator& generator = RandomGenerator::getCurrent();
 		float sqrNorm;
 		
 		do 
 		{
-			particle.velocity().set(SPK_RANDOM(-1.0f,1.0f),SPK_RANDOM(-1.0f,1.0f),SPK_RANDOM(-1.0f,1.0f));
+			particle.velocity().set(generator.generate(-1.0f,1.0f),generator.generate(-1.0f,1.0f),generator.generate(-1.0f,1.0f));
 			sqrNorm = particle.velocity().getSqrNorm();
 		}
 		while((sqrNorm > 1.0f) || (sqrNorm == 0.0f));
 
 		particle.velocity() *= speed / std::sqrt(sqrNorm);
 	}
+
+	void RandomEmitter::generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const
+	{
+		// The directions are generated in bulk without any rejection
+		const size_t BLOCK_SIZE = 256;
+		Vector3D directions[BLOCK_SIZE];
+
+		RandomGenerator& generator = RandomGenerator::getCurrent();
+		for (size_t blockStart = 0; blockStart < nb; blockStart += BLOCK_SIZE)
+		{
+			const size_t blockSize = std::min(BLOCK_SIZE,nb - blockStart);
+			generator.fillDirections(directions,blockSize);
+
+			const Vector3D* dir = directions;
+			const float* speed = speeds + blockStart;
+			for (GroupIterator particleIt(group,start + blockStart,start + blockStart + blockSize); !particleIt.end(); ++particleIt)
+				particleIt->velocity() = *(dir++) * *(speed++);
+		}
+	}
 }
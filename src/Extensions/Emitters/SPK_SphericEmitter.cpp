@@ -19,6 +19,8 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm> // for min
+
 #include <SPARK_Core.h>
 #include "Extensions/Emitters/SPK_SphericEmitter.h"
 
@@ -132,6 +134,33 @@ namespace SPK
 		particle.velocity().z = speed * (matrix[6] * x + matrix[7] * y + matrix[8] * z);
 	}
 
+	void SphericEmitter::generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const
+	{
+		// The directions are generated in bulk within the cone around the z axis without any trigonometric function per particle
+		// and are then rotated towards the direction of the emitter
+		const size_t BLOCK_SIZE = 256;
+		Vector3D directions[BLOCK_SIZE];
+
+		RandomGenerator& generator = RandomGenerator::getCurrent();
+		for (size_t blockStart = 0; blockStart < nb; blockStart += BLOCK_SIZE)
+		{
+			const size_t blockSize = std::min(BLOCK_SIZE,nb - blockStart);
+			generator.fillDirections(directions,blockSize,cosAngleMax,cosAngleMin);
+
+			const Vector3D* dir = directions;
+			const float* speed = speeds + blockStart;
+			for (GroupIterator particleIt(group,start + blockStart,start + blockStart + blockSize); !particleIt.end(); ++particleIt)
+			{
+				Vector3D& velocity = particleIt->velocity();
+				velocity.x = *speed * (matrix[0] * dir->x + matrix[1] * dir->y + matrix[2] * dir->z);
+				velocity.y = *speed * (matrix[3] * dir->x + matrix[4] * dir->y + matrix[5] * dir->z);
+				velocity.z = *speed * (matrix[6] * dir->x + matrix[7] * dir->y + matrix[8] * dir->z);
+				++dir;
+				++speed;
+			}
+		}
+	}
+
 	void SphericEmitter::innerUpdateTransform()
 	{
 		Emitter::innerUpdateTransform();
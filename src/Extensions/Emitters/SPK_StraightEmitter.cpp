@@ -58,6 +58,12 @@ namespace SPK
 		particle.velocity() *= speed;
 	}
 
+	void StraightEmitter::generateVelocities(Group& group,size_t start,size_t nb,const float* speeds) const
+	{
+		for (GroupIterator particleIt(group,start,start + nb); !particleIt.end(); ++particleIt)
+			particleIt->velocity() = tDirection * *(speeds++);
+	}
+
 	void StraightEmitter::innerUpdateTransform()
 	{
 		Emitter::innerUpdateTransform();
@@ -206,9 +206,9 @@ namespace IO
 			T buffer;
 			size_t pos = 0;
 			size_t next = vec.find(';');
-			if(next - pos > 1)
+			if(!vec.empty() && next > 0) // the first value is not preceded by a separator
 			{
-				decodeValue(vec.substr(pos + 1, next - pos - 1), buffer);
+				decodeValue(vec.substr(0, next), buffer);
 				value.push_back(buffer);
 			}
 			pos = next;
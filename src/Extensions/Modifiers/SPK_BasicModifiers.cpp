@@ -26,27 +26,64 @@
 
 namespace SPK
 {
-	void Gravity::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	void Gravity::modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const
 	{
 		const Vector3D discreteGravity = tValue * deltaTime;
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
 			particleIt->velocity() += discreteGravity;
 	}
 
-	void Friction::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	void Gravity::modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const
+	{
+		// Only the coordinates affected by the gravity are modified
+		const Vector3D discreteGravity = tValue * deltaTime;
+		if (discreteGravity.x != 0.0f)
+			Kernels::add(streams.velocities.x,discreteGravity.x,end - start);
+		if (discreteGravity.y != 0.0f)
+			Kernels::add(streams.velocities.y,discreteGravity.y,end - start);
+		if (discreteGravity.z != 0.0f)
+			Kernels::add(streams.velocities.z,discreteGravity.z,end - start);
+	}
+
+	void Friction::modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const
 	{
 		const float discreteFriction = value * deltaTime;
 
 		if (group.isEnabled(PARAM_MASS))
 		{
-			for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+			for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
 				particleIt->velocity() *= 1.0f - std::min(1.0f,discreteFriction / particleIt->getParamNC(PARAM_MASS));
 		}
 		else
 		{
 			const float ratio =  1.0f - std::min(1.0f,discreteFriction);
-			for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+			for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
 				particleIt->velocity() *= ratio;
 		}
 	}
+
+	void Friction::modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const
+	{
+		const float discreteFriction = value * deltaTime;
+		const size_t nb = end - start;
+
+		if (group.isEnabled(PARAM_MASS))
+		{
+			const float* masses = static_cast<const float*>(group.getParamAddress(PARAM_MASS)) + start;
+			for (size_t i = 0; i < nb; ++i)
+			{
+				const float ratio = 1.0f - std::min(1.0f,discreteFriction / masses[i]);
+				streams.velocities.x[i] *= ratio;
+				streams.velocities.y[i] *= ratio;
+				streams.velocities.z[i] *= ratio;
+			}
+		}
+		else
+		{
+			const float ratio =  1.0f - std::min(1.0f,discreteFriction);
+			Kernels::multiply(streams.velocities.x,ratio,nb);
+			Kernels::multiply(streams.velocities.y,ratio,nb);
+			Kernels::multiply(streams.velocities.z,ratio,nb);
+		}
+	}
 }
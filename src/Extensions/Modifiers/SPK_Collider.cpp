@@ -19,11 +19,63 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm> // for std::min
+
 #include <SPARK_Core.h>
 #include "Extensions/Modifiers/SPK_Collider.h"
 
 namespace SPK
 {
+	namespace
+	{
+		// Tells whether the particle belongs to one of the first cells of the list
+		bool isInCells(const Octree& octree,const Octree::Array<size_t>& cells,size_t nbCells,size_t particleIndex)
+		{
+			const Octree::Array<size_t>& particleCells = octree.getNeighborCells(particleIndex);
+			for (size_t i = 0; i < nbCells; ++i)
+				for (size_t j = 0; j < particleCells.size(); ++j)
+					if (cells[i] == particleCells[j])
+						return true;
+			return false;
+		}
+	}
+
+	// Solves or applies the collisions of a chunk of particles
+	class Collider::SolverJob : public ThreadPool::Job
+	{
+	public :
+
+		SolverJob(const Collider& collider,Group& group,DataSet* dataSet) :
+			collider(collider),
+			group(group),
+			dataSet(dataSet),
+			applying(false)
+		{}
+
+		void setApplying(bool applying)
+		{
+			this->applying = applying;
+		}
+
+		virtual void run(size_t index)
+		{
+			size_t start = index * SOLVER_CHUNK_SIZE;
+			size_t end = std::min(start + SOLVER_CHUNK_SIZE,group.getNbParticles());
+
+			if (applying)
+				collider.applyRange(group,dataSet,start,end);
+			else
+				collider.solveRange(group,dataSet,start,end);
+		}
+
+	private :
+
+		const Collider& collider;
+		Group& group;
+		DataSet* dataSet;
+		bool applying;
+	};
+
 	void Collider::setElasticity(float elasticity)
 	{
 		if (elasticity < 0.0f)
@@ -35,7 +87,168 @@ namespace SPK
 		this->elasticity = elasticity;
 	}
 
+	void Collider::createData(DataSet& dataSet,const Group& group) const
+	{
+		// Only the parallel solver needs to store the changes of the particles
+		dataSet.init(NB_DATA);
+		if (parallelSolvingEnabled)
+		{
+			dataSet.setData(VELOCITY_DELTA_INDEX,SPK_NEW(Vector3DArrayData,group.getCapacity(),1));
+			dataSet.setData(RESET_POSITION_INDEX,SPK_NEW(ArrayData<unsigned char>,group.getCapacity(),1));
+		}
+	}
+
+	void Collider::checkData(DataSet& dataSet,const Group& group) const
+	{
+		// If the solver has changed, the data must be created or destroyed
+		if ((dataSet.getData(VELOCITY_DELTA_INDEX) != NULL) != parallelSolvingEnabled)
+			createData(dataSet,group);
+	}
+
 	void Collider::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (!parallelSolvingEnabled)
+		{
+			solveSerial(group);
+			return;
+		}
+
+		SPK_ASSERT(group.getOctree() != NULL,"Collider::modify(Group&,DataSet*,float) - The group has no spatial index");
+
+		const size_t nbChunks = (group.getNbParticles() + SOLVER_CHUNK_SIZE - 1) / SOLVER_CHUNK_SIZE;
+		ThreadPool* threadPool = group.getThreadPool();
+		SolverJob job(*this,group,dataSet);
+
+		// The velocity changes are all computed before being applied so that the result does not depend on the order of the chunks
+		for (size_t phase = 0; phase < 2; ++phase)
+		{
+			job.setApplying(phase == 1);
+			if (threadPool != NULL && nbChunks > 1)
+				threadPool->parallelFor(nbChunks,job);
+			else
+				for (size_t i = 0; i < nbChunks; ++i)
+					job.run(i);
+		}
+	}
+
+	void Collider::solveRange(Group& group,DataSet* dataSet,size_t start,size_t end) const
+	{
+		const float groupSqrRadius = group.getPhysicalRadius() * group.getPhysicalRadius();
+		const Octree& octree = *group.getOctree();
+
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		const Vector3D* oldPositions = static_cast<const Vector3D*>(group.getOldPositionAddress());
+		const Vector3D* velocities = static_cast<const Vector3D*>(group.getVelocityAddress());
+		const float* scales = static_cast<const float*>(group.getParamAddress(PARAM_SCALE)); // NULL if the scale is not enabled
+		const float* masses = static_cast<const float*>(group.getParamAddress(PARAM_MASS)); // NULL if the mass is not enabled
+
+		Vector3D* velocityDeltas = SPK_GET_DATA(Vector3DArrayData,dataSet,VELOCITY_DELTA_INDEX).getData();
+		unsigned char* resetPositions = SPK_GET_DATA(ArrayData<unsigned char>,dataSet,RESET_POSITION_INDEX).getData();
+
+		for (size_t index0 = start; index0 < end; ++index0)
+		{
+			const Vector3D& position0 = positions[index0];
+			const Vector3D& velocity0 = velocities[index0];
+			const float radius0 = scales != NULL ? scales[index0] : 1.0f;
+			const float m0 = masses != NULL ? masses[index0] : 1.0f;
+
+			Vector3D velocityDelta;
+			bool resetPosition = false;
+
+			const Octree::Array<size_t>& neighborCells = octree.getNeighborCells(index0);
+			size_t nbCells = neighborCells.size();
+
+			for (size_t i = 0; i < nbCells; ++i) // For each neighboring cell in the spatial index
+			{
+				const Octree::Cell& cell = octree.getCell(neighborCells[i]);
+				size_t nbParticleInCells = cell.particles.size();
+
+				for (size_t j = 0; j < nbParticleInCells; ++j) // for each particles in the cell
+				{
+					size_t index1 = cell.particles[j];
+					if (index1 == index0)
+						continue;
+
+					const float radius1 = scales != NULL ? scales[index1] : 1.0f;
+
+					float sqrRadius = radius0 + radius1;
+					sqrRadius *= sqrRadius * groupSqrRadius;
+
+					// Gets the normal of the collision plane
+					Vector3D normal = position0 - positions[index1];
+					float sqrDist = normal.getSqrNorm();
+
+					if (sqrDist >= sqrRadius || isInCells(octree,neighborCells,i,index1)) // not intersecting or already processed in a previous cell
+						continue;
+
+					const Vector3D& velocity1 = velocities[index1];
+					Vector3D delta = velocity0 - velocity1;
+
+					if (dotProduct(normal,delta) >= 0.0f) // particles are not moving towards each other
+						continue;
+
+					float oldSqrDist = getSqrDist(oldPositions[index0],oldPositions[index1]);
+					if (oldSqrDist > sqrDist)
+					{
+						// Disables the move from this frame
+						resetPosition = true;
+						normal = oldPositions[index0] - oldPositions[index1];
+
+						if (dotProduct(normal,delta) >= 0.0f)
+							continue;
+					}
+
+					normal.normalize();
+
+					// Gets the normal components of the velocities
+					Vector3D normal0 = normal * dotProduct(normal,velocity0);
+					Vector3D normal1 = normal * dotProduct(normal,velocity1);
+
+					if (oldSqrDist < sqrRadius)
+					{
+						// Tweak to separate particles that intersects at both t - deltaTime and t
+						// In that case the collision is no more considered as punctual
+						if (dotProduct(normal,normal0) < 0.0f)
+							velocityDelta -= normal0;
+
+						if (dotProduct(normal,normal1) > 0.0f)
+							velocityDelta += normal1;
+					}
+					else
+					{
+						// Else classic collision equations are applied
+						// Tangent components of the velocities are left untouched
+						const float m1 = masses != NULL ? masses[index1] : 1.0f;
+						const float invM01 = 1 / (m0 + m1);
+
+						velocityDelta -= (1.0f + (elasticity * m1 - m0) * invM01) * normal0;
+						velocityDelta += ((1.0f + elasticity) * m1 * invM01) * normal1;
+					}
+				}
+			}
+
+			velocityDeltas[index0] = velocityDelta;
+			resetPositions[index0] = resetPosition ? 1 : 0;
+		}
+	}
+
+	void Collider::applyRange(Group& group,DataSet* dataSet,size_t start,size_t end) const
+	{
+		const Vector3D* velocityDeltas = SPK_GET_DATA(Vector3DArrayData,dataSet,VELOCITY_DELTA_INDEX).getData();
+		const unsigned char* resetPositions = SPK_GET_DATA(ArrayData<unsigned char>,dataSet,RESET_POSITION_INDEX).getData();
+
+		for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
+		{
+			Particle& particle = *particleIt;
+			size_t index = particle.getIndex();
+
+			if (resetPositions[index] != 0)
+				particle.position() = particle.oldPosition();
+			particle.velocity() += velocityDeltas[index];
+		}
+	}
+
+	void Collider::solveSerial(Group& group) const
 	{
 		float groupSqrRadius = group.getPhysicalRadius() * group.getPhysicalRadius();
 		SPK_ASSERT(group.getOctree() != NULL,"GLQuadRenderer::render(const Group&,const DataSet*,RenderBuffer*) - renderBuffer must not be NULL");
@@ -129,7 +342,7 @@ namespace SPK
 								particle1.velocity() -= (1.0f + (elasticityM0 - m1) * invM01) * normal1;
 
 								normal0 *= (elasticityM0 + m0) * invM01;
-								normal1 *= (elasticityM1 + m0) * invM01;
+								normal1 *= (elasticityM1 + m1) * invM01;
 
 								particle0.velocity() += normal1;
 								particle1.velocity() += normal0;
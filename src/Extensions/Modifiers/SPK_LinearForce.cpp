@@ -25,7 +25,7 @@
 namespace SPK
 {
 	LinearForce::LinearForce(const Vector3D& value,const Ref<Zone>& zone,ZoneTest zoneTest) :
-		ZonedModifier(MODIFIER_PRIORITY_FORCE,false,false,false,ZONE_TEST_FLAG_ALWAYS | ZONE_TEST_FLAG_INSIDE | ZONE_TEST_FLAG_OUTSIDE,zoneTest,zone),
+		ZonedModifier(MODIFIER_PRIORITY_FORCE,false,false,false,ZONE_TEST_FLAG_ALWAYS | ZONE_TEST_FLAG_INSIDE | ZONE_TEST_FLAG_OUTSIDE,zoneTest,zone,true),
 		relative(false),
 		squaredSpeed(false),
 		param(PARAM_SCALE),
@@ -130,7 +130,7 @@ namespace SPK
 		return discreteFactor;
 	}
 
-	void LinearForce::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	void LinearForce::modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const
 	{
 		// Optimization to compute the factor only if needed
 		bool factorByParticle = true;
@@ -145,51 +145,60 @@ namespace SPK
 			for (int i = 0; i < factor; ++i)
 				realCoef *= group.getPhysicalRadius();
 
-		if (!relative)
+		const Vector3D discreteForce = tValue * deltaTime * realCoef;
+
+		// The zone is checked by blocks of particles
+		uint8 mask[Zone::BATCH_SIZE];
+		for (size_t blockStart = start; blockStart < end; blockStart += Zone::BATCH_SIZE)
 		{
-			const Vector3D discreteForce = tValue * deltaTime * realCoef;
+			const size_t blockEnd = end - blockStart < Zone::BATCH_SIZE ? end : blockStart + Zone::BATCH_SIZE;
+			checkZoneBatch(group,blockStart,blockEnd - blockStart,mask);
+			const uint8* particleMask = mask;
 
-			if (!factorByParticle)
+			if (!relative)
 			{
-				for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-					if (checkZone(*particleIt))
-						particleIt->velocity() += discreteForce;
+				if (!factorByParticle)
+				{
+					for (GroupIterator particleIt(group,blockStart,blockEnd); !particleIt.end(); ++particleIt, ++particleMask)
+						if (*particleMask != 0)
+							particleIt->velocity() += discreteForce;
+				}
+				else
+				{
+					for (GroupIterator particleIt(group,blockStart,blockEnd); !particleIt.end(); ++particleIt, ++particleMask)
+						if (*particleMask != 0)
+							particleIt->velocity() += discreteForce * getDiscreteFactor(*particleIt);
+				}
 			}
 			else
 			{
-				for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-					if (checkZone(*particleIt))
-						particleIt->velocity() += discreteForce * getDiscreteFactor(*particleIt);
-			}
-		}
-		else
-		{
-			for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-				if (checkZone(*particleIt))
-				{
-					Particle& particle = *particleIt;
-					Vector3D relativeForce = tValue - particle.velocity();
-
-					float clamp = 1.0f;
-					if (squaredSpeed)
+				for (GroupIterator particleIt(group,blockStart,blockEnd); !particleIt.end(); ++particleIt, ++particleMask)
+					if (*particleMask != 0)
 					{
-						Vector3D absForce(relativeForce);
-						absForce.abs();
-						clamp = 1.0f / absForce.getMax();
-						relativeForce *= relativeForce;
+						Particle& particle = *particleIt;
+						Vector3D relativeForce = tValue - particle.velocity();
+
+						float clamp = 1.0f;
+						if (squaredSpeed)
+						{
+							Vector3D absForce(relativeForce);
+							absForce.abs();
+							clamp = 1.0f / absForce.getMax();
+							relativeForce *= relativeForce;
+						}
+
+						float discreteFactor = deltaTime * realCoef;
+						if (factorByParticle)
+							discreteFactor *= getDiscreteFactor(particle);
+
+						// the factor is clamped due to the use of a discrete time.
+						// this is to prevent odd behaviours like the air drag being so strong that particle starts going towards the opposite direction.
+						if (discreteFactor > clamp)
+							discreteFactor = clamp;
+
+						particle.velocity() += relativeForce * discreteFactor;
 					}
-
-					float discreteFactor = deltaTime * realCoef;
-					if (factorByParticle)
-						discreteFactor *= getDiscreteFactor(particle);
-
-					// the factor is clamped due to the use of a discrete time.
-					// this is to prevent odd behaviours like the air drag being so strong that particle starts going towards the opposite direction.
-					if (discreteFactor > clamp)
-						discreteFactor = clamp;
-
-					particle.velocity() += relativeForce * discreteFactor;
-				}
+			}
 		}
 	}
 }
@@ -36,38 +36,57 @@ namespace SPK
 		friction(obstacle.friction)
 	{}
 
-	void Obstacle::init(Particle& particle,DataSet* dataSet) const
+	void Obstacle::initBatch(Group& group,DataSet* dataSet,size_t start,size_t end) const
 	{
-		switch(getZoneTest()) 
+		// Only the particles spawning inside a plain obstacle are killed
+		if (getZoneTest() != ZONE_TEST_INSIDE && getZoneTest() != ZONE_TEST_OUTSIDE)
+			return;
+
+		uint8 mask[Zone::BATCH_SIZE];
+		for (size_t blockStart = start; blockStart < end; blockStart += Zone::BATCH_SIZE)
 		{
-		case ZONE_TEST_INSIDE :
-		case ZONE_TEST_OUTSIDE :
-			if (checkZone(particle))
-				particle.kill(); // If the particle spawns inside a plain obstacle, it is killed
-			break;
+			const size_t blockEnd = end - blockStart < Zone::BATCH_SIZE ? end : blockStart + Zone::BATCH_SIZE;
+			checkZoneBatch(group,blockStart,blockEnd - blockStart,mask);
+			const uint8* particleMask = mask;
+
+			for (GroupIterator particleIt(group,blockStart,blockEnd); !particleIt.end(); ++particleIt, ++particleMask)
+				if (*particleMask != 0)
+					particleIt->kill();
 		}
 	}
 
 	void Obstacle::modify(Group& group,DataSet* dataSet,float deltaTime) const
 	{
-		Vector3D normal;
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		uint8 mask[Zone::BATCH_SIZE];
+		Vector3D normals[Zone::BATCH_SIZE];
+
+		const size_t nbParticles = group.getNbParticles();
+		for (size_t blockStart = 0; blockStart < nbParticles; blockStart += Zone::BATCH_SIZE)
 		{
-			if (checkZone(*particleIt,&normal))
-			{ 
-				particleIt->position() = particleIt->oldPosition();
+			const size_t blockEnd = nbParticles - blockStart < Zone::BATCH_SIZE ? nbParticles : blockStart + Zone::BATCH_SIZE;
+			checkZoneBatch(group,blockStart,blockEnd - blockStart,mask,normals);
+			const uint8* particleMask = mask;
+			Vector3D* normal = normals;
+
+			for (GroupIterator particleIt(group,blockStart,blockEnd); !particleIt.end(); ++particleIt, ++particleMask, ++normal)
+			{
+				if (*particleMask != 0)
+				{ 
+					particleIt->position() = particleIt->oldPosition();
+
+					Vector3D& velocity = particleIt->velocity();
+					float dist = dotProduct(velocity,*normal);
 
-				Vector3D& velocity = particleIt->velocity();
+					*normal *= dist - 0.001f;
+					velocity -= *normal;		// tangent component
+					velocity *= friction;
+					*normal *= bouncingRatio;	// normal component
 
-				float dist = dotProduct(velocity,normal);
+					if (dist > 0.0f)
+						normal->revert();
 
-				normal *= dist - 0.001f;
-				velocity -= normal;			// tangent component
-				velocity *= friction;
-				normal *= bouncingRatio;	// normal component
-				if (dist > 0.0f)
-					normal.revert();
-				velocity -= normal;
+					velocity -= *normal;
+				}
 			}
 		}
 	}
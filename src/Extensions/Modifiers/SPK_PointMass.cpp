@@ -19,13 +19,15 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm> // for min
+
 #include <SPARK_Core.h>
 #include "Extensions/Modifiers/SPK_PointMass.h"
 
 namespace SPK
 {
 	PointMass::PointMass(const Vector3D& pos,float mass,float offset) :
-		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false),
+		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false,true,true),
 		mass(mass)
 	{
 		setPosition(pos);
@@ -51,12 +53,12 @@ namespace SPK
 		this->offset = offset;
 	}
 
-	void PointMass::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	void PointMass::modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const
 	{
 		float sqrOffset = offset * offset;
 		float massSecond = mass * deltaTime;
 
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
 		{
 			Particle& particle = *particleIt;
 			Vector3D force = tPosition - particle.position();
@@ -64,4 +66,35 @@ namespace SPK
 			particle.velocity() += force;
 		}
 	}
+
+	void PointMass::modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const
+	{
+		const float sqrOffset = offset * offset;
+		const float massSecond = mass * deltaTime;
+		const Vector3DStreams positions = streams.positions;
+		const Vector3DStreams velocities = streams.velocities;
+
+		// The loops are split so that each one reads and writes few streams and can be vectorized by the compiler
+		const size_t BATCH_SIZE = 64;
+		float ratios[BATCH_SIZE];
+		for (size_t batchStart = 0, nb = end - start; batchStart < nb; batchStart += BATCH_SIZE)
+		{
+			const size_t batchEnd = std::min(batchStart + BATCH_SIZE,nb);
+
+			for (size_t i = batchStart; i < batchEnd; ++i)
+			{
+				float forceX = tPosition.x - positions.x[i];
+				float forceY = tPosition.y - positions.y[i];
+				float forceZ = tPosition.z - positions.z[i];
+				ratios[i - batchStart] = massSecond / (forceX * forceX + forceY * forceY + forceZ * forceZ + sqrOffset);
+			}
+
+			for (size_t i = batchStart; i < batchEnd; ++i)
+				velocities.x[i] += (tPosition.x - positions.x[i]) * ratios[i - batchStart];
+			for (size_t i = batchStart; i < batchEnd; ++i)
+				velocities.y[i] += (tPosition.y - positions.y[i]) * ratios[i - batchStart];
+			for (size_t i = batchStart; i < batchEnd; ++i)
+				velocities.z[i] += (tPosition.z - positions.z[i]) * ratios[i - batchStart];
+		}
+	}
 }
@@ -24,15 +24,21 @@
 
 namespace SPK
 {
-	void Rotator::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	void Rotator::modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const
 	{
 		if (group.isEnabled(PARAM_ANGLE) && group.isEnabled(PARAM_ROTATION_SPEED))
-			for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+			for (GroupIterator particleIt(group,start,end); !particleIt.end(); ++particleIt)
 			{
 				float angle = particleIt->getParamNC(PARAM_ANGLE) + particleIt->getParamNC(PARAM_ROTATION_SPEED) * deltaTime;
 				particleIt->setParamNC(PARAM_ANGLE,angle);
 			}
-		else
-			SPK_LOG_WARNING("Rotator::modify(Group&,DataSet*,float) - PARAM_ANGLE and PARAM_ROTATION_SPEED must be enabled to use a rotator");
+		else if (start == 0) // logs only once per update
+			SPK_LOG_WARNING("Rotator::modifyRange(Group&,DataSet*,float,size_t,size_t) - PARAM_ANGLE and PARAM_ROTATION_SPEED must be enabled to use a rotator");
+	}
+
+	void Rotator::modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const
+	{
+		// The rotator does not use the vectors
+		modifyRange(group,dataSet,deltaTime,start,end);
 	}
 }
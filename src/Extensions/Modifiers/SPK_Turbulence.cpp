@@ -0,0 +1,249 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm> // for min
+#include <cmath>
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_VectorFieldForce.h"
+#include "Extensions/Modifiers/SPK_Turbulence.h"
+
+namespace SPK
+{
+	namespace
+	{
+		// Each octave is shifted so that the octaves do not meet at the origin
+		const float OCTAVE_OFFSET[3] = { 17.13f,-31.71f,23.37f };
+
+		// The root mean square magnitude of the curl noise (see Kernels::computeCurlNoise(...)), measured over random points
+		const float CURL_MAGNITUDE = 4.25f;
+	}
+
+	Turbulence::TimeData::TimeData() :
+		time(0.0f)
+	{}
+
+	Turbulence::Turbulence(float strength,float frequency,unsigned int nbOctaves,VectorFieldMode mode) :
+		Modifier(MODIFIER_PRIORITY_FORCE,true,false,false,true,true),
+		frequency(1.0f),
+		nbOctaves(1),
+		persistence(0.5f),
+		lacunarity(2.0f),
+		mode(mode),
+		strength(strength)
+	{
+		setFrequency(frequency);
+		setNbOctaves(nbOctaves);
+	}
+
+	void Turbulence::setFrequency(float frequency)
+	{
+		if (frequency <= 0.0f)
+		{
+			SPK_LOG_WARNING("Turbulence::setFrequency(float) - The frequency must be strictly positive. Call is ignored");
+			return;
+		}
+
+		this->frequency = frequency;
+	}
+
+	void Turbulence::setNbOctaves(unsigned int nbOctaves)
+	{
+		if (nbOctaves == 0)
+		{
+			SPK_LOG_WARNING("Turbulence::setNbOctaves(unsigned int) - There must be at least 1 octave. The number of octaves is set to 1");
+			nbOctaves = 1;
+		}
+
+		this->nbOctaves = nbOctaves;
+		computeNormalization();
+	}
+
+	void Turbulence::setPersistence(float persistence)
+	{
+		if (persistence < 0.0f)
+		{
+			SPK_LOG_WARNING("Turbulence::setPersistence(float) - The persistence must be positive. Call is ignored");
+			return;
+		}
+
+		this->persistence = persistence;
+		computeNormalization();
+	}
+
+	void Turbulence::setLacunarity(float lacunarity)
+	{
+		if (lacunarity <= 0.0f)
+		{
+			SPK_LOG_WARNING("Turbulence::setLacunarity(float) - The lacunarity must be strictly positive. Call is ignored");
+			return;
+		}
+
+		this->lacunarity = lacunarity;
+	}
+
+	Vector3D Turbulence::sample(const Vector3D& position,float time) const
+	{
+		Vector3D v;
+		sampleBatch(&position.x,&position.y,&position.z,&v.x,&v.y,&v.z,time,1);
+		return v;
+	}
+
+	void Turbulence::computeNormalization()
+	{
+		// The octaves are independent : the average magnitude of their sum grows as the root of the sum of their square amplitudes
+		float sqrAmplitudes = 0.0f;
+		float amplitude = 1.0f;
+		for (unsigned int i = 0; i < nbOctaves; ++i)
+		{
+			sqrAmplitudes += amplitude * amplitude;
+			amplitude *= persistence;
+		}
+
+		normalization = 1.0f / (CURL_MAGNITUDE * std::sqrt(sqrAmplitudes));
+	}
+
+	void Turbulence::createData(DataSet& dataSet,const Group& group) const
+	{
+		dataSet.init(NB_DATA);
+		dataSet.setData(TIME_INDEX,SPK_NEW(TimeData));
+	}
+
+	void Turbulence::prepareModify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		SPK_GET_DATA(TimeData,dataSet,TIME_INDEX).time += deltaTime;
+	}
+
+	void Turbulence::sampleBatch(const float* x,const float* y,const float* z,float* vx,float* vy,float* vz,float time,size_t nb) const
+	{
+		SPK_ASSERT(nb <= BATCH_SIZE,"Turbulence::sampleBatch(const float*,const float*,const float*,float*,float*,float*,float,size_t) - The batch is too large");
+
+		float noiseX[BATCH_SIZE];
+		float noiseY[BATCH_SIZE];
+		float noiseZ[BATCH_SIZE];
+		float curlX[BATCH_SIZE];
+		float curlY[BATCH_SIZE];
+		float curlZ[BATCH_SIZE];
+
+		for (size_t i = 0; i < nb; ++i)
+			vx[i] = vy[i] = vz[i] = 0.0f;
+
+		float octaveFrequency = frequency;
+		float amplitude = normalization;
+		for (unsigned int octave = 0; octave < nbOctaves; ++octave)
+		{
+			// The positions are scrolled and converted in the space of the noise of the octave
+			const float offsetX = octave * OCTAVE_OFFSET[0] - scrollSpeed.x * time * octaveFrequency;
+			const float offsetY = octave * OCTAVE_OFFSET[1] - scrollSpeed.y * time * octaveFrequency;
+			const float offsetZ = octave * OCTAVE_OFFSET[2] - scrollSpeed.z * time * octaveFrequency;
+			for (size_t i = 0; i < nb; ++i)
+			{
+				noiseX[i] = x[i] * octaveFrequency + offsetX;
+				noiseY[i] = y[i] * octaveFrequency + offsetY;
+				noiseZ[i] = z[i] * octaveFrequency + offsetZ;
+			}
+
+			// The curl is taken in the space of the noise so that the magnitude of the octave does not depend on its frequency
+			Kernels::computeCurlNoise(noiseX,noiseY,noiseZ,curlX,curlY,curlZ,nb);
+			for (size_t i = 0; i < nb; ++i)
+			{
+				vx[i] += curlX[i] * amplitude;
+				vy[i] += curlY[i] * amplitude;
+				vz[i] += curlZ[i] * amplitude;
+			}
+
+			octaveFrequency *= lacunarity;
+			amplitude *= persistence;
+		}
+	}
+
+	void Turbulence::modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const
+	{
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		const float time = SPK_GET_DATA(TimeData,dataSet,TIME_INDEX).time;
+		const float factor = mode == VECTOR_FIELD_FORCE ? strength * deltaTime : std::min(strength * deltaTime,1.0f);
+
+		float x[BATCH_SIZE];
+		float y[BATCH_SIZE];
+		float z[BATCH_SIZE];
+		float vx[BATCH_SIZE];
+		float vy[BATCH_SIZE];
+		float vz[BATCH_SIZE];
+		const Vector3DStreams positionStreams = { x,y,z };
+
+		for (size_t batchStart = start; batchStart < end; batchStart += BATCH_SIZE)
+		{
+			const size_t batchEnd = std::min(batchStart + BATCH_SIZE,end);
+			const size_t nb = batchEnd - batchStart;
+
+			Kernels::toStreams(positions + batchStart,positionStreams,nb);
+			sampleBatch(x,y,z,vx,vy,vz,time,nb);
+
+			size_t i = 0;
+			if (mode == VECTOR_FIELD_FORCE)
+				for (GroupIterator particleIt(group,batchStart,batchEnd); !particleIt.end(); ++particleIt, ++i)
+					particleIt->velocity() += Vector3D(vx[i],vy[i],vz[i]) * factor;
+			else
+				for (GroupIterator particleIt(group,batchStart,batchEnd); !particleIt.end(); ++particleIt, ++i)
+				{
+					Vector3D& velocity = particleIt->velocity();
+					velocity += (Vector3D(vx[i],vy[i],vz[i]) - velocity) * factor;
+				}
+		}
+	}
+
+	void Turbulence::modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const
+	{
+		const Vector3DStreams positions = streams.positions;
+		const Vector3DStreams velocities = streams.velocities;
+		const float time = SPK_GET_DATA(TimeData,dataSet,TIME_INDEX).time;
+		const float factor = mode == VECTOR_FIELD_FORCE ? strength * deltaTime : std::min(strength * deltaTime,1.0f);
+
+		float vx[BATCH_SIZE];
+		float vy[BATCH_SIZE];
+		float vz[BATCH_SIZE];
+
+		for (size_t batchStart = 0, nbParticles = end - start; batchStart < nbParticles; batchStart += BATCH_SIZE)
+		{
+			const size_t nb = nbParticles - batchStart < BATCH_SIZE ? nbParticles - batchStart : BATCH_SIZE;
+
+			sampleBatch(positions.x + batchStart,positions.y + batchStart,positions.z + batchStart,vx,vy,vz,time,nb);
+
+			float* velocityX = velocities.x + batchStart;
+			float* velocityY = velocities.y + batchStart;
+			float* velocityZ = velocities.z + batchStart;
+			if (mode == VECTOR_FIELD_FORCE)
+				for (size_t i = 0; i < nb; ++i)
+				{
+					velocityX[i] += vx[i] * factor;
+					velocityY[i] += vy[i] * factor;
+					velocityZ[i] += vz[i] * factor;
+				}
+			else
+				for (size_t i = 0; i < nb; ++i)
+				{
+					velocityX[i] += (vx[i] - velocityX[i]) * factor;
+					velocityY[i] += (vy[i] - velocityY[i]) * factor;
+					velocityZ[i] += (vz[i] - velocityZ[i]) * factor;
+				}
+		}
+	}
+}
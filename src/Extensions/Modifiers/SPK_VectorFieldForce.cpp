@@ -0,0 +1,450 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm> // for min and max
+#include <fstream>
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_VectorFieldForce.h"
+
+namespace SPK
+{
+	namespace
+	{
+		/// VECTOR FIELD FILE FORMAT, VERSION 1
+		/*
+			size		item
+			------------------------------------------------
+			3			Magic number			+
+			1			Version					|
+			4			Nodes along x			| Header
+			4			Nodes along y			|
+			4			Nodes along z			|
+			12			Position				|
+			12			Dimension				+
+
+			12 * nb		Vectors (x first, then y and then z)
+		*/
+		const unsigned char FIELD_MAGIC_NUMBER[3] = { 'S', 'V', 'F' };
+		const unsigned char FIELD_VERSION = 1;
+		const size_t FIELD_HEADER_SIZE = 36; // after the magic number and the version
+	}
+
+	VectorFieldForce::VectorFieldForce(
+		unsigned int nbX,
+		unsigned int nbY,
+		unsigned int nbZ,
+		const Vector3D& position,
+		const Vector3D& dimension,
+		VectorFieldMode mode,
+		float strength) :
+		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false,true,true),
+		nbX(2),
+		nbY(2),
+		nbZ(2),
+		mode(mode),
+		strength(strength),
+		borderClamped(false)
+	{
+		tAxis[0].set(1.0f,0.0f,0.0f);
+		tAxis[1].set(0.0f,1.0f,0.0f);
+		tAxis[2].set(0.0f,0.0f,1.0f);
+		setResolution(nbX,nbY,nbZ);
+		setBounds(position,dimension);
+	}
+
+	VectorFieldForce::VectorFieldForce(const VectorFieldForce& vectorField) :
+		Modifier(vectorField),
+		nbX(vectorField.nbX),
+		nbY(vectorField.nbY),
+		nbZ(vectorField.nbZ),
+		position(vectorField.position),
+		tPosition(vectorField.tPosition),
+		dimension(vectorField.dimension),
+		vectors(vectorField.vectors),
+		nodes(vectorField.nodes),
+		mode(vectorField.mode),
+		strength(vectorField.strength),
+		borderClamped(vectorField.borderClamped)
+	{
+		for (size_t i = 0; i < 3; ++i)
+			tAxis[i] = vectorField.tAxis[i];
+	}
+
+	void VectorFieldForce::setResolution(unsigned int nbX,unsigned int nbY,unsigned int nbZ)
+	{
+		if (nbX < 2 || nbY < 2 || nbZ < 2)
+		{
+			SPK_LOG_WARNING("VectorFieldForce::setResolution(unsigned int,unsigned int,unsigned int) - There must be at least 2 nodes along each axis. The resolution is clamped");
+			nbX = std::max(nbX,2u);
+			nbY = std::max(nbY,2u);
+			nbZ = std::max(nbZ,2u);
+		}
+
+		this->nbX = nbX;
+		this->nbY = nbY;
+		this->nbZ = nbZ;
+
+		const size_t nbVectors = static_cast<size_t>(nbX) * nbY * nbZ;
+		vectors.assign(nbVectors,Vector3D());
+		nodes.assign(nbVectors * 4,0.0f);
+	}
+
+	void VectorFieldForce::setBounds(const Vector3D& position,const Vector3D& dimension)
+	{
+		this->position = position;
+		transformPos(tPosition,position);
+
+		this->dimension = dimension;
+		if (dimension.x <= 0.0f || dimension.y <= 0.0f || dimension.z <= 0.0f)
+		{
+			SPK_LOG_WARNING("VectorFieldForce::setBounds(const Vector3D&,const Vector3D&) - The dimension must be strictly positive along each axis. Invalid values are set to 1");
+			if (this->dimension.x <= 0.0f) this->dimension.x = 1.0f;
+			if (this->dimension.y <= 0.0f) this->dimension.y = 1.0f;
+			if (this->dimension.z <= 0.0f) this->dimension.z = 1.0f;
+		}
+	}
+
+	Vector3D VectorFieldForce::getNodePosition(unsigned int x,unsigned int y,unsigned int z) const
+	{
+		return Vector3D(
+			position.x + dimension.x * x / (nbX - 1),
+			position.y + dimension.y * y / (nbY - 1),
+			position.z + dimension.z * z / (nbZ - 1));
+	}
+
+	void VectorFieldForce::setVector(unsigned int x,unsigned int y,unsigned int z,const Vector3D& v)
+	{
+		const size_t index = getIndex(x,y,z);
+		vectors[index] = v;
+		nodes[index * 4] = v.x;
+		nodes[index * 4 + 1] = v.y;
+		nodes[index * 4 + 2] = v.z;
+	}
+
+	void VectorFieldForce::setVectors(const std::vector<Vector3D>& vectors)
+	{
+		if (vectors.size() != this->vectors.size())
+		{
+			SPK_LOG_ERROR("VectorFieldForce::setVectors(const std::vector<Vector3D>&) - The number of vectors (" << vectors.size() << ") does not match the number of nodes (" << this->vectors.size() << ")");
+			return;
+		}
+
+		this->vectors = vectors;
+		for (size_t i = 0; i < vectors.size(); ++i)
+		{
+			nodes[i * 4] = vectors[i].x;
+			nodes[i * 4 + 1] = vectors[i].y;
+			nodes[i * 4 + 2] = vectors[i].z;
+		}
+	}
+
+	Vector3D VectorFieldForce::sample(const Vector3D& position) const
+	{
+		Vector3D v;
+		float weight;
+		sampleBatch(&position.x,&position.y,&position.z,&v.x,&v.y,&v.z,&weight,1);
+		return v * weight;
+	}
+
+	bool VectorFieldForce::loadField(std::istream& is)
+	{
+		// Header: magic number and version
+		unsigned char magic[4];
+		if (!is.read(reinterpret_cast<char*>(magic),4)
+			|| magic[0] != FIELD_MAGIC_NUMBER[0]
+			|| magic[1] != FIELD_MAGIC_NUMBER[1]
+			|| magic[2] != FIELD_MAGIC_NUMBER[2])
+		{
+			SPK_LOG_ERROR("VectorFieldForce::loadField(std::istream&) - The stream does not contain a vector field");
+			return false;
+		}
+
+		if (magic[3] != FIELD_VERSION)
+		{
+			SPK_LOG_ERROR("VectorFieldForce::loadField(std::istream&) - Version of vector field in stream (" << (int)magic[3] << ") does not match the version of the loader (" << (int)FIELD_VERSION << ")");
+			return false;
+		}
+
+		// Header: grid
+		IO::Buffer header(FIELD_HEADER_SIZE,is);
+		const unsigned int newNbX = header.get<uint32>();
+		const unsigned int newNbY = header.get<uint32>();
+		const unsigned int newNbZ = header.get<uint32>();
+		const Vector3D newPosition = header.get<Vector3D>();
+		const Vector3D newDimension = header.get<Vector3D>();
+		if (!is || newNbX < 2 || newNbY < 2 || newNbZ < 2)
+		{
+			SPK_LOG_ERROR("VectorFieldForce::loadField(std::istream&) - The header of the vector field is invalid");
+			return false;
+		}
+
+		// Vectors
+		const size_t nbVectors = static_cast<size_t>(newNbX) * newNbY * newNbZ;
+		IO::Buffer data(nbVectors * 12,is);
+		if (!is)
+		{
+			SPK_LOG_ERROR("VectorFieldForce::loadField(std::istream&) - The vectors of the vector field are truncated");
+			return false;
+		}
+
+		std::vector<Vector3D> newVectors(nbVectors);
+		for (size_t i = 0; i < nbVectors; ++i)
+			newVectors[i] = data.get<Vector3D>();
+
+		setResolution(newNbX,newNbY,newNbZ);
+		setBounds(newPosition,newDimension);
+		setVectors(newVectors);
+		return true;
+	}
+
+	bool VectorFieldForce::loadField(const std::string& path)
+	{
+		std::ifstream file(path.c_str(),std::ios::in | std::ios::binary);
+		if (!file)
+		{
+			SPK_LOG_ERROR("VectorFieldForce::loadField(const std::string&) - Cannot open the file " << path);
+			return false;
+		}
+
+		return loadField(file);
+	}
+
+	bool VectorFieldForce::saveField(std::ostream& os) const
+	{
+		IO::Buffer buffer(4 + FIELD_HEADER_SIZE + vectors.size() * 12);
+		buffer << FIELD_MAGIC_NUMBER << FIELD_VERSION;
+		buffer.put(static_cast<uint32>(nbX));
+		buffer.put(static_cast<uint32>(nbY));
+		buffer.put(static_cast<uint32>(nbZ));
+		buffer.put(position);
+		buffer.put(dimension);
+		for (size_t i = 0; i < vectors.size(); ++i)
+			buffer.put(vectors[i]);
+
+		os.write(buffer.getData(),buffer.getSize());
+		return !os.fail();
+	}
+
+	bool VectorFieldForce::saveField(const std::string& path) const
+	{
+		std::ofstream file(path.c_str(),std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			SPK_LOG_ERROR("VectorFieldForce::saveField(const std::string&) - Cannot open the file " << path);
+			return false;
+		}
+
+		return saveField(file);
+	}
+
+	void VectorFieldForce::bake(const std::vector<Ref<Modifier> >& modifiers,float timeStep)
+	{
+		if (timeStep <= 0.0f)
+		{
+			SPK_LOG_ERROR("VectorFieldForce::bake(const std::vector<Ref<Modifier> >&,float) - The time step must be strictly positive");
+			return;
+		}
+
+		// A still group holds a particle with no velocity at each node of the grid
+		Ref<System> system = System::create(true);
+		system->useLocalRealStep();
+		system->setLocalClampStep(false);
+
+		Ref<Group> group = system->createGroup(vectors.size());
+		group->setImmortal(true);
+		group->setStill(true);
+		// The modifiers are copied so that the temporary system does not change their transforms
+		for (std::vector<Ref<Modifier> >::const_iterator it = modifiers.begin(); it != modifiers.end(); ++it)
+			group->addModifier(SPKObject::copy(*it));
+
+		for (unsigned int z = 0; z < nbZ; ++z)
+			for (unsigned int y = 0; y < nbY; ++y)
+				for (unsigned int x = 0; x < nbX; ++x)
+				{
+					const Vector3D node = getNodePosition(x,y,z) - position;
+					const Vector3D nodePosition = tPosition + tAxis[0] * node.x + tAxis[1] * node.y + tAxis[2] * node.z;
+					group->addParticles(1,nodePosition,Vector3D());
+				}
+		group->flushBufferedParticles();
+
+		// The modifiers are applied once
+		system->updateParticles(timeStep);
+
+		if (group->getNbParticles() != vectors.size())
+		{
+			SPK_LOG_ERROR("VectorFieldForce::bake(const std::vector<Ref<Modifier> >&,float) - Some particles were killed by the modifiers. The field is not baked");
+			return;
+		}
+
+		// The particles are in the order of the nodes and their velocities are converted in the space of the grid
+		std::vector<Vector3D> bakedVectors(vectors.size());
+		for (size_t i = 0; i < bakedVectors.size(); ++i)
+		{
+			const Vector3D acceleration = group->getParticle(i).velocity() / timeStep;
+			bakedVectors[i].set(
+				dotProduct(acceleration,tAxis[0]),
+				dotProduct(acceleration,tAxis[1]),
+				dotProduct(acceleration,tAxis[2]));
+		}
+
+		setVectors(bakedVectors);
+	}
+
+	void VectorFieldForce::innerUpdateTransform()
+	{
+		Modifier::innerUpdateTransform();
+		transformPos(tPosition,position);
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			Vector3D axis;
+			axis[i] = 1.0f;
+			transformDir(tAxis[i],axis);
+			tAxis[i].normalize();
+		}
+	}
+
+	void VectorFieldForce::sampleBatch(const float* x,const float* y,const float* z,float* vx,float* vy,float* vz,float* weights,size_t nb) const
+	{
+		SPK_ASSERT(nb <= BATCH_SIZE,"VectorFieldForce::sampleBatch(const float*,const float*,const float*,float*,float*,float*,float*,size_t) - The batch is too large");
+		if (nb == 0)
+			return;
+
+		// The positions are converted in grid coordinates : gridPos = (pos - tPosition) . tAxis * (nbNodes - 1) / dimension
+		const float maxX = static_cast<float>(nbX - 1);
+		const float maxY = static_cast<float>(nbY - 1);
+		const float maxZ = static_cast<float>(nbZ - 1);
+		const Vector3D axisX = tAxis[0] * (maxX / dimension.x);
+		const Vector3D axisY = tAxis[1] * (maxY / dimension.y);
+		const Vector3D axisZ = tAxis[2] * (maxZ / dimension.z);
+		const float offsetX = -dotProduct(tPosition,axisX);
+		const float offsetY = -dotProduct(tPosition,axisY);
+		const float offsetZ = -dotProduct(tPosition,axisZ);
+
+		float gridX[BATCH_SIZE];
+		float gridY[BATCH_SIZE];
+		float gridZ[BATCH_SIZE];
+
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const float posX = x[i] * axisX.x + y[i] * axisX.y + z[i] * axisX.z + offsetX;
+			const float posY = x[i] * axisY.x + y[i] * axisY.y + z[i] * axisY.z + offsetY;
+			const float posZ = x[i] * axisZ.x + y[i] * axisZ.y + z[i] * axisZ.z + offsetZ;
+
+			// The points outside the grid are weighted by 0 if the border is not clamped
+			weights[i] = (borderClamped || (posX >= 0.0f && posX <= maxX && posY >= 0.0f && posY <= maxY && posZ >= 0.0f && posZ <= maxZ)) ? 1.0f : 0.0f;
+
+			gridX[i] = std::min(std::max(posX,0.0f),maxX);
+			gridY[i] = std::min(std::max(posY,0.0f),maxY);
+			gridZ[i] = std::min(std::max(posZ,0.0f),maxZ);
+		}
+
+		float localX[BATCH_SIZE];
+		float localY[BATCH_SIZE];
+		float localZ[BATCH_SIZE];
+		Kernels::sampleGrid(&nodes[0],nbX,nbY,nbZ,gridX,gridY,gridZ,localX,localY,localZ,nb);
+
+		// The vectors are rotated from the space of the grid to world space
+		for (size_t i = 0; i < nb; ++i)
+		{
+			vx[i] = localX[i] * tAxis[0].x + localY[i] * tAxis[1].x + localZ[i] * tAxis[2].x;
+			vy[i] = localX[i] * tAxis[0].y + localY[i] * tAxis[1].y + localZ[i] * tAxis[2].y;
+			vz[i] = localX[i] * tAxis[0].z + localY[i] * tAxis[1].z + localZ[i] * tAxis[2].z;
+		}
+	}
+
+	void VectorFieldForce::modifyRange(Group& group,DataSet* dataSet,float deltaTime,size_t start,size_t end) const
+	{
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		const float factor = mode == VECTOR_FIELD_FORCE ? strength * deltaTime : std::min(strength * deltaTime,1.0f);
+
+		float x[BATCH_SIZE];
+		float y[BATCH_SIZE];
+		float z[BATCH_SIZE];
+		float vx[BATCH_SIZE];
+		float vy[BATCH_SIZE];
+		float vz[BATCH_SIZE];
+		float ratios[BATCH_SIZE];
+		const Vector3DStreams positionStreams = { x,y,z };
+
+		for (size_t batchStart = start; batchStart < end; batchStart += BATCH_SIZE)
+		{
+			const size_t batchEnd = std::min(batchStart + BATCH_SIZE,end);
+			const size_t nb = batchEnd - batchStart;
+
+			Kernels::toStreams(positions + batchStart,positionStreams,nb);
+			sampleBatch(x,y,z,vx,vy,vz,ratios,nb);
+			for (size_t i = 0; i < nb; ++i)
+				ratios[i] *= factor;
+
+			size_t i = 0;
+			if (mode == VECTOR_FIELD_FORCE)
+				for (GroupIterator particleIt(group,batchStart,batchEnd); !particleIt.end(); ++particleIt, ++i)
+					particleIt->velocity() += Vector3D(vx[i],vy[i],vz[i]) * ratios[i];
+			else
+				for (GroupIterator particleIt(group,batchStart,batchEnd); !particleIt.end(); ++particleIt, ++i)
+				{
+					Vector3D& velocity = particleIt->velocity();
+					velocity += (Vector3D(vx[i],vy[i],vz[i]) - velocity) * ratios[i];
+				}
+		}
+	}
+
+	void VectorFieldForce::modifyStreams(Group& group,DataSet* dataSet,float deltaTime,const ParticleStreams& streams,size_t start,size_t end) const
+	{
+		const Vector3DStreams positions = streams.positions;
+		const Vector3DStreams velocities = streams.velocities;
+		const float factor = mode == VECTOR_FIELD_FORCE ? strength * deltaTime : std::min(strength * deltaTime,1.0f);
+
+		float vx[BATCH_SIZE];
+		float vy[BATCH_SIZE];
+		float vz[BATCH_SIZE];
+		float ratios[BATCH_SIZE];
+
+		for (size_t batchStart = 0, nbParticles = end - start; batchStart < nbParticles; batchStart += BATCH_SIZE)
+		{
+			const size_t nb = nbParticles - batchStart < BATCH_SIZE ? nbParticles - batchStart : BATCH_SIZE;
+
+			sampleBatch(positions.x + batchStart,positions.y + batchStart,positions.z + batchStart,vx,vy,vz,ratios,nb);
+			for (size_t i = 0; i < nb; ++i)
+				ratios[i] *= factor;
+
+			float* velocityX = velocities.x + batchStart;
+			float* velocityY = velocities.y + batchStart;
+			float* velocityZ = velocities.z + batchStart;
+			if (mode == VECTOR_FIELD_FORCE)
+				for (size_t i = 0; i < nb; ++i)
+				{
+					velocityX[i] += vx[i] * ratios[i];
+					velocityY[i] += vy[i] * ratios[i];
+					velocityZ[i] += vz[i] * ratios[i];
+				}
+			else
+				for (size_t i = 0; i < nb; ++i)
+				{
+					velocityX[i] += (vx[i] - velocityX[i]) * ratios[i];
+					velocityY[i] += (vy[i] - velocityY[i]) * ratios[i];
+					velocityZ[i] += (vz[i] - velocityZ[i]) * ratios[i];
+				}
+		}
+	}
+}
@@ -0,0 +1,454 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm> // for std::min
+
+#include <SPARK_Core.h>
+#include "Extensions/Renderers/SPK_QuadExpander.h"
+
+#ifdef SPK_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace SPK
+{
+	namespace
+	{
+		// The texture coordinates of the corners in the OpenGL convention
+		const float DEFAULT_CORNER_TEX_COORDS[8] =
+		{
+			1.0f,0.0f,	// top right
+			0.0f,0.0f,	// top left
+			0.0f,1.0f,	// bottom left
+			1.0f,1.0f,	// bottom right
+		};
+
+		// The data needed to expand the positions and colors of a range of particles
+		struct Expansion
+		{
+			const Vector3D* positions;
+			const Color* colors;
+			const float* scales;	// NULL if the scale is not enabled
+			const float* sines;		// sines of the angles of the particles from sinCosStart, NULL if the angle is not enabled
+			const float* cosines;	// cosines of the angles of the particles from sinCosStart, NULL if the angle is not enabled
+			size_t sinCosStart;
+
+			unsigned char* vertexPositions;
+			size_t positionStride;
+			unsigned char* vertexColors;
+			size_t colorStride;
+
+			Vector3D side;
+			Vector3D up;
+			float scaleX;
+			float scaleY;
+		};
+
+		// Number of particles whose sines and cosines are computed at once before being expanded
+		const size_t SIN_COS_BLOCK_SIZE = 256;
+
+		inline void setVertexPosition(unsigned char* vertex,const Vector3D& position)
+		{
+			*reinterpret_cast<Vector3D*>(vertex) = position;
+		}
+
+		// Scalar kernels
+		// They are also used for the remainders of the vectorized kernels
+
+		void expandPositionsScalar(const Expansion& expansion,size_t start,size_t end)
+		{
+			// The data are copied locally as the compiler cannot tell they are not modified by the writes of the vertices
+			const Vector3D side = expansion.side;
+			const Vector3D up = expansion.up;
+			const float scaleX = expansion.scaleX;
+			const float scaleY = expansion.scaleY;
+			const Vector3D* const positions = expansion.positions;
+			const float* const scales = expansion.scales;
+			const float* const sines = expansion.sines;
+			const float* const cosines = expansion.cosines;
+			const size_t sinCosStart = expansion.sinCosStart;
+			unsigned char* const vertices = expansion.vertexPositions;
+			const size_t stride = expansion.positionStride;
+
+			for (size_t i = start; i < end; ++i)
+			{
+				float sizeX = scaleX;
+				float sizeY = scaleY;
+				if (scales != NULL)
+				{
+					sizeX *= scales[i];
+					sizeY *= scales[i];
+				}
+
+				// The rotation around the look vector is a rotation in the plane (side,up)
+				Vector3D sideQuad;
+				Vector3D upQuad;
+				if (sines != NULL)
+				{
+					const float sinA = sines[i - sinCosStart];
+					const float cosA = cosines[i - sinCosStart];
+					sideQuad = (side * cosA + up * sinA) * sizeX;
+					upQuad = (up * cosA - side * sinA) * sizeY;
+				}
+				else
+				{
+					sideQuad = side * sizeX;
+					upQuad = up * sizeY;
+				}
+
+				const Vector3D position = positions[i];
+				unsigned char* vertex = vertices + (i << 2) * stride;
+				setVertexPosition(vertex,position + sideQuad + upQuad);				// top right vertex
+				setVertexPosition(vertex + stride,position - sideQuad + upQuad);		// top left vertex
+				setVertexPosition(vertex + 2 * stride,position - sideQuad - upQuad);	// bottom left vertex
+				setVertexPosition(vertex + 3 * stride,position + sideQuad - upQuad);	// bottom right vertex
+			}
+		}
+
+		void expandColorsScalar(const Expansion& expansion,size_t start,size_t end)
+		{
+			const size_t stride = expansion.colorStride;
+			for (size_t i = start; i < end; ++i)
+			{
+				unsigned char* vertex = expansion.vertexColors + (i << 2) * stride;
+				for (size_t j = 0; j < 4; ++j, vertex += stride)
+					*reinterpret_cast<Color*>(vertex) = expansion.colors[i];
+			}
+		}
+
+#ifdef SPK_SIMD_SSE2
+		// SSE2 kernels
+
+		// 4 particles are expanded at once : their coordinates are transposed (see Kernels::toStreams),
+		// the 16 corners are computed and transposed back so that each register holds a coordinate of the 4 corners of a particle
+
+		void expandPositionsSSE2(const Expansion& expansion,size_t start,size_t end)
+		{
+			const __m128 sideX = _mm_set1_ps(expansion.side.x);
+			const __m128 sideY = _mm_set1_ps(expansion.side.y);
+			const __m128 sideZ = _mm_set1_ps(expansion.side.z);
+			const __m128 upX = _mm_set1_ps(expansion.up.x);
+			const __m128 upY = _mm_set1_ps(expansion.up.y);
+			const __m128 upZ = _mm_set1_ps(expansion.up.z);
+			const __m128 scaleX = _mm_set1_ps(expansion.scaleX);
+			const __m128 scaleY = _mm_set1_ps(expansion.scaleY);
+
+			const Vector3D* const positions = expansion.positions;
+			const float* const scales = expansion.scales;
+			const float* const sines = expansion.sines;
+			const float* const cosines = expansion.cosines;
+			const size_t sinCosStart = expansion.sinCosStart;
+			unsigned char* const vertices = expansion.vertexPositions;
+			const size_t stride = expansion.positionStride;
+			const bool packed = stride == sizeof(Vector3D);
+
+			size_t i = start;
+			for (; i + 4 <= end; i += 4)
+			{
+				const float* data = reinterpret_cast<const float*>(positions + i);
+				__m128 a = _mm_loadu_ps(data);
+				__m128 b = _mm_loadu_ps(data + 4);
+				__m128 c = _mm_loadu_ps(data + 8);
+				__m128 posX = _mm_shuffle_ps(a,_mm_shuffle_ps(b,c,_MM_SHUFFLE(1,1,2,2)),_MM_SHUFFLE(2,0,3,0));
+				__m128 posY = _mm_shuffle_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(0,0,1,1)),_mm_shuffle_ps(b,c,_MM_SHUFFLE(2,2,3,3)),_MM_SHUFFLE(2,0,2,0));
+				__m128 posZ = _mm_shuffle_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(1,1,2,2)),c,_MM_SHUFFLE(3,0,2,0));
+
+				__m128 sizeX = scaleX;
+				__m128 sizeY = scaleY;
+				if (scales != NULL)
+				{
+					__m128 particleScales = _mm_loadu_ps(scales + i);
+					sizeX = _mm_mul_ps(sizeX,particleScales);
+					sizeY = _mm_mul_ps(sizeY,particleScales);
+				}
+
+				__m128 sideQuadX,sideQuadY,sideQuadZ;
+				__m128 upQuadX,upQuadY,upQuadZ;
+				if (sines != NULL)
+				{
+					const __m128 sinA = _mm_loadu_ps(sines + (i - sinCosStart));
+					const __m128 cosA = _mm_loadu_ps(cosines + (i - sinCosStart));
+
+					sideQuadX = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(sideX,cosA),_mm_mul_ps(upX,sinA)),sizeX);
+					sideQuadY = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(sideY,cosA),_mm_mul_ps(upY,sinA)),sizeX);
+					sideQuadZ = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(sideZ,cosA),_mm_mul_ps(upZ,sinA)),sizeX);
+					upQuadX = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(upX,cosA),_mm_mul_ps(sideX,sinA)),sizeY);
+					upQuadY = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(upY,cosA),_mm_mul_ps(sideY,sinA)),sizeY);
+					upQuadZ = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(upZ,cosA),_mm_mul_ps(sideZ,sinA)),sizeY);
+				}
+				else
+				{
+					sideQuadX = _mm_mul_ps(sideX,sizeX);
+					sideQuadY = _mm_mul_ps(sideY,sizeX);
+					sideQuadZ = _mm_mul_ps(sideZ,sizeX);
+					upQuadX = _mm_mul_ps(upX,sizeY);
+					upQuadY = _mm_mul_ps(upY,sizeY);
+					upQuadZ = _mm_mul_ps(upZ,sizeY);
+				}
+
+				// Corners in the same order and with the same operations as the scalar kernel
+				__m128 rightX = _mm_add_ps(posX,sideQuadX);
+				__m128 leftX = _mm_sub_ps(posX,sideQuadX);
+				__m128 x0 = _mm_add_ps(rightX,upQuadX);
+				__m128 x1 = _mm_add_ps(leftX,upQuadX);
+				__m128 x2 = _mm_sub_ps(leftX,upQuadX);
+				__m128 x3 = _mm_sub_ps(rightX,upQuadX);
+
+				__m128 rightY = _mm_add_ps(posY,sideQuadY);
+				__m128 leftY = _mm_sub_ps(posY,sideQuadY);
+				__m128 y0 = _mm_add_ps(rightY,upQuadY);
+				__m128 y1 = _mm_add_ps(leftY,upQuadY);
+				__m128 y2 = _mm_sub_ps(leftY,upQuadY);
+				__m128 y3 = _mm_sub_ps(rightY,upQuadY);
+
+				__m128 rightZ = _mm_add_ps(posZ,sideQuadZ);
+				__m128 leftZ = _mm_sub_ps(posZ,sideQuadZ);
+				__m128 z0 = _mm_add_ps(rightZ,upQuadZ);
+				__m128 z1 = _mm_add_ps(leftZ,upQuadZ);
+				__m128 z2 = _mm_sub_ps(leftZ,upQuadZ);
+				__m128 z3 = _mm_sub_ps(rightZ,upQuadZ);
+
+				_MM_TRANSPOSE4_PS(x0,x1,x2,x3);
+				_MM_TRANSPOSE4_PS(y0,y1,y2,y3);
+				_MM_TRANSPOSE4_PS(z0,z1,z2,z3);
+
+				const __m128 cornersX[4] = { x0,x1,x2,x3 };
+				const __m128 cornersY[4] = { y0,y1,y2,y3 };
+				const __m128 cornersZ[4] = { z0,z1,z2,z3 };
+
+				unsigned char* vertex = vertices + (i << 2) * stride;
+				for (size_t j = 0; j < 4; ++j)
+				{
+					__m128 vx = cornersX[j];
+					__m128 vy = cornersY[j];
+					__m128 vz = cornersZ[j];
+					if (packed) // the 4 vertices of the particle are written with 3 stores (see Kernels::fromStreams)
+					{
+						float* out = reinterpret_cast<float*>(vertex);
+						_mm_storeu_ps(out,_mm_shuffle_ps(_mm_shuffle_ps(vx,vy,_MM_SHUFFLE(0,0,0,0)),_mm_shuffle_ps(vz,vx,_MM_SHUFFLE(1,1,0,0)),_MM_SHUFFLE(2,0,2,0)));
+						_mm_storeu_ps(out + 4,_mm_shuffle_ps(_mm_shuffle_ps(vy,vz,_MM_SHUFFLE(1,1,1,1)),_mm_shuffle_ps(vx,vy,_MM_SHUFFLE(2,2,2,2)),_MM_SHUFFLE(2,0,2,0)));
+						_mm_storeu_ps(out + 8,_mm_shuffle_ps(_mm_shuffle_ps(vz,vx,_MM_SHUFFLE(3,3,2,2)),_mm_shuffle_ps(vy,vz,_MM_SHUFFLE(3,3,3,3)),_MM_SHUFFLE(2,0,2,0)));
+						vertex += sizeof(Vector3D) << 2;
+					}
+					else
+					{
+						float coordinates[12];
+						_mm_storeu_ps(coordinates,vx);
+						_mm_storeu_ps(coordinates + 4,vy);
+						_mm_storeu_ps(coordinates + 8,vz);
+						for (size_t k = 0; k < 4; ++k, vertex += stride)
+							setVertexPosition(vertex,Vector3D(coordinates[k],coordinates[k + 4],coordinates[k + 8]));
+					}
+				}
+			}
+			expandPositionsScalar(expansion,i,end);
+		}
+
+		void expandColorsSSE2(const Expansion& expansion,size_t start,size_t end)
+		{
+			if (expansion.colorStride != sizeof(Color))
+			{
+				expandColorsScalar(expansion,start,end);
+				return;
+			}
+
+			// The colors of 4 particles fit in a register and each one is broadcast to its 4 vertices
+			size_t i = start;
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128i colors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(expansion.colors + i));
+				__m128i* vertex = reinterpret_cast<__m128i*>(expansion.vertexColors + (i << 2) * sizeof(Color));
+				_mm_storeu_si128(vertex,_mm_shuffle_epi32(colors,_MM_SHUFFLE(0,0,0,0)));
+				_mm_storeu_si128(vertex + 1,_mm_shuffle_epi32(colors,_MM_SHUFFLE(1,1,1,1)));
+				_mm_storeu_si128(vertex + 2,_mm_shuffle_epi32(colors,_MM_SHUFFLE(2,2,2,2)));
+				_mm_storeu_si128(vertex + 3,_mm_shuffle_epi32(colors,_MM_SHUFFLE(3,3,3,3)));
+			}
+			expandColorsScalar(expansion,i,end);
+		}
+#endif
+	}
+
+	class QuadExpander::Job : public ThreadPool::Job
+	{
+	public :
+
+		Job(const QuadExpander& expander,const Group& group,const QuadVertexArrays& arrays) :
+			expander(expander),
+			group(group),
+			arrays(arrays)
+		{}
+
+		virtual void run(size_t index)
+		{
+			size_t start = index * CHUNK_SIZE;
+			size_t end = std::min(start + CHUNK_SIZE,group.getNbParticles());
+			expander.expand(group,arrays,start,end);
+		}
+
+	private :
+
+		const QuadExpander& expander;
+		const Group& group;
+		const QuadVertexArrays& arrays;
+	};
+
+	QuadExpander::QuadExpander() :
+		side(1.0f,0.0f,0.0f),
+		up(0.0f,1.0f,0.0f),
+		scaleX(1.0f),
+		scaleY(1.0f),
+		texturingMode(TEXTURE_MODE_NONE),
+		atlasNbX(1),
+		atlasNbY(1)
+	{
+		setCornerTexCoords(DEFAULT_CORNER_TEX_COORDS);
+	}
+
+	void QuadExpander::expand(const Group& group,const QuadVertexArrays& arrays) const
+	{
+		const size_t nbChunks = (group.getNbParticles() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		ThreadPool* threadPool = group.getThreadPool();
+		Job job(*this,group,arrays);
+
+		if (threadPool != NULL && nbChunks > 1)
+			threadPool->parallelFor(nbChunks,job);
+		else
+			for (size_t i = 0; i < nbChunks; ++i)
+				job.run(i);
+	}
+
+	void QuadExpander::expand(const Group& group,const QuadVertexArrays& arrays,size_t start,size_t end) const
+	{
+		Expansion expansion;
+		expansion.positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		expansion.colors = static_cast<const Color*>(group.getColorAddress());
+		expansion.scales = group.isEnabled(PARAM_SCALE) ? static_cast<const float*>(group.getParamAddress(PARAM_SCALE)) : NULL;
+		expansion.sines = NULL;
+		expansion.cosines = NULL;
+		expansion.sinCosStart = start;
+		expansion.vertexPositions = static_cast<unsigned char*>(arrays.positions);
+		expansion.positionStride = arrays.positionStride;
+		expansion.vertexColors = static_cast<unsigned char*>(arrays.colors);
+		expansion.colorStride = arrays.colorStride;
+		expansion.side = side;
+		expansion.up = up;
+		expansion.scaleX = scaleX;
+		expansion.scaleY = scaleY;
+
+		if (arrays.positions != NULL)
+		{
+			// The sines and cosines of the angles are computed by blocks before the quads of the block are expanded (see Kernels::computeSinCos)
+			const float* angles = group.isEnabled(PARAM_ANGLE) ? static_cast<const float*>(group.getParamAddress(PARAM_ANGLE)) : NULL;
+			float sines[SIN_COS_BLOCK_SIZE];
+			float cosines[SIN_COS_BLOCK_SIZE];
+
+			for (size_t blockStart = start; blockStart < end; blockStart += SIN_COS_BLOCK_SIZE)
+			{
+				const size_t blockEnd = std::min(blockStart + SIN_COS_BLOCK_SIZE,end);
+				if (angles != NULL)
+				{
+					Kernels::computeSinCos(angles + blockStart,sines,cosines,blockEnd - blockStart);
+					expansion.sines = sines;
+					expansion.cosines = cosines;
+					expansion.sinCosStart = blockStart;
+				}
+
+#ifdef SPK_SIMD_SSE2
+				if (Kernels::getInstructionSet() != INSTRUCTION_SET_SCALAR)
+					expandPositionsSSE2(expansion,blockStart,blockEnd);
+				else
+#endif
+					expandPositionsScalar(expansion,blockStart,blockEnd);
+			}
+		}
+
+		if (arrays.colors != NULL)
+		{
+#ifdef SPK_SIMD_SSE2
+			if (Kernels::getInstructionSet() != INSTRUCTION_SET_SCALAR)
+				expandColorsSSE2(expansion,start,end);
+			else
+#endif
+				expandColorsScalar(expansion,start,end);
+		}
+
+		if (arrays.texCoords == NULL || texturingMode == TEXTURE_MODE_NONE)
+			return;
+
+		const float* textureIndices = group.isEnabled(PARAM_TEXTURE_INDEX) ? static_cast<const float*>(group.getParamAddress(PARAM_TEXTURE_INDEX)) : NULL;
+		float corners[8]; // local copy that cannot be aliased by the texture coordinates
+		for (size_t i = 0; i < 8; ++i)
+			corners[i] = cornerTexCoords[i];
+
+		unsigned char* vertex = static_cast<unsigned char*>(arrays.texCoords) + (start << 2) * arrays.texCoordStride;
+		const size_t stride = arrays.texCoordStride;
+
+		if (texturingMode == TEXTURE_MODE_3D)
+		{
+			for (size_t i = start; i < end; ++i)
+			{
+				float textureIndex = textureIndices != NULL ? textureIndices[i] : 0.0f;
+				for (size_t j = 0; j < 4; ++j, vertex += stride)
+				{
+					float* texCoord = reinterpret_cast<float*>(vertex);
+					texCoord[0] = corners[j << 1];
+					texCoord[1] = corners[(j << 1) + 1];
+					texCoord[2] = textureIndex;
+				}
+			}
+		}
+		else if (textureIndices != NULL)
+		{
+			// The row of the cell is computed with a float multiplication instead of an integer division which is much slower
+			// The half added to the index keeps the product away from integer values so that the truncation is exact
+			const int nbX = static_cast<int>(atlasNbX);
+			const float atlasNbXf = static_cast<float>(atlasNbX);
+			const float atlasNbYf = static_cast<float>(atlasNbY);
+			const float atlasW = 1.0f / atlasNbX;
+			const float atlasH = 1.0f / atlasNbY;
+
+			for (size_t i = start; i < end; ++i)
+			{
+				int textureIndex = static_cast<int>(textureIndices[i]);
+				int row = static_cast<int>((textureIndex + 0.5f) * atlasW);
+				float u0 = static_cast<float>(textureIndex - row * nbX) / atlasNbXf;
+				float v0 = static_cast<float>(row) / atlasNbYf;
+
+				for (size_t j = 0; j < 4; ++j, vertex += stride)
+				{
+					float* texCoord = reinterpret_cast<float*>(vertex);
+					texCoord[0] = u0 + corners[j << 1] * atlasW;
+					texCoord[1] = v0 + corners[(j << 1) + 1] * atlasH;
+				}
+			}
+		}
+		else
+		{
+			for (size_t i = start; i < end; ++i)
+				for (size_t j = 0; j < 4; ++j, vertex += stride)
+				{
+					float* texCoord = reinterpret_cast<float*>(vertex);
+					texCoord[0] = corners[j << 1];
+					texCoord[1] = corners[(j << 1) + 1];
+				}
+		}
+	}
+}
@@ -19,6 +19,7 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm> // for min
 #include <limits> // for max float value
 
 #include <SPARK_Core.h>
@@ -113,6 +114,47 @@ namespace SPK
 			v += randomDim[i] * tAxis[i];
 	}
 
+	void Box::generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii) const
+	{
+		// The coordinates along the axes are generated in bulk by blocks within [-1,1[ and then scaled
+		const size_t BLOCK_SIZE = 256;
+		float coords[3][BLOCK_SIZE];
+		float faces[BLOCK_SIZE];
+
+		RandomGenerator& generator = RandomGenerator::getCurrent();
+		for (size_t start = 0; start < nb; start += BLOCK_SIZE)
+		{
+			const size_t blockSize = std::min(BLOCK_SIZE,nb - start);
+			for (size_t i = 0; i < 3; ++i)
+				generator.fillUniform(coords[i],blockSize,-1.0f,1.0f);
+			if (!full)
+				generator.fillUniform(faces,blockSize,0.0f,6.0f);
+
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				Vector3D randomDim(coords[0][i],coords[1][i],coords[2][i]);
+				if (full)
+				{
+					Vector3D relDimensions;
+					relDimensions.setMax(halfDimensions - (radii != NULL ? radii[start + i] : 0.0f));
+					randomDim *= relDimensions;
+				}
+				else
+				{
+					// The point is moved on a random face (the value is clamped as the rounding may reach 6)
+					size_t n = std::min(static_cast<size_t>(faces[i]),static_cast<size_t>(5));
+					randomDim[n >> 1] = ((n & 1) << 1) - 1.0f;
+					randomDim *= halfDimensions;
+				}
+
+				Vector3D& v = positions[start + i];
+				v = getTransformedPosition();
+				for (size_t j = 0; j < 3; ++j)
+					v += randomDim[j] * tAxis[j];
+			}
+		}
+	}
+
 	bool Box::contains(const Vector3D& v,float radius) const
 	{
 		Vector3D d(v - getTransformedPosition());
@@ -145,13 +187,61 @@ namespace SPK
 		Vector3D d0(v0 - getTransformedPosition());
 		Vector3D d1(v1 - getTransformedPosition());
 
+		float dists0[3];
+		float dists1[3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			dists0[i] = dotProduct(tAxis[i],d0);
+			dists1[i] = dotProduct(tAxis[i],d1);
+		}
+
+		return intersectsFromDists(dists0,dists1,radius,normal);
+	}
+
+	void Box::containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const
+	{
+		float dists[3][BATCH_SIZE];
+		for (size_t i = 0; i < 3; ++i)
+			Kernels::computeDistances(positions,getTransformedPosition(),tAxis[i],dists[i],nb);
+
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const float radius = radii != NULL ? radii[i] * radiusFactor : 0.0f;
+			// The 3 axis are tested without branching
+			mask[i] = !(std::abs(dists[0][i]) - radius > halfDimensions.x)
+				& !(std::abs(dists[1][i]) - radius > halfDimensions.y)
+				& !(std::abs(dists[2][i]) - radius > halfDimensions.z);
+		}
+	}
+
+	void Box::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		float dists0[3][BATCH_SIZE];
+		float dists1[3][BATCH_SIZE];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			Kernels::computeDistances(v0,getTransformedPosition(),tAxis[i],dists0[i],nb);
+			Kernels::computeDistances(v1,getTransformedPosition(),tAxis[i],dists1[i],nb);
+		}
+
+		for (size_t i = 0; i < nb; ++i)
+			if (mask[i] != 0)
+			{
+				const float particleDists0[3] = { dists0[0][i],dists0[1][i],dists0[2][i] };
+				const float particleDists1[3] = { dists1[0][i],dists1[1][i],dists1[2][i] };
+				mask[i] = intersectsFromDists(particleDists0,particleDists1,radii != NULL ? radii[i] : 0.0f,normals != NULL ? normals + i : NULL);
+			}
+	}
+
+	bool Box::intersectsFromDists(const float* dists0,const float* dists1,float radius,Vector3D* normal) const
+	{
 		float minRatio = std::numeric_limits<float>::max();
 		bool intersect = false;
 
 		for (size_t i = 0; i < 3; ++i) 
 		{
-			float dist0 = dotProduct(tAxis[i],d0);
-			float dist1 = dotProduct(tAxis[i],d1);
+			float dist0 = dists0[i];
+			float dist1 = dists1[i];
 			float minDist,maxDist;
 
 			if (dist1 - dist0 > 0.0f)
@@ -19,6 +19,9 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm> // for min
+#include <cstring> // for memset
+
 #include <SPARK_Core.h>
 #include "Extensions/Zones/SPK_Cylinder.h"
 
@@ -101,6 +104,48 @@ namespace SPK
 		v += SPK_RANDOM(-relHeight,relHeight) * tAxis;
 		v += getTransformedPosition();
 	}
+
+	void Cylinder::generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii) const
+	{
+		// The points on the disk are generated from an angle and a distance to the axis rather than by rejection
+		const float PI = 3.14159265f;
+		const size_t BLOCK_SIZE = 256;
+		float angles[BLOCK_SIZE];
+		float sines[BLOCK_SIZE];
+		float cosines[BLOCK_SIZE];
+		float dists[BLOCK_SIZE];
+		float heights[BLOCK_SIZE];
+
+		RandomGenerator& generator = RandomGenerator::getCurrent();
+		for (size_t start = 0; start < nb; start += BLOCK_SIZE)
+		{
+			const size_t blockSize = std::min(BLOCK_SIZE,nb - start);
+			generator.fillUniform(angles,blockSize,-PI,PI);
+			if (full)
+				generator.fillUniform(dists,blockSize,0.0f,1.0f);
+			generator.fillUniform(heights,blockSize,-1.0f,1.0f);
+			Kernels::computeSinCos(angles,sines,cosines,blockSize);
+
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				const float particleRadius = (radii != NULL ? radii[start + i] : 0.0f);
+
+				float dist = radius;
+				if (full)
+				{
+					// The square root gives a uniform distribution on the disk
+					const float relRadius = radius - particleRadius;
+					dist = (relRadius <= 0.0f ? 0.0f : relRadius * std::sqrt(dists[i]));
+				}
+
+				Vector3D& v = positions[start + i];
+				v = (dist * cosines[i]) * tNormal;
+				v += (dist * sines[i]) * tCoNormal;
+				v += (heights[i] * (height * 0.5f - particleRadius)) * tAxis;
+				v += getTransformedPosition();
+			}
+		}
+	}
 	
 	bool Cylinder::contains(const Vector3D& v,float radius) const
 	{
@@ -120,6 +165,33 @@ namespace SPK
 		return false;
 	}
 
+	void Cylinder::containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const
+	{
+		// The distances along the axis reject the particles above or below the cylinder
+		float tangentDists[BATCH_SIZE];
+		Kernels::computeDistances(positions,getTransformedPosition(),tAxis,tangentDists,nb);
+
+		const float halfHeight = height * 0.5f;
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const float radius = radii != NULL ? radii[i] * radiusFactor : 0.0f;
+			if (std::abs(tangentDists[i]) - radius > halfHeight)
+				mask[i] = 0;
+			else
+			{
+				float normalSqrDist = (positions[i] - getTransformedPosition() - tangentDists[i] * tAxis).getSqrNorm();
+				float relRadius = this->radius - radius;
+				mask[i] = normalSqrDist <= relRadius * relRadius;
+			}
+		}
+	}
+
+	void Cylinder::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		SPK_LOG_INFO("The intersection is not implemented yet with the Cylinder Zone");
+		std::memset(mask,0,nb);
+	}
+
 	Vector3D Cylinder::computeNormal(const Vector3D& v) const
 	{
 		Vector3D normal = v - getTransformedPosition();
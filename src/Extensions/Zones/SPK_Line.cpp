@@ -67,6 +67,22 @@ namespace SPK
 
 	}
 
+	void Line::generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii) const
+	{
+		// The ratios along the line are generated in bulk by blocks
+		const size_t BLOCK_SIZE = 256;
+		float ratios[BLOCK_SIZE];
+
+		RandomGenerator& generator = RandomGenerator::getCurrent();
+		for (size_t start = 0; start < nb; start += BLOCK_SIZE)
+		{
+			const size_t blockSize = std::min(BLOCK_SIZE,nb - start);
+			generator.fillUniform(ratios,blockSize,0.0f,1.0f);
+			for (size_t i = 0; i < blockSize; ++i)
+				positions[start + i] = tBounds[0] + tDist * ratios[i];
+		}
+	}
+
 	Vector3D Line::computeNormal(const Vector3D& point) const
 	{
 		float d = -dotProduct(tDist,point);
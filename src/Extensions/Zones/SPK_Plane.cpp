@@ -34,12 +34,39 @@ namespace SPK
 
 	bool Plane::intersects(const Vector3D& v0,const Vector3D& v1,float radius,Vector3D* normal) const
 	{
-		float dist0 = dotProduct(tNormal,v0 - getTransformedPosition());
-		
+		return intersectsFromDists(dotProduct(tNormal,v0 - getTransformedPosition()),dotProduct(tNormal,v1 - getTransformedPosition()),radius,normal);
+	}
+
+	void Plane::containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const
+	{
+		float dists[BATCH_SIZE];
+		Kernels::computeDistances(positions,getTransformedPosition(),tNormal,dists,nb);
+
+		if (radii == NULL)
+			for (size_t i = 0; i < nb; ++i)
+				mask[i] = dists[i] <= 0.0f;
+		else
+			for (size_t i = 0; i < nb; ++i)
+				mask[i] = dists[i] <= radii[i] * radiusFactor;
+	}
+
+	void Plane::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		float dists0[BATCH_SIZE];
+		float dists1[BATCH_SIZE];
+		Kernels::computeDistances(v0,getTransformedPosition(),tNormal,dists0,nb);
+		Kernels::computeDistances(v1,getTransformedPosition(),tNormal,dists1,nb);
+
+		for (size_t i = 0; i < nb; ++i)
+			if (mask[i] != 0)
+				mask[i] = intersectsFromDists(dists0[i],dists1[i],radii != NULL ? radii[i] : 0.0f,normals != NULL ? normals + i : NULL);
+	}
+
+	bool Plane::intersectsFromDists(float dist0,float dist1,float radius,Vector3D* normal) const
+	{
 		if (std::abs(dist0) < radius)
 			return false; // the particle is already intersecting the plane, the intersection is ignored
 
-		float dist1 = dotProduct(tNormal,v1 - getTransformedPosition());
 		if (std::abs(dist1) < radius)
 		{
 			if (normal != NULL)
@@ -19,7 +19,8 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
-#include <algorithm> // for std::swap
+#include <algorithm> // for std::swap and std::min
+#include <cstring> // for memset
 
 #include <SPARK_Core.h>
 #include "Extensions/Zones/SPK_Ring.h"
@@ -45,8 +46,7 @@ namespace SPK
 	{
 		normal = n;
 		normal.normalize();
-		transformDir(tNormal,normal);
-		tNormal.normalize();
+		computeTransformedBase();
 	}
 
 	void Ring::setRadius(float minRadius,float maxRadius)
@@ -91,17 +91,73 @@ namespace SPK
 		v += getTransformedPosition();
 	}
 
+	void Ring::generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii) const
+	{
+		// The points are generated from an angle in the plane of the ring rather than by rejection
+		const float PI = 3.14159265f;
+		const size_t BLOCK_SIZE = 256;
+		float angles[BLOCK_SIZE];
+		float sines[BLOCK_SIZE];
+		float cosines[BLOCK_SIZE];
+		float ratios[BLOCK_SIZE];
+
+		RandomGenerator& generator = RandomGenerator::getCurrent();
+		for (size_t start = 0; start < nb; start += BLOCK_SIZE)
+		{
+			const size_t blockSize = std::min(BLOCK_SIZE,nb - start);
+			generator.fillUniform(angles,blockSize,-PI,PI);
+			generator.fillUniform(ratios,blockSize,0.0f,1.0f);
+			Kernels::computeSinCos(angles,sines,cosines,blockSize);
+
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				const float radius = (radii != NULL ? radii[start + i] : 0.0f);
+				float relMinRadius = minRadius + radius;
+				float relMaxRadius = maxRadius - radius;
+
+				if (relMinRadius > relMaxRadius)
+					relMinRadius = relMaxRadius = (relMinRadius + relMaxRadius) * 0.5f;
+
+				relMinRadius *= relMinRadius;
+				relMaxRadius *= relMaxRadius;
+				const float dist = std::sqrt(relMinRadius + ratios[i] * (relMaxRadius - relMinRadius)); // to have a uniform distribution
+
+				Vector3D& v = positions[start + i];
+				v = (dist * cosines[i]) * tTangent;
+				v += (dist * sines[i]) * tCoTangent;
+				v += getTransformedPosition();
+			}
+		}
+	}
+
 	bool Ring::intersects(const Vector3D& v0,const Vector3D& v1,float radius,Vector3D* normal) const
 	{
-		Vector3D r0 = v0 - getTransformedPosition();
-		float dist0 = dotProduct(tNormal,r0);
-		
+		return intersectsFromDists(v0,v1,dotProduct(tNormal,v0 - getTransformedPosition()),dotProduct(tNormal,v1 - getTransformedPosition()),radius,normal);
+	}
+
+	void Ring::containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const
+	{
+		std::memset(mask,0,nb); // A ring has no volume
+	}
+
+	void Ring::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		// The distances to the plane of the ring reject most of the particles
+		float dists0[BATCH_SIZE];
+		float dists1[BATCH_SIZE];
+		Kernels::computeDistances(v0,getTransformedPosition(),tNormal,dists0,nb);
+		Kernels::computeDistances(v1,getTransformedPosition(),tNormal,dists1,nb);
+
+		for (size_t i = 0; i < nb; ++i)
+			if (mask[i] != 0)
+				mask[i] = intersectsFromDists(v0[i],v1[i],dists0[i],dists1[i],radii != NULL ? radii[i] : 0.0f,normals != NULL ? normals + i : NULL);
+	}
+
+	bool Ring::intersectsFromDists(const Vector3D& v0,const Vector3D& v1,float dist0,float dist1,float radius,Vector3D* normal) const
+	{
 		if (std::abs(dist0) < radius)
 			return false; // the particle is already intersecting the plane, the intersection is ignored
 
-		Vector3D r1 = v1 - getTransformedPosition();
-		float dist1 = dotProduct(tNormal,r1);
-
 		if (std::abs(dist1) >= radius)
 		{
 			float dist1Bis = dist1;
@@ -116,6 +172,8 @@ namespace SPK
 
 		// The particle is intersecting the plane but is it within the ring ?
 		// Projects on the ring's plane
+		Vector3D r0 = v0 - getTransformedPosition();
+		Vector3D r1 = v1 - getTransformedPosition();
 		r0 -= dist0 * tNormal;
 		r1 -= dist1 * tNormal;
 
@@ -138,7 +196,20 @@ namespace SPK
 	void Ring::innerUpdateTransform()
 	{
 		Zone::innerUpdateTransform();
+		computeTransformedBase();
+	}
+
+	void Ring::computeTransformedBase()
+	{
 		transformDir(tNormal,normal);
 		tNormal.normalize();
+
+		// Any orthonormal base of the plane of the ring is fine
+		Vector3D tmp(1.0f,0.0f,0.0f);
+		if (std::abs(tNormal.x) > 0.9f) tmp.set(0.0f,1.0f,0.0f);
+
+		tTangent = crossProduct(tNormal,tmp);
+		tTangent.normalize();
+		tCoTangent = crossProduct(tTangent,tNormal);
 	}
 }
@@ -19,7 +19,7 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
-#include <algorithm> // for min
+#include <algorithm> // for min and max
 
 #include <SPARK_Core.h>
 #include "Extensions/Zones/SPK_Sphere.h"
@@ -61,6 +61,44 @@ namespace SPK
 		v += getTransformedPosition();
 	}
 
+	void Sphere::generatePositions(Vector3D* positions,size_t nb,bool full,const float* radii) const
+	{
+		RandomGenerator& generator = RandomGenerator::getCurrent();
+		const Vector3D& center = getTransformedPosition();
+
+		if (!full)
+		{
+			generator.fillDirections(positions,nb);
+			for (size_t i = 0; i < nb; ++i)
+			{
+				positions[i] *= radius;
+				positions[i] += center;
+			}
+			return;
+		}
+
+		// The distance to the center of a uniform point in a ball is distributed as the cube root of a uniform variable,
+		// which is also the distribution of the maximum of 3 uniform variables
+		const size_t BLOCK_SIZE = 256;
+		float values[BLOCK_SIZE * 3];
+
+		for (size_t start = 0; start < nb; start += BLOCK_SIZE)
+		{
+			const size_t blockSize = std::min(BLOCK_SIZE,nb - start);
+			Vector3D* block = positions + start;
+			generator.fillDirections(block,blockSize);
+			generator.fillUniform(values,blockSize * 3,0.0f,1.0f);
+
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				const float relRadius = radius - (radii != NULL ? radii[start + i] : 0.0f);
+				const float* u = values + i * 3;
+				block[i] *= (relRadius <= 0.0f ? 0.0f : relRadius * std::max(u[0],std::max(u[1],u[2])));
+				block[i] += center;
+			}
+		}
+	}
+
 	bool Sphere::contains(const Vector3D& v,float radius) const
 	{
 		const float relRadius = this->radius - radius;
@@ -68,13 +106,46 @@ namespace SPK
 	}
 
 	bool Sphere::intersects(const Vector3D& v0,const Vector3D& v1,float radius,Vector3D* normal) const
+	{
+		return intersectsFromSqrDists(getSqrDist(getTransformedPosition(),v0),getSqrDist(getTransformedPosition(),v1),v0,radius,normal);
+	}
+
+	void Sphere::containsBatch(const Vector3D* positions,const float* radii,float radiusFactor,size_t nb,uint8* mask) const
+	{
+		float sqrDists[BATCH_SIZE];
+		Kernels::computeSqrDistances(positions,getTransformedPosition(),sqrDists,nb);
+
+		if (radii == NULL)
+		{
+			const float sqrRadius = radius * radius;
+			for (size_t i = 0; i < nb; ++i)
+				mask[i] = sqrDists[i] <= sqrRadius;
+		}
+		else
+			for (size_t i = 0; i < nb; ++i)
+			{
+				const float relRadius = radius - radii[i] * radiusFactor;
+				mask[i] = sqrDists[i] <= relRadius * relRadius;
+			}
+	}
+
+	void Sphere::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,uint8* mask,Vector3D* normals) const
+	{
+		float sqrDists0[BATCH_SIZE];
+		float sqrDists1[BATCH_SIZE];
+		Kernels::computeSqrDistances(v0,getTransformedPosition(),sqrDists0,nb);
+		Kernels::computeSqrDistances(v1,getTransformedPosition(),sqrDists1,nb);
+
+		for (size_t i = 0; i < nb; ++i)
+			if (mask[i] != 0)
+				mask[i] = intersectsFromSqrDists(sqrDists0[i],sqrDists1[i],v0[i],radii != NULL ? radii[i] : 0.0f,normals != NULL ? normals + i : NULL);
+	}
+
+	bool Sphere::intersectsFromSqrDists(float dist0,float dist1,const Vector3D& v0,float radius,Vector3D* normal) const
 	{
 		float r2 = this->radius * this->radius + radius * radius;
 		float s2 = 2.0f * this->radius * radius;
 
-		float dist0 = getSqrDist(getTransformedPosition(),v0);
-		float dist1 = getSqrDist(getTransformedPosition(),v1);
-
 		if (dist0 > r2 + s2) // the start sphere is completely out of the sphere
 		{
 			if (dist1 > r2 + s2) // the end sphere is completely out of the sphere
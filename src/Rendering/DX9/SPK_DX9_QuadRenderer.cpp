@@ -21,12 +21,25 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include <SPARK_Core.h>
+#include "Extensions/Renderers/SPK_QuadExpander.h"
 #include "Rendering/DX9/SPK_DX9_QuadRenderer.h"
 
 namespace SPK
 {
 namespace DX9
 {
+	namespace
+	{
+		// The texture coordinates of the corners in the order of the vertices
+		const float CORNER_TEX_COORDS[8] =
+		{
+			0.0f,0.0f,
+			1.0f,0.0f,
+			1.0f,1.0f,
+			0.0f,1.0f,
+		};
+	}
+
 	void (DX9QuadRenderer::*DX9QuadRenderer::renderParticle)(const Particle&,DX9Buffer& renderBuffer) const = NULL;
 
 	DX9QuadRenderer::DX9QuadRenderer(float scaleX,float scaleY) :
@@ -185,8 +198,7 @@ namespace DX9
 			computeGlobalOrientation3D(group);
 
 			buffer.lock(lockType);
-			for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-				(this->*renderParticle)(*particleIt,buffer);
+			expandQuads(group,buffer);
 			buffer.unlock();
 		}
 		else
@@ -206,6 +218,37 @@ namespace DX9
 		if( texturingMode != TEXTURE_MODE_NONE ) DX9Info::getDevice()->SetTexture( 0, NULL );
 	}
 
+	void DX9QuadRenderer::expandQuads(const Group& group,DX9Buffer& renderBuffer) const
+	{
+		QuadExpander expander;
+		expander.setOrientation(orientationSide(),orientationUp());
+		expander.setScale(scaleX,scaleY);
+		expander.setTexturing(texturingMode,textureAtlasNbX,textureAtlasNbY);
+		expander.setCornerTexCoords(CORNER_TEX_COORDS);
+
+		// The colors are stored as ARGB by Direct3D so they cannot be copied by the expander
+		QuadVertexArrays arrays;
+		arrays.positions = renderBuffer.getLockedVertexBuffer();
+		arrays.positionStride = sizeof(D3DXVECTOR3);
+		arrays.colors = NULL;
+		arrays.colorStride = 0;
+		arrays.texCoords = NULL;
+		arrays.texCoordStride = 0;
+
+		// The texture coordinates are locked only if they depend on the texture index
+		if (texturingMode != TEXTURE_MODE_NONE && group.isEnabled(PARAM_TEXTURE_INDEX))
+		{
+			arrays.texCoords = renderBuffer.getLockedTexCoordBuffer();
+			arrays.texCoordStride = renderBuffer.getNbTexCoords() * sizeof(float);
+		}
+
+		expander.expand(group,arrays);
+
+		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+			for (size_t i = 0; i < 4; ++i)
+				renderBuffer.setNextColor(particleIt->getColor());
+	}
+
 	void DX9QuadRenderer::computeAABB(Vector3D& AABBMin,Vector3D& AABBMax,const Group& group,const DataSet* dataSet) const
 	{
 		float diagonal = group.getGraphicalRadius() * std::sqrt(scaleX * scaleX + scaleY * scaleY);
@@ -38,7 +38,8 @@ namespace IRR
 		currentIndexIndex(0),
 		currentVertexIndex(0),
 		currentColorIndex(0),
-		currentTexCoordIndex(0)
+		currentTexCoordIndex(0),
+		naturalOrder(true)
 	{
 		SPK_ASSERT(nbParticles > 0,"IRRBuffer::IRRBuffer(irr::IrrlichtDevice*,irr::scene::E_PRIMITIVE_TYPE,size_t) - The number of particles cannot be 0");
 		SPK_ASSERT(nbVerticesPerParticle > 0,"IRRBuffer::IRRBuffer(irr::IrrlichtDevice*,irr::scene::E_PRIMITIVE_TYPE,size_t) - The number of vertices per particle cannot be 0");
@@ -70,4 +71,34 @@ namespace IRR
 		meshBuffer->getVertexBuffer().set_used(nb * nbVerticesPerParticle);
 		meshBuffer->getIndexBuffer().set_used(nb * nbIndicesPerParticle);
 	}
+
+	void IRRBuffer::setParticleOrder(const int* indexPattern,const unsigned int* particleIndices,size_t nb)
+	{
+		if (particleIndices == NULL && naturalOrder)
+			return;
+
+		irr::scene::IIndexBuffer& indexBuffer = meshBuffer->getIndexBuffer();
+		const size_t nbUsedIndices = indexBuffer.size();
+
+		// The natural order is restored for the whole capacity as the unused indices may be used later without being rewritten
+		if (particleIndices == NULL)
+		{
+			nb = nbParticles;
+			indexBuffer.set_used(nbParticles * nbIndicesPerParticle);
+		}
+		else if (nb > nbParticles)
+			nb = nbParticles;
+
+		size_t index = 0;
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const int firstVertex = static_cast<int>((particleIndices != NULL ? particleIndices[i] : i) * nbVerticesPerParticle);
+			for (size_t j = 0; j < nbIndicesPerParticle; ++j)
+				indexBuffer.setValue(index++,firstVertex + indexPattern[j]);
+		}
+
+		indexBuffer.set_used(nbUsedIndices);
+		naturalOrder = particleIndices == NULL;
+		meshBuffer->setDirty(irr::scene::EBT_INDEX);
+	}
 }}
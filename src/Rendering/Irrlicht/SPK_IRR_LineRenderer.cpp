@@ -28,6 +28,11 @@ namespace SPK
 {
 namespace IRR
 {
+	namespace
+	{
+		const int LINE_INDICES[2] = {0,1};
+	}
+
 	IRRLineRenderer::IRRLineRenderer(irr::IrrlichtDevice* d,float length,float width) :
 		IRRRenderer(d),
 		LineRenderBehavior(length,width)
@@ -72,6 +77,7 @@ namespace IRR
 			buffer.setNextColor(color);
 		}
 		buffer.getMeshBuffer().setDirty(irr::scene::EBT_VERTEX);
+		buffer.setParticleOrder(LINE_INDICES,group.getSortedIndices(),group.getNbParticles());
 
 		irr::video::IVideoDriver* driver = device->getVideoDriver();
 		driver->setMaterial(material);
@@ -28,6 +28,11 @@ namespace SPK
 {
 namespace IRR
 {
+	namespace
+	{
+		const int POINT_INDICES[1] = {0};
+	}
+
 	IRRPointRenderer::IRRPointRenderer(irr::IrrlichtDevice* d,float screenSize) :
 		IRRRenderer(d),
 		PointRenderBehavior(POINT_TYPE_SQUARE,screenSize)
@@ -88,6 +93,7 @@ namespace IRR
 			buffer.setNextColor(particleIt->getColor());
 		}
 		buffer.getMeshBuffer().setDirty(irr::scene::EBT_VERTEX);
+		buffer.setParticleOrder(POINT_INDICES,group.getSortedIndices(),group.getNbParticles());
 
 		irr::video::IVideoDriver* driver = device->getVideoDriver();
         driver->setMaterial(material);
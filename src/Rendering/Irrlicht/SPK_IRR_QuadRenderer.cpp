@@ -28,6 +28,12 @@ namespace SPK
 {
 namespace IRR
 {
+	namespace
+	{
+		// The 2 triangles of a quad relative to its first vertex
+		const int QUAD_INDICES[6] = {0,1,2,0,2,3};
+	}
+
 	IRRQuadRenderer::IRRQuadRenderer(irr::IrrlichtDevice* d,float scaleX,float scaleY) :
 		IRRRenderer(d),
 		QuadRenderBehavior(scaleX,scaleY),
@@ -144,6 +150,7 @@ namespace IRR
 			}
 		}
 		buffer.getMeshBuffer().setDirty(irr::scene::EBT_VERTEX);
+		buffer.setParticleOrder(QUAD_INDICES,group.getSortedIndices(),group.getNbParticles());
 
 		driver->setMaterial(material);
 		driver->drawMeshBuffer(&buffer.getMeshBuffer()); // this draw call is used in order to be able to use VBOs
@@ -19,6 +19,10 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifndef SPK_GL_NO_EXT
+#include <GL/glew.h>
+#endif
+
 #include <SPARK_Core.h>
 #include "Rendering/OpenGL/SPK_GL_Buffer.h"
 
@@ -29,16 +33,19 @@ namespace GL
 	GLBuffer::GLBuffer(size_t nbVertices,size_t nbTexCoords) :
 		nbVertices(nbVertices),
 		nbTexCoords(nbTexCoords),
+		vertexBuffer(NULL),
+		colorBuffer(NULL),
 		texCoordBuffer(NULL),
+		elementBuffer(NULL),
+		scratchBuffer(NULL),
+		scratchSize(0),
 		currentVertexIndex(0),
 		currentColorIndex(0),
-		currentTexCoordIndex(0)
+		currentTexCoordIndex(0),
+		streamBufferID(0)
 	{
 		SPK_ASSERT(nbVertices > 0,"GLBuffer::GLBuffer(size_t,size_t) - The number of vertices cannot be 0");
 
-		vertexBuffer = SPK_NEW_ARRAY(Vector3D,nbVertices);
-		colorBuffer = SPK_NEW_ARRAY(Color,nbVertices);
-
 		if (nbTexCoords > 0)
 			texCoordBuffer = SPK_NEW_ARRAY(float,nbVertices * nbTexCoords);
 	}
@@ -48,6 +55,23 @@ namespace GL
 		SPK_DELETE_ARRAY(vertexBuffer);
 		SPK_DELETE_ARRAY(colorBuffer);
 		SPK_DELETE_ARRAY(texCoordBuffer);
+		SPK_DELETE_ARRAY(elementBuffer);
+		SPK_DELETE_ARRAY(scratchBuffer);
+	}
+
+	void GLBuffer::releaseGLResources()
+	{
+#ifndef SPK_GL_NO_EXT
+		if (streamBufferID != 0)
+			glDeleteBuffers(1,&streamBufferID);
+		streamBufferID = 0;
+#endif
+	}
+
+	void GLBuffer::allocateVertices()
+	{
+		vertexBuffer = SPK_NEW_ARRAY(Vector3D,nbVertices);
+		colorBuffer = SPK_NEW_ARRAY(Color,nbVertices);
 	}
 
 	void GLBuffer::setNbTexCoords(size_t nb)
@@ -63,6 +87,42 @@ namespace GL
 	}
 
 	void GLBuffer::render(GLuint primitive,size_t nbVertices)
+	{
+		enableArrays();
+		glDrawArrays(primitive,0,nbVertices);
+		disableArrays();
+	}
+
+	void GLBuffer::render(GLuint primitive,size_t nbVerticesPerParticle,const unsigned int* particleIndices,size_t nbParticles)
+	{
+		if (elementBuffer == NULL)
+			elementBuffer = SPK_NEW_ARRAY(GLuint,nbVertices);
+
+		GLuint* element = elementBuffer;
+		for (size_t i = 0; i < nbParticles; ++i)
+		{
+			const GLuint firstVertex = static_cast<GLuint>(particleIndices[i] * nbVerticesPerParticle);
+			for (size_t j = 0; j < nbVerticesPerParticle; ++j)
+				*element++ = firstVertex + static_cast<GLuint>(j);
+		}
+
+		enableArrays();
+		glDrawElements(primitive,static_cast<GLsizei>(nbParticles * nbVerticesPerParticle),GL_UNSIGNED_INT,elementBuffer);
+		disableArrays();
+	}
+
+	void* GLBuffer::getScratchBuffer(size_t size)
+	{
+		if (size > scratchSize)
+		{
+			SPK_DELETE_ARRAY(scratchBuffer);
+			scratchBuffer = SPK_NEW_ARRAY(char,size);
+			scratchSize = size;
+		}
+		return scratchBuffer;
+	}
+
+	void GLBuffer::enableArrays()
 	{
 		glEnableClientState(GL_VERTEX_ARRAY);
 		glEnableClientState(GL_COLOR_ARRAY);
@@ -75,13 +135,25 @@ namespace GL
 
 		glVertexPointer(3,GL_FLOAT,0,vertexBuffer);
 		glColorPointer(4,GL_UNSIGNED_BYTE,0,colorBuffer);
-	
-		glDrawArrays(primitive,0,nbVertices);
+	}
 
+	void GLBuffer::disableArrays()
+	{
 		glDisableClientState(GL_VERTEX_ARRAY);
 		glDisableClientState(GL_COLOR_ARRAY);
 
 		if (nbTexCoords > 0)
 			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	}
+
+#ifndef SPK_GL_NO_EXT
+	void GLBuffer::bindStreamBuffer(size_t size)
+	{
+		if (streamBufferID == 0)
+			glGenBuffers(1,&streamBufferID);
+
+		glBindBuffer(GL_ARRAY_BUFFER,streamBufferID);
+		glBufferData(GL_ARRAY_BUFFER,size,NULL,GL_STREAM_DRAW);
+	}
+#endif
 }}
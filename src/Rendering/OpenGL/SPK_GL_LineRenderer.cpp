@@ -65,7 +65,11 @@ namespace GL
 			buffer.setNextColor(particle.getColor());
 		}
 
-		buffer.render(GL_LINES,group.getNbParticles() << 1);
+		const unsigned int* sortedIndices = group.getSortedIndices();
+		if (sortedIndices != NULL)
+			buffer.render(GL_LINES,2,sortedIndices,group.getNbParticles());
+		else
+			buffer.render(GL_LINES,group.getNbParticles() << 1);
 	}
 
 	void GLLineRenderer::computeAABB(Vector3D& AABBMin,Vector3D& AABBMax,const Group& group,const DataSet* dataSet) const
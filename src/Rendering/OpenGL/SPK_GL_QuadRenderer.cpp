@@ -24,6 +24,7 @@
 #endif
 
 #include <SPARK_Core.h>
+#include "Extensions/Renderers/SPK_QuadExpander.h"
 #include "Rendering/OpenGL/SPK_GL_QuadRenderer.h"
 
 namespace SPK
@@ -32,19 +33,155 @@ namespace GL
 {
 	GLboolean* const GLQuadRenderer::SPK_GL_TEXTURE_3D_EXT = &__GLEW_EXT_texture3D;
 
+#ifndef SPK_GL_NO_EXT
+	GLboolean* const GLQuadRenderer::SPK_GL_SHADERS_EXT = &__GLEW_VERSION_2_0;
+	GLboolean* const GLQuadRenderer::SPK_GL_INSTANCED_ARRAYS_EXT = &__GLEW_ARB_instanced_arrays;
+	GLboolean* const GLQuadRenderer::SPK_GL_VBO_EXT = &__GLEW_VERSION_1_5;
+
+	namespace
+	{
+		// Attributes of the instancing program
+		enum InstancingAttribute
+		{
+			ATTRIBUTE_CORNER,
+			ATTRIBUTE_POSITION,
+			ATTRIBUTE_COLOR,
+			ATTRIBUTE_SCALE,
+			ATTRIBUTE_ANGLE,
+			ATTRIBUTE_TEXTURE_INDEX,
+			NB_ATTRIBUTES,
+		};
+
+		const char* const ATTRIBUTE_NAMES[NB_ATTRIBUTES] =
+		{
+			"corner",
+			"position",
+			"color",
+			"scale",
+			"angle",
+			"textureIndex",
+		};
+
+		// The quad is expanded from its center with the side and up vectors of the group, rotated by the angle of the particle
+		// The texture coordinates are the same as the ones computed on the CPU side
+		const char* const INSTANCING_VERTEX_SHADER =
+			"#version 120\n"
+			"attribute vec2 corner;\n"
+			"attribute vec3 position;\n"
+			"attribute vec4 color;\n"
+			"attribute float scale;\n"
+			"attribute float angle;\n"
+			"attribute float textureIndex;\n"
+			"uniform vec3 side;\n"
+			"uniform vec3 up;\n"
+			"uniform vec2 quadScale;\n"
+			"uniform vec2 atlasDimensions;\n"
+			"uniform float atlasEnabled;\n"
+			"uniform float texture3DEnabled;\n"
+			"void main()\n"
+			"{\n"
+			"	float cosA = cos(angle);\n"
+			"	float sinA = sin(angle);\n"
+			"	vec3 quadSide = (side * cosA + up * sinA) * (scale * quadScale.x);\n"
+			"	vec3 quadUp = (up * cosA - side * sinA) * (scale * quadScale.y);\n"
+			"	gl_Position = gl_ModelViewProjectionMatrix * vec4(position + quadSide * corner.x + quadUp * corner.y,1.0);\n"
+			"	gl_FrontColor = color;\n"
+			"	float atlasIndex = floor(textureIndex) * atlasEnabled;\n"
+			"	vec2 cell = vec2(mod(atlasIndex,atlasDimensions.x),floor(atlasIndex / atlasDimensions.x));\n"
+			"	vec2 coords = vec2(corner.x + 1.0,1.0 - corner.y) * 0.5;\n"
+			"	gl_TexCoord[0] = vec4((cell + coords) / atlasDimensions,textureIndex * texture3DEnabled,1.0);\n"
+			"}\n";
+
+		// The corners of a quad drawn as a triangle fan in counter clockwise order
+		const float QUAD_CORNERS[8] =
+		{
+			1.0f,1.0f,		// top right
+			-1.0f,1.0f,		// top left
+			-1.0f,-1.0f,	// bottom left
+			1.0f,-1.0f,		// bottom right
+		};
+
+		// Sets an attribute read once per instance, either from the given array or from the stream buffer currently bound
+		void setInstanceAttribute(GLuint index,GLint size,GLenum type,GLboolean normalized,const void* data,size_t dataSize,bool streamed,size_t& offset)
+		{
+			glEnableVertexAttribArray(index);
+			glVertexAttribDivisorARB(index,1);
+
+			if (streamed)
+			{
+				glBufferSubData(GL_ARRAY_BUFFER,offset,dataSize,data);
+				glVertexAttribPointer(index,size,type,normalized,0,reinterpret_cast<const GLvoid*>(offset));
+				offset += dataSize;
+			}
+			else
+				glVertexAttribPointer(index,size,type,normalized,0,data);
+		}
+
+		// Gathers the data of the particles in the sorted order into the given storage which is then moved after the gathered data
+		// The data are returned as they are if the particles are not sorted by indices
+		template<typename T>
+		const void* sortInstanceData(const void* data,const unsigned int* sortedIndices,size_t nbParticles,char*& storage)
+		{
+			if (sortedIndices == NULL)
+				return data;
+
+			const T* src = static_cast<const T*>(data);
+			T* dst = reinterpret_cast<T*>(storage);
+			for (size_t i = 0; i < nbParticles; ++i)
+				dst[i] = src[sortedIndices[i]];
+			storage += nbParticles * sizeof(T);
+			return dst;
+		}
+
+		// Sets a parameter attribute, constant if the parameter is not enabled in the group
+		void setParamAttribute(GLuint index,const Group& group,Param param,float defaultValue,const unsigned int* sortedIndices,char*& sortedData,bool streamed,size_t& offset)
+		{
+			const size_t nbParticles = group.getNbParticles();
+			if (group.isEnabled(param))
+				setInstanceAttribute(index,1,GL_FLOAT,GL_FALSE,sortInstanceData<float>(group.getParamAddress(param),sortedIndices,nbParticles,sortedData),nbParticles * sizeof(float),streamed,offset);
+			else
+				glVertexAttrib1f(index,defaultValue);
+		}
+	}
+
+#endif
+
 	GLQuadRenderer::GLQuadRenderer(float scaleX,float scaleY) :
 		GLRenderer(false),
 		QuadRenderBehavior(scaleX,scaleY),
 		Oriented3DRenderBehavior(),
 		textureIndex(0)
-	{}
+	{
+#ifndef SPK_GL_NO_EXT
+		instancingProgram.status = InstancingProgram::PROGRAM_UNLOADED;
+		instancingProgram.id = 0;
+#endif
+	}
 
 	GLQuadRenderer::GLQuadRenderer(const GLQuadRenderer& renderer) :
 		GLRenderer(renderer),
 		QuadRenderBehavior(renderer),
 		Oriented3DRenderBehavior(renderer),
 		textureIndex(renderer.textureIndex)
-	{}
+	{
+		// The copy builds its own program
+#ifndef SPK_GL_NO_EXT
+		instancingProgram.status = InstancingProgram::PROGRAM_UNLOADED;
+		instancingProgram.id = 0;
+#endif
+	}
+
+	void GLQuadRenderer::releaseGLResources()
+	{
+#ifndef SPK_GL_NO_EXT
+		if (instancingProgram.status == InstancingProgram::PROGRAM_LINKED)
+			glDeleteProgram(instancingProgram.id);
+
+		// A failed build is attempted again as the next context may support it
+		instancingProgram.status = InstancingProgram::PROGRAM_UNLOADED;
+		instancingProgram.id = 0;
+#endif
+	}
 
 #if 1
 	void GLQuadRenderer::setTexturingMode(TextureMode mode)
@@ -65,7 +202,6 @@ namespace GL
 	{
 		SPK_ASSERT(renderBuffer != NULL,"GLQuadRenderer::render(const Group&,const DataSet*,RenderBuffer*) - renderBuffer must not be NULL");
 		GLBuffer& buffer = static_cast<GLBuffer&>(*renderBuffer);
-		buffer.positionAtStart(); // Repositions all the buffers at the start
 
 		float oldModelView[16];
 		for (int i = 0; i < 16; ++i)
@@ -83,11 +219,26 @@ namespace GL
 
 		glShadeModel(GL_FLAT);
 
+		bool globalOrientation = precomputeOrientation3D(
+			group,
+			Vector3D(-invModelView[8],-invModelView[9],-invModelView[10]),
+			Vector3D(invModelView[4],invModelView[5],invModelView[6]),
+			Vector3D(invModelView[12],invModelView[13],invModelView[14]));
+
+		// The quads are expanded on the GPU only if they share the same orientation
+#ifndef SPK_GL_NO_EXT
+		const bool instanced = globalOrientation && isInstancingUsable();
+#else
+		const bool instanced = false;
+#endif
+		if (!instanced)
+			buffer.positionAtStart(); // Repositions all the buffers at the start
+
 		switch(texturingMode)
 		{
 		case TEXTURE_MODE_2D :
 			// Creates and inits the 2D TexCoord buffer if necessary
-			if (buffer.getNbTexCoords() != 2)
+			if (!instanced && buffer.getNbTexCoords() != 2)
 			{
 				buffer.setNbTexCoords(2);
 				if (!group.isEnabled(PARAM_TEXTURE_INDEX))
@@ -126,7 +277,7 @@ namespace GL
 
 		case TEXTURE_MODE_3D :
 			// Creates and inits the 3D TexCoord buffer if necessery
-			if (buffer.getNbTexCoords() != 3)
+			if (!instanced && buffer.getNbTexCoords() != 3)
 			{
 				buffer.setNbTexCoords(3);
 				float t[12] =  {1.0f,0.0f,0.0f,0.0f,0.0f,0.0f,0.0f,1.0f,0.0f,1.0f,1.0f,0.0f};
@@ -167,19 +318,20 @@ namespace GL
 			break;
 		}
 
-		bool globalOrientation = precomputeOrientation3D(
-			group,
-			Vector3D(-invModelView[8],-invModelView[9],-invModelView[10]),
-			Vector3D(invModelView[4],invModelView[5],invModelView[6]),
-			Vector3D(invModelView[12],invModelView[13],invModelView[14]));
+#ifndef SPK_GL_NO_EXT
+		if (instanced)
+		{
+			computeGlobalOrientation3D(group);
+			renderInstances(group,buffer);
+			return;
+		}
+#endif
 
 		// Fills the buffers
 		if (globalOrientation)
 		{
 			computeGlobalOrientation3D(group);
-
-			for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-				(this->*renderParticle)(*particleIt,buffer);
+			expandQuads(group,buffer);
 		}
 		else
 		{
@@ -190,7 +342,157 @@ namespace GL
 			}
 		}
 
-		buffer.render(GL_QUADS,group.getNbParticles() << 2);
+		// The quads are filled in the order of the particles and drawn in the sorted order if any
+		const unsigned int* sortedIndices = group.getSortedIndices();
+		if (sortedIndices != NULL)
+			buffer.render(GL_QUADS,4,sortedIndices,group.getNbParticles());
+		else
+			buffer.render(GL_QUADS,group.getNbParticles() << 2);
+	}
+
+#ifndef SPK_GL_NO_EXT
+	void GLQuadRenderer::initInstancingProgram() const
+	{
+		instancingProgram.status = InstancingProgram::PROGRAM_FAILED;
+
+		GLuint shader = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(shader,1,&INSTANCING_VERTEX_SHADER,NULL);
+		glCompileShader(shader);
+
+		GLint compiled = GL_FALSE;
+		glGetShaderiv(shader,GL_COMPILE_STATUS,&compiled);
+		if (compiled != GL_TRUE)
+		{
+			SPK_LOG_ERROR("GLQuadRenderer::initInstancingProgram() - The instancing vertex shader cannot be compiled, quads are expanded on the CPU");
+			glDeleteShader(shader);
+			return;
+		}
+
+		// The fragments are processed by the fixed pipeline
+		GLuint program = glCreateProgram();
+		glAttachShader(program,shader);
+		for (GLuint i = 0; i < NB_ATTRIBUTES; ++i)
+			glBindAttribLocation(program,i,ATTRIBUTE_NAMES[i]);
+		glLinkProgram(program);
+		glDeleteShader(shader); // flagged for deletion with the program
+
+		GLint linked = GL_FALSE;
+		glGetProgramiv(program,GL_LINK_STATUS,&linked);
+		if (linked != GL_TRUE)
+		{
+			SPK_LOG_ERROR("GLQuadRenderer::initInstancingProgram() - The instancing program cannot be linked, quads are expanded on the CPU");
+			glDeleteProgram(program);
+			return;
+		}
+
+		instancingProgram.status = InstancingProgram::PROGRAM_LINKED;
+		instancingProgram.id = program;
+		instancingProgram.sideLocation = glGetUniformLocation(program,"side");
+		instancingProgram.upLocation = glGetUniformLocation(program,"up");
+		instancingProgram.quadScaleLocation = glGetUniformLocation(program,"quadScale");
+		instancingProgram.atlasDimensionsLocation = glGetUniformLocation(program,"atlasDimensions");
+		instancingProgram.atlasEnabledLocation = glGetUniformLocation(program,"atlasEnabled");
+		instancingProgram.texture3DEnabledLocation = glGetUniformLocation(program,"texture3DEnabled");
+	}
+
+	bool GLQuadRenderer::isInstancingUsable() const
+	{
+		if (getShaderHint() == SHADER_HINT_NONE
+			|| !SPK_GL_CHECK_EXTENSION(SPK_GL_SHADERS_EXT)
+			|| !SPK_GL_CHECK_EXTENSION(SPK_GL_INSTANCED_ARRAYS_EXT))
+			return false;
+
+		// The program is built once in the current context (see releaseGLResources())
+		if (instancingProgram.status == InstancingProgram::PROGRAM_UNLOADED)
+			initInstancingProgram();
+
+		return instancingProgram.status == InstancingProgram::PROGRAM_LINKED;
+	}
+
+	void GLQuadRenderer::renderInstances(const Group& group,GLBuffer& renderBuffer) const
+	{
+		const size_t nbParticles = group.getNbParticles();
+		if (nbParticles == 0)
+			return;
+
+		glUseProgram(instancingProgram.id);
+
+		const Vector3D& side = orientationSide();
+		const Vector3D& up = orientationUp();
+		const bool atlasEnabled = texturingMode == TEXTURE_MODE_2D && group.isEnabled(PARAM_TEXTURE_INDEX);
+
+		glUniform3f(instancingProgram.sideLocation,side.x,side.y,side.z);
+		glUniform3f(instancingProgram.upLocation,up.x,up.y,up.z);
+		glUniform2f(instancingProgram.quadScaleLocation,scaleX,scaleY);
+		glUniform2f(instancingProgram.atlasDimensionsLocation,
+			atlasEnabled ? static_cast<float>(textureAtlasNbX) : 1.0f,
+			atlasEnabled ? static_cast<float>(textureAtlasNbY) : 1.0f);
+		glUniform1f(instancingProgram.atlasEnabledLocation,atlasEnabled ? 1.0f : 0.0f);
+		glUniform1f(instancingProgram.texture3DEnabledLocation,texturingMode == TEXTURE_MODE_3D ? 1.0f : 0.0f);
+
+		// The corners are read from client memory for each vertex of an instance
+		glEnableVertexAttribArray(ATTRIBUTE_CORNER);
+		glVertexAttribPointer(ATTRIBUTE_CORNER,2,GL_FLOAT,GL_FALSE,0,QUAD_CORNERS);
+
+		size_t dataSize = nbParticles * (sizeof(Vector3D) + sizeof(Color));
+		if (group.isEnabled(PARAM_SCALE)) dataSize += nbParticles * sizeof(float);
+		if (group.isEnabled(PARAM_ANGLE)) dataSize += nbParticles * sizeof(float);
+		if (group.isEnabled(PARAM_TEXTURE_INDEX)) dataSize += nbParticles * sizeof(float);
+
+		// The data of particles are either streamed into the buffer object or directly read from the group
+		const bool streamed = getVBOHint() && SPK_GL_CHECK_EXTENSION(SPK_GL_VBO_EXT);
+		if (streamed)
+			renderBuffer.bindStreamBuffer(dataSize);
+
+		// Instances cannot be drawn by indices so the data of sorted particles are gathered in the sorted order
+		const unsigned int* sortedIndices = group.getSortedIndices();
+		char* sortedData = sortedIndices != NULL ? static_cast<char*>(renderBuffer.getScratchBuffer(dataSize)) : NULL;
+
+		size_t offset = 0;
+		setInstanceAttribute(ATTRIBUTE_POSITION,3,GL_FLOAT,GL_FALSE,sortInstanceData<Vector3D>(group.getPositionAddress(),sortedIndices,nbParticles,sortedData),nbParticles * sizeof(Vector3D),streamed,offset);
+		setInstanceAttribute(ATTRIBUTE_COLOR,4,GL_UNSIGNED_BYTE,GL_TRUE,sortInstanceData<Color>(group.getColorAddress(),sortedIndices,nbParticles,sortedData),nbParticles * sizeof(Color),streamed,offset);
+		setParamAttribute(ATTRIBUTE_SCALE,group,PARAM_SCALE,1.0f,sortedIndices,sortedData,streamed,offset);
+		setParamAttribute(ATTRIBUTE_ANGLE,group,PARAM_ANGLE,0.0f,sortedIndices,sortedData,streamed,offset);
+		setParamAttribute(ATTRIBUTE_TEXTURE_INDEX,group,PARAM_TEXTURE_INDEX,0.0f,sortedIndices,sortedData,streamed,offset);
+
+		glDrawArraysInstancedARB(GL_TRIANGLE_FAN,0,4,static_cast<GLsizei>(nbParticles));
+
+		// Restores the states
+		for (GLuint i = 0; i < NB_ATTRIBUTES; ++i)
+		{
+			glDisableVertexAttribArray(i);
+			glVertexAttribDivisorARB(i,0);
+		}
+
+		if (streamed)
+			glBindBuffer(GL_ARRAY_BUFFER,0);
+		glUseProgram(0);
+	}
+#endif
+
+	void GLQuadRenderer::expandQuads(const Group& group,GLBuffer& renderBuffer) const
+	{
+		QuadExpander expander;
+		expander.setOrientation(orientationSide(),orientationUp());
+		expander.setScale(scaleX,scaleY);
+		expander.setTexturing(texturingMode,textureAtlasNbX,textureAtlasNbY);
+
+		QuadVertexArrays arrays;
+		arrays.positions = renderBuffer.getVertexBuffer();
+		arrays.positionStride = sizeof(Vector3D);
+		arrays.colors = renderBuffer.getColorBuffer();
+		arrays.colorStride = sizeof(Color);
+		arrays.texCoords = NULL;
+		arrays.texCoordStride = 0;
+
+		// The texture coordinates of non atlas 2D textures are constant and were set at the creation of the buffer
+		if (texturingMode == TEXTURE_MODE_3D || (texturingMode == TEXTURE_MODE_2D && group.isEnabled(PARAM_TEXTURE_INDEX)))
+		{
+			arrays.texCoords = renderBuffer.getTexCoordBuffer();
+			arrays.texCoordStride = renderBuffer.getNbTexCoords() * sizeof(float);
+		}
+
+		expander.expand(group,arrays);
 	}
 
 	void GLQuadRenderer::computeAABB(Vector3D& AABBMin,Vector3D& AABBMax,const Group& group,const DataSet* dataSet) const